@@ -140,6 +140,13 @@ void CheckpointAdapter::receiveCommandSuccess(Command* cmd) {
   }
 }
 
+void CheckpointAdapter::receiveCommandFailed(Command* cmd) {
+  if (cmd != NULL) {
+    getInterface().handleCommandAck(cmd, COMMAND_FAILED);
+    getInterface().notifyOfExternalEvent();
+  }
+}
+
 ///////////////////////////// Member functions //////////////////////////////////
 
 
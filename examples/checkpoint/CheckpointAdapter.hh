@@ -79,6 +79,7 @@ public:
 
   void receiveCommandReceived(PLEXIL::Command* cmd);
   void receiveCommandSuccess(PLEXIL::Command* cmd);
+  void receiveCommandFailed(PLEXIL::Command* cmd);
 
 private:
 
@@ -26,6 +26,7 @@
 
 #include "CheckpointSystem.hh"
 #include "Guard.hh"
+#include "JournalSaveManager.hh"
 #include "SimpleSaveManager.hh"
 #include "Publisher.hh"
 
@@ -101,6 +102,12 @@ void CheckpointSystem::useTime(bool use_time) {
 }
 
 void CheckpointSystem::setSaveConfiguration(const pugi::xml_node* configXml){
+  // Select the save manager; SimpleSaveManager is the default
+  if (configXml && string(configXml->attribute("Manager").value()) == "Journal") {
+    debug("Using JournalSaveManager");
+    m_manager = std::make_unique<JournalSaveManager>();
+    m_manager->useTime(m_use_time);
+  }
   m_manager->setConfig(configXml);
 }
 
@@ -0,0 +1,556 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "JournalSaveManager.hh"
+
+#include "Publisher.hh" // publishCommandSuccess(), publishCommandFailed()
+
+// PLEXIL includes
+#include "Debug.hh"
+#include "StateCache.hh" // queryTime(), currentTime()
+
+#include "pugixml.hpp"
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C++ Standard Library includes
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+
+// C library includes
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+using std::map;
+using namespace PLEXIL;
+
+#define debug(msg) debugMsg("JournalSaveManager"," "<<msg)
+
+// Defined in SimpleSaveManager.cc
+int mkdir_p(const char *path);
+
+/////////////////////// Journal format //////////////////////////
+
+// The journal begins with a magic number and format version, followed
+// by records.  Each record is a fixed-size header, followed by the
+// checkpoint name and info strings, if any.
+
+static const char JOURNAL_MAGIC[8] = {'P', 'X', 'C', 'K', 'J', 'N', 'L', '\0'};
+static const uint32_t JOURNAL_VERSION = 1;
+static const size_t JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + sizeof(uint32_t);
+
+static const char *JOURNAL_FILE_NAME = "journal.bin";
+
+enum JournalRecordType : uint8_t
+  {
+   J_NONE = 0,
+   J_BOOT,       // New boot: time of boot
+   J_OK,         // is_ok of some boot
+   J_CHECKPOINT, // Checkpoint state, time, name, info
+   J_SAVE,       // Time of last save
+   J_INVALID
+  };
+
+struct JournalRecord
+{
+  uint32_t checksum;    // of the remainder of the header and the strings
+  uint8_t type;
+  uint8_t state;        // checkpoint state or is_ok
+  uint8_t has_time;
+  uint8_t reserved;
+  uint32_t boot;        // absolute boot number
+  uint32_t name_length;
+  uint32_t info_length;
+  uint32_t reserved2;
+  double time;
+};
+
+static_assert(sizeof(JournalRecord) == 32, "JournalRecord has unexpected padding");
+
+static uint32_t checksum(const char *data, size_t len, uint32_t hash = 2166136261u)
+{
+  // FNV-1a
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= (uint8_t) data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static void appendRecord(vector<char> &buf, uint8_t type, uint32_t boot, bool state,
+                         const Nullable<Real> &time,
+                         const string &name, const string &info)
+{
+  JournalRecord rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.type = type;
+  rec.state = state ? 1 : 0;
+  rec.has_time = time.has_value() ? 1 : 0;
+  rec.boot = boot;
+  rec.name_length = (uint32_t) name.size();
+  rec.info_length = (uint32_t) info.size();
+  rec.time = time.has_value() ? time.value() : 0.0;
+
+  const char *body = reinterpret_cast<const char *>(&rec) + sizeof(rec.checksum);
+  uint32_t sum = checksum(body, sizeof(rec) - sizeof(rec.checksum));
+  sum = checksum(name.data(), name.size(), sum);
+  rec.checksum = checksum(info.data(), info.size(), sum);
+
+  const char *bytes = reinterpret_cast<const char *>(&rec);
+  buf.insert(buf.end(), bytes, bytes + sizeof(rec));
+  buf.insert(buf.end(), name.begin(), name.end());
+  buf.insert(buf.end(), info.begin(), info.end());
+}
+
+// Apply the records in the buffer to the boot history.
+// Returns the length of the valid prefix of the buffer.
+static size_t applyRecords(const char *data, size_t len,
+                           map<uint32_t, BootData> &image, size_t &count)
+{
+  size_t offset = 0;
+  while (len - offset >= sizeof(JournalRecord)) {
+    JournalRecord rec;
+    memcpy(&rec, data + offset, sizeof(rec));
+    size_t strings = (size_t) rec.name_length + rec.info_length;
+    if (len - offset - sizeof(rec) < strings)
+      break; // truncated
+    const char *name = data + offset + sizeof(rec);
+    uint32_t sum = checksum(data + offset + sizeof(rec.checksum),
+                            sizeof(rec) - sizeof(rec.checksum) + strings);
+    if (sum != rec.checksum || rec.type == J_NONE || rec.type >= J_INVALID)
+      break; // torn write
+
+    Nullable<Real> time;
+    if (rec.has_time)
+      time.set_value(rec.time);
+    BootData &boot = image[rec.boot];
+    switch (rec.type) {
+    case J_BOOT:
+      boot.boot_time = time;
+      boot.crash_time.nullify();
+      boot.is_ok = false;
+      boot.checkpoints.clear();
+      break;
+
+    case J_OK:
+      boot.is_ok = rec.state;
+      break;
+
+    case J_CHECKPOINT: {
+      CheckpointData checkpoint = {(bool) rec.state,
+                                   time,
+                                   string(name + rec.name_length, rec.info_length)};
+      boot.checkpoints[string(name, rec.name_length)] = checkpoint;
+      break;
+    }
+
+    case J_SAVE:
+      boot.crash_time = time;
+      break;
+    }
+    offset += sizeof(rec) + strings;
+    ++count;
+  }
+  return offset;
+}
+
+// Write the whole buffer, retrying as needed.
+static bool writeAll(int fd, const char *data, size_t len)
+{
+  while (len) {
+    ssize_t n = ::write(fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+static Nullable<Real> now()
+{
+  // Use currentTime, not queryTime, because the TimeAdapter may
+  // already have quit
+  Nullable<Real> time(StateCache::currentTime());
+  if (time.value() == std::numeric_limits<double>::min())
+    time.nullify();
+  return time;
+}
+
+//////////////////////// Class Features ////////////////////////////
+
+JournalSaveManager::JournalSaveManager()
+  : SaveManager(),
+    m_queuedSeq(0),
+    m_durableSeq(0),
+    m_stop(false),
+    m_failed(false),
+    m_recordCount(0),
+    m_compactAt(0),
+    m_fd(-1),
+    m_file_directory("./saves"),
+    m_compaction_threshold(1024),
+    m_group_commit_ms(0),
+    m_current_boot(0),
+    m_have_read(false)
+{
+}
+
+JournalSaveManager::~JournalSaveManager()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_stop = true;
+  }
+  m_pendingCv.notify_all();
+  if (m_writer.joinable())
+    m_writer.join(); // writes out anything still queued
+  if (m_fd >= 0)
+    ::close(m_fd);
+  // Pointers in m_pendingCommands are managed elsewhere
+}
+
+void JournalSaveManager::setData(vector<BootData> *data, int32_t *num_total_boots)
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  m_data_vector = data;
+  m_num_total_boots = num_total_boots;
+}
+
+void JournalSaveManager::useTime(bool use_time)
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  m_use_time = use_time;
+}
+
+void JournalSaveManager::setConfig(const pugi::xml_node* configXml)
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  if (configXml == NULL || !configXml->attribute("Directory")) {
+    cerr << "JournalSaveManager: No \"Directory\" attribute found in configuration, defaulting to ./saves" << endl;
+    m_file_directory = "./saves";
+  }
+  else
+    m_file_directory = configXml->attribute("Directory").value();
+
+  if (configXml) {
+    pugi::xml_attribute attr = configXml->attribute("CompactionThreshold");
+    if (attr)
+      m_compaction_threshold = std::max(1u, attr.as_uint());
+    attr = configXml->attribute("GroupCommitInterval");
+    if (attr)
+      m_group_commit_ms = attr.as_uint();
+  }
+  debug("directory " << m_file_directory
+        << ", compaction threshold " << m_compaction_threshold
+        << ", group commit interval " << m_group_commit_ms << " ms");
+}
+
+string JournalSaveManager::journalName() const
+{
+  return m_file_directory + "/" + JOURNAL_FILE_NAME;
+}
+
+size_t JournalSaveManager::readJournal()
+{
+  std::ifstream in(journalName().c_str(), std::ios::binary);
+  if (!in)
+    return 0;
+  vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  uint32_t version = 0;
+  if (data.size() >= JOURNAL_HEADER_SIZE)
+    memcpy(&version, &data[sizeof(JOURNAL_MAGIC)], sizeof(version));
+  if (data.size() < JOURNAL_HEADER_SIZE
+      || memcmp(&data[0], JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC))
+      || version != JOURNAL_VERSION) {
+    cerr << "JournalSaveManager: " << journalName() << " is not a valid journal, ignoring" << endl;
+    return 0;
+  }
+  size_t valid = JOURNAL_HEADER_SIZE
+    + applyRecords(&data[JOURNAL_HEADER_SIZE], data.size() - JOURNAL_HEADER_SIZE,
+                   m_image, m_recordCount);
+  if (valid < data.size())
+    cerr << "JournalSaveManager: discarding " << data.size() - valid
+         << " bytes of incomplete records from " << journalName() << endl;
+  debug("read " << m_recordCount << " records for " << m_image.size() << " boots");
+  return valid;
+}
+
+bool JournalSaveManager::openJournal()
+{
+  if (mkdir_p(m_file_directory.c_str()) != 0) {
+    cerr << "JournalSaveManager: Unable to create directory " << m_file_directory << endl;
+    return false;
+  }
+  size_t valid = readJournal();
+  m_fd = ::open(journalName().c_str(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR);
+  if (m_fd < 0) {
+    cerr << "JournalSaveManager: Unable to open " << journalName()
+         << ": " << strerror(errno) << endl;
+    return false;
+  }
+  // Discard any torn record at the end, or an invalid file
+  if (::ftruncate(m_fd, valid) != 0
+      || ::lseek(m_fd, 0, SEEK_END) < 0) {
+    cerr << "JournalSaveManager: Unable to prepare " << journalName()
+         << ": " << strerror(errno) << endl;
+    return false;
+  }
+  if (valid == 0) {
+    vector<char> header(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+    const char *version = reinterpret_cast<const char *>(&JOURNAL_VERSION);
+    header.insert(header.end(), version, version + sizeof(JOURNAL_VERSION));
+    if (!writeAll(m_fd, &header[0], header.size())) {
+      cerr << "JournalSaveManager: Unable to write " << journalName()
+           << ": " << strerror(errno) << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void JournalSaveManager::loadCrashes()
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  if (m_have_read) {
+    cerr << "Aleady loaded crashes, this operation only supported once" << endl;
+    return;
+  }
+  m_have_read = true;
+
+  if (!openJournal())
+    m_failed = true;
+  m_compactAt = std::max(m_compaction_threshold, 2 * m_recordCount);
+
+  // Current boot first, then previous boots from newest to oldest
+  m_current_boot = m_image.empty() ? 1 : m_image.rbegin()->first + 1;
+  *m_num_total_boots = m_current_boot;
+
+  Nullable<Real> time;
+  if (m_use_time) {
+    // Use queryTime here because this is likely the first time we are reading the time
+    time.set_value(StateCache::queryTime());
+    if (time.value() == std::numeric_limits<double>::min())
+      time.nullify();
+  }
+  BootData boot_d = {time,
+                     Nullable<Real>(),
+                     false,
+                     map<const string, CheckpointData>()};
+  m_data_vector->clear();
+  m_data_vector->push_back(boot_d);
+  for (BootMap::const_reverse_iterator it = m_image.rbegin(); it != m_image.rend(); ++it)
+    m_data_vector->push_back(it->second);
+  debug("boot " << m_current_boot << ", " << m_image.size() << " previous boots");
+
+  enqueue(J_BOOT, m_current_boot, false, time, string(), string(), NULL);
+  m_writer = std::thread([this]() { run(); });
+}
+
+uint64_t JournalSaveManager::enqueue(uint8_t type, uint32_t boot, bool state,
+                                     const Nullable<Real> &time,
+                                     const string &name, const string &info,
+                                     Command *cmd)
+{
+  appendRecord(m_pending, type, boot, state, time, name, info);
+  if (cmd)
+    m_pendingCommands.push_back(cmd);
+  if (m_use_time)
+    m_saveTime = now();
+  m_pendingCv.notify_one();
+  return ++m_queuedSeq;
+}
+
+void JournalSaveManager::setOK(bool b, Integer boot_num, Command *cmd)
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  enqueue(J_OK, m_current_boot - (uint32_t) boot_num, b,
+          Nullable<Real>(), string(), string(), cmd);
+}
+
+void JournalSaveManager::setCheckpoint(const string& checkpoint_name, bool value,
+                                       string& info, Nullable<Real> time, Command *cmd)
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  enqueue(J_CHECKPOINT, m_current_boot, value, time, checkpoint_name, info, cmd);
+}
+
+bool JournalSaveManager::writeOut()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (!m_have_read) {
+    cerr << "JournalSaveManager: writeOut called before loadCrashes" << endl;
+    return false;
+  }
+  // Record the time of this save even if nothing else has changed
+  uint64_t seq = enqueue(J_SAVE, m_current_boot, false,
+                         m_use_time ? now() : Nullable<Real>(),
+                         string(), string(), NULL);
+  m_durableCv.wait(lock, [this, seq]() { return m_durableSeq >= seq; });
+  return !m_failed;
+}
+
+void JournalSaveManager::run()
+{
+  vector<char> batch;
+  vector<Command *> commands;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_pendingCv.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+    if (m_pending.empty())
+      break; // stopping, and all changes written
+
+    // Allow further changes to accumulate for the same commit
+    if (m_group_commit_ms && !m_stop)
+      m_pendingCv.wait_for(lock, std::chrono::milliseconds(m_group_commit_ms),
+                           [this]() { return m_stop; });
+
+    batch.swap(m_pending);
+    commands.swap(m_pendingCommands);
+    if (m_saveTime.has_value()) {
+      appendRecord(batch, J_SAVE, m_current_boot, false, m_saveTime, string(), string());
+      m_saveTime.nullify();
+    }
+    uint64_t seq = m_queuedSeq;
+    bool failed = m_failed;
+    lock.unlock();
+
+    bool ok = !failed && commit(batch);
+    if (!ok)
+      cerr << "JournalSaveManager: Unable to save " << commands.size()
+           << " change(s) to " << journalName() << endl;
+    // Report success only for changes which are durable
+    debug("sending " << (ok ? "success" : "failure") << " to "
+          << commands.size() << " command(s)");
+    for (Command *cmd : commands) {
+      if (ok)
+        publishCommandSuccess(cmd);
+      else
+        publishCommandFailed(cmd);
+    }
+    batch.clear();
+    commands.clear();
+
+    lock.lock();
+    if (!ok)
+      m_failed = true;
+    m_durableSeq = seq;
+    m_durableCv.notify_all();
+
+    if (ok && m_recordCount >= m_compactAt) {
+      lock.unlock();
+      if (!compact())
+        cerr << "JournalSaveManager: Compaction of " << journalName() << " failed" << endl;
+      lock.lock();
+    }
+  }
+}
+
+bool JournalSaveManager::commit(const vector<char> &records)
+{
+  if (!writeAll(m_fd, &records[0], records.size()) || ::fsync(m_fd) != 0) {
+    cerr << "JournalSaveManager: Write to " << journalName()
+         << " failed: " << strerror(errno) << endl;
+    return false;
+  }
+  size_t before = m_recordCount;
+  applyRecords(&records[0], records.size(), m_image, m_recordCount);
+  debug("committed " << m_recordCount - before << " records, "
+        << records.size() << " bytes");
+  return true;
+}
+
+bool JournalSaveManager::compact()
+{
+  // Build the minimal journal for the current history
+  vector<char> data(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+  const char *version = reinterpret_cast<const char *>(&JOURNAL_VERSION);
+  data.insert(data.end(), version, version + sizeof(JOURNAL_VERSION));
+  size_t live = 0;
+  for (BootMap::const_iterator it = m_image.begin(); it != m_image.end(); ++it) {
+    const BootData &boot = it->second;
+    appendRecord(data, J_BOOT, it->first, false, boot.boot_time, string(), string());
+    ++live;
+    if (boot.is_ok) {
+      appendRecord(data, J_OK, it->first, true, Nullable<Real>(), string(), string());
+      ++live;
+    }
+    for (map<const string, CheckpointData>::const_iterator cp = boot.checkpoints.begin();
+         cp != boot.checkpoints.end();
+         ++cp) {
+      appendRecord(data, J_CHECKPOINT, it->first, cp->second.state, cp->second.time,
+                   cp->first, cp->second.info);
+      ++live;
+    }
+    if (boot.crash_time.has_value()) {
+      appendRecord(data, J_SAVE, it->first, false, boot.crash_time, string(), string());
+      ++live;
+    }
+  }
+
+  // Write it to a temporary file, then replace the journal with it.
+  // If we crash before the rename, the old journal is still valid.
+  string temp = journalName() + ".part";
+  int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0)
+    return false;
+  if (!writeAll(fd, &data[0], data.size()) || ::fsync(fd) != 0
+      || ::rename(temp.c_str(), journalName().c_str()) != 0) {
+    ::close(fd);
+    ::remove(temp.c_str());
+    return false;
+  }
+
+  // Make the rename durable
+  int dir = ::open(m_file_directory.c_str(), O_RDONLY);
+  if (dir >= 0) {
+    ::fsync(dir);
+    ::close(dir);
+  }
+
+  ::close(m_fd);
+  m_fd = fd;
+  debug("compacted " << m_recordCount << " records to " << live);
+  m_recordCount = live;
+  m_compactAt = std::max(m_compaction_threshold, 2 * live);
+  return true;
+}
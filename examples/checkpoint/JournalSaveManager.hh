@@ -0,0 +1,135 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _H_JournalSaveManager
+#define _H_JournalSaveManager
+
+#include "SaveManager.hh"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+
+// A SaveManager which appends each change to a binary journal,
+// instead of rewriting the entire boot history on every change.
+//
+// Changes are queued by the calling thread and written by a
+// dedicated writer thread, which commits everything queued since its
+// last write with a single fsync().  Commands are acknowledged only
+// once their records are on disk.  The writer periodically rewrites
+// the journal to hold only the current contents, so the journal's
+// size is proportional to the history rather than the number of
+// changes.
+//
+// Selected by Manager="Journal" in the SaveConfiguration element.
+// Additional attributes:
+//  Directory           - directory for the journal file (default ./saves)
+//  CompactionThreshold - minimum number of records in the journal before
+//                        it is compacted (default 1024)
+//  GroupCommitInterval - milliseconds to wait after the first change for
+//                        further changes to commit with it (default 0)
+
+class JournalSaveManager : public SaveManager
+{
+public:
+
+  JournalSaveManager();
+  virtual ~JournalSaveManager();
+
+  virtual void setData(std::vector<BootData> *data, int *num_total_boots);
+
+  virtual void setConfig(const pugi::xml_node* configXml);
+
+  virtual void useTime(bool use_time);
+
+  virtual void loadCrashes();
+
+  // Waits until all changes made so far are on disk
+  virtual bool writeOut();
+
+  // Queue the change; the command succeeds when the change is on disk
+  virtual void setOK(bool b, PLEXIL::Integer boot_num, PLEXIL::Command *cmd);
+  virtual void setCheckpoint(const std::string& checkpoint_name, bool value,
+                             std::string& info, Nullable<PLEXIL::Real> time,
+                             PLEXIL::Command *cmd);
+
+private:
+  // Disallow copy
+  JournalSaveManager & operator=(const JournalSaveManager&) = delete;
+  JournalSaveManager(const JournalSaveManager&) = delete;
+
+  // Boot history, indexed by absolute boot number
+  typedef std::map<uint32_t, BootData> BootMap;
+
+  // Queue a record; caller must hold m_mutex
+  uint64_t enqueue(uint8_t type, uint32_t boot, bool state,
+                   Nullable<PLEXIL::Real> const &time,
+                   std::string const &name, std::string const &info,
+                   PLEXIL::Command *cmd);
+
+  // Writer thread
+  void run();
+  bool openJournal();
+  bool commit(std::vector<char> const &records);
+  bool compact();
+
+  // Read the journal into m_image; returns the length of the valid prefix
+  size_t readJournal();
+
+  std::string journalName() const;
+
+  // Guarded by m_mutex
+  std::mutex m_mutex;
+  std::condition_variable m_pendingCv;
+  std::condition_variable m_durableCv;
+  std::vector<char> m_pending;
+  std::vector<PLEXIL::Command *> m_pendingCommands;
+  Nullable<PLEXIL::Real> m_saveTime; // time of last queued change
+  uint64_t m_queuedSeq;  // sequence number of last queued record
+  uint64_t m_durableSeq; // sequence number of last record on disk
+  bool m_stop;
+  bool m_failed;
+
+  // Owned by the writer thread once started
+  BootMap m_image;
+  size_t m_recordCount;  // records in the journal file
+  size_t m_compactAt;    // record count at which to compact
+  int m_fd;
+
+  // Configuration
+  std::string m_file_directory;
+  size_t m_compaction_threshold;
+  unsigned int m_group_commit_ms;
+
+  uint32_t m_current_boot;
+  bool m_have_read;
+  std::thread m_writer;
+};
+#endif
@@ -62,5 +62,7 @@ void publishCommandReceived (PLEXIL::Command* cmd);
 
 void publishCommandSuccess  (PLEXIL::Command* cmd); 
 
+void publishCommandFailed   (PLEXIL::Command* cmd);
+
 
 #endif // CHECKPOINT_PUBLISHER_HH
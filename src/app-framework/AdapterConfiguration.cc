@@ -67,6 +67,10 @@
 #include "PlanDebugListener.hh"
 #endif
 
+#ifdef HAVE_FLIGHT_RECORDER
+#include "FlightRecorder.hh"
+#endif
+
 #ifdef HAVE_IPC_ADAPTER
 #include "IpcAdapter.h"
 #endif
@@ -80,12 +84,39 @@
 #endif
 #endif // not defined(PIC)
 
-#include <map>
+#include <unordered_map>
 
 #include <cstring>
 
 namespace PLEXIL {
 
+  //! Brackets a call to a handler, so that responses the handler
+  //! makes before returning are applied without queueing.
+  class DispatchGuard final
+  {
+  public:
+    DispatchGuard(InterfaceManager *mgr)
+      : m_manager(mgr)
+    {
+      m_manager->beginDispatch();
+    }
+
+    ~DispatchGuard()
+    {
+      m_manager->endDispatch();
+    }
+
+  private:
+    // Not implemented
+    DispatchGuard() = delete;
+    DispatchGuard(DispatchGuard const &) = delete;
+    DispatchGuard(DispatchGuard &&) = delete;
+    DispatchGuard &operator=(DispatchGuard const &) = delete;
+    DispatchGuard &operator=(DispatchGuard &&) = delete;
+
+    InterfaceManager *m_manager;
+  };
+
   //*
   // @class AdapterConfigurationImpl
   // @brief Implementation class for AdapterConfiguration
@@ -99,8 +130,9 @@ namespace PLEXIL {
     // punt for now
     using InterfaceAdapterSet = std::vector<InterfaceAdapterPtr>;
 
-    using CommandHandlerMap = std::map<std::string, CommandHandlerPtr>;
-    using LookupHandlerMap = std::map<std::string, LookupHandlerPtr>;
+    // Hashed, as these are consulted for every command and lookup
+    using CommandHandlerMap = std::unordered_map<std::string, CommandHandlerPtr>;
+    using LookupHandlerMap = std::unordered_map<std::string, LookupHandlerPtr>;
 
 
   public:
@@ -138,6 +170,15 @@ namespace PLEXIL {
 #endif
 #endif
 
+#ifdef HAVE_FLIGHT_RECORDER
+      // Every application should have access to the Flight Recorder
+#ifdef PIC
+      dynamicLoadModule("FlightRecorder", nullptr);
+#else
+      initFlightRecorder();
+#endif
+#endif
+
 #ifdef HAVE_IPC_ADAPTER
       // Every application should have access to the IPC Adapter
 #ifdef PIC
@@ -523,6 +564,7 @@ namespace PLEXIL {
     //! @param The command to be executed.
     virtual void executeCommand(Command *cmd)
     {
+      DispatchGuard guard(m_manager);
       try {
         getCommandHandler(cmd->getName())->executeCommand(cmd, m_manager);
       }
@@ -547,6 +589,7 @@ namespace PLEXIL {
     //! @param cmd The command to abort..
     virtual void invokeAbort(Command *cmd)
     {
+      DispatchGuard guard(m_manager);
       try {
         getCommandHandler(cmd->getName())->abortCommand(cmd, m_manager);
       }
@@ -563,6 +606,7 @@ namespace PLEXIL {
     virtual void executeUpdate(Update *update)
     {
       assertTrue_1(update);
+      DispatchGuard guard(m_manager);
       PlannerUpdateHandler handler = getPlannerUpdateHandler();
       if (!handler) {
         // Fake the ack
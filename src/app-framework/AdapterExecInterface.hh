@@ -76,6 +76,10 @@ namespace PLEXIL
     //
     // Command API
     //
+    // Responses made from within a handler's executeCommand() or
+    // abortCommand(), on the calling thread, are applied to the Exec
+    // immediately rather than queued.
+    //
 
     //!
     // @brief Notify of the availability of a command handle value for a command.
@@ -29,13 +29,19 @@
 #include "AdapterConfiguration.hh"
 #include "Debug.hh"
 #include "ExecListenerHub.hh"
+#include "ExecSnapshot.hh"
 #include "InterfaceAdapter.hh"
 #include "InterfaceManager.hh"
+#include "InterfaceSchema.hh"
 #include "InputQueue.hh"
+#include "NodeImpl.hh"
+#include "NodeStateTable.hh"
 #include "ParserException.hh"
 #include "PlexilExec.hh"
 #include "PlexilSchema.hh"
+#include "QueueJournal.hh"
 #include "StateCache.hh"
+#include "Timebase.hh"
 
 #include "pugixml.hpp"
 
@@ -55,6 +61,8 @@
 #include <unistd.h> // sleep()
 #endif
 
+#include <atomic>
+#include <chrono>
 #include <exception>
 #include <mutex>
 #include <thread>
@@ -208,9 +216,14 @@ namespace PLEXIL
     //! queries about the exec state.
     std::mutex m_execMutex;
 
-    // Semaphore for notifying the Exec of external events
+    // Semaphore for waking the worker thread on external events
     ThreadSemaphore m_sem;
 
+    //! True if m_sem has been posted and the worker has not yet
+    //! started processing the queue.  Further notifications are
+    //! coalesced into the pending wakeup.
+    std::atomic<bool> m_wakeupPending;
+
     // Semaphore for notifyAndWaitForCompletion()
     ThreadSemaphore m_markSem;
 
@@ -220,6 +233,12 @@ namespace PLEXIL
     // Semaphore for waiting on all plans to finish
     ThreadSemaphore m_allFinishedSem;
 
+    //! Minimum time between starts of successive worker runs
+    std::chrono::steady_clock::duration m_minStepInterval;
+
+    //! Start time of the most recent worker run
+    std::chrono::steady_clock::time_point m_lastRunStart;
+
     //! Last mark seen
     unsigned int m_lastMark;
 #endif 
@@ -236,6 +255,18 @@ namespace PLEXIL
     //! Exec listener hub
     ExecListenerHubPtr m_listener;
 
+    //! Journal of Exec input, if recording
+    std::unique_ptr<QueueRecorder> m_recorder;
+
+    //! Saved Exec state, if enabled
+    std::unique_ptr<ExecSnapshot> m_snapshot;
+
+    //! Maximum micro steps per time slice; 0 if unlimited
+    unsigned int m_sliceMicroSteps;
+
+    //! Maximum time slice duration in seconds; 0 if unlimited
+    double m_sliceSeconds;
+
     // Flag to determine whether exec should run conservatively
     bool m_runExecInBkgndOnly;
 
@@ -263,15 +294,22 @@ namespace PLEXIL
         m_workerThread(),
         m_execMutex(),
         m_sem(),
+        m_wakeupPending(false),
         m_markSem(),
         m_shutdownSem(),
         m_allFinishedSem(),
+        m_minStepInterval(std::chrono::steady_clock::duration::zero()),
+        m_lastRunStart(),
         m_lastMark(0),
 #endif
         m_configuration(makeAdapterConfiguration()),
         m_manager(new InterfaceManager(this, m_configuration.get())),
         m_exec(makePlexilExec()),
         m_listener(new ExecListenerHub()),
+        m_recorder(),
+        m_snapshot(),
+        m_sliceMicroSteps(0),
+        m_sliceSeconds(0),
         m_runExecInBkgndOnly(true),
         m_initialized(false),
         m_interfacesStarted(false),
@@ -333,6 +371,59 @@ namespace PLEXIL
       m_runExecInBkgndOnly = bkgndOnly; 
     }
 
+    //! Set the minimum interval between worker runs of the Exec.
+    //! @param seconds The interval in seconds.  0 disables batching.
+    virtual void setMinimumStepInterval(double seconds) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      if (seconds < 0) {
+        warn("setMinimumStepInterval: ignoring negative interval " << seconds);
+        return;
+      }
+      m_minStepInterval =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>
+        (std::chrono::duration<double>(seconds));
+      debugMsg("ExecApplication:setMinimumStepInterval", ' ' << seconds);
+#endif
+    }
+
+    //! Limit the work the Exec does between checks of the input queue.
+    //! @param maxMicroSteps Maximum micro steps per time slice.  0 for no limit.
+    //! @param maxSeconds Maximum time slice duration in seconds.  0 for no limit.
+    virtual void setTimeSlice(unsigned int maxMicroSteps, double maxSeconds) override
+    {
+      if (maxSeconds < 0) {
+        warn("setTimeSlice: ignoring negative duration " << maxSeconds);
+        maxSeconds = 0;
+      }
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      m_sliceMicroSteps = maxMicroSteps;
+      m_sliceSeconds = maxSeconds;
+      m_exec->setTimeSlice(maxMicroSteps, maxSeconds);
+    }
+
+    //! Set the scheduling weight of a plan.
+    //! @param rootNodeId The node ID of the plan's root node.
+    //! @param weight The weight.  0 is treated as 1.
+    virtual void setPlanWeight(std::string const &rootNodeId, unsigned int weight) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      m_exec->setPlanWeight(rootNodeId, weight);
+    }
+
+    //! Enable or disable filtering of node condition change notifications.
+    //! @param enable True to filter, false to pass every notification.
+    virtual void setConditionNotificationFilter(bool enable) override
+    {
+      NodeImpl::setConditionNotificationFilter(enable);
+      debugMsg("ExecApplication:setConditionNotificationFilter",
+               ' ' << (enable ? "enabled" : "disabled"));
+    }
+
     //! Add the specified directory name to the end of the library node loading path.
     //! @param libdir The directory name.
     virtual void addLibraryPath(const std::string& libdir) override
@@ -374,6 +465,41 @@ namespace PLEXIL
       // Load debug configuration from XML
       // *** NYI ***
 
+      // Worker step rate
+      if (!configXml.empty()) {
+        pugi::xml_attribute intervalAttr =
+          configXml.attribute(InterfaceSchema::MIN_STEP_INTERVAL_ATTR);
+        if (!intervalAttr.empty())
+          setMinimumStepInterval(intervalAttr.as_double());
+
+        pugi::xml_attribute sliceStepsAttr =
+          configXml.attribute(InterfaceSchema::TIME_SLICE_MICRO_STEPS_ATTR);
+        pugi::xml_attribute sliceAttr =
+          configXml.attribute(InterfaceSchema::TIME_SLICE_ATTR);
+        if (!sliceStepsAttr.empty() || !sliceAttr.empty())
+          setTimeSlice(sliceStepsAttr.as_uint(), sliceAttr.as_double());
+
+        pugi::xml_attribute filterAttr =
+          configXml.attribute(InterfaceSchema::FILTER_CONDITION_NOTIFICATIONS_ATTR);
+        if (!filterAttr.empty())
+          setConditionNotificationFilter(filterAttr.as_bool());
+
+        // Plan scheduling weights
+        for (pugi::xml_node weightXml = configXml.child(InterfaceSchema::PLAN_WEIGHT_TAG);
+             weightXml;
+             weightXml = weightXml.next_sibling(InterfaceSchema::PLAN_WEIGHT_TAG)) {
+          char const *nodeId = weightXml.attribute(InterfaceSchema::NODE_ID_ATTR).value();
+          pugi::xml_attribute weightAttr = weightXml.attribute(InterfaceSchema::WEIGHT_ATTR);
+          if (!*nodeId || weightAttr.empty()) {
+            warn("ExecApplication: " << InterfaceSchema::PLAN_WEIGHT_TAG
+                 << " element requires " << InterfaceSchema::NODE_ID_ATTR
+                 << " and " << InterfaceSchema::WEIGHT_ATTR << " attributes");
+            return false;
+          }
+          setPlanWeight(nodeId, weightAttr.as_uint());
+        }
+      }
+
       // Construct interfaces
       if (!m_configuration->constructInterfaces(configXml, *m_manager, *m_listener)) {
         debugMsg("ExecApplication:initialize",
@@ -455,11 +581,14 @@ namespace PLEXIL
         debugMsg("ExecApplication:step", " Processing queue");
         m_manager->processQueue();
         debugMsg("ExecApplication:step", " Stepping exec");
-        m_exec->step(StateCache::queryTime());
+        m_exec->startTimeSlice();
+        stepExec();
         // Take care of any plans which have finished
         m_exec->deleteFinishedPlans();
         allFinished = m_exec->allPlansFinished();
         needsStep = m_exec->needsStep();
+        if (m_snapshot && !needsStep)
+          m_snapshot->checkpoint(*m_exec);
       }
 #ifdef PLEXIL_WITH_THREADS
       if (m_planLoaded && allFinished) {
@@ -492,16 +621,20 @@ namespace PLEXIL
         debugMsg("ExecApplication:runExec", " Processing queue");
         m_manager->processQueue();
         do {
+          // Take in fresh input whenever a time slice is exhausted
+          m_exec->startTimeSlice();
           do {
             debugMsg("ExecApplication:runExec", " Stepping exec");
-            m_exec->step(StateCache::queryTime());
-          } while (m_exec->needsStep());
+            stepExec();
+          } while (m_exec->needsStep() && !m_exec->timeSliceExpired());
           debugMsg("ExecApplication:runExec", " Processing queue");
-        } while (m_manager->processQueue());
+        } while (m_manager->processQueue() || m_exec->needsStep());
 
         // Clean up
         m_exec->deleteFinishedPlans();
         allFinished = m_exec->allPlansFinished();
+        if (m_snapshot)
+          m_snapshot->checkpoint(*m_exec);
         debugMsg("ExecApplication:runExec", " Queue empty and exec quiescent");
       }
 #ifdef PLEXIL_WITH_THREADS
@@ -600,7 +733,9 @@ namespace PLEXIL
       if (m_workerThread.joinable()) {
         debugMsg("ExecApplication:stop", " Halting top level thread");
         m_stop = true;
-        notifyExec();
+        // Post even if a wakeup is pending, as the worker may have
+        // checked m_stop before clearing the pending flag
+        m_wakeupPending.store(true);
         int status = m_sem.post();
         if (status) {
           warn("ExecApplication: semaphore post failed, status = " << status);
@@ -652,6 +787,173 @@ namespace PLEXIL
       std::cout << "PLEXIL Exec terminated" << std::endl;
     }
 
+    //
+    // Record and replay
+    //
+
+    //! Begin journaling Exec input to the named file.
+    //! @param filename The journal file name.
+    //! @return true if successful, false otherwise.
+    virtual bool startRecording(std::string const &filename) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      if (m_recorder) {
+        warn("startRecording: already recording");
+        return false;
+      }
+      m_recorder.reset(makeQueueRecorder(filename, m_configuration.get()));
+      if (!m_recorder)
+        return false;
+
+      // Interpose the recorder between the Exec and the interfaces
+      g_dispatcher = m_recorder.get();
+      m_exec->setDispatcher(m_recorder.get());
+      m_manager->setRecorder(m_recorder.get());
+      debugMsg("ExecApplication:startRecording", ' ' << filename);
+      return true;
+    }
+
+    //! Stop journaling Exec input and close the journal.
+    virtual void stopRecording() override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      if (!m_recorder)
+        return;
+      m_manager->setRecorder(nullptr);
+      m_exec->setDispatcher(m_configuration.get());
+      g_dispatcher = static_cast<Dispatcher *>(m_configuration.get());
+      m_recorder.reset();
+      debugMsg("ExecApplication:stopRecording", " complete");
+    }
+
+    //! Run the Exec from a journal recorded by startRecording().
+    //! @param filename The journal file name.
+    //! @return true if the journal was replayed in full, false otherwise.
+    virtual bool replay(std::string const &filename) override
+    {
+      if (!m_interfacesStarted) {
+        warn("Error: replay() called before startInterfaces()");
+        return false;
+      }
+#ifdef PLEXIL_WITH_THREADS
+      if (m_workerThread.joinable()) {
+        warn("Error: replay() called while the Exec is running");
+        return false;
+      }
+#endif
+      if (m_recorder) {
+        warn("Error: replay() called while recording");
+        return false;
+      }
+
+      bool result = false;
+      {
+#ifdef PLEXIL_WITH_THREADS
+        ThreadMutexGuard guard(m_execMutex);
+#endif
+        m_planLoaded = true;
+        result = replayQueueJournal(filename, *m_manager, *m_exec);
+        // Replay sets its own time slices
+        m_exec->setTimeSlice(m_sliceMicroSteps, m_sliceSeconds);
+      }
+#ifdef PLEXIL_WITH_THREADS
+      if (m_exec->allPlansFinished())
+        m_allFinishedSem.post();
+#endif
+      return result;
+    }
+
+    //
+    // Snapshot and restore
+    //
+
+    //! Save the Exec state to the named file at each quiescent point.
+    //! @param filename The snapshot file name.
+    //! @return true if successful, false otherwise.
+    virtual bool startSnapshots(std::string const &filename) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      if (m_snapshot) {
+        warn("startSnapshots: snapshots already enabled");
+        return false;
+      }
+      m_snapshot.reset(makeExecSnapshot(filename));
+      if (!m_snapshot)
+        return false;
+      m_manager->setSnapshot(m_snapshot.get());
+      debugMsg("ExecApplication:startSnapshots", ' ' << filename);
+      return true;
+    }
+
+    //! Restore the Exec state saved in the named file.
+    //! @param filename The snapshot file name.
+    //! @return true if the snapshot was restored in full, false otherwise.
+    virtual bool restoreSnapshot(std::string const &filename) override
+    {
+      if (!m_interfacesStarted) {
+        warn("Error: restoreSnapshot() called before startInterfaces()");
+        return false;
+      }
+#ifdef PLEXIL_WITH_THREADS
+      if (m_workerThread.joinable()) {
+        warn("Error: restoreSnapshot() called while the Exec is running");
+        return false;
+      }
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      bool result = restoreExecSnapshot(filename, *this, m_snapshot.get());
+      if (!m_exec->getPlans().empty())
+        m_planLoaded = true;
+      debugMsg("ExecApplication:restoreSnapshot",
+               ' ' << filename << (result ? " succeeded" : " failed"));
+      return result;
+    }
+
+    //! Return the Exec to its state before the first plan was added.
+    //! @return true if successful, false otherwise.
+    virtual bool reset() override
+    {
+      if (!m_initialized) {
+        warn("Error: reset() called before initialize()");
+        return false;
+      }
+
+      debugMsg("ExecApplication:reset", " entered");
+#ifdef PLEXIL_WITH_THREADS
+      unsigned int oldMark = m_lastMark;
+#endif
+      {
+#ifdef PLEXIL_WITH_THREADS
+        ThreadMutexGuard guard(m_execMutex);
+#endif
+        // Order matters: queued plans reference global mutexes,
+        // and plans' lookups are registered with the state cache
+        m_manager->reset();
+        m_exec->reset();
+        StateCache::instance().reset();
+        if (m_snapshot)
+          m_snapshot->reset();
+        m_planLoaded = false;
+      }
+#ifdef PLEXIL_WITH_THREADS
+      // Discard any stale notifications from the previous run
+      while (!m_allFinishedSem.tryWait())
+        continue;
+      if (m_lastMark > oldMark) {
+        debugMsg("ExecApplication:reset", " queue mark(s) discarded");
+        m_markSem.post();
+      }
+#endif
+      debugMsg("ExecApplication:reset", " complete");
+      return true;
+    }
+
     //! Notify the Exec thread that it should check the queue and run
     //! one cycle.
     virtual void notifyExec() override
@@ -668,14 +970,8 @@ namespace PLEXIL
       else {
         // Some thread currently owns the exec. Could be this thread.
         // runExec() could notice, or not.
-        // Post to semaphore to ensure event is not lost.
-        int status = m_sem.post();
-        if (status) {
-          warn("notifyExec: semaphore post failed, status = " << status);
-        }
-        else {
-          debugMsg("ExecApplication:notify", " released semaphore");
-        }
+        // Wake the worker to ensure event is not lost.
+        wakeWorker();
       }
 #endif
     }
@@ -722,6 +1018,16 @@ namespace PLEXIL
       return m_exec->allPlansFinished();
     }
 
+    //! Copy the current state of every node in every plan.
+    //! @param result The vector to receive the records.
+    virtual void dumpNodeStates(std::vector<NodeStateRecord> &result) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif
+      m_exec->getNodeStateTable().dump(result);
+    }
+
     /**
      * @brief Suspend the current thread until the application reaches APP_STOPPED state.
      * @note May be called by multiple threads
@@ -830,6 +1136,27 @@ namespace PLEXIL
     // Implementation methods
     //
 
+    //! Step the Exec once at the current time, journaling the step
+    //! if recording.
+    //! @note Caller must hold m_execMutex.
+    void stepExec()
+    {
+      double now = StateCache::queryTime();
+      if (!m_recorder) {
+        m_exec->step(now);
+        return;
+      }
+
+      // Record where a step exhausted its slice, so replay defers
+      // the same plans
+      m_recorder->recordStep(now);
+      unsigned int microSteps = m_exec->getTimeSliceMicroSteps();
+      m_exec->step(now);
+      if (m_exec->timeSliceExpired() && m_exec->needsStep())
+        m_recorder->recordStepLimit(m_exec->getTimeSliceMicroSteps() - microSteps);
+      m_recorder->stepComplete();
+    }
+
 #ifdef PLEXIL_WITH_THREADS
     /**
      * @brief Spawns the worker thread which runs the exec's top level loop.
@@ -859,6 +1186,7 @@ namespace PLEXIL
         // give any preloaded plans a chance to start
         step();
         debugMsg("ExecApplication:worker", " Initial step complete");
+        advanceVirtualTime();
 
         while (waitForExternalEvent()) {
           if (m_stop) {
@@ -866,7 +1194,13 @@ namespace PLEXIL
             m_stop = false; // acknowledge stop request
             break;
           }
+          waitForMinimumStepInterval();
+          // Clear the flag *before* draining the queue, so that any
+          // event queued after this point posts a fresh wakeup
+          m_wakeupPending.store(false);
+          m_lastRunStart = std::chrono::steady_clock::now();
           runExec();
+          advanceVirtualTime();
         }
       } catch (EmergencyBrake const &b) {
         debugMsg("ExecApplication:worker", " exiting on signal");
@@ -878,6 +1212,57 @@ namespace PLEXIL
       debugMsg("ExecApplication:worker", " finished.");
     }
 
+    //! If the timebase implements virtual time, and the Exec has
+    //! nothing left to do at the current time, skip ahead to the next
+    //! scheduled wakeup rather than waiting for it.
+    //! @note Must not be called with m_execMutex held, as the wakeup
+    //!       function will call notifyExec().
+    void advanceVirtualTime()
+    {
+      if (m_stop || m_suspended)
+        return;
+      {
+        ThreadMutexGuard guard(m_execMutex);
+        if (m_exec->needsStep() || !m_manager->isQueueEmpty())
+          return;
+      }
+      if (Timebase::advanceTime())
+        debugMsg("ExecApplication:worker", " advanced virtual time");
+    }
+
+    //! Wake the worker thread, unless a wakeup is already pending.
+    //! @return true if successful, false if the semaphore post failed.
+    bool wakeWorker()
+    {
+      if (m_wakeupPending.exchange(true)) {
+        debugMsg("ExecApplication:notify", " wakeup already pending");
+        return true;
+      }
+      int status = m_sem.post();
+      if (status) {
+        m_wakeupPending.store(false);
+        warn("ExecApplication: semaphore post failed, status = " << status);
+        return false;
+      }
+      debugMsg("ExecApplication:notify", " released semaphore");
+      return true;
+    }
+
+    //! If a minimum step interval is set, sleep until it has elapsed
+    //! since the start of the previous run.  Events arriving in the
+    //! meantime are coalesced into the pending wakeup.
+    void waitForMinimumStepInterval()
+    {
+      if (m_minStepInterval == std::chrono::steady_clock::duration::zero())
+        return;
+      std::chrono::steady_clock::time_point next =
+        m_lastRunStart + m_minStepInterval;
+      if (std::chrono::steady_clock::now() < next) {
+        debugMsg("ExecApplication:wait", " delaying for minimum step interval");
+        std::this_thread::sleep_until(next);
+      }
+    }
+
     //! Suspends the calling thread until another thread has placed a
     //! call to notifyExec(). Can return immediately if the call to
     //! wait() returns an error.
@@ -893,6 +1278,7 @@ namespace PLEXIL
         if (!m_stop && m_suspended) {
           debugMsg("ExecApplication:wait",
                    " Application is suspended, ignoring external event");
+          m_wakeupPending.store(false);
         }
       } while (!m_stop && m_suspended);
 
@@ -47,6 +47,7 @@ namespace PLEXIL
   class ExecListenerHub;
   class InterfaceManager;
   class PlexilExec;
+  struct NodeStateRecord;
 
   //! @class ExecApplication
   //! Provides the skeleton of a complete PLEXIL Executive application.
@@ -66,6 +67,55 @@ namespace PLEXIL
     //! @note Default is background only.
     virtual void setRunExecInBkgndOnly(bool bkgndOnly) = 0;
 
+    //! Set the minimum interval between the starts of successive
+    //! runs of the Exec in the worker thread.  External events
+    //! arriving within the interval are batched into the next run.
+    //! @param seconds The interval in seconds.  0 disables batching.
+    //! @note Default is 0.  Has no effect if PLEXIL is built without threads.
+    //! @note May also be set by the MinimumStepInterval attribute of
+    //!       the Interfaces configuration element.
+    virtual void setMinimumStepInterval(double seconds) = 0;
+
+    //! Limit the work the Exec does between checks of the input
+    //! queue.  When a time slice is exhausted, the macro step in
+    //! progress finishes the plans it has already served, leaves the
+    //! others for later, and the queue is processed before the Exec
+    //! steps again.  Each plan's step still runs to quiescence, so
+    //! this bounds the latency of external input between plans, and
+    //! between the macro steps of a plan which keeps the Exec busy,
+    //! but not within one plan's step.
+    //! @param maxMicroSteps Maximum micro steps per time slice.  0 for no limit.
+    //! @param maxSeconds Maximum time slice duration in seconds.  0 for no limit.
+    //! @note Default is no limit, i.e. each macro step runs to quiescence.
+    //! @note May also be set by the TimeSliceMicroSteps and TimeSlice
+    //!       attributes of the Interfaces configuration element.
+    virtual void setTimeSlice(unsigned int maxMicroSteps, double maxSeconds) = 0;
+
+    //! Set the scheduling weight of a plan.  While several plans
+    //! have nodes to check, one of lower weight is served in
+    //! proportionately fewer micro steps.
+    //! @param rootNodeId The node ID of the plan's root node.
+    //! @param weight The weight.  0 is treated as 1.
+    //! @note Applies to running plans with that root node ID, and to
+    //!       any added later.  Default is 1.
+    //! @note May also be set by PlanWeight elements, with NodeId and
+    //!       Weight attributes, in the Interfaces configuration element.
+    //! @see PlexilExec::setPlanWeight
+    virtual void setPlanWeight(std::string const &rootNodeId, unsigned int weight) = 0;
+
+    //! Enable or disable filtering of node condition change
+    //! notifications.  With the filter, a node is only queued for a
+    //! condition check when one of its conditions has changed value,
+    //! rather than on every change to the condition's operands.
+    //! Node transitions are the same either way.
+    //! @param enable True to filter, false to pass every notification.
+    //! @note Applies to nodes of plans loaded afterward, in every
+    //!       application in the process.  Default is false.
+    //! @note May also be set by the FilterConditionNotifications
+    //!       attribute of the Interfaces configuration element.
+    //! @see NodeImpl::setConditionNotificationFilter
+    virtual void setConditionNotificationFilter(bool enable) = 0;
+
     //! Add the specified directory name to the end of the library node loading path.
     //! @param libdir The directory name.
     virtual void addLibraryPath(const std::string& libdir) = 0;
@@ -135,6 +185,59 @@ namespace PLEXIL
     //! controlled fashion.
     virtual void terminate() = 0;
 
+    //! Delete all plans, discard pending input and cached external
+    //! state, and return the Exec to the state it was in before the
+    //! first plan was added, in preparation for another run.
+    //! @return true if successful, false otherwise.
+    //! @note Loaded libraries, the interface configuration, and the
+    //!       running interfaces and listeners are retained.
+    //! @note Interfaces must not hold references to commands or
+    //!       updates from the deleted plans; the caller should ensure
+    //!       all plans have finished before calling.
+    virtual bool reset() = 0;
+
+    //!
+    //! Record and replay
+    //!
+
+    //! Begin journaling all input to the Exec to the named file.
+    //! @param filename The journal file name.
+    //! @return true if successful, false otherwise.
+    //! @note Plans added before recording starts are not journaled.
+    virtual bool startRecording(std::string const &filename) = 0;
+
+    //! Stop journaling and close the journal file.
+    virtual void stopRecording() = 0;
+
+    //! Run the Exec from a journal recorded by startRecording(),
+    //! without consulting the interfaces.
+    //! @param filename The journal file name.
+    //! @return true if the journal was replayed in full, false otherwise.
+    //! @note Must be called after startInterfaces() and not while
+    //!       the Exec worker thread is running.
+    virtual bool replay(std::string const &filename) = 0;
+
+    //!
+    //! Snapshot and restore
+    //!
+
+    //! Save the Exec state to the named file whenever the Exec is
+    //! quiescent.
+    //! @param filename The snapshot file name.
+    //! @return true if successful, false otherwise.
+    //! @note Plans added before snapshots start are not saved.
+    virtual bool startSnapshots(std::string const &filename) = 0;
+
+    //! Reload the plans and libraries saved in the named snapshot
+    //! file, and return their nodes to their saved states.
+    //! @param filename The snapshot file name.
+    //! @return true if the snapshot was restored in full, false otherwise.
+    //! @note Must be called after startInterfaces() and before the
+    //!       Exec worker thread is started.
+    //! @note Commands and updates whose results had not been received
+    //!       when the snapshot was taken are issued again.
+    virtual bool restoreSnapshot(std::string const &filename) = 0;
+
     //!
     //! Notification and waiting
     //!
@@ -158,6 +261,12 @@ namespace PLEXIL
     //!         plans have finished, false otherwise.
     virtual bool allPlansFinished() = 0;
 
+    //! Copy the current state of every node in every plan.
+    //! @param result The vector to receive the records; its previous
+    //!               contents are replaced.
+    //! @note Safe to call from any thread.
+    virtual void dumpNodeStates(std::vector<NodeStateRecord> &result) = 0;
+
     //! Suspend the current thread until the application reaches
     //! APP_STOPPED state.
     //! @note Wait can be interrupted by signal handling; calling
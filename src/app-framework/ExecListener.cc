@@ -93,6 +93,38 @@ namespace PLEXIL
       this->implementNotifyAssignment(dest, destName, value);
   }
 
+  /**
+   * @brief Determine whether this listener may report any of the node's transitions.
+   * @param node The node.
+   * @return true if it may, false if it never will.
+   */
+  bool ExecListener::selectNodeTransitions(Node const *node) const
+  {
+    return !m_filter || m_filter->selectNodeTransitions(node);
+  }
+
+  /**
+   * @brief Determine whether this listener may report assignments performed by the node.
+   * @param node The Assignment node.
+   * @param destName A string naming the destination expression.
+   * @return true if it may, false if it never will.
+   */
+  bool ExecListener::selectAssignments(Node const *node,
+                                       std::string const &destName) const
+  {
+    return !m_filter || m_filter->selectAssignments(node, destName);
+  }
+
+  /**
+   * @brief Tell this listener's filter which bit represents the listener.
+   * @param bit The bit, or 0 if the listener shares its bit with others.
+   */
+  void ExecListener::setListenerBit(uint32_t bit) const
+  {
+    if (m_filter)
+      m_filter->setListenerBit(bit);
+  }
+
   /**
    * @brief Construct the ExecListenerFilter specified by this listener's configuration XML.
    * @return True if successful, false otherwise.
@@ -93,6 +93,27 @@ namespace PLEXIL
     // @param libNode The XML representation of the plan.
     void notifyOfAddLibrary(pugi::xml_node const libNode) const;
 
+    //! Determine whether this listener may report any of the node's
+    //! transitions.
+    //! @param node The node.
+    //! @return true if it may, false if it never will.
+    //! @note Called by the ExecListenerHub when the plan is added.
+    bool selectNodeTransitions(Node const *node) const;
+
+    //! Determine whether this listener may report assignments
+    //! performed by the node.
+    //! @param node The Assignment node.
+    //! @param destName A string naming the destination expression.
+    //! @return true if it may, false if it never will.
+    //! @note Called by the ExecListenerHub when the plan is added.
+    bool selectAssignments(Node const *node, std::string const &destName) const;
+
+    //! Tell this listener's filter which bit represents the listener
+    //! in node listener masks.
+    //! @param bit The bit, or 0 if the listener shares its bit with others.
+    //! @note Called by the ExecListenerHub when a plan is indexed.
+    void setListenerBit(uint32_t bit) const;
+
     //
     // Lifecycle API which can be overridden by derived classes
     //
@@ -26,13 +26,16 @@
 
 #include "ExecListenerFilter.hh"
 
+#include "Node.hh"
+
 namespace PLEXIL
 {
   /**
    * @brief Constructor.
    */
   ExecListenerFilter::ExecListenerFilter()
-    : m_xml()
+    : m_xml(),
+      m_listenerBit(0)
   {
   }
 
@@ -40,7 +43,8 @@ namespace PLEXIL
    * @brief Constructor from configuration XML.
    */
   ExecListenerFilter::ExecListenerFilter(pugi::xml_node const xml)
-    : m_xml(xml)
+    : m_xml(xml),
+      m_listenerBit(0)
   {
   }
 
@@ -100,4 +104,41 @@ namespace PLEXIL
     return true;
   }
 
+  /**
+   * @brief Determine whether any of this node's transitions may be reported.
+   * @param node The node.
+   * @return false if no transition of this node can be reported, true otherwise.
+   */
+  bool
+  ExecListenerFilter::selectNodeTransitions(Node const * /* node */)
+  {
+    return true;
+  }
+
+  /**
+   * @brief Determine whether assignments performed by this node may be reported.
+   * @param node The Assignment node.
+   * @param destName A string naming the destination.
+   * @return false if none of the node's assignments can be reported, true otherwise.
+   */
+  bool
+  ExecListenerFilter::selectAssignments(Node const * /* node */,
+                                        std::string const & /* destName */)
+  {
+    return true;
+  }
+
+  /**
+   * @brief Determine whether the node's listener mask records this
+   *        filter's plan-add time selection.
+   * @param node The node.
+   * @return true if it does, false otherwise.
+   */
+  bool
+  ExecListenerFilter::selectionRecorded(Node const *node) const
+  {
+    // Nodes of plans which were not indexed keep every bit set
+    return m_listenerBit && ~node->getListenerMask();
+  }
+
 }
@@ -107,6 +107,63 @@ namespace PLEXIL
                                   std::string const &destName,
                                   Value const &value);
 
+    //
+    // Plan-add time selection
+    //
+    // These are consulted once per node when a plan is added, so
+    // that events the filter would reject are never queued for its
+    // listener.  Events which pass are still offered to the
+    // report... member functions above.
+    //
+
+    /**
+     * @brief Determine whether any of this node's transitions may be reported.
+     * @param node The node.
+     * @return false if no transition of this node can be reported, true otherwise.
+     * @note The default method simply returns true.
+     */
+    virtual bool selectNodeTransitions(Node const *node);
+
+    /**
+     * @brief Determine whether assignments performed by this node may be reported.
+     * @param node The Assignment node.
+     * @param destName A string naming the destination.
+     * @return false if none of the node's assignments can be reported, true otherwise.
+     * @note The default method simply returns true.
+     */
+    virtual bool selectAssignments(Node const *node, std::string const &destName);
+
+    /**
+     * @brief Set the bit which represents this filter's listener in
+     *        node listener masks.
+     * @param bit The bit, or 0 if the listener shares its bit with others.
+     * @note Called by the ExecListenerHub when a plan is indexed.
+     */
+    void setListenerBit(uint32_t bit)
+    {
+      m_listenerBit = bit;
+    }
+
+  protected:
+
+    /**
+     * @brief Determine whether the node's listener mask records this
+     *        filter's plan-add time selection.
+     * @param node The node.
+     * @return true if it does; false if the node's plan was not
+     *         indexed, or the listener shares its bit with others.
+     */
+    bool selectionRecorded(Node const *node) const;
+
+    /**
+     * @brief Get the bit which represents this filter's listener.
+     * @return The bit, or 0 if the listener has no bit of its own.
+     */
+    uint32_t listenerBit() const
+    {
+      return m_listenerBit;
+    }
+
   private:
     //
     // Deliberately unimplemented
@@ -122,6 +179,12 @@ namespace PLEXIL
      * @brief The configuration XML used at construction time.
      */
     const pugi::xml_node m_xml;
+
+    /**
+     * @brief The bit representing this filter's listener in node
+     *        listener masks; 0 if none.
+     */
+    uint32_t m_listenerBit;
   };
 
 }
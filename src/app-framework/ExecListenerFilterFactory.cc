@@ -144,14 +144,9 @@ namespace PLEXIL
                                                   ExecListenerFilterFactory* factory)
   {
     assertTrue_1(factory);
-    if (factoryMap().find(name) != factoryMap().end()) {
-      warn("Attempted to register an exec listener filter factory for name \""
-           << name.c_str()
-           << "\" twice, ignoring.");
-      delete factory;
-      return;
-    }
-    factoryMap()[name] = ExecListenerFilterFactoryPtr(factory);
+    // Called from the factory's constructor, so the factory can't be
+    // deleted here; replace any earlier registration instead.
+    factoryMap()[name].reset(factory);
     debugMsg("ExecListenerFilterFactory:registerFactory",
              " Registered exec listener filter factory for name \"" << name.c_str() << "\"");
   }
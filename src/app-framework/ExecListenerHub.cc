@@ -26,21 +26,50 @@
 
 #include "ExecListenerHub.hh"
 
+#include "Assignable.hh"
+#include "Assignment.hh"
+#include "AssignmentNode.hh"
 #include "Debug.hh"
 #include "Error.hh"
 #include "ExecListener.hh"
 #include "ExecListenerFactory.hh"
 #include "InterfaceSchema.hh"
+#include "NodeImpl.hh"
 #include "NodeTransition.hh"
 
 #include "pugixml.hpp"
 
+#include <algorithm> // std::min()
+
 namespace PLEXIL
 {
+  // All listeners
+  static uint32_t const ALL_LISTENERS = ~(uint32_t) 0;
+
+  // The bit representing the listener with the given index.
+  // Listeners beyond the width of the mask share the last bit,
+  // so their filters must check each event they are handed.
+  static uint32_t listenerBit(size_t index)
+  {
+    return ((uint32_t) 1) << std::min(index, (size_t) 31);
+  }
+
+  // The bit belonging to the listener with the given index alone;
+  // 0 if it shares the last bit.
+  static uint32_t exclusiveBit(size_t index)
+  {
+    return index < 31 ? listenerBit(index) : 0;
+  }
+
   ExecListenerHub::ExecListenerHub()
     : m_listeners(),
       m_transitions(),
-      m_assignments()
+      m_transitionMasks(),
+      m_assignments(),
+      m_selected(),
+      m_commonMask(ALL_LISTENERS),
+      m_assignmentMasks(),
+      m_planDestinations()
   {
   }
 
@@ -55,8 +84,16 @@ namespace PLEXIL
   void
   ExecListenerHub::notifyOfTransitions(std::vector<NodeTransition> const &transitions)
   {
-    m_transitions.insert(m_transitions.end(),
-                         transitions.begin(), transitions.end());
+    for (NodeTransition const &trans : transitions) {
+      uint32_t mask = trans.node->getListenerMask();
+      if (mask) {
+        m_transitions.push_back(trans);
+        m_transitionMasks.push_back(mask);
+        m_commonMask &= mask;
+      }
+      if (trans.newState == FINISHED_STATE && !trans.node->getParent())
+        forgetPlan(trans.node);
+    }
   }
 
   /**
@@ -71,7 +108,15 @@ namespace PLEXIL
                                            std::string const &destName,
                                            Value const &value)
   {
-    m_assignments.push_back(AssignmentRecord(dest, destName, value));
+    uint32_t mask = ALL_LISTENERS;
+    if (!m_assignmentMasks.empty()) {
+      std::unordered_map<Expression const *, uint32_t>::const_iterator it =
+        m_assignmentMasks.find(dest);
+      if (it != m_assignmentMasks.end())
+        mask = it->second;
+    }
+    if (mask)
+      m_assignments.push_back(AssignmentRecord(dest, destName, value, mask));
   }
 
   //
@@ -104,13 +149,87 @@ namespace PLEXIL
    */
   void ExecListenerHub::stepComplete(unsigned int cycleNum)
   {
-    for (ExecListenerPtr const &listener : m_listeners) {
-      listener->notifyOfTransitions(m_transitions);
+    for (size_t i = 0; i < m_listeners.size(); ++i) {
+      ExecListener const *listener = m_listeners[i].get();
+      uint32_t bit = listenerBit(i);
+      if (!m_transitions.empty()) {
+        if (m_commonMask & bit)
+          listener->notifyOfTransitions(m_transitions);
+        else {
+          m_selected.clear();
+          for (size_t j = 0; j < m_transitions.size(); ++j)
+            if (m_transitionMasks[j] & bit)
+              m_selected.push_back(m_transitions[j]);
+          if (!m_selected.empty())
+            listener->notifyOfTransitions(m_selected);
+        }
+      }
       for (AssignmentRecord const &assign : m_assignments)
-        listener->notifyOfAssignment(assign.dest, assign.destName, assign.value);
+        if (assign.mask & bit)
+          listener->notifyOfAssignment(assign.dest, assign.destName, assign.value);
     }
     m_transitions.clear();
+    m_transitionMasks.clear();
     m_assignments.clear();
+    m_commonMask = ALL_LISTENERS;
+  }
+
+  /**
+   * @brief Determine which listeners may report events from the nodes of a new plan.
+   * @param root The root node of the plan.
+   */
+  void ExecListenerHub::indexPlan(NodeImpl *root)
+  {
+    // A new plan may occupy the storage of a deleted one
+    forgetPlan(root);
+    // Let filters rely on the masks; listeners may have been added
+    for (size_t i = 0; i < m_listeners.size(); ++i)
+      m_listeners[i]->setListenerBit(exclusiveBit(i));
+    std::vector<Expression const *> &dests = m_planDestinations[root];
+    indexNode(root, dests);
+    debugMsg("ExecListenerHub:indexPlan",
+             ' ' << root->getNodeId() << ", " << dests.size() << " assignments");
+  }
+
+  void ExecListenerHub::indexNode(NodeImpl *node, std::vector<Expression const *> &dests)
+  {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < m_listeners.size(); ++i)
+      if (m_listeners[i]->selectNodeTransitions(node))
+        mask |= listenerBit(i);
+    node->setListenerMask(mask);
+
+    if (node->getType() == NodeType_Assignment) {
+      Assignment *assign = static_cast<AssignmentNode *>(node)->getAssignment();
+      Expression const *dest = assign->getDest();
+      std::string const destName = dest->getName();
+      uint32_t assignMask = 0;
+      for (size_t i = 0; i < m_listeners.size(); ++i)
+        if (m_listeners[i]->selectAssignments(node, destName))
+          assignMask |= listenerBit(i);
+      // Several nodes may assign the same variable
+      std::pair<std::unordered_map<Expression const *, uint32_t>::iterator, bool> entry =
+        m_assignmentMasks.insert(std::make_pair(dest, assignMask));
+      if (entry.second)
+        dests.push_back(dest);
+      else
+        entry.first->second |= assignMask;
+    }
+
+    for (NodeImplPtr const &child : node->getChildren())
+      indexNode(child.get(), dests);
+  }
+
+  // Forget the assignment destinations of a plan about to be deleted.
+  void ExecListenerHub::forgetPlan(Node const *root)
+  {
+    std::unordered_map<Node const *, std::vector<Expression const *>>::iterator it =
+      m_planDestinations.find(root);
+    if (it == m_planDestinations.end())
+      return;
+    for (Expression const *dest : it->second)
+      m_assignmentMasks.erase(dest);
+    m_planDestinations.erase(it);
   }
 
   //
@@ -32,9 +32,12 @@
 #include "Value.hh"
 
 #include <memory>
+#include <unordered_map>
 
 namespace PLEXIL
 {
+  class NodeImpl;
+
   //! @class ExecListenerHub
   //! A central dispatcher for multiple exec listeners.
   class ExecListenerHub : public ExecListenerBase
@@ -76,6 +79,14 @@ namespace PLEXIL
     //! @param libNode The XML representation of the plan.
     void notifyOfAddLibrary(pugi::xml_node const libNode);
 
+    //! Determine which listeners may report events from the nodes
+    //! of a newly added plan, so that other events are discarded
+    //! without being queued.
+    //! @param root The root node of the plan.
+    //! @note Plans which are not indexed report all their events
+    //!       to every listener's filter.
+    void indexPlan(NodeImpl *root);
+
     //
     // Interface management API to AdapterConfiguration
     // 
@@ -89,6 +100,8 @@ namespace PLEXIL
     //! @param Pointer to an ExecListener instance.
     //! @note The ExecListenerHub takes ownership of the listener
     //!       instance, and will delete it when the hub is deleted.
+    //! @note Listeners added after a plan has been indexed are not
+    //!       offered that plan's events.
     void addListener(ExecListener *listener);
 
     //! Initialize all the listeners registered with addListener().
@@ -109,13 +122,16 @@ namespace PLEXIL
       Value value;
       std::string destName;
       Expression const *dest;
+      uint32_t mask;
 
       AssignmentRecord(Expression const *dst,
                        std::string const &name,
-                       Value const &val)
+                       Value const &val,
+                       uint32_t msk)
         : value(val),
           destName(name),
-          dest(dst)
+          dest(dst),
+          mask(msk)
       {}
 
       // use default destructor, copy constructor, assignment
@@ -130,12 +146,29 @@ namespace PLEXIL
     ExecListenerHub &operator=(ExecListenerHub const &) = delete;
     ExecListenerHub &operator=(ExecListenerHub &&) = delete;
 
+    // Internal helpers
+    void indexNode(NodeImpl *node, std::vector<Expression const *> &dests);
+    void forgetPlan(Node const *root);
+
     // Clients
     std::vector<ExecListenerPtr> m_listeners;
 
     // Queues
     std::vector<NodeTransition> m_transitions;
+    std::vector<uint32_t> m_transitionMasks;
     std::vector<AssignmentRecord> m_assignments;
+
+    // Transitions selected for one listener
+    std::vector<NodeTransition> m_selected;
+
+    // Listeners selecting all queued transitions
+    uint32_t m_commonMask;
+
+    // Listeners selecting assignments to each destination
+    std::unordered_map<Expression const *, uint32_t> m_assignmentMasks;
+
+    // Assignment destinations of each indexed plan
+    std::unordered_map<Node const *, std::vector<Expression const *>> m_planDestinations;
   };
 
 }
@@ -0,0 +1,1259 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExecSnapshot.hh"
+
+#include "Assignment.hh"
+#include "AssignmentNode.hh"
+#include "CommandImpl.hh"
+#include "CommandNode.hh"
+#include "Debug.hh"
+#include "Error.hh"
+#include "ExecApplication.hh"
+#include "ExecListenerHub.hh"
+#include "InterfaceManager.hh"
+#include "NodeStateTable.hh"
+#include "NodeTimepointValue.hh"
+#include "parsePlan.hh"
+#include "ParserException.hh"
+#include "PlexilExec.hh"
+#include "SimpleBooleanVariable.hh"
+#include "UpdateImpl.hh"
+#include "UpdateNode.hh"
+#include "Variable.hh"
+
+#include "pugixml.hpp"
+
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>  // rename()
+#include <cstring> // memcpy(), memcmp()
+
+namespace PLEXIL
+{
+
+  //
+  // Snapshot format
+  //
+  // The file begins with an 8 byte magic number and a 4 byte format
+  // version.  It is followed by records, each consisting of a 1 byte
+  // record type, a 4 byte payload length, and the payload.  Integers
+  // and reals are written in host byte order; values use their own
+  // serial format.
+  //
+  // A node record supersedes any earlier record for the same node.
+  // Records following the last checkpoint record are ignored.
+  //
+
+  static char const SNAPSHOT_MAGIC[8] = {'P', 'X', 'S', 'N', 'A', 'P', '\0', '\0'};
+  static uint32_t const SNAPSHOT_VERSION = 1;
+  static size_t const SNAPSHOT_HEADER_SIZE = sizeof(SNAPSHOT_MAGIC) + sizeof(uint32_t);
+  static size_t const RECORD_HEADER_SIZE = 1 + sizeof(uint32_t);
+
+  // Compact the file when it exceeds this multiple of the live state size
+  static size_t const COMPACTION_RATIO = 4;
+  // ... plus this many bytes
+  static size_t const COMPACTION_SLACK = 1024 * 1024;
+
+  enum SnapshotRecordType : uint8_t
+    {
+     S_UNINITED = 0,
+     S_LIBRARY,      //!< Library: XML
+     S_PLAN,         //!< Plan: plan ID, XML
+     S_PLAN_DELETED, //!< Plan finished and deleted: plan ID
+     S_NODE,         //!< Node: plan ID, node index, node state
+     S_CHECKPOINT,   //!< End of checkpoint: sequence number
+     S_INVALID
+    };
+
+  // Kinds of node action state saved
+  enum SnapshotActionType : uint8_t
+    {
+     ACTION_NONE = 0,
+     ACTION_COMMAND,    //!< Command handle, abort complete
+     ACTION_ASSIGNMENT, //!< Acknowledgement, abort complete
+     ACTION_UPDATE      //!< Acknowledgement
+    };
+
+  // Encoding of Boolean flags which may be unknown
+  enum SnapshotFlag : uint8_t
+    {
+     FLAG_FALSE = 0,
+     FLAG_TRUE,
+     FLAG_UNKNOWN
+    };
+
+  static uint8_t flagValue(Expression const *flag)
+  {
+    Boolean b;
+    if (!flag->getValue(b))
+      return FLAG_UNKNOWN;
+    return b ? FLAG_TRUE : FLAG_FALSE;
+  }
+
+  static bool isActionState(NodeState s)
+  {
+    return s == EXECUTING_STATE || s == FINISHING_STATE || s == FAILING_STATE;
+  }
+
+  //! List the node and its descendants in preorder.
+  static void collectNodes(NodeImpl *node, std::vector<NodeImpl *> &result)
+  {
+    result.push_back(node);
+    for (NodeImplPtr &child : node->getChildren())
+      collectNodes(child.get(), result);
+  }
+
+  //
+  // Record construction
+  //
+
+  static void putBytes(std::vector<char> &buf, void const *bytes, size_t n)
+  {
+    char const *b = static_cast<char const *>(bytes);
+    buf.insert(buf.end(), b, b + n);
+  }
+
+  static void putUint8(std::vector<char> &buf, uint8_t n)
+  {
+    buf.push_back((char) n);
+  }
+
+  static void putUint32(std::vector<char> &buf, uint32_t n)
+  {
+    putBytes(buf, &n, sizeof(n));
+  }
+
+  static void putDouble(std::vector<char> &buf, double d)
+  {
+    putBytes(buf, &d, sizeof(d));
+  }
+
+  static void putString(std::vector<char> &buf, std::string const &s)
+  {
+    putUint32(buf, (uint32_t) s.size());
+    putBytes(buf, s.data(), s.size());
+  }
+
+  static void putValue(std::vector<char> &buf, Value const &v)
+  {
+    size_t start = buf.size();
+    buf.resize(start + v.serialSize());
+    if (!v.serialize(&buf[start])) {
+      // Too large to serialize; save as unknown
+      buf.resize(start + Value().serialSize());
+      Value().serialize(&buf[start]);
+    }
+  }
+
+  //! Start a record in the buffer.
+  //! @return Offset of the record in the buffer.
+  static size_t beginRecord(std::vector<char> &buf, SnapshotRecordType type)
+  {
+    size_t start = buf.size();
+    buf.resize(start + RECORD_HEADER_SIZE);
+    buf[start] = (char) type;
+    return start;
+  }
+
+  static void endRecord(std::vector<char> &buf, size_t start)
+  {
+    uint32_t len = (uint32_t) (buf.size() - start - RECORD_HEADER_SIZE);
+    memcpy(&buf[start + 1], &len, sizeof(len));
+  }
+
+  static std::string printXml(pugi::xml_node const xml)
+  {
+    std::ostringstream s;
+    xml.print(s, "", pugi::format_raw);
+    return s.str();
+  }
+
+  //! Append a complete node record to the buffer.
+  static void serializeNode(std::vector<char> &buf,
+                            uint32_t planId,
+                            uint32_t index,
+                            NodeImpl *node)
+  {
+    size_t start = beginRecord(buf, S_NODE);
+    putUint32(buf, planId);
+    putUint32(buf, index);
+    putString(buf, node->getNodeId());
+    putUint8(buf, node->getState());
+    putUint8(buf, node->getOutcome());
+    putUint8(buf, node->getFailureType());
+    putDouble(buf, node->getCurrentStateStartTime());
+
+    // Timepoints
+    size_t countOffset = buf.size();
+    putUint8(buf, 0);
+    uint8_t count = 0;
+    for (NodeTimepointValue *tp = node->getTimepoints(); tp; tp = tp->next()) {
+      Real t = 0;
+      bool known = tp->getValue(t);
+      putUint8(buf, known ? FLAG_TRUE : FLAG_UNKNOWN);
+      putDouble(buf, t);
+      ++count;
+    }
+    buf[countOffset] = (char) count;
+
+    // Action in progress
+    switch (node->getType()) {
+    case NodeType_Command: {
+      CommandImpl *cmd = static_cast<CommandNode *>(node)->getCommand();
+      putUint8(buf, ACTION_COMMAND);
+      putUint8(buf, cmd->getCommandHandle());
+      putUint8(buf, flagValue(cmd->getAbortComplete()));
+      break;
+    }
+
+    case NodeType_Assignment: {
+      Assignment *assign = static_cast<AssignmentNode *>(node)->getAssignment();
+      putUint8(buf, ACTION_ASSIGNMENT);
+      putUint8(buf, flagValue(assign->getAck()));
+      putUint8(buf, flagValue(assign->getAbortComplete()));
+      break;
+    }
+
+    case NodeType_Update: {
+      UpdateImpl *upd = static_cast<UpdateNode *>(node)->getUpdate();
+      putUint8(buf, ACTION_UPDATE);
+      putUint8(buf, flagValue(upd->getAck()));
+      putUint8(buf, FLAG_UNKNOWN);
+      break;
+    }
+
+    default:
+      putUint8(buf, ACTION_NONE);
+      break;
+    }
+
+    // Local variables
+    std::vector<ExpressionPtr> const *vars = node->getLocalVariables();
+    putUint32(buf, vars ? (uint32_t) vars->size() : 0);
+    if (vars)
+      for (ExpressionPtr const &var : *vars)
+        putValue(buf, var->toValue());
+
+    endRecord(buf, start);
+  }
+
+  //
+  // Writer
+  //
+
+  class ExecSnapshotImpl final : public ExecSnapshot
+  {
+  private:
+
+    struct NodeEntry
+    {
+      std::vector<char> record; //!< Last record written
+      NodeState state;
+      NodeOutcome outcome;
+      FailureType failure;
+    };
+
+    struct PlanEntry
+    {
+      std::vector<char> record; //!< The plan record
+      std::vector<NodeImpl *> nodes;
+      std::vector<uint32_t> indices; //!< The nodes' NodeStateTable indices
+      std::vector<NodeEntry> entries;
+      uint32_t id;
+      bool live;
+    };
+
+  public:
+    ExecSnapshotImpl(std::string const &filename)
+      : ExecSnapshot(),
+        m_filename(filename),
+        m_out(),
+        m_buffer(),
+        m_libraries(),
+        m_pendingLibraries(),
+        m_pendingPlans(),
+        m_newPlans(),
+        m_plans(),
+        m_untracked(),
+#ifdef PLEXIL_WITH_THREADS
+        m_mutex(),
+#endif
+        m_fileSize(0),
+        m_liveSize(0),
+        m_nextPlanId(0),
+        m_sequence(0),
+        m_failed(false)
+    {
+    }
+
+    virtual ~ExecSnapshotImpl() = default;
+
+    virtual void addPlan(NodeImpl const *root, pugi::xml_node const planXml) override
+    {
+      std::string xml = printXml(planXml);
+      Guard guard(m_mutex);
+      m_pendingPlans[root] = std::move(xml);
+    }
+
+    virtual void addLibrary(pugi::xml_node const libXml) override
+    {
+      std::string xml = printXml(libXml);
+      Guard guard(m_mutex);
+      m_pendingLibraries.push_back(std::move(xml));
+    }
+
+    virtual void reset() override
+    {
+      Guard guard(m_mutex);
+      m_pendingPlans.clear();
+      m_newPlans.clear();
+    }
+
+    virtual void checkpoint(PlexilExec &exec) override
+    {
+      if (m_failed)
+        return;
+
+      std::vector<std::string> libraries;
+      {
+        Guard guard(m_mutex);
+        libraries.swap(m_pendingLibraries);
+        for (std::pair<NodeImpl const *const, std::string> &p : m_pendingPlans)
+          m_newPlans[p.first] = std::move(p.second);
+        m_pendingPlans.clear();
+      }
+
+      m_buffer.clear();
+      for (std::string const &xml : libraries) {
+        m_libraries.emplace_back();
+        std::vector<char> &rec = m_libraries.back();
+        size_t start = beginRecord(rec, S_LIBRARY);
+        putString(rec, xml);
+        endRecord(rec, start);
+        m_buffer.insert(m_buffer.end(), rec.begin(), rec.end());
+      }
+
+      for (std::pair<NodeImpl const *const, PlanEntry> &p : m_plans)
+        p.second.live = false;
+      std::unordered_set<NodeImpl const *> untracked;
+
+      for (NodePtr const &n : exec.getPlans()) {
+        NodeImpl *root = dynamic_cast<NodeImpl *>(n.get());
+        if (!root)
+          continue;
+
+        std::unordered_map<NodeImpl const *, std::string>::iterator newIt =
+          m_newPlans.find(root);
+        if (newIt != m_newPlans.end()) {
+          // A plan at the same address as an existing entry replaces it
+          std::map<NodeImpl const *, PlanEntry>::iterator oldIt = m_plans.find(root);
+          if (oldIt != m_plans.end()) {
+            writePlanDeleted(oldIt->second.id);
+            m_plans.erase(oldIt);
+          }
+          addPlanEntry(root, newIt->second);
+          m_newPlans.erase(newIt);
+        }
+
+        std::map<NodeImpl const *, PlanEntry>::iterator it = m_plans.find(root);
+        if (it == m_plans.end()) {
+          if (!m_untracked.count(root))
+            warn("ExecSnapshot: plan " << root->getNodeId()
+                 << " was started before snapshots began, not saved");
+          untracked.insert(root);
+          continue;
+        }
+        it->second.live = true;
+        checkpointPlan(it->second, exec.getNodeStateTable());
+      }
+      m_untracked.swap(untracked);
+
+      // Plans which have been deleted
+      std::map<NodeImpl const *, PlanEntry>::iterator it = m_plans.begin();
+      while (it != m_plans.end()) {
+        if (it->second.live)
+          ++it;
+        else {
+          writePlanDeleted(it->second.id);
+          it = m_plans.erase(it);
+        }
+      }
+
+      if (m_buffer.empty() && m_out.is_open())
+        return; // nothing changed
+
+      size_t start = beginRecord(m_buffer, S_CHECKPOINT);
+      putUint32(m_buffer, ++m_sequence);
+      endRecord(m_buffer, start);
+
+      if (!m_out.is_open()
+          || m_fileSize + m_buffer.size() > COMPACTION_RATIO * m_liveSize + COMPACTION_SLACK)
+        writeFull();
+      else {
+        m_out.write(m_buffer.data(), m_buffer.size());
+        m_out.flush();
+        if (!m_out) {
+          warn("ExecSnapshot: error writing " << m_filename << ", snapshots disabled");
+          m_failed = true;
+          return;
+        }
+        m_fileSize += m_buffer.size();
+      }
+      debugMsg("ExecSnapshot:checkpoint",
+               ' ' << m_sequence << ", " << m_buffer.size() << " bytes");
+    }
+
+  private:
+
+    // Not implemented
+    ExecSnapshotImpl() = delete;
+    ExecSnapshotImpl(ExecSnapshotImpl const &) = delete;
+    ExecSnapshotImpl(ExecSnapshotImpl &&) = delete;
+    ExecSnapshotImpl &operator=(ExecSnapshotImpl const &) = delete;
+    ExecSnapshotImpl &operator=(ExecSnapshotImpl &&) = delete;
+
+#ifdef PLEXIL_WITH_THREADS
+    using Guard = std::lock_guard<std::mutex>;
+#else
+    struct Guard
+    {
+      Guard(int) {}
+    };
+#endif
+
+    void addPlanEntry(NodeImpl *root, std::string const &xml)
+    {
+      PlanEntry &entry = m_plans[root];
+      entry.id = m_nextPlanId++;
+      collectNodes(root, entry.nodes);
+      entry.indices.reserve(entry.nodes.size());
+      for (NodeImpl const *node : entry.nodes) {
+        // The Exec adds a plan's nodes to its table before running it
+        assertTrue_2(node->getStateTableIndex() != NodeStateTable::NO_INDEX,
+                     "ExecSnapshot: plan node not in the node state table");
+        entry.indices.push_back(node->getStateTableIndex());
+      }
+      entry.entries.resize(entry.nodes.size());
+      for (NodeEntry &e : entry.entries) {
+        // Force each node to be written at the first checkpoint
+        e.state = NO_NODE_STATE;
+        e.outcome = NO_OUTCOME;
+        e.failure = NO_FAILURE;
+      }
+      size_t start = beginRecord(entry.record, S_PLAN);
+      putUint32(entry.record, entry.id);
+      putString(entry.record, xml);
+      endRecord(entry.record, start);
+      m_buffer.insert(m_buffer.end(), entry.record.begin(), entry.record.end());
+      debugMsg("ExecSnapshot:addPlan",
+               ' ' << root->getNodeId() << " as plan " << entry.id
+               << ", " << entry.nodes.size() << " nodes");
+    }
+
+    //! Append records for those nodes of the plan which have changed.
+    //! The node states are read from the Exec's state table, so that
+    //! unchanged nodes are not visited.
+    void checkpointPlan(PlanEntry &plan, NodeStateTable const &table)
+    {
+      NodeState const *states = table.states();
+      NodeOutcome const *outcomes = table.outcomes();
+      FailureType const *failures = table.failureTypes();
+      for (size_t i = 0; i < plan.nodes.size(); ++i) {
+        uint32_t idx = plan.indices[i];
+        NodeEntry &entry = plan.entries[i];
+        NodeState state = states[idx];
+
+        // Variables and actions can only change while the node is
+        // executing; otherwise the node changes only on transition.
+        if (state == entry.state
+            && outcomes[idx] == entry.outcome
+            && failures[idx] == entry.failure
+            && !isActionState(state))
+          continue;
+
+        m_scratch.clear();
+        serializeNode(m_scratch, plan.id, (uint32_t) i, plan.nodes[i]);
+        entry.state = state;
+        entry.outcome = outcomes[idx];
+        entry.failure = failures[idx];
+        if (m_scratch == entry.record)
+          continue;
+        entry.record.swap(m_scratch);
+        m_buffer.insert(m_buffer.end(), entry.record.begin(), entry.record.end());
+      }
+    }
+
+    void writePlanDeleted(uint32_t id)
+    {
+      size_t start = beginRecord(m_buffer, S_PLAN_DELETED);
+      putUint32(m_buffer, id);
+      endRecord(m_buffer, start);
+    }
+
+    //! Write the complete current state to a new file, and replace
+    //! the existing file with it.
+    void writeFull()
+    {
+      std::string tempName = m_filename + ".tmp";
+      size_t size = 0;
+      {
+        std::ofstream out(tempName, std::ios::binary | std::ios::trunc);
+        out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        out.write(reinterpret_cast<char const *>(&SNAPSHOT_VERSION), sizeof(SNAPSHOT_VERSION));
+        size = SNAPSHOT_HEADER_SIZE;
+        for (std::vector<char> const &lib : m_libraries) {
+          out.write(lib.data(), lib.size());
+          size += lib.size();
+        }
+        for (std::pair<NodeImpl const *const, PlanEntry> const &p : m_plans) {
+          out.write(p.second.record.data(), p.second.record.size());
+          size += p.second.record.size();
+          for (NodeEntry const &e : p.second.entries) {
+            out.write(e.record.data(), e.record.size());
+            size += e.record.size();
+          }
+        }
+        std::vector<char> rec;
+        size_t start = beginRecord(rec, S_CHECKPOINT);
+        putUint32(rec, m_sequence);
+        endRecord(rec, start);
+        out.write(rec.data(), rec.size());
+        size += rec.size();
+        out.flush();
+        if (!out) {
+          warn("ExecSnapshot: error writing " << tempName << ", snapshots disabled");
+          m_failed = true;
+          return;
+        }
+      }
+
+      m_out.close();
+      if (rename(tempName.c_str(), m_filename.c_str())) {
+        warn("ExecSnapshot: unable to rename " << tempName << " to " << m_filename
+             << ", snapshots disabled");
+        m_failed = true;
+        return;
+      }
+      m_out.open(m_filename, std::ios::binary | std::ios::app);
+      if (!m_out) {
+        warn("ExecSnapshot: unable to reopen " << m_filename << ", snapshots disabled");
+        m_failed = true;
+        return;
+      }
+      m_fileSize = m_liveSize = size;
+      debugMsg("ExecSnapshot:writeFull", ' ' << m_filename << ", " << size << " bytes");
+    }
+
+    std::string m_filename;
+    std::ofstream m_out;
+    std::vector<char> m_buffer;   // records for the current checkpoint
+    std::vector<char> m_scratch;  // node record under construction
+    std::vector<std::vector<char>> m_libraries;
+    std::vector<std::string> m_pendingLibraries;
+    std::unordered_map<NodeImpl const *, std::string> m_pendingPlans;
+    std::unordered_map<NodeImpl const *, std::string> m_newPlans;
+    std::map<NodeImpl const *, PlanEntry> m_plans;
+    std::unordered_set<NodeImpl const *> m_untracked;
+#ifdef PLEXIL_WITH_THREADS
+    std::mutex m_mutex;
+#else
+    int m_mutex = 0;
+#endif
+    size_t m_fileSize;
+    size_t m_liveSize;
+    uint32_t m_nextPlanId;
+    uint32_t m_sequence;
+    bool m_failed;
+  };
+
+  ExecSnapshot *makeExecSnapshot(std::string const &filename)
+  {
+    return new ExecSnapshotImpl(filename);
+  }
+
+  //
+  // Restore
+  //
+
+  //! Stands in for the Exec while nodes are brought to their saved
+  //! states, so that the actions of the intermediate transitions are
+  //! not performed.
+  class RestoreExec final : public PlexilExec
+  {
+  public:
+    RestoreExec(PlexilExec &exec)
+      : PlexilExec(),
+        m_candidates(),
+        m_actions(),
+        m_exec(exec)
+    {
+    }
+
+    virtual ~RestoreExec() = default;
+
+    //! Hold an action for the real Exec until the plan is restored.
+    void deferAction(std::function<void(PlexilExec &)> action)
+    {
+      m_actions.push_back(std::move(action));
+    }
+
+    //! Pass the deferred actions of a fully restored plan to the real Exec.
+    void commitPlan()
+    {
+      for (std::function<void(PlexilExec &)> const &action : m_actions)
+        action(m_exec);
+      m_actions.clear();
+    }
+
+    //! Forget the deferred actions and notified nodes of a plan
+    //! which could not be restored.
+    void abandonPlan(Node const *root)
+    {
+      m_actions.clear();
+      m_candidates.erase(std::remove_if(m_candidates.begin(), m_candidates.end(),
+                                        [root] (Node const *node) -> bool
+                                        { return node->getRoot() == root; }),
+                         m_candidates.end());
+    }
+
+    //! Return the nodes notified during the restore to the real Exec.
+    void notifyCandidates()
+    {
+      for (Node *node : m_candidates) {
+        node->setQueueStatus(QUEUE_NONE);
+        node->notify(&m_exec);
+      }
+      m_candidates.clear();
+    }
+
+    virtual void addCandidateNode(Node *node) override
+    {
+      m_candidates.push_back(node);
+    }
+
+    // Actions are reissued as needed once the node is restored
+    virtual void enqueueAssignment(Assignment * /* assign */) override
+    {
+    }
+
+    virtual void enqueueAssignmentForRetraction(Assignment * /* assign */) override
+    {
+    }
+
+    virtual void enqueueCommand(CommandImpl * /* cmd */) override
+    {
+    }
+
+    virtual void enqueueAbortCommand(CommandImpl * /* cmd */) override
+    {
+    }
+
+    virtual void enqueueUpdate(Update * /* update */) override
+    {
+    }
+
+    virtual void markRootNodeFinished(Node *node) override
+    {
+      m_exec.markRootNodeFinished(node);
+    }
+
+    virtual void setDispatcher(Dispatcher * /* intf */) override
+    {
+    }
+
+    virtual void setExecListener(ExecListenerBase * /* listener */) override
+    {
+    }
+
+    virtual ExecListenerBase *getExecListener() override
+    {
+      return nullptr;
+    }
+
+    // No command resources have been reserved for restored nodes
+    virtual ResourceArbiterInterface *getArbiter() override
+    {
+      return nullptr;
+    }
+
+    virtual void step(double /* startTime */) override
+    {
+    }
+
+    virtual bool needsStep() const override
+    {
+      return false;
+    }
+
+    virtual void setTimeSlice(unsigned int /* maxMicroSteps */, double /* maxSeconds */) override
+    {
+    }
+
+    virtual void startTimeSlice() override
+    {
+    }
+
+    virtual bool timeSliceExpired() const override
+    {
+      return false;
+    }
+
+    virtual unsigned int getTimeSliceMicroSteps() const override
+    {
+      return 0;
+    }
+
+    virtual void setPlanWeight(std::string const & /* rootNodeId */,
+                               unsigned int /* weight */) override
+    {
+    }
+
+    // Restored nodes update their entries in the real Exec's table
+    virtual NodeStateTable &getNodeStateTable() override
+    {
+      return m_exec.getNodeStateTable();
+    }
+
+    virtual NodeStateTable const &getNodeStateTable() const override
+    {
+      return m_exec.getNodeStateTable();
+    }
+
+    virtual bool addPlan(Node * /* root */) override
+    {
+      return false;
+    }
+
+    virtual void removePlan(Node * /* root */) override
+    {
+    }
+
+    virtual void deleteFinishedPlans() override
+    {
+    }
+
+    virtual bool allPlansFinished() const override
+    {
+      return m_exec.allPlansFinished();
+    }
+
+    virtual void reset() override
+    {
+    }
+
+    virtual std::list<NodePtr> const &getPlans() const override
+    {
+      return m_exec.getPlans();
+    }
+
+  private:
+
+    // Not implemented
+    RestoreExec() = delete;
+    RestoreExec(RestoreExec const &) = delete;
+    RestoreExec(RestoreExec &&) = delete;
+    RestoreExec &operator=(RestoreExec const &) = delete;
+    RestoreExec &operator=(RestoreExec &&) = delete;
+
+    std::vector<Node *> m_candidates;
+    std::vector<std::function<void(PlexilExec &)>> m_actions;
+    PlexilExec &m_exec;
+  };
+
+  //! Sequential reader of snapshot data.
+  class SnapshotReader final
+  {
+  public:
+    SnapshotReader(char const *start, char const *end)
+      : m_ptr(start),
+        m_end(end),
+        m_ok(true)
+    {
+    }
+
+    ~SnapshotReader() = default;
+
+    bool ok() const
+    {
+      return m_ok;
+    }
+
+    bool atEnd() const
+    {
+      return m_ptr >= m_end;
+    }
+
+    char const *position() const
+    {
+      return m_ptr;
+    }
+
+    void getBytes(void *dest, size_t n)
+    {
+      if (!m_ok || (size_t) (m_end - m_ptr) < n) {
+        m_ok = false;
+        memset(dest, 0, n);
+        return;
+      }
+      memcpy(dest, m_ptr, n);
+      m_ptr += n;
+    }
+
+    void skip(size_t n)
+    {
+      if (!m_ok || (size_t) (m_end - m_ptr) < n)
+        m_ok = false;
+      else
+        m_ptr += n;
+    }
+
+    uint8_t getUint8()
+    {
+      uint8_t result;
+      getBytes(&result, sizeof(result));
+      return result;
+    }
+
+    uint32_t getUint32()
+    {
+      uint32_t result;
+      getBytes(&result, sizeof(result));
+      return result;
+    }
+
+    double getDouble()
+    {
+      double result;
+      getBytes(&result, sizeof(result));
+      return result;
+    }
+
+    std::string getString()
+    {
+      uint32_t len = getUint32();
+      if (!m_ok || (size_t) (m_end - m_ptr) < len) {
+        m_ok = false;
+        return std::string();
+      }
+      std::string result(m_ptr, len);
+      m_ptr += len;
+      return result;
+    }
+
+    Value getValue()
+    {
+      Value result;
+      if (!m_ok)
+        return result;
+      char const *next = result.deserialize(m_ptr);
+      if (!next || next > m_end)
+        m_ok = false;
+      else
+        m_ptr = next;
+      return result;
+    }
+
+  private:
+    char const *m_ptr;
+    char const *m_end;
+    bool m_ok;
+  };
+
+  //! The contents of the snapshot as of the last checkpoint.
+  struct SnapshotImage
+  {
+    struct Record
+    {
+      char const *start;
+      size_t length;
+    };
+
+    struct Plan
+    {
+      std::string xml;
+      std::map<uint32_t, Record> nodes;
+    };
+
+    std::vector<std::string> libraries;
+    std::map<uint32_t, Plan> plans;
+  };
+
+  //! Read the snapshot into an image.
+  //! @return true if successful, false otherwise.
+  static bool readSnapshot(std::vector<char> const &data, SnapshotImage &image)
+  {
+    uint32_t version = 0;
+    if (data.size() >= SNAPSHOT_HEADER_SIZE)
+      memcpy(&version, data.data() + sizeof(SNAPSHOT_MAGIC), sizeof(version));
+    if (data.size() < SNAPSHOT_HEADER_SIZE
+        || memcmp(data.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC))
+        || version != SNAPSHOT_VERSION) {
+      warn("restoreExecSnapshot: not a compatible snapshot file");
+      return false;
+    }
+
+    // Records are applied only when their checkpoint is complete
+    std::vector<std::pair<SnapshotRecordType, SnapshotImage::Record>> uncommitted;
+    SnapshotReader file(data.data() + SNAPSHOT_HEADER_SIZE, data.data() + data.size());
+    while (!file.atEnd()) {
+      SnapshotRecordType type = (SnapshotRecordType) file.getUint8();
+      uint32_t len = file.getUint32();
+      char const *start = file.position();
+      file.skip(len);
+      if (!file.ok())
+        break; // truncated by a crash
+
+      if (type != S_CHECKPOINT) {
+        uncommitted.push_back(std::make_pair(type, SnapshotImage::Record{start, len}));
+        continue;
+      }
+
+      for (std::pair<SnapshotRecordType, SnapshotImage::Record> const &r : uncommitted) {
+        SnapshotReader rec(r.second.start, r.second.start + r.second.length);
+        switch (r.first) {
+        case S_LIBRARY:
+          image.libraries.push_back(rec.getString());
+          break;
+
+        case S_PLAN: {
+          uint32_t id = rec.getUint32();
+          image.plans[id].xml = rec.getString();
+          break;
+        }
+
+        case S_PLAN_DELETED:
+          image.plans.erase(rec.getUint32());
+          break;
+
+        case S_NODE: {
+          uint32_t id = rec.getUint32();
+          uint32_t index = rec.getUint32();
+          std::map<uint32_t, SnapshotImage::Plan>::iterator it = image.plans.find(id);
+          if (it != image.plans.end())
+            it->second.nodes[index] = r.second;
+          break;
+        }
+
+        default:
+          warn("restoreExecSnapshot: invalid record type " << (int) r.first);
+          return false;
+        }
+        if (!rec.ok()) {
+          warn("restoreExecSnapshot: invalid record in snapshot");
+          return false;
+        }
+      }
+      uncommitted.clear();
+    }
+    return true;
+  }
+
+  //! Check that every saved node record names the node at its index
+  //! in the parsed plan.
+  //! @return true if the records match the plan, false otherwise.
+  static bool matchesPlan(SnapshotImage::Plan const &plan,
+                          std::vector<NodeImpl *> const &nodes)
+  {
+    for (std::pair<uint32_t const, SnapshotImage::Record> const &n : plan.nodes) {
+      if (n.first >= nodes.size())
+        return false;
+      SnapshotReader rec(n.second.start, n.second.start + n.second.length);
+      rec.getUint32(); // plan ID
+      rec.getUint32(); // node index
+      if (rec.getString() != nodes[n.first]->getNodeId() || !rec.ok())
+        return false;
+    }
+    return true;
+  }
+
+  //! Bring the node to the state in its saved record.
+  //! @return true if successful, false otherwise.
+  static bool restoreNode(NodeImpl *node,
+                          SnapshotImage::Record const &record,
+                          RestoreExec &restoreExec)
+  {
+    SnapshotReader rec(record.start, record.start + record.length);
+    rec.getUint32(); // plan ID
+    rec.getUint32(); // node index
+    rec.getString(); // node ID, checked by matchesPlan()
+    NodeState state = (NodeState) rec.getUint8();
+    NodeOutcome outcome = (NodeOutcome) rec.getUint8();
+    FailureType failure = (FailureType) rec.getUint8();
+    double startTime = rec.getDouble();
+    if (!rec.ok() || state == NO_NODE_STATE || state >= NODE_STATE_MAX) {
+      warn("restoreExecSnapshot: invalid record for node " << node->getNodeId());
+      return false;
+    }
+    if (!node->restoreState(&restoreExec, state, outcome, failure, startTime)) {
+      warn("restoreExecSnapshot: unable to restore node " << node->getNodeId()
+           << " to state " << nodeStateName(state));
+      return false;
+    }
+
+    // Timepoints
+    uint8_t nTimepoints = rec.getUint8();
+    NodeTimepointValue *tp = node->getTimepoints();
+    for (uint8_t i = 0; i < nTimepoints && tp; ++i, tp = tp->next()) {
+      bool known = rec.getUint8() == FLAG_TRUE;
+      double t = rec.getDouble();
+      if (known)
+        tp->setValue(t);
+      else
+        tp->reset();
+    }
+
+    // Action in progress
+    uint8_t action = rec.getUint8();
+    uint8_t status = FLAG_UNKNOWN;
+    uint8_t abortComplete = FLAG_UNKNOWN;
+    if (action != ACTION_NONE) {
+      status = rec.getUint8();
+      abortComplete = rec.getUint8();
+    }
+    bool executing = isActionState(state);
+    switch (action) {
+    case ACTION_COMMAND:
+      if (executing && node->getType() == NodeType_Command) {
+        CommandImpl *cmd = static_cast<CommandNode *>(node)->getCommand();
+        switch ((CommandHandleValue) status) {
+        case NO_COMMAND_HANDLE:
+        case COMMAND_SENT_TO_SYSTEM:
+        case COMMAND_ACCEPTED:
+        case COMMAND_RCVD_BY_SYSTEM:
+          // Status lost with the interface; issue again
+          if (state != FAILING_STATE) {
+            debugMsg("ExecSnapshot:restore", " reissuing command for " << node->getNodeId());
+            restoreExec.deferAction([cmd] (PlexilExec &e) { e.enqueueCommand(cmd); });
+          }
+          break;
+
+        default:
+          cmd->setCommandHandle((CommandHandleValue) status);
+          break;
+        }
+        if (state == FAILING_STATE) {
+          if (abortComplete == FLAG_TRUE)
+            cmd->acknowledgeAbort(true);
+          else
+            restoreExec.deferAction([cmd] (PlexilExec &e) { e.enqueueAbortCommand(cmd); });
+        }
+      }
+      break;
+
+    case ACTION_ASSIGNMENT:
+      if (executing && node->getType() == NodeType_Assignment) {
+        Assignment *assign = static_cast<AssignmentNode *>(node)->getAssignment();
+        if (state == FAILING_STATE) {
+          if (abortComplete == FLAG_TRUE)
+            dynamic_cast<SimpleBooleanVariable *>(assign->getAbortComplete())->setValue(true);
+          else
+            restoreExec.deferAction([assign] (PlexilExec &e) { e.enqueueAssignmentForRetraction(assign); });
+        }
+        else if (status == FLAG_TRUE)
+          dynamic_cast<SimpleBooleanVariable *>(assign->getAck())->setValue(true);
+        else
+          restoreExec.deferAction([assign] (PlexilExec &e) { e.enqueueAssignment(assign); });
+      }
+      break;
+
+    case ACTION_UPDATE:
+      if (executing && node->getType() == NodeType_Update) {
+        UpdateImpl *upd = static_cast<UpdateNode *>(node)->getUpdate();
+        if (status != FLAG_UNKNOWN)
+          upd->acknowledge(status == FLAG_TRUE);
+        else if (state == EXECUTING_STATE) {
+          debugMsg("ExecSnapshot:restore", " reissuing update for " << node->getNodeId());
+          restoreExec.deferAction([upd] (PlexilExec &e) { e.enqueueUpdate(upd); });
+        }
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    // Local variables
+    uint32_t nVars = rec.getUint32();
+    std::vector<ExpressionPtr> const *vars = node->getLocalVariables();
+    if (nVars != (vars ? vars->size() : 0)) {
+      warn("restoreExecSnapshot: variables of node " << node->getNodeId()
+           << " do not match snapshot; plan or libraries have changed");
+      return false;
+    }
+    for (uint32_t i = 0; i < nVars; ++i) {
+      Value val = rec.getValue();
+      Expression *var = (*vars)[i].get();
+      Assignable *assignable = var->asAssignable();
+      // Skip aliases for variables of other nodes
+      if (!assignable
+          || static_cast<Expression const *>(assignable->getBaseVariable()) != var)
+        continue;
+      if (val.isKnown())
+        assignable->setValue(val);
+      else
+        assignable->setUnknown();
+    }
+
+    if (!rec.ok()) {
+      warn("restoreExecSnapshot: invalid record for node " << node->getNodeId());
+      return false;
+    }
+    return true;
+  }
+
+  bool restoreExecSnapshot(std::string const &filename,
+                           ExecApplication &app,
+                           ExecSnapshot *snapshot)
+  {
+    std::vector<char> data;
+    {
+      std::ifstream in(filename, std::ios::binary);
+      if (!in) {
+        warn("restoreExecSnapshot: unable to open " << filename);
+        return false;
+      }
+      data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    SnapshotImage image;
+    if (!readSnapshot(data, image))
+      return false;
+    debugMsg("ExecSnapshot:restore",
+             ' ' << filename << ": " << image.libraries.size() << " libraries, "
+             << image.plans.size() << " plans");
+
+    // Libraries first, as plans may reference them
+    for (std::string const &xml : image.libraries) {
+      pugi::xml_document *doc = new pugi::xml_document();
+      if (doc->load_buffer(xml.data(), xml.size(), PUGI_PARSE_OPTIONS).status != pugi::status_ok) {
+        warn("restoreExecSnapshot: unable to parse saved library");
+        delete doc;
+        return false;
+      }
+      app.manager()->handleAddLibrary(doc); // takes ownership
+    }
+
+    PlexilExec &exec = *app.exec();
+    RestoreExec restoreExec(exec);
+    PlexilExec *savedExec = g_exec;
+    bool result = true;
+
+    for (std::pair<uint32_t const, SnapshotImage::Plan> const &p : image.plans) {
+      SnapshotImage::Plan const &plan = p.second;
+      pugi::xml_document doc;
+      if (doc.load_buffer(plan.xml.data(), plan.xml.size(), PUGI_PARSE_OPTIONS).status
+          != pugi::status_ok) {
+        warn("restoreExecSnapshot: unable to parse saved plan " << p.first);
+        result = false;
+        continue;
+      }
+
+      NodeImpl *root = nullptr;
+      try {
+        root = parsePlan(doc.document_element());
+      }
+      catch (ParserException const &e) {
+        warn("restoreExecSnapshot: error parsing saved plan " << p.first << ":\n" << e.what());
+        result = false;
+        continue;
+      }
+
+      // Finished plans need not be restored
+      std::map<uint32_t, SnapshotImage::Record>::const_iterator rootRec = plan.nodes.find(0);
+      if (rootRec != plan.nodes.end()) {
+        SnapshotReader rec(rootRec->second.start, rootRec->second.start + rootRec->second.length);
+        rec.getUint32();
+        rec.getUint32();
+        rec.getString();
+        if (rec.getUint8() == FINISHED_STATE) {
+          debugMsg("ExecSnapshot:restore", " plan " << root->getNodeId() << " finished, skipping");
+          delete root;
+          continue;
+        }
+      }
+
+      // Check the saved nodes against the plan before the Exec sees it
+      std::vector<NodeImpl *> nodes;
+      collectNodes(root, nodes);
+      if (!matchesPlan(plan, nodes)) {
+        warn("restoreExecSnapshot: plan " << root->getNodeId()
+             << " does not match snapshot; plan or libraries have changed");
+        delete root;
+        result = false;
+        continue;
+      }
+
+      exec.addPlan(root); // activates root
+
+      // Parents are restored before their children
+      g_exec = &restoreExec;
+      bool restored = true;
+      for (std::pair<uint32_t const, SnapshotImage::Record> const &n : plan.nodes) {
+        if (!restoreNode(nodes[n.first], n.second, restoreExec)) {
+          restored = false;
+          break;
+        }
+      }
+      g_exec = savedExec;
+
+      if (!restored) {
+        // Don't leave a partly restored plan in the Exec
+        warn("restoreExecSnapshot: plan " << root->getNodeId()
+             << " could not be restored, removing it");
+        restoreExec.abandonPlan(root);
+        exec.removePlan(root);
+        result = false;
+        continue;
+      }
+
+      restoreExec.commitPlan();
+      app.listenerHub()->indexPlan(root);
+      if (snapshot)
+        snapshot->addPlan(root, doc.document_element());
+      app.listenerHub()->notifyOfAddPlan(doc.document_element());
+      debugMsg("ExecSnapshot:restore",
+               " restored plan " << root->getNodeId() << ", " << nodes.size() << " nodes");
+    }
+
+    restoreExec.notifyCandidates();
+    return result;
+  }
+
+} // namespace PLEXIL
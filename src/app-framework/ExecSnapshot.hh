@@ -0,0 +1,113 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_EXEC_SNAPSHOT_HH
+#define PLEXIL_EXEC_SNAPSHOT_HH
+
+#include <string>
+
+// Forward reference
+namespace pugi
+{
+  class xml_node;
+}
+
+namespace PLEXIL
+{
+  // Forward references
+  class ExecApplication;
+  class NodeImpl;
+  class PlexilExec;
+
+  //! @class ExecSnapshot
+  //! Maintains a compact binary snapshot of the state of all running
+  //! plans, from which the Exec can be warm restarted.
+  //! @details The snapshot captures each node's state, outcome,
+  //!          failure type, and transition timepoints; the values of
+  //!          its local variables, including arrays; and the status
+  //!          of any command, assignment, or update it has in
+  //!          progress.  The plans and libraries themselves are saved
+  //!          as received.
+  //!
+  //!          The snapshot file is an append-only log.  Each
+  //!          checkpoint appends only the nodes which have changed
+  //!          since the last, followed by a commit record; a
+  //!          checkpoint interrupted by a crash is ignored on
+  //!          restore.  The log is compacted when it grows large
+  //!          relative to the live state.
+  class ExecSnapshot
+  {
+  public:
+    virtual ~ExecSnapshot() = default;
+
+    //! Register a plan as it is received.
+    //! @param root The root node parsed from the plan.
+    //! @param planXml The plan's XML.
+    //! @note May be called from any thread.
+    virtual void addPlan(NodeImpl const *root, pugi::xml_node const planXml) = 0;
+
+    //! Register a library node as it is received.
+    //! @param libXml The library document's XML.
+    //! @note May be called from any thread.
+    virtual void addLibrary(pugi::xml_node const libXml) = 0;
+
+    //! Write a checkpoint of all registered plans running in the Exec.
+    //! @param exec The Exec.
+    //! @note Must be called from the Exec thread, when the Exec is quiescent.
+    virtual void checkpoint(PlexilExec &exec) = 0;
+
+    //! Forget plans registered but never started.
+    //! @note Called when the application is reset.
+    virtual void reset() = 0;
+  };
+
+  //! Construct an ExecSnapshot writing to the named file.
+  //! @param filename Name of the snapshot file.  The file is
+  //!                 overwritten at the first checkpoint.
+  //! @return Pointer to the new snapshot object.
+  ExecSnapshot *makeExecSnapshot(std::string const &filename);
+
+  //! Restore the plans saved in a snapshot file, bringing each
+  //! node to its saved state.
+  //! @param filename Name of the snapshot file.
+  //! @param app The application.  Its interfaces must be started,
+  //!            and the Exec must not be running.
+  //! @param snapshot If not null, the restored plans are registered
+  //!                 with it, so that checkpoints continue from the
+  //!                 restored state.
+  //! @return true if successful, false otherwise.
+  //! @note Commands and updates which had not received a final
+  //!       status when the snapshot was taken are issued again.
+  //!       Aborts not yet acknowledged are likewise reissued.
+  //! @note Library nodes loaded from the library path must be
+  //!       available on the library path at restore time.
+  bool restoreExecSnapshot(std::string const &filename,
+                           ExecApplication &app,
+                           ExecSnapshot *snapshot);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_EXEC_SNAPSHOT_HH
@@ -36,10 +36,12 @@
 #include "Debug.hh"
 #include "ExecApplication.hh"
 #include "ExecListenerHub.hh"
+#include "ExecSnapshot.hh"
 #include "InputQueue.hh"
 #include "InterfaceAdapter.hh"
 #include "InterfaceError.hh"
 #include "LookupReceiver.hh"
+#include "Message.hh"
 #include "NodeImpl.hh"
 #include "parsePlan.hh"
 #include "parser-utils.hh"
@@ -47,6 +49,7 @@
 #include "PlexilExec.hh"
 #include "PlexilSchema.hh"
 #include "QueueEntry.hh"
+#include "QueueJournal.hh"
 #include "State.hh"
 #include "StateCache.hh"
 #include "Update.hh"
@@ -67,7 +70,14 @@ namespace PLEXIL
       m_application(app),
       m_configuration(config),
       m_inputQueue(),
-      m_markCount(0)
+      m_recorder(nullptr),
+      m_snapshot(nullptr),
+      m_markCount(0),
+#ifdef PLEXIL_WITH_THREADS
+      m_dispatchThread()
+#else
+      m_dispatching(false)
+#endif
   {
   }
 
@@ -173,6 +183,11 @@ namespace PLEXIL
              " for command " << cmd->getCommand()
              << ", handle = " << commandHandleValueName(value));
 
+    if (isSynchronousResponse()) {
+      commandHandleReturn(cmd, value);
+      return;
+    }
+
     assertTrue_1(m_inputQueue);
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
@@ -195,6 +210,11 @@ namespace PLEXIL
              " for command " << cmd->getCommand()
              << ", value = " << value);
 
+    if (isSynchronousResponse()) {
+      commandReturn(cmd, value);
+      return;
+    }
+
     assertTrue_1(m_inputQueue);
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
@@ -214,6 +234,11 @@ namespace PLEXIL
              " for command " << cmd->getCommand()
              << ", value = " << value);
 
+    if (isSynchronousResponse()) {
+      commandReturn(cmd, value);
+      return;
+    }
+
     assertTrue_1(m_inputQueue);
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
@@ -237,7 +262,14 @@ namespace PLEXIL
              " for command " << cmd->getCommand()
              << ", ack = " << (ack ? "true" : "false"));
 
+    // Responses to the command may already be waiting in the queue;
+    // applying the abort ack ahead of them would reorder them.
     assertTrue_1(m_inputQueue);
+    if (isSynchronousResponse() && m_inputQueue->isEmpty()) {
+      commandAbortAcknowledge(cmd, ack);
+      return;
+    }
+
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
 
@@ -264,6 +296,11 @@ namespace PLEXIL
              " for node " << upd->getNodeId()
              << ", ack = " << (ack ? "true" : "false"));
 
+    if (isSynchronousResponse()) {
+      upd->acknowledge(ack);
+      return;
+    }
+
     assertTrue_1(m_inputQueue);
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
@@ -355,6 +392,10 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForAddPlan(root);
+    if (m_recorder)
+      m_recorder->recordPlan(root, planXml);
+    if (m_snapshot)
+      m_snapshot->addPlan(root, planXml);
     m_inputQueue->put(entry);
     m_application->listenerHub()->notifyOfAddPlan(planXml);
     debugMsg("InterfaceManager:handleAddPlan", " plan enqueued for loading");
@@ -370,6 +411,11 @@ namespace PLEXIL
     checkError(doc,
                "InterfaceManager::handleAddLibrary: Null plan document");
 
+    if (m_recorder)
+      m_recorder->recordLibrary(doc->document_element());
+    if (m_snapshot)
+      m_snapshot->addLibrary(doc->document_element());
+
     // Hand off to librarian
     Library const *l = loadLibraryDocument(doc);
     if (l) {
@@ -434,6 +480,88 @@ namespace PLEXIL
     return sequence;
   }
 
+  //! Query whether the input queue is empty.
+  //! @return True if no input is waiting to be processed, false otherwise.
+  bool InterfaceManager::isQueueEmpty() const
+  {
+    assertTrue_1(m_inputQueue);
+    return m_inputQueue->isEmpty();
+  }
+
+  void InterfaceManager::setRecorder(QueueRecorder *recorder)
+  {
+    m_recorder = recorder;
+  }
+
+  void InterfaceManager::setSnapshot(ExecSnapshot *snapshot)
+  {
+    m_snapshot = snapshot;
+  }
+
+  void InterfaceManager::beginDispatch()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    m_dispatchThread = std::this_thread::get_id();
+#else
+    m_dispatching = true;
+#endif
+  }
+
+  void InterfaceManager::endDispatch()
+  {
+#ifdef PLEXIL_WITH_THREADS
+    m_dispatchThread = std::thread::id();
+#else
+    m_dispatching = false;
+#endif
+  }
+
+  // The recorder only sees queued responses, so they must go through
+  // the queue while recording.
+  bool InterfaceManager::isSynchronousResponse() const
+  {
+#ifdef PLEXIL_WITH_THREADS
+    if (m_dispatchThread != std::this_thread::get_id())
+      return false;
+#else
+    if (!m_dispatching)
+      return false;
+#endif
+    return !m_recorder;
+  }
+
+  //! Discard all pending input.
+  void InterfaceManager::reset()
+  {
+    assertTrue_1(m_inputQueue);
+    debugMsg("InterfaceManager:reset", " flushing input queue");
+
+    // Entries carrying objects the Exec would have taken ownership of
+    // must be disposed of here
+    QueueEntry *entry;
+    while ((entry = m_inputQueue->get())) {
+      switch (entry->type) {
+      case Q_MARK:
+        m_application->markProcessed(entry->sequence);
+        break;
+
+      case Q_ADD_PLAN:
+        delete entry->plan;
+        entry->plan = nullptr;
+        break;
+
+      case Q_ACCEPT_MSG:
+        delete entry->message;
+        entry->message = nullptr;
+        break;
+
+      default:
+        break;
+      }
+      m_inputQueue->release(entry);
+    }
+  }
+
 #ifdef PLEXIL_WITH_THREADS
   //! Notify the executive that it should run one cycle. Block the
   //! calling thread until all the items in the input queue at the
@@ -460,7 +588,11 @@ namespace PLEXIL
 
     bool needsStep = false;
     QueueEntry *entry;
+    if (m_recorder)
+      m_recorder->recordQueueStart();
     while ((entry = m_inputQueue->get())) {
+      if (m_recorder)
+        m_recorder->recordQueueEntry(*entry);
       switch (entry->type) {
       case Q_MARK:
         debugMsg("InterfaceManager:processQueue", " Received mark");
@@ -535,6 +667,7 @@ namespace PLEXIL
           assertTrue_1(pid);
           debugMsg("InterfaceManager:processQueue",
                    " adding plan " << entry->plan->getNodeId());
+          m_application->listenerHub()->indexPlan(pid);
           g_exec->addPlan(pid);
         }
         entry->plan = nullptr;
@@ -582,6 +715,8 @@ namespace PLEXIL
       // Recycle the queue entry
       m_inputQueue->release(entry);
     }
+    if (m_recorder)
+      m_recorder->recordQueueEnd();
 
     debugMsg("InterfaceManager:processQueue",
              " Queue empty, returning " << (needsStep ? "true" : "false"));
@@ -30,6 +30,11 @@
 
 #include <memory>
 
+#ifdef PLEXIL_WITH_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
 // Forward reference
 namespace pugi
 {
@@ -48,6 +53,9 @@ namespace PLEXIL
 
   class InputQueue;
 
+  class ExecSnapshot;
+  class QueueRecorder;
+
   //! @class InterfaceManager
   //! A concrete derived class implementing the API of the
   //! AdapterExecInterface class.
@@ -88,6 +96,39 @@ namespace PLEXIL
     //! @return The sequence number of the mark.
     unsigned int markQueue();
 
+    //! Query whether the input queue is empty.
+    //! @return True if no input is waiting to be processed, false otherwise.
+    bool isQueueEmpty() const;
+
+    //! Discard all pending input, deleting any plans and accepted
+    //! messages not yet delivered to the Exec.
+    //! @note Queue marks are reported as processed, so that waiting
+    //!       threads are released.
+    //! @note Should only be called with exec locked by the current thread.
+    void reset();
+
+    //! Set the recorder which journals queue processing.
+    //! @param recorder Pointer to the recorder; may be null.
+    //! @note The caller retains ownership of the recorder.
+    void setRecorder(QueueRecorder *recorder);
+
+    //! Set the snapshot writer which saves the Exec state.
+    //! @param snapshot Pointer to the snapshot writer; may be null.
+    //! @note The caller retains ownership of the snapshot writer.
+    void setSnapshot(ExecSnapshot *snapshot);
+
+    //! Note that the Exec is about to hand a command, abort, or
+    //! update to its handler on the calling thread.
+    //! @details Until endDispatch() is called, responses from
+    //!          handlers on this thread are applied to the Exec
+    //!          directly instead of being queued, so the Exec
+    //!          sees synchronous handlers' results in the same cycle.
+    //! @note Should only be called with exec locked by the current thread.
+    void beginDispatch();
+
+    //! Note that the Exec has finished handing a request to its handler.
+    void endDispatch();
+
     //
     // API to interface handlers
     //
@@ -197,6 +238,11 @@ namespace PLEXIL
     InterfaceManager &operator=(InterfaceManager const &) = delete;
     InterfaceManager &operator=(InterfaceManager &&) = delete;
 
+    //! Should a response be applied directly rather than queued?
+    //! @return True if called on the dispatching thread during a
+    //!         dispatch, and not recording; false otherwise.
+    bool isSynchronousResponse() const;
+
     //
     // Private member variables
     //
@@ -210,8 +256,23 @@ namespace PLEXIL
     //! The queue of input data for the Exec.
     std::unique_ptr<InputQueue> m_inputQueue;
 
+    //! Journal of queue processing, if recording.
+    QueueRecorder *m_recorder;
+
+    //! Saved Exec state, if snapshots are enabled.
+    ExecSnapshot *m_snapshot;
+
     //! Index of last queue mark enqueued.
     unsigned int m_markCount;
+
+#ifdef PLEXIL_WITH_THREADS
+    //! The thread between beginDispatch() and endDispatch() calls;
+    //! default-constructed at all other times.
+    std::atomic<std::thread::id> m_dispatchThread;
+#else
+    //! True between beginDispatch() and endDispatch() calls.
+    bool m_dispatching;
+#endif
   };
 
 }
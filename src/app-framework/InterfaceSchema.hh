@@ -53,6 +53,7 @@ namespace PLEXIL
     static constexpr char const *LOOKUP_HANDLER_TAG = "LookupHandler";
     static constexpr char const *LOOKUP_NAMES_TAG = "LookupNames";
     static constexpr char const *PLAN_PATH_TAG = "PlanPath";
+    static constexpr char const *PLAN_WEIGHT_TAG = "PlanWeight";
     static constexpr char const *PLANNER_UPDATE_TAG = "PlannerUpdate";
     static constexpr char const *PLANNER_UPDATE_HANDLER_TAG = "PlannerUpdateHandler";
     static constexpr char const *TIMEBASE_TAG = "Timebase";
@@ -65,13 +66,19 @@ namespace PLEXIL
 
     static constexpr char const *ADAPTER_TYPE_ATTR = "AdapterType";
     static constexpr char const *DEFAULT_HANDLER_ATTR = "DefaultHandler";
+    static constexpr char const *FILTER_CONDITION_NOTIFICATIONS_ATTR = "FilterConditionNotifications";
     static constexpr char const *FILTER_TYPE_ATTR = "FilterType";
     static constexpr char const *HANDLER_TYPE_ATTR = "HandlerType";
     static constexpr char const *LIB_PATH_ATTR = "LibPath";
     static constexpr char const *LISTENER_TYPE_ATTR = "ListenerType";
+    static constexpr char const *MIN_STEP_INTERVAL_ATTR = "MinimumStepInterval";
     static constexpr char const *NAME_ATTR = "Name";
+    static constexpr char const *NODE_ID_ATTR = "NodeId";
     static constexpr char const *TICK_INTERVAL_ATTR = "TickInterval";
+    static constexpr char const *TIME_SLICE_ATTR = "TimeSlice";
+    static constexpr char const *TIME_SLICE_MICRO_STEPS_ATTR = "TimeSliceMicroSteps";
     static constexpr char const *TYPE_ATTR = "Type";
+    static constexpr char const *WEIGHT_ATTR = "Weight";
     
     /**
      * @brief Extract comma separated arguments from a character string.
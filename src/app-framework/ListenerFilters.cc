@@ -31,10 +31,22 @@
 #include "InterfaceSchema.hh"
 #include "Node.hh"
 #include "NodeTransition.hh"
+#include "PlexilNodeType.hh"
+
+#include <set>
 
 #define STATES_TAG "States"
 #define IGNORED_STATES_TAG "IgnoredStates"
 
+#define NODE_ID_PREFIXES_TAG "NodeIdPrefixes"
+#define SUBTREES_TAG "Subtrees"
+#define NODE_TYPES_TAG "NodeTypes"
+#define VARIABLES_TAG "Variables"
+#define EVENTS_TAG "Events"
+
+#define TRANSITIONS_EVENT "Transitions"
+#define ASSIGNMENTS_EVENT "Assignments"
+
 //
 // Library of standard ExecListenerFilter classes
 //
@@ -120,9 +132,143 @@ namespace PLEXIL
     bool m_stateEnabled[NODE_STATE_MAX];
   };
 
-  //
-  // More later
-  //
+  /**
+   * @class NodeSelectionFilter
+   * @brief Selects events by the node ID, subtree, or type of the node,
+   *        the name of the variable assigned, and the kind of event.
+   * @note Selections are resolved when the plan is added, so rejected
+   *       events cost the listener nothing.
+   */
+
+  class NodeSelectionFilter : public ExecListenerFilter
+  {
+  public:
+
+    NodeSelectionFilter(pugi::xml_node const xml)
+      : ExecListenerFilter(xml),
+        m_prefixes(),
+        m_subtrees(),
+        m_variables(),
+        m_transitions(true),
+        m_assignments(true)
+    {
+      for (size_t i = 0; i < NodeType_error; ++i)
+        m_typeEnabled[i] = true;
+    }
+
+    ~NodeSelectionFilter()
+    {
+    }
+
+    bool initialize()
+    {
+      parseList(NODE_ID_PREFIXES_TAG, m_prefixes);
+      parseList(SUBTREES_TAG, m_subtrees);
+      parseList(VARIABLES_TAG, m_variables);
+
+      std::set<std::string> names;
+      if (parseList(NODE_TYPES_TAG, names)) {
+        for (size_t i = 0; i < NodeType_error; ++i)
+          m_typeEnabled[i] = false;
+        for (std::string const &name : names) {
+          PlexilNodeType typ = parseNodeType(name.c_str());
+          if (typ == NodeType_error) {
+            warn("NodeSelectionFilter: invalid node type \"" << name << '"');
+            return false;
+          }
+          m_typeEnabled[typ] = true;
+        }
+      }
+
+      names.clear();
+      if (parseList(EVENTS_TAG, names)) {
+        m_transitions = names.count(TRANSITIONS_EVENT) != 0;
+        m_assignments = names.count(ASSIGNMENTS_EVENT) != 0;
+        names.erase(TRANSITIONS_EVENT);
+        names.erase(ASSIGNMENTS_EVENT);
+        if (!names.empty()) {
+          warn("NodeSelectionFilter: invalid event type \"" << *names.begin() << '"');
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool selectNodeTransitions(Node const *node)
+    {
+      return m_transitions && selectNode(node);
+    }
+
+    bool selectAssignments(Node const *node, std::string const &destName)
+    {
+      return m_assignments
+        && selectNode(node)
+        && (m_variables.empty() || m_variables.count(destName));
+    }
+
+    bool reportNodeTransition(NodeTransition const &trans)
+    {
+      // Use the selection made when the plan was added, if recorded
+      if (selectionRecorded(trans.node))
+        return (trans.node->getListenerMask() & listenerBit()) != 0;
+      return selectNodeTransitions(trans.node);
+    }
+
+    // The assigning node is not known here, so only the variable can be checked
+    bool reportAssignment(Expression const * /* dest */,
+                          std::string const &destName,
+                          Value const & /* value */)
+    {
+      return m_assignments
+        && (m_variables.empty() || m_variables.count(destName));
+    }
+
+  private:
+
+    //
+    // Deliberately unimplemented
+    //
+    NodeSelectionFilter();
+    NodeSelectionFilter(const NodeSelectionFilter&);
+    NodeSelectionFilter& operator=(const NodeSelectionFilter&);
+
+    // Returns true if the element was present.
+    bool parseList(char const *tag, std::set<std::string> &result)
+    {
+      pugi::xml_node const elt = this->getXml().child(tag);
+      if (!elt)
+        return false;
+      std::vector<std::string>* names =
+        InterfaceSchema::parseCommaSeparatedArgs(elt.child_value());
+      result.insert(names->begin(), names->end());
+      delete names;
+      return true;
+    }
+
+    bool selectNode(Node const *node)
+    {
+      if (!m_typeEnabled[node->getType()])
+        return false;
+      if (m_prefixes.empty() && m_subtrees.empty())
+        return true;
+
+      std::string const &nodeId = node->getNodeId();
+      for (std::string const &prefix : m_prefixes)
+        if (!nodeId.compare(0, prefix.size(), prefix))
+          return true;
+      for (Node const *ancestor = node; ancestor; ancestor = ancestor->getParent())
+        if (m_subtrees.count(ancestor->getNodeId()))
+          return true;
+      return false;
+    }
+
+    std::set<std::string> m_prefixes;
+    std::set<std::string> m_subtrees;
+    std::set<std::string> m_variables;
+    bool m_typeEnabled[NodeType_error];
+    bool m_transitions;
+    bool m_assignments;
+  };
 
   /**
    * @brief Register the standard exec listener filters.
@@ -130,6 +276,7 @@ namespace PLEXIL
   void registerExecListenerFilters()
   {
     REGISTER_EXEC_LISTENER_FILTER(NodeStateFilter, "NodeState")
+    REGISTER_EXEC_LISTENER_FILTER(NodeSelectionFilter, "NodeSelection")
   }
 
 }
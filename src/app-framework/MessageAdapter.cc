@@ -38,9 +38,14 @@
 #include "InterfaceAdapter.hh"
 #include "Message.hh"
 #include "MessageAdapter.hh"
+#include "MessageQueueMap.hh" // parseMessageQueueBound()
+#include "RingQueue.hh"
 #include "Timebase.hh"
 
-#include <queue>
+#include "Debug.hh"
+
+#include <memory>
+#include <mutex>
 
 namespace PLEXIL
 {
@@ -58,23 +63,35 @@ namespace PLEXIL
 
     //! Constructor.
     MessageAdapterImpl(AdapterExecInterface &intf, AdapterConf *conf)
-      : InterfaceAdapter(intf, conf)
+      : InterfaceAdapter(intf, conf),
+        m_current(),
+        m_queue(),
+        m_mutex(),
+        m_received(0),
+        m_accepted(0),
+        m_dropped(0)
     {
     }
 
     //! Virtual destructor.
     virtual ~MessageAdapterImpl()
     {
-      // Clean up message queue
-      while (!m_queue.empty()) {
-        Message *msg = m_queue.front();
-        m_queue.pop();
-        delete msg;
-      }
+      debugMsg("MessageAdapter:statistics",
+               " received " << m_received << ", accepted " << m_accepted
+               << ", dropped " << m_dropped << ", pending "
+               << m_queue.size() + (m_current ? 1 : 0));
+      // Remaining messages are deleted with the queue
     }
 
     virtual bool initialize(AdapterConfiguration *config)
     {
+      // Optional bound on the messages waiting behind the current one
+      size_t bound = 0;
+      QueueDropPolicy policy = QUEUE_DROP_OLDEST;
+      if (!parseMessageQueueBound(getXml(), bound, policy))
+        return false;
+      m_queue.setBound(bound, policy);
+
       // Register command handlers
       config->registerCommandHandlerFunction("GetMessageHandle",
                                              getMessageHandleHandler);
@@ -122,7 +139,8 @@ namespace PLEXIL
     //! Pop the message at the head of the queue and send it to the Exec.
     void acceptMessage(Command *cmd, AdapterExecInterface *intf)
     {
-      if (m_queue.empty()) {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if (!m_current) {
         // Empty queue -> handle unknown
         intf->handleCommandReturn(cmd, Value());
       }
@@ -130,14 +148,17 @@ namespace PLEXIL
         // Generate a handle
         std::string handle;
         // TODO - generate UID?
-        intf->notifyMessageAccepted(m_queue.front(), handle);
-        m_queue.pop();
+        // Exec takes ownership of the message
+        intf->notifyMessageAccepted(m_current.release(), handle);
+        ++m_accepted;
         intf->handleCommandReturn(cmd, Value(handle));
         // Post the new state of the queue.
         if (m_queue.empty()) {
           intf->notifyMessageQueueEmpty();
         } else {
-          intf->notifyMessageReceived(m_queue.front());
+          m_current = std::move(m_queue.front());
+          m_queue.pop();
+          intf->notifyMessageReceived(m_current.get());
         }
       }
       // In either case, we've done our job
@@ -296,23 +317,36 @@ namespace PLEXIL
     void enqueueMessage(State const &state, std::string const &sender, double timestamp)
     {
       // check if started?
-      bool wasEmpty = m_queue.empty();
-      m_queue.push(new Message(state, sender, timestamp));
-      if (wasEmpty) {
+      std::unique_ptr<Message> msg(new Message(state, sender, timestamp));
+      {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        ++m_received;
+        if (m_current) {
+          // The Exec already holds the current message,
+          // so only the waiting messages are subject to the bound
+          m_dropped += m_queue.push(std::move(msg));
+          return;
+        }
+        m_current = std::move(msg);
         // Tell the Exec we have a message for them
         // (populates the PeekAtMessage and PeekAtMessageSender lookups)
-        getInterface().notifyMessageReceived(m_queue.front());
-        getInterface().notifyOfExternalEvent();
+        getInterface().notifyMessageReceived(m_current.get());
       }
+      getInterface().notifyOfExternalEvent();
     }
     
     //
     // Member data
     //
 
-    using MessageQueue = std::queue<Message *>;
+    using MessageQueue = RingQueue<std::unique_ptr<Message>>;
 
-    MessageQueue m_queue;
+    std::unique_ptr<Message> m_current; //!< The message at the head of the queue, as posted to the Exec.
+    MessageQueue m_queue;               //!< Messages waiting behind the current one.
+    std::mutex m_mutex;                 //!< Guards the queue, which transports fill from their own threads.
+    uint64_t m_received;
+    uint64_t m_accepted;
+    uint64_t m_dropped;
   }; // class MessageAdapterImpl
 
 } // namespace PLEXIL
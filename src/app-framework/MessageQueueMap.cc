@@ -0,0 +1,302 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+ *  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Universities Space Research Association nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * MessageQueueMap.cc
+ *
+ *  Created on: Feb 19, 2010
+ *      Author: jhogins
+ */
+
+#include "MessageQueueMap.hh"
+
+#include "AdapterExecInterface.hh"
+#include "Command.hh"
+#include "Debug.hh"
+#include "Error.hh"
+
+#include "pugixml.hpp"
+
+#include <cstring> // strcmp()
+#include <functional> // std::hash
+#include <utility>
+
+namespace PLEXIL 
+{
+
+  MessageQueueMap::MessageQueueMap(AdapterExecInterface& execInterface,
+                                   bool allowDuplicateMessages,
+                                   size_t nBuckets) :
+    m_buckets(),
+    m_execInterface(execInterface),
+    m_queueBound(0),
+    m_dropPolicy(QUEUE_DROP_OLDEST),
+    m_allowDuplicateMessages(allowDuplicateMessages)
+  {
+    size_t n = 1;
+    while (n < nBuckets)
+      n <<= 1;
+    m_buckets.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+      m_buckets.emplace_back(std::unique_ptr<Bucket>(new Bucket()));
+  }
+
+  MessageQueueMap::~MessageQueueMap()
+  {
+    debugMsg("MessageQueueMap:statistics", " for " << this);
+    debugStmt("MessageQueueMap:statistics",
+              {
+                std::vector<MessageQueueStatistics> stats;
+                getAllStatistics(stats);
+                for (MessageQueueStatistics const &s : stats)
+                  getDebugOutputStream()
+                    << " \"" << s.name << "\" received " << s.messagesReceived
+                    << ", delivered " << s.messagesDelivered
+                    << ", dropped " << s.messagesDropped
+                    << ", high water " << s.messagesHighWater << std::endl;
+              });
+  }
+
+  /**
+   * @brief Adds the given recipient to the queue to receive the given message.
+   * If a recipient already exists for this message, messages will be handed out in the order
+   * of the adding of the recipients.
+   * @param message The message the recipient is waiting for
+   * @param cmd The command instance
+   * @note Always executed from the Exec thread.
+   */
+  void MessageQueueMap::addRecipient(const std::string& message, Command *cmd) {
+    debugMsg("MessageQueueMap:addRecipient", ' ' << this << " for \"" << message << "\"");
+    bool delivered;
+    {
+      Bucket &bucket = getBucket(message);
+      std::lock_guard<std::mutex> guard(bucket.m_mutex);
+      PairingQueue* que = ensureQueue(bucket, message);
+      que->m_recipientQueue.push(cmd);
+      ++que->m_recipientsAdded;
+      delivered = updateQueue(que);
+    }
+    if (delivered)
+      m_execInterface.notifyOfExternalEvent();
+    debugMsg("MessageQueueMap:addRecipient", ' ' << this << " added for message \"" << message << '"');
+  }
+
+  /**
+   * @brief Adds the given message to its queue. If there is a recipient waiting for the message, it is sent immediately.
+   * @param message The message string to be added
+   * @note Only called from IpcAdapter::handleMessageMessage().
+   */
+  void MessageQueueMap::addMessage(const std::string& message) {
+    debugMsg("MessageQueueMap:addMessage", ' ' << this << " entered for \"" << message << "\"");
+    enqueueMessage(message, Value(message));
+    debugMsg("MessageQueueMap:addMessage", ' ' << this << " Message \"" << message << "\" added");
+  }
+
+  /**
+   * @brief Adds the given message with the given parameters to its queue.
+   * If there is a recipient waiting for the message, it is sent immediately.
+   * @param message The message string to be added
+   * @param params The parameters that are to be sent with the message
+   * @note Only called from IpcAdapter::handleCommandSequence().
+   */
+  void MessageQueueMap::addMessage(const std::string& message, const Value& param) {
+    debugMsg("MessageQueueMap:addMessage", ' ' << this << " entered for \"" << message << "\"");
+    enqueueMessage(message, Value(param));
+    debugMsg("MessageQueueMap:addMessage",
+             ' ' << this << " Message \"" << message << "\" added, value = \"" << param << '"');
+  }
+
+  /**
+   * @brief Sets the flag that determines whether or not incoming messages
+   *        with duplicate strings are queued. If true, all incoming messages are
+   *        put into the queue. Oldest instances of the message are distributed first.
+   *        If false, new messages with duplicate strings replace older ones; this
+   *        will remove all oldest duplicates from the queue immediately as well
+   *        as set the behavior for future messages.
+   * @param flag If false, duplicates will be replaced with the newest
+   *        message. If true, duplicates are queued.
+   * @note Only called from adapter initialize() methods. So unlikely to have received any messages
+   *       when this is called.
+   */
+  void MessageQueueMap::setAllowDuplicateMessages(bool flag) {
+    debugMsg("MessageQueueMap:setAllowDuplicateMessages", ' ' << this << " to " << flag);
+    m_allowDuplicateMessages = flag;
+  }
+
+  bool MessageQueueMap::getAllowDuplicateMessages()
+  {
+    return m_allowDuplicateMessages;
+  }
+
+  void MessageQueueMap::setQueueBound(size_t bound, QueueDropPolicy policy)
+  {
+    debugMsg("MessageQueueMap:setQueueBound",
+             ' ' << this << " to " << bound
+             << (policy == QUEUE_DROP_OLDEST ? ", drop oldest" : ", drop newest"));
+    m_queueBound = bound;
+    m_dropPolicy = policy;
+    for (std::unique_ptr<Bucket> const &bucket : m_buckets) {
+      std::lock_guard<std::mutex> guard(bucket->m_mutex);
+      for (auto &entry : bucket->m_queues) {
+        PairingQueue *pq = entry.second.get();
+        pq->m_dropped += pq->m_messageQueue.setBound(bound, policy);
+      }
+    }
+  }
+
+  bool MessageQueueMap::configure(pugi::xml_node const xml)
+  {
+    size_t bound = m_queueBound;
+    QueueDropPolicy policy = m_dropPolicy;
+    if (!parseMessageQueueBound(xml, bound, policy))
+      return false;
+    setQueueBound(bound, policy);
+    return true;
+  }
+
+  bool MessageQueueMap::getStatistics(std::string const &message,
+                                      MessageQueueStatistics &result) const
+  {
+    Bucket &bucket = getBucket(message);
+    std::lock_guard<std::mutex> guard(bucket.m_mutex);
+    auto it = bucket.m_queues.find(message);
+    if (it == bucket.m_queues.end())
+      return false;
+    it->second->getStatistics(result);
+    return true;
+  }
+
+  void MessageQueueMap::getAllStatistics(std::vector<MessageQueueStatistics> &result) const
+  {
+    for (std::unique_ptr<Bucket> const &bucket : m_buckets) {
+      std::lock_guard<std::mutex> guard(bucket->m_mutex);
+      for (auto const &entry : bucket->m_queues) {
+        result.emplace_back();
+        entry.second->getStatistics(result.back());
+      }
+    }
+  }
+
+  void MessageQueueMap::PairingQueue::getStatistics(MessageQueueStatistics &result) const
+  {
+    result.name = m_name;
+    result.messagesReceived = m_received;
+    result.messagesDelivered = m_delivered;
+    result.messagesDropped = m_dropped;
+    result.recipientsAdded = m_recipientsAdded;
+    result.messagesPending = m_messageQueue.size();
+    result.recipientsWaiting = m_recipientQueue.size();
+    result.messagesHighWater = m_highWater;
+  }
+
+  //! @brief Get the bucket for this message.
+  MessageQueueMap::Bucket &MessageQueueMap::getBucket(const std::string& message) const
+  {
+    return *m_buckets[std::hash<std::string>()(message) & (m_buckets.size() - 1)];
+  }
+
+  //! @brief Get or construct the PairingQueue for this message.
+  MessageQueueMap::PairingQueue * MessageQueueMap::ensureQueue(Bucket &bucket,
+                                                               const std::string& message)
+  {
+    auto it = bucket.m_queues.find(message);
+    if (bucket.m_queues.end() == it) {
+      it = bucket.m_queues.emplace(message,
+                                   std::unique_ptr<PairingQueue>(new PairingQueue(message,
+                                                                                  m_queueBound,
+                                                                                  m_dropPolicy))).first;
+      debugMsg("MessageQueueMap:ensureQueue", " created new queue with name \"" << message << '"');
+    }
+    return it->second.get();
+  }
+
+  void MessageQueueMap::enqueueMessage(const std::string &message, Value &&value)
+  {
+    bool delivered;
+    {
+      Bucket &bucket = getBucket(message);
+      std::lock_guard<std::mutex> guard(bucket.m_mutex);
+      PairingQueue* pq = ensureQueue(bucket, message);
+      if (!m_allowDuplicateMessages)
+        pq->m_dropped += pq->m_messageQueue.clear();
+      ++pq->m_received;
+      size_t dropped = pq->m_messageQueue.push(std::move(value));
+      if (dropped) {
+        pq->m_dropped += dropped;
+        debugMsg("MessageQueueMap:addMessage",
+                 " queue \"" << message << "\" full, dropped a message");
+      }
+      if (pq->m_messageQueue.size() > pq->m_highWater)
+        pq->m_highWater = pq->m_messageQueue.size();
+      delivered = updateQueue(pq);
+    }
+    if (delivered)
+      m_execInterface.notifyOfExternalEvent();
+  }
+
+  /**
+   * @brief Resolves matches between messages and recipients. Should be called whenever updates occur to a queue.
+   */
+  bool MessageQueueMap::updateQueue(PairingQueue* queue)
+  {
+    debugMsg("MessageQueueMap:updateQueue", ' ' << queue->m_name << " entered");
+    RingQueue<Value> &mq = queue->m_messageQueue;
+    RingQueue<Command *> &rq = queue->m_recipientQueue;
+    bool valChanged = !mq.empty() && !rq.empty();
+    while (!mq.empty() && !rq.empty()) {
+      debugMsg("MessageQueueMap:updateQueue", ' ' << queue->m_name << " returning value");
+      m_execInterface.handleCommandReturn(rq.front(), mq.front());
+      rq.pop();
+      mq.pop();
+      ++queue->m_delivered;
+    }
+    if (valChanged)
+      debugMsg("MessageQueueMap:updateQueue", " Message \"" << queue->m_name << "\" paired and sent");
+    return valChanged;
+  }
+
+  bool parseMessageQueueBound(pugi::xml_node const xml,
+                              size_t &bound,
+                              QueueDropPolicy &policy)
+  {
+    pugi::xml_attribute const limitAttr = xml.attribute("MessageQueueLimit");
+    if (limitAttr)
+      bound = limitAttr.as_uint();
+    pugi::xml_attribute const policyAttr = xml.attribute("MessageQueueDropPolicy");
+    if (policyAttr) {
+      char const *policyName = policyAttr.value();
+      if (!strcmp(policyName, "Oldest"))
+        policy = QUEUE_DROP_OLDEST;
+      else if (!strcmp(policyName, "Newest"))
+        policy = QUEUE_DROP_NEWEST;
+      else {
+        warn("MessageQueueDropPolicy \"" << policyName
+             << "\" is invalid; must be \"Oldest\" or \"Newest\"");
+        return false;
+      }
+    }
+    return true;
+  }
+
+}
@@ -0,0 +1,261 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+ *  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Universities Space Research Association nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * MessageQueueMap.hh
+ *
+ *  Created on: Feb 19, 2010
+ *      Author: jhogins
+ */
+
+#ifndef MESSAGEQUEUEMAP_H_
+#define MESSAGEQUEUEMAP_H_
+
+#include "RingQueue.hh"
+#include "Value.hh"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Forward reference
+namespace pugi
+{
+  class xml_node;
+}
+
+namespace PLEXIL 
+{
+  // Forward references
+  class AdapterExecInterface;
+  class Command;
+
+  //! @struct MessageQueueStatistics
+  //! Counters for one message queue.
+  struct MessageQueueStatistics
+  {
+    std::string name;            //!< The message name.
+    uint64_t messagesReceived;   //!< Messages added.
+    uint64_t messagesDelivered;  //!< Messages paired with a recipient.
+    uint64_t messagesDropped;    //!< Messages discarded by the bound or duplicate policy.
+    uint64_t recipientsAdded;    //!< Recipients added.
+    size_t messagesPending;      //!< Messages waiting for a recipient.
+    size_t recipientsWaiting;    //!< Recipients waiting for a message.
+    size_t messagesHighWater;    //!< Longest the message queue has been.
+  };
+
+  //! @class MessageQueueMap
+  //! Pairs incoming messages with the commands waiting to receive
+  //! them, by message name.  Shared by the IPC and UDP adapters.
+  //! @details Queues are spread over hashed buckets, each with its
+  //!          own lock, so traffic on different message names rarely
+  //!          contends.  Each queue holds its messages and recipients
+  //!          in ring buffers; the message queue may be bounded, with
+  //!          a policy for which message to drop when it is full.
+  class MessageQueueMap
+  {
+  public:
+
+    //! Constructor.
+    //! @param execInterface The interface through which paired
+    //!                      messages are returned to the Exec.
+    //! @param allowDuplicateMessages See setAllowDuplicateMessages().
+    //! @param nBuckets The number of lock stripes.  Rounded up to a
+    //!                 power of 2.
+    MessageQueueMap(AdapterExecInterface& execInterface,
+                    bool allowDuplicateMessages = true,
+                    size_t nBuckets = 16);
+
+    virtual ~MessageQueueMap();
+
+    /**
+     * @brief Adds the given recipient to the queue to receive the given message.
+     * If a recipient already exists for this message, messages will be handed out in the order
+     * of the adding of the recipients.
+     * @param message The message the recipient is waiting for
+     * @param cmd Pointer to the command requesting the message.
+     */
+    void addRecipient(const std::string &message, Command *cmd);
+
+    /**
+     * @brief Adds the given message to its queue. If there is a recipient
+     * waiting for the message, it is sent immediately.
+     * @param message The message string to be added
+     */
+    void addMessage(const std::string &message);
+
+    /**
+     * @brief Adds the given message with the given parameters to its queue.
+     * If there is a recipient waiting for the message, it is sent immediately.
+     * @param message The message string to be added
+     * @param params The parameters that are to be sent with the message
+     */
+    void addMessage(const std::string& message, const Value& param);
+
+    /**
+     * @brief Sets the flag that determines whether or not incoming messages
+     * with duplicate strings are queued. If true, all incoming messages are
+     * put into the queue. Oldest instances of the message are distributed first.
+     * If false, new messages with duplicate strings replace older ones; this
+     * will remove all oldest duplicates from the queue immediately as well
+     * as set the behavior for future messages.
+     * @param flag If false, duplicates will be replaced with the newest
+     * message. If true, duplicates are queued.
+     */
+    void setAllowDuplicateMessages(bool flag);
+
+    /**
+     * @brief Returns whether or not incoming messages
+     * with duplicate strings are queued. If true, all incoming messages are
+     * put into the queue. Oldest instances of the message are distributed first.
+     * If false, new messages with duplicate strings replace older ones.
+     * @return The boolean flag.
+     */
+    bool getAllowDuplicateMessages();
+
+    //! Set the maximum length of each message queue, and what to
+    //! discard when a queue is full.  Applies to existing queues as
+    //! well as future ones.
+    //! @param bound The maximum length; 0 means unbounded.
+    //! @param policy The drop policy.
+    void setQueueBound(size_t bound, QueueDropPolicy policy);
+
+    //! Set the queue bound and drop policy from an adapter's
+    //! configuration XML.
+    //! @param xml The adapter configuration element.
+    //! @return True if the attributes were valid, false otherwise.
+    //! @see parseMessageQueueBound
+    bool configure(pugi::xml_node const xml);
+
+    //! Get the statistics for one message queue.
+    //! @param message The message name.
+    //! @param result Place to store the statistics.
+    //! @return True if the queue exists, false if not.
+    bool getStatistics(std::string const &message,
+                       MessageQueueStatistics &result) const;
+
+    //! Get the statistics for all message queues, in no particular order.
+    //! @param result Vector to which the statistics are appended.
+    void getAllStatistics(std::vector<MessageQueueStatistics> &result) const;
+
+  private:
+
+    // Not implemented
+    MessageQueueMap() = delete;
+    MessageQueueMap(MessageQueueMap const &) = delete;
+    MessageQueueMap(MessageQueueMap &&) = delete;
+    MessageQueueMap &operator=(MessageQueueMap const &) = delete;
+    MessageQueueMap &operator=(MessageQueueMap &&) = delete;
+
+    //* @brief Data queue structure associating a message string with a queue of recipients and a queue of messages. Only one queue should have items at a time. */
+    struct PairingQueue
+    {
+      std::string m_name;
+      RingQueue<Command *> m_recipientQueue;
+      RingQueue<Value> m_messageQueue;
+      uint64_t m_received;
+      uint64_t m_delivered;
+      uint64_t m_dropped;
+      uint64_t m_recipientsAdded;
+      size_t m_highWater;
+
+      PairingQueue(const std::string &name, size_t bound, QueueDropPolicy policy)
+        : m_name(name),
+          m_recipientQueue(),
+          m_messageQueue(bound, policy),
+          m_received(0),
+          m_delivered(0),
+          m_dropped(0),
+          m_recipientsAdded(0),
+          m_highWater(0)
+      {
+      }
+
+      void getStatistics(MessageQueueStatistics &result) const;
+    };
+
+    //* @brief One lock stripe. */
+    struct Bucket
+    {
+      std::mutex m_mutex;
+      std::unordered_map<std::string, std::unique_ptr<PairingQueue>> m_queues;
+    };
+
+    /**
+     * @brief Private function that returns the bucket holding the queue for the given message.
+     */
+    Bucket &getBucket(const std::string& message) const;
+
+    /**
+     * @brief Private function that returns the queue for the given message. Creates a new queue
+     * if one does not already exist.
+     * @note Caller must hold the bucket's lock.
+     */
+    PairingQueue* ensureQueue(Bucket &bucket, const std::string& message);
+
+    /**
+     * @brief Add a message to the queue and pair it with any waiting recipient.
+     */
+    void enqueueMessage(const std::string &message, Value &&value);
+
+    /**
+     * @brief Resolves matches between messages and recipients. Should be called whenever updates occur to a queue.
+     * @return True if any message was delivered.
+     * @note Caller must hold the bucket's lock.
+     */
+    bool updateQueue(PairingQueue* queue);
+
+    //* @brief The lock stripes.  Count is a power of 2.
+    std::vector<std::unique_ptr<Bucket>> m_buckets;
+
+    //* @brief The interface
+    AdapterExecInterface& m_execInterface;
+
+    //* @brief Maximum message queue length; 0 means unbounded.
+    size_t m_queueBound;
+
+    //* @brief What to discard when a message queue is full.
+    QueueDropPolicy m_dropPolicy;
+
+    //* @brief If true, all messages are put into the queue. If false, messages with duplicate strings replace older ones.
+    bool m_allowDuplicateMessages;
+  };
+
+  //! Parse the message queue bound and drop policy attributes of an
+  //! adapter's configuration XML.
+  //! @param xml The adapter configuration element.
+  //! @param bound Place to store the MessageQueueLimit attribute, if present.
+  //! @param policy Place to store the MessageQueueDropPolicy attribute
+  //!               ("Oldest" or "Newest"), if present.
+  //! @return True if the attributes were valid or absent, false otherwise.
+  bool parseMessageQueueBound(pugi::xml_node const xml,
+                              size_t &bound,
+                              QueueDropPolicy &policy);
+
+}
+
+#endif /* MESSAGEQUEUEMAP_H_ */
@@ -0,0 +1,1150 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "QueueJournal.hh"
+
+#include "ArrayImpl.hh"
+#include "CommandImpl.hh"
+#include "Debug.hh"
+#include "Error.hh"
+#include "InterfaceManager.hh"
+#include "LookupReceiver.hh"
+#include "Message.hh"
+#include "NodeImpl.hh"
+#include "ParserException.hh"
+#include "PlexilExec.hh"
+#include "QueueEntry.hh"
+#include "State.hh"
+#include "StateCache.hh"
+#include "Update.hh"
+
+#include "pugixml.hpp"
+
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include <cstdint>
+#include <cstring> // memcpy(), memcmp()
+
+namespace PLEXIL
+{
+
+  //
+  // Journal format
+  //
+  // The file begins with an 8 byte magic number and a 4 byte format
+  // version.  It is followed by records, each consisting of a 1 byte
+  // record type, a 4 byte payload length, and the payload.  Integers
+  // and reals are written in host byte order; values and states use
+  // their own serial formats.
+  //
+
+  static char const JOURNAL_MAGIC[8] = {'P', 'X', 'Q', 'J', 'R', 'N', 'L', '\0'};
+  static uint32_t const JOURNAL_VERSION = 2;
+  static size_t const JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + sizeof(uint32_t);
+  static size_t const RECORD_HEADER_SIZE = 1 + sizeof(uint32_t);
+
+  // Flush to the file when this much data is buffered
+  static size_t const JOURNAL_FLUSH_SIZE = 65536;
+
+  // Preserve whitespace-only string constants in recorded plans
+  static unsigned int const PUGI_PARSE_OPTIONS =
+    pugi::parse_default | pugi::parse_ws_pcdata_single;
+
+  // ID written for a command, update, or plan the recorder never saw
+  static uint32_t const UNKNOWN_ID = ~((uint32_t) 0);
+
+  enum JournalRecordType : uint8_t
+    {
+     J_UNINITED = 0,
+
+     // Events outside the input queue
+     J_PLAN,               //!< Plan received: ID, XML
+     J_LIBRARY,            //!< Library received: XML
+     J_QUEUE_START,        //!< Start of queue processing
+     J_QUEUE_END,          //!< End of queue processing
+     J_STEP,               //!< Macro step: time
+     J_STEP_LIMIT,         //!< Preceding macro step exhausted its time slice: micro steps
+     J_LOOKUP_NOW,         //!< Synchronous lookup: state, status, value
+     J_COMMAND,            //!< Command dispatched: ID, name
+     J_COMMAND_DENIED,     //!< Command denied by arbiter: ID, name
+     J_UPDATE,             //!< Update dispatched: ID, node ID
+
+     // Input queue entries
+     J_LOOKUP,             //!< State, value
+     J_COMMAND_ACK,        //!< Command ID, value
+     J_COMMAND_RETURN,     //!< Command ID, value
+     J_COMMAND_ABORT,      //!< Command ID, value
+     J_UPDATE_ACK,         //!< Update ID, value
+     J_ADD_PLAN,           //!< Plan ID
+     J_RECEIVE_MSG,        //!< Message state, sender, timestamp
+     J_ACCEPT_MSG,         //!< Message state, sender, timestamp, handle
+     J_RELEASE_MSG_HANDLE, //!< Handle
+     J_MSG_QUEUE_EMPTY,
+
+     J_INVALID
+    };
+
+  // Lookup response status in J_LOOKUP_NOW records
+  enum LookupStatus : uint8_t
+    {
+     LOOKUP_NO_RESPONSE = 0,
+     LOOKUP_UNKNOWN,
+     LOOKUP_VALUE
+    };
+
+  //
+  // Recording
+  //
+
+  //! Captures the response to a lookupNow() request, so that it can
+  //! be journaled before being passed on.
+  class CapturingReceiver final : public LookupReceiver
+  {
+  public:
+    CapturingReceiver()
+      : m_value(),
+        m_status(LOOKUP_NO_RESPONSE)
+    {
+    }
+
+    virtual ~CapturingReceiver() = default;
+
+    virtual void update(Value const &val) override
+    {
+      m_value = val;
+      m_status = val.isKnown() ? LOOKUP_VALUE : LOOKUP_UNKNOWN;
+    }
+
+    virtual void setUnknown() override
+    {
+      m_value.setUnknown();
+      m_status = LOOKUP_UNKNOWN;
+    }
+
+    virtual void update(Boolean val) override
+    {
+      update(Value(val));
+    }
+
+    virtual void update(Integer val) override
+    {
+      update(Value(val));
+    }
+
+    virtual void update(Real val) override
+    {
+      update(Value(val));
+    }
+
+    virtual void update(String const &val) override
+    {
+      update(Value(val));
+    }
+
+    virtual void update(char const *val) override
+    {
+      update(Value(val));
+    }
+
+    virtual void update(Boolean const ary[], size_t size) override
+    {
+      update(Value(BooleanArray(std::vector<Boolean>(ary, ary + size))));
+    }
+
+    virtual void update(Integer const ary[], size_t size) override
+    {
+      update(Value(IntegerArray(std::vector<Integer>(ary, ary + size))));
+    }
+
+    virtual void update(Real const ary[], size_t size) override
+    {
+      update(Value(RealArray(std::vector<Real>(ary, ary + size))));
+    }
+
+    virtual void update(String const ary[], size_t size) override
+    {
+      update(Value(StringArray(std::vector<String>(ary, ary + size))));
+    }
+
+    //! Pass the captured response on to its intended receiver.
+    void forward(LookupReceiver *receiver) const
+    {
+      if (m_status == LOOKUP_VALUE)
+        receiver->update(m_value);
+      else if (m_status == LOOKUP_UNKNOWN)
+        receiver->setUnknown();
+    }
+
+    Value const &value() const
+    {
+      return m_value;
+    }
+
+    LookupStatus status() const
+    {
+      return m_status;
+    }
+
+  private:
+    Value m_value;
+    LookupStatus m_status;
+  };
+
+  class QueueRecorderImpl final : public QueueRecorder
+  {
+  public:
+    QueueRecorderImpl(Dispatcher *target)
+      : QueueRecorder(),
+        m_commandIds(),
+        m_updateIds(),
+        m_planIds(),
+        m_buffer(),
+        m_out(),
+#ifdef PLEXIL_WITH_THREADS
+        m_mutex(),
+#endif
+        m_target(target),
+        m_recordStart(0),
+        m_nextCommandId(0),
+        m_nextUpdateId(0),
+        m_nextPlanId(0)
+    {
+      m_buffer.reserve(JOURNAL_FLUSH_SIZE * 2);
+    }
+
+    virtual ~QueueRecorderImpl()
+    {
+      flush();
+    }
+
+    bool open(std::string const &filename)
+    {
+      m_out.open(filename, std::ios::binary | std::ios::trunc);
+      if (!m_out) {
+        warn("QueueRecorder: unable to open " << filename);
+        return false;
+      }
+      m_out.write(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+      m_out.write(reinterpret_cast<char const *>(&JOURNAL_VERSION), sizeof(JOURNAL_VERSION));
+      debugMsg("QueueRecorder:open", " recording to " << filename);
+      return (bool) m_out;
+    }
+
+    //
+    // QueueRecorder API
+    //
+
+    virtual void recordPlan(NodeImpl const *root, pugi::xml_node const planXml) override
+    {
+      std::ostringstream xml;
+      planXml.print(xml, "", pugi::format_raw);
+      Guard guard(m_mutex);
+      uint32_t id = m_nextPlanId++;
+      m_planIds[root] = id;
+      beginRecord(J_PLAN);
+      putUint32(id);
+      putString(xml.str());
+      endRecord();
+    }
+
+    virtual void recordLibrary(pugi::xml_node const libXml) override
+    {
+      std::ostringstream xml;
+      libXml.print(xml, "", pugi::format_raw);
+      Guard guard(m_mutex);
+      beginRecord(J_LIBRARY);
+      putString(xml.str());
+      endRecord();
+    }
+
+    virtual void recordQueueStart() override
+    {
+      Guard guard(m_mutex);
+      beginRecord(J_QUEUE_START);
+      endRecord();
+    }
+
+    virtual void recordQueueEntry(QueueEntry const &entry) override
+    {
+      Guard guard(m_mutex);
+      switch (entry.type) {
+      case Q_LOOKUP:
+        beginRecord(J_LOOKUP);
+        putState(*entry.state);
+        putValue(entry.value);
+        break;
+
+      case Q_COMMAND_ACK:
+        beginRecord(J_COMMAND_ACK);
+        putUint32(commandId(entry.command));
+        putValue(entry.value);
+        break;
+
+      case Q_COMMAND_RETURN:
+        beginRecord(J_COMMAND_RETURN);
+        putUint32(commandId(entry.command));
+        putValue(entry.value);
+        break;
+
+      case Q_COMMAND_ABORT:
+        // The abort acknowledgement is a command's last response
+        beginRecord(J_COMMAND_ABORT);
+        putUint32(commandId(entry.command));
+        putValue(entry.value);
+        m_commandIds.erase(entry.command);
+        break;
+
+      case Q_UPDATE_ACK: {
+        // An update receives exactly one acknowledgement
+        std::unordered_map<Update const *, uint32_t>::iterator it =
+          m_updateIds.find(entry.update);
+        beginRecord(J_UPDATE_ACK);
+        if (it == m_updateIds.end())
+          putUint32(UNKNOWN_ID);
+        else {
+          putUint32(it->second);
+          m_updateIds.erase(it);
+        }
+        putValue(entry.value);
+        break;
+      }
+
+      case Q_ADD_PLAN: {
+        std::unordered_map<NodeImpl const *, uint32_t>::iterator it =
+          m_planIds.find(entry.plan);
+        if (it == m_planIds.end()) {
+          warn("QueueRecorder: plan " << entry.plan->getNodeId()
+               << " was received before recording started, not recorded");
+          return;
+        }
+        beginRecord(J_ADD_PLAN);
+        putUint32(it->second);
+        m_planIds.erase(it);
+        break;
+      }
+
+      case Q_RECEIVE_MSG:
+        beginRecord(J_RECEIVE_MSG);
+        putMessage(*entry.message);
+        break;
+
+      case Q_ACCEPT_MSG:
+        beginRecord(J_ACCEPT_MSG);
+        putMessage(*entry.message);
+        putValue(entry.value);
+        break;
+
+      case Q_RELEASE_MSG_HANDLE:
+        beginRecord(J_RELEASE_MSG_HANDLE);
+        putValue(entry.value);
+        break;
+
+      case Q_MSG_QUEUE_EMPTY:
+        beginRecord(J_MSG_QUEUE_EMPTY);
+        break;
+
+      default:
+        // Queue marks are only meaningful to the live application
+        return;
+      }
+      endRecord();
+    }
+
+    virtual void recordQueueEnd() override
+    {
+      Guard guard(m_mutex);
+      beginRecord(J_QUEUE_END);
+      endRecord();
+    }
+
+    virtual void recordStep(double time) override
+    {
+      Guard guard(m_mutex);
+      beginRecord(J_STEP);
+      putDouble(time);
+      endRecord();
+    }
+
+    virtual void recordStepLimit(unsigned int microSteps) override
+    {
+      Guard guard(m_mutex);
+      beginRecord(J_STEP_LIMIT);
+      putUint32(microSteps);
+      endRecord();
+    }
+
+    virtual void stepComplete() override
+    {
+      Guard guard(m_mutex);
+      // Must run before deleteFinishedPlans() frees the commands
+      std::unordered_map<Command const *, uint32_t>::iterator it =
+        m_commandIds.begin();
+      while (it != m_commandIds.end()) {
+        CommandImpl const *cmd = dynamic_cast<CommandImpl const *>(it->first);
+        if (cmd && cmd->isActive())
+          ++it;
+        else
+          it = m_commandIds.erase(it);
+      }
+    }
+
+    virtual size_t pendingIdCount() const override
+    {
+      Guard guard(m_mutex);
+      return m_commandIds.size() + m_updateIds.size();
+    }
+
+    virtual void flush() override
+    {
+      Guard guard(m_mutex);
+      writeBuffer();
+      m_out.flush();
+    }
+
+    //
+    // Dispatcher API
+    //
+
+    virtual void lookupNow(State const &state, LookupReceiver *receiver) override
+    {
+      CapturingReceiver capture;
+      m_target->lookupNow(state, &capture);
+      {
+        Guard guard(m_mutex);
+        beginRecord(J_LOOKUP_NOW);
+        putState(state);
+        putUint8(capture.status());
+        if (capture.status() == LOOKUP_VALUE)
+          putValue(capture.value());
+        endRecord();
+      }
+      capture.forward(receiver);
+    }
+
+    virtual void setThresholds(const State& state, Real hi, Real lo) override
+    {
+      m_target->setThresholds(state, hi, lo);
+    }
+
+    virtual void setThresholds(const State& state, Integer hi, Integer lo) override
+    {
+      m_target->setThresholds(state, hi, lo);
+    }
+
+    virtual void clearThresholds(const State& state) override
+    {
+      m_target->clearThresholds(state);
+    }
+
+    virtual void executeCommand(Command *cmd) override
+    {
+      recordCommand(J_COMMAND, cmd);
+      m_target->executeCommand(cmd);
+    }
+
+    virtual void reportCommandArbitrationFailure(Command *cmd) override
+    {
+      recordCommand(J_COMMAND_DENIED, cmd);
+      m_target->reportCommandArbitrationFailure(cmd);
+    }
+
+    virtual void invokeAbort(Command *cmd) override
+    {
+      m_target->invokeAbort(cmd);
+    }
+
+    virtual void executeUpdate(Update *upd) override
+    {
+      {
+        Guard guard(m_mutex);
+        uint32_t id = m_nextUpdateId++;
+        m_updateIds[upd] = id;
+        beginRecord(J_UPDATE);
+        putUint32(id);
+        putString(upd->getNodeId());
+        endRecord();
+      }
+      m_target->executeUpdate(upd);
+    }
+
+  private:
+
+    // Not implemented
+    QueueRecorderImpl() = delete;
+    QueueRecorderImpl(QueueRecorderImpl const &) = delete;
+    QueueRecorderImpl(QueueRecorderImpl &&) = delete;
+    QueueRecorderImpl &operator=(QueueRecorderImpl const &) = delete;
+    QueueRecorderImpl &operator=(QueueRecorderImpl &&) = delete;
+
+#ifdef PLEXIL_WITH_THREADS
+    using Guard = std::lock_guard<std::mutex>;
+#else
+    struct Guard
+    {
+      Guard(int) {}
+    };
+#endif
+
+    void recordCommand(JournalRecordType type, Command *cmd)
+    {
+      Guard guard(m_mutex);
+      uint32_t id = m_nextCommandId++;
+      // A denied command gets no responses through the queue
+      if (type == J_COMMAND_DENIED)
+        m_commandIds.erase(cmd);
+      else
+        m_commandIds[cmd] = id;
+      beginRecord(type);
+      putUint32(id);
+      putString(cmd->getName());
+      endRecord();
+    }
+
+    uint32_t commandId(Command const *cmd) const
+    {
+      std::unordered_map<Command const *, uint32_t>::const_iterator it =
+        m_commandIds.find(cmd);
+      return it == m_commandIds.end() ? UNKNOWN_ID : it->second;
+    }
+
+    //
+    // Record construction
+    // Caller must hold m_mutex
+    //
+
+    void beginRecord(JournalRecordType type)
+    {
+      m_recordStart = m_buffer.size();
+      m_buffer.resize(m_recordStart + RECORD_HEADER_SIZE);
+      m_buffer[m_recordStart] = (char) type;
+    }
+
+    void endRecord()
+    {
+      uint32_t len = (uint32_t) (m_buffer.size() - m_recordStart - RECORD_HEADER_SIZE);
+      memcpy(&m_buffer[m_recordStart + 1], &len, sizeof(len));
+      if (m_buffer.size() >= JOURNAL_FLUSH_SIZE)
+        writeBuffer();
+    }
+
+    void writeBuffer()
+    {
+      if (m_buffer.empty())
+        return;
+      m_out.write(m_buffer.data(), m_buffer.size());
+      m_buffer.clear();
+    }
+
+    void putBytes(void const *bytes, size_t n)
+    {
+      char const *b = static_cast<char const *>(bytes);
+      m_buffer.insert(m_buffer.end(), b, b + n);
+    }
+
+    void putUint8(uint8_t n)
+    {
+      m_buffer.push_back((char) n);
+    }
+
+    void putUint32(uint32_t n)
+    {
+      putBytes(&n, sizeof(n));
+    }
+
+    void putDouble(double d)
+    {
+      putBytes(&d, sizeof(d));
+    }
+
+    void putString(std::string const &s)
+    {
+      putUint32((uint32_t) s.size());
+      putBytes(s.data(), s.size());
+    }
+
+    void putValue(Value const &v)
+    {
+      size_t start = m_buffer.size();
+      m_buffer.resize(start + v.serialSize());
+      char *end = v.serialize(&m_buffer[start]);
+      if (!end) {
+        // Too large to serialize; record as unknown
+        m_buffer.resize(start + Value().serialSize());
+        Value().serialize(&m_buffer[start]);
+      }
+    }
+
+    void putState(State const &s)
+    {
+      size_t start = m_buffer.size();
+      m_buffer.resize(start + s.serialSize());
+      s.serialize(&m_buffer[start]);
+    }
+
+    void putMessage(Message const &msg)
+    {
+      putState(msg.message);
+      putString(msg.sender);
+      putDouble(msg.timestamp);
+    }
+
+    std::unordered_map<Command const *, uint32_t> m_commandIds;
+    std::unordered_map<Update const *, uint32_t> m_updateIds;
+    std::unordered_map<NodeImpl const *, uint32_t> m_planIds;
+    std::vector<char> m_buffer;
+    std::ofstream m_out;
+#ifdef PLEXIL_WITH_THREADS
+    mutable std::mutex m_mutex;
+#else
+    int m_mutex = 0;
+#endif
+    Dispatcher *m_target;
+    size_t m_recordStart;
+    uint32_t m_nextCommandId;
+    uint32_t m_nextUpdateId;
+    uint32_t m_nextPlanId;
+  };
+
+  QueueRecorder *makeQueueRecorder(std::string const &filename,
+                                   Dispatcher *target)
+  {
+    std::unique_ptr<QueueRecorderImpl> result(new QueueRecorderImpl(target));
+    if (!result->open(filename))
+      return nullptr;
+    return result.release();
+  }
+
+  //
+  // Replay
+  //
+
+  //! Reads the journal, feeding queue entries to the InterfaceManager
+  //! and stepping the Exec.  Stands in for the Dispatcher while doing so.
+  class QueueReplayer final : public Dispatcher
+  {
+  public:
+    QueueReplayer(InterfaceManager &manager, PlexilExec &exec)
+      : Dispatcher(),
+        m_data(),
+        m_plans(),
+        m_messages(),
+        m_commands(),
+        m_updates(),
+        m_manager(manager),
+        m_exec(exec),
+        m_ptr(nullptr),
+        m_end(nullptr),
+        m_recordEnd(nullptr),
+        m_ok(true)
+    {
+    }
+
+    virtual ~QueueReplayer() = default;
+
+    bool load(std::string const &filename)
+    {
+      std::ifstream in(filename, std::ios::binary);
+      if (!in) {
+        warn("replayQueueJournal: unable to open " << filename);
+        return false;
+      }
+      m_data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      uint32_t version = 0;
+      if (m_data.size() >= JOURNAL_HEADER_SIZE)
+        memcpy(&version, m_data.data() + sizeof(JOURNAL_MAGIC), sizeof(version));
+      if (m_data.size() < JOURNAL_HEADER_SIZE
+          || memcmp(m_data.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC))
+          || version != JOURNAL_VERSION) {
+        warn("replayQueueJournal: " << filename << " is not a compatible journal");
+        return false;
+      }
+      m_ptr = m_data.data() + JOURNAL_HEADER_SIZE;
+      m_end = m_data.data() + m_data.size();
+      return true;
+    }
+
+    bool run()
+    {
+      Dispatcher *savedDispatcher = g_dispatcher;
+      g_dispatcher = this;
+      m_exec.setDispatcher(this);
+
+      try {
+        JournalRecordType type;
+        while (m_ok && (type = nextRecord()) != J_UNINITED)
+          replayRecord(type);
+      }
+      catch (ParserException const &e) {
+        warn("replayQueueJournal: error parsing recorded plan:\n" << e.what());
+        m_ok = false;
+      }
+
+      m_exec.deleteFinishedPlans();
+      m_exec.setDispatcher(savedDispatcher);
+      g_dispatcher = savedDispatcher;
+      return m_ok;
+    }
+
+    //
+    // Dispatcher API
+    //
+
+    virtual void lookupNow(State const &state, LookupReceiver *receiver) override
+    {
+      if (!expectRecord(J_LOOKUP_NOW)) {
+        receiver->setUnknown();
+        return;
+      }
+      State recorded;
+      getState(recorded);
+      if (recorded != state) {
+        outOfSync("lookup of " + state.toString());
+        receiver->setUnknown();
+        return;
+      }
+      switch (getUint8()) {
+      case LOOKUP_VALUE:
+        receiver->update(getValue());
+        break;
+
+      case LOOKUP_UNKNOWN:
+        receiver->setUnknown();
+        break;
+
+      default:
+        break;
+      }
+    }
+
+    virtual void setThresholds(const State& /* state */, Real /* hi */, Real /* lo */) override
+    {
+    }
+
+    virtual void setThresholds(const State& /* state */, Integer /* hi */, Integer /* lo */) override
+    {
+    }
+
+    virtual void clearThresholds(const State& /* state */) override
+    {
+    }
+
+    virtual void executeCommand(Command *cmd) override
+    {
+      mapCommand(J_COMMAND, cmd);
+    }
+
+    virtual void reportCommandArbitrationFailure(Command *cmd) override
+    {
+      if (mapCommand(J_COMMAND_DENIED, cmd))
+        commandHandleReturn(cmd, COMMAND_DENIED);
+    }
+
+    virtual void invokeAbort(Command * /* cmd */) override
+    {
+      // Acknowledgement will arrive through the queue
+    }
+
+    virtual void executeUpdate(Update *upd) override
+    {
+      if (!expectRecord(J_UPDATE))
+        return;
+      uint32_t id = getUint32();
+      if (m_updates.size() <= id)
+        m_updates.resize(id + 1, nullptr);
+      m_updates[id] = upd;
+    }
+
+  private:
+
+    // Not implemented
+    QueueReplayer() = delete;
+    QueueReplayer(QueueReplayer const &) = delete;
+    QueueReplayer(QueueReplayer &&) = delete;
+    QueueReplayer &operator=(QueueReplayer const &) = delete;
+    QueueReplayer &operator=(QueueReplayer &&) = delete;
+
+    void replayRecord(JournalRecordType type)
+    {
+      switch (type) {
+      case J_PLAN: {
+        uint32_t id = getUint32();
+        std::string xml = getString();
+        std::unique_ptr<pugi::xml_document> doc(new pugi::xml_document());
+        if (doc->load_buffer(xml.data(), xml.size(), PUGI_PARSE_OPTIONS).status != pugi::status_ok) {
+          warn("replayQueueJournal: unable to parse recorded plan " << id);
+          m_ok = false;
+          return;
+        }
+        m_plans[id] = std::move(doc);
+        return;
+      }
+
+      case J_LIBRARY: {
+        std::string xml = getString();
+        pugi::xml_document *doc = new pugi::xml_document();
+        if (doc->load_buffer(xml.data(), xml.size(), PUGI_PARSE_OPTIONS).status != pugi::status_ok) {
+          warn("replayQueueJournal: unable to parse recorded library");
+          delete doc;
+          m_ok = false;
+          return;
+        }
+        m_manager.handleAddLibrary(doc); // takes ownership
+        return;
+      }
+
+      case J_QUEUE_START:
+        // The application cleans up finished plans before processing the queue
+        m_exec.deleteFinishedPlans();
+        return;
+
+      case J_QUEUE_END:
+        debugMsg("QueueReplayer", " processing queue");
+        m_manager.processQueue();
+        return;
+
+      case J_STEP: {
+        double time = getDouble();
+        uint32_t limit = stepLimit();
+        debugMsg("QueueReplayer", " stepping exec at " << std::setprecision(15) << time);
+        condDebugMsg(limit, "QueueReplayer", " step limited to " << limit << " micro steps");
+        // Exhaust the slice where the recorded step exhausted it
+        m_exec.setTimeSlice(limit, 0);
+        m_exec.startTimeSlice();
+        m_exec.step(time);
+        return;
+      }
+
+      case J_STEP_LIMIT:
+        // Already applied by the preceding J_STEP
+        return;
+
+      case J_LOOKUP_NOW: {
+        // Outside of a macro step; only the time lookup is expected here
+        State state;
+        getState(state);
+        if (getUint8() == LOOKUP_VALUE)
+          StateCache::instance().lookupReturn(state, getValue());
+        return;
+      }
+
+      case J_LOOKUP: {
+        State state;
+        getState(state);
+        m_manager.handleValueChange(std::move(state), getValue());
+        return;
+      }
+
+      case J_COMMAND_ACK: {
+        Command *cmd = command(getUint32());
+        CommandHandleValue handle = NO_COMMAND_HANDLE;
+        if (cmd && getValue().getValue(handle))
+          m_manager.handleCommandAck(cmd, handle);
+        return;
+      }
+
+      case J_COMMAND_RETURN: {
+        Command *cmd = command(getUint32());
+        if (cmd)
+          m_manager.handleCommandReturn(cmd, getValue());
+        return;
+      }
+
+      case J_COMMAND_ABORT: {
+        Command *cmd = command(getUint32());
+        bool ack = false;
+        if (cmd && getValue().getValue(ack))
+          m_manager.handleCommandAbortAck(cmd, ack);
+        return;
+      }
+
+      case J_UPDATE_ACK: {
+        uint32_t id = getUint32();
+        bool ack = false;
+        if (id < m_updates.size() && m_updates[id] && getValue().getValue(ack))
+          m_manager.handleUpdateAck(m_updates[id], ack);
+        else
+          warn("replayQueueJournal: acknowledgement for unknown update " << id);
+        return;
+      }
+
+      case J_ADD_PLAN: {
+        uint32_t id = getUint32();
+        std::unordered_map<uint32_t, std::unique_ptr<pugi::xml_document>>::const_iterator it =
+          m_plans.find(id);
+        if (it == m_plans.end()) {
+          warn("replayQueueJournal: plan " << id << " not found in journal");
+          m_ok = false;
+          return;
+        }
+        m_manager.handleAddPlan(it->second->document_element());
+        return;
+      }
+
+      case J_RECEIVE_MSG: {
+        // Received messages remain owned by the sender
+        m_messages.emplace_back(getMessage());
+        m_manager.notifyMessageReceived(m_messages.back().get());
+        return;
+      }
+
+      case J_ACCEPT_MSG: {
+        // Accepted messages are owned by the StateCache
+        Message *msg = getMessage();
+        std::string handle;
+        getValue().getValue(handle);
+        m_manager.notifyMessageAccepted(msg, handle);
+        return;
+      }
+
+      case J_RELEASE_MSG_HANDLE: {
+        std::string handle;
+        getValue().getValue(handle);
+        m_manager.notifyMessageHandleReleased(handle);
+        return;
+      }
+
+      case J_MSG_QUEUE_EMPTY:
+        m_manager.notifyMessageQueueEmpty();
+        return;
+
+      default:
+        outOfSync("record type " + std::to_string((int) type));
+        return;
+      }
+    }
+
+    bool mapCommand(JournalRecordType type, Command *cmd)
+    {
+      if (!expectRecord(type))
+        return false;
+      uint32_t id = getUint32();
+      if (getString() != cmd->getName()) {
+        outOfSync("command " + cmd->getName());
+        return false;
+      }
+      if (m_commands.size() <= id)
+        m_commands.resize(id + 1, nullptr);
+      m_commands[id] = cmd;
+      return true;
+    }
+
+    Command *command(uint32_t id)
+    {
+      if (id < m_commands.size() && m_commands[id])
+        return m_commands[id];
+      // Responses to inactive commands are recorded without an ID
+      if (id == UNKNOWN_ID) {
+        debugMsg("QueueReplayer", " ignoring response to inactive command");
+      }
+      else
+        warn("replayQueueJournal: response for unknown command " << id);
+      return nullptr;
+    }
+
+    void outOfSync(std::string const &what)
+    {
+      if (m_ok)
+        warn("replayQueueJournal: journal out of sync with Exec at " << what
+             << ", offset " << (m_ptr - m_data.data()));
+      m_ok = false;
+    }
+
+    //
+    // Reading
+    //
+
+    //! Advance to the next record.
+    //! @return The record type; J_UNINITED at end of journal or on error.
+    JournalRecordType nextRecord()
+    {
+      if (m_recordEnd)
+        m_ptr = m_recordEnd;
+      if (m_ptr + RECORD_HEADER_SIZE > m_end)
+        return J_UNINITED;
+      JournalRecordType type = (JournalRecordType) *m_ptr;
+      uint32_t len;
+      memcpy(&len, m_ptr + 1, sizeof(len));
+      m_ptr += RECORD_HEADER_SIZE;
+      if ((size_t) (m_end - m_ptr) < len) {
+        warn("replayQueueJournal: journal truncated");
+        m_ok = false;
+        return J_UNINITED;
+      }
+      m_recordEnd = m_ptr + len;
+      return type;
+    }
+
+    //! Find the J_STEP_LIMIT record, if any, belonging to the macro
+    //! step whose record was just read.  It follows any records made
+    //! during the step, and precedes the next step.
+    //! @return The number of micro steps the step performed before
+    //!         its time slice was exhausted; 0 if it was not.
+    uint32_t stepLimit() const
+    {
+      char const *ptr = m_recordEnd;
+      while (ptr + RECORD_HEADER_SIZE <= m_end) {
+        JournalRecordType type = (JournalRecordType) *ptr;
+        uint32_t len;
+        memcpy(&len, ptr + 1, sizeof(len));
+        if (type == J_STEP || (size_t) (m_end - ptr) - RECORD_HEADER_SIZE < len)
+          break;
+        if (type == J_STEP_LIMIT && len >= sizeof(uint32_t)) {
+          uint32_t result;
+          memcpy(&result, ptr + RECORD_HEADER_SIZE, sizeof(result));
+          return result;
+        }
+        ptr += RECORD_HEADER_SIZE + len;
+      }
+      return 0;
+    }
+
+    //! Advance to the next record, which must be of the given type.
+    bool expectRecord(JournalRecordType expected)
+    {
+      if (!m_ok)
+        return false;
+      char const *savedPtr = m_ptr;
+      char const *savedEnd = m_recordEnd;
+      JournalRecordType type = nextRecord();
+      if (type != expected) {
+        m_ptr = savedPtr;
+        m_recordEnd = savedEnd;
+        outOfSync("record type " + std::to_string((int) expected));
+        return false;
+      }
+      return true;
+    }
+
+    void getBytes(void *dest, size_t n)
+    {
+      if (m_ptr + n > m_recordEnd) {
+        outOfSync("truncated record");
+        memset(dest, 0, n);
+        return;
+      }
+      memcpy(dest, m_ptr, n);
+      m_ptr += n;
+    }
+
+    uint8_t getUint8()
+    {
+      uint8_t result;
+      getBytes(&result, sizeof(result));
+      return result;
+    }
+
+    uint32_t getUint32()
+    {
+      uint32_t result;
+      getBytes(&result, sizeof(result));
+      return result;
+    }
+
+    double getDouble()
+    {
+      double result;
+      getBytes(&result, sizeof(result));
+      return result;
+    }
+
+    std::string getString()
+    {
+      uint32_t len = getUint32();
+      if (m_ptr + len > m_recordEnd) {
+        outOfSync("truncated string");
+        return std::string();
+      }
+      std::string result(m_ptr, len);
+      m_ptr += len;
+      return result;
+    }
+
+    Value getValue()
+    {
+      Value result;
+      char const *next = result.deserialize(m_ptr);
+      if (!next || next > m_recordEnd)
+        outOfSync("invalid value");
+      else
+        m_ptr = next;
+      return result;
+    }
+
+    void getState(State &result)
+    {
+      char const *next = result.deserialize(m_ptr);
+      if (!next || next > m_recordEnd)
+        outOfSync("invalid state");
+      else
+        m_ptr = next;
+    }
+
+    Message *getMessage()
+    {
+      State state;
+      getState(state);
+      std::string sender = getString();
+      double timestamp = getDouble();
+      return new Message(state, sender, timestamp);
+    }
+
+    std::vector<char> m_data;
+    std::unordered_map<uint32_t, std::unique_ptr<pugi::xml_document>> m_plans;
+    std::vector<std::unique_ptr<Message>> m_messages;
+    std::vector<Command *> m_commands;
+    std::vector<Update *> m_updates;
+    InterfaceManager &m_manager;
+    PlexilExec &m_exec;
+    char const *m_ptr;       // read position
+    char const *m_end;       // end of journal
+    char const *m_recordEnd; // end of current record
+    bool m_ok;
+  };
+
+  bool replayQueueJournal(std::string const &filename,
+                          InterfaceManager &manager,
+                          PlexilExec &exec)
+  {
+    QueueReplayer replayer(manager, exec);
+    if (!replayer.load(filename))
+      return false;
+    debugMsg("QueueReplayer", " replaying " << filename);
+    bool result = replayer.run();
+    debugMsg("QueueReplayer", " replay of " << filename
+             << (result ? " complete" : " failed"));
+    return result;
+  }
+
+} // namespace PLEXIL
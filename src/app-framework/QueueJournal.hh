@@ -0,0 +1,130 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_QUEUE_JOURNAL_HH
+#define PLEXIL_QUEUE_JOURNAL_HH
+
+#include "Dispatcher.hh"
+
+#include <string>
+
+// Forward reference
+namespace pugi
+{
+  class xml_node;
+}
+
+namespace PLEXIL
+{
+  // Forward references
+  class InterfaceManager;
+  class NodeImpl;
+  class PlexilExec;
+  struct QueueEntry;
+
+  //! @class QueueRecorder
+  //! Journals everything which drives the Exec to a compact binary
+  //! log, for later replay by replayQueueJournal().
+  //! @details The journal records, in the order the Exec sees them:
+  //!          plans and libraries as received; each batch of input
+  //!          queue entries processed; each macro step and the time
+  //!          at which it ran; and the results of synchronous
+  //!          lookups and the order of commands and updates issued,
+  //!          which the recorder observes by standing in for the
+  //!          Dispatcher.
+  //! @note Command handlers which return status by calling
+  //!       commandHandleReturn() et al. directly, rather than
+  //!       through the AdapterExecInterface, are not captured.
+  class QueueRecorder : public Dispatcher
+  {
+  public:
+    virtual ~QueueRecorder() = default;
+
+    //! Record a plan as it is received.
+    //! @param root The root node parsed from the plan.
+    //! @param planXml The plan's XML.
+    //! @note May be called from any thread.
+    virtual void recordPlan(NodeImpl const *root, pugi::xml_node const planXml) = 0;
+
+    //! Record a library node as it is received.
+    //! @param libXml The library document's XML.
+    //! @note May be called from any thread.
+    virtual void recordLibrary(pugi::xml_node const libXml) = 0;
+
+    //! Record the start of input queue processing.
+    virtual void recordQueueStart() = 0;
+
+    //! Record one input queue entry as it is processed.
+    virtual void recordQueueEntry(QueueEntry const &entry) = 0;
+
+    //! Record the end of input queue processing.
+    virtual void recordQueueEnd() = 0;
+
+    //! Record the start of a macro step.
+    //! @param time The time passed to PlexilExec::step().
+    virtual void recordStep(double time) = 0;
+
+    //! Record that the preceding macro step exhausted its time slice.
+    //! @param microSteps The number of micro steps the step performed
+    //!                   before the slice was exhausted.
+    virtual void recordStepLimit(unsigned int microSteps) = 0;
+
+    //! Note the end of a macro step.  Forgets the IDs of commands the
+    //! step deactivated; the Exec ignores any later response to them.
+    virtual void stepComplete() = 0;
+
+    //! @return The number of commands and updates whose IDs are held
+    //!         for responses not yet recorded.
+    virtual size_t pendingIdCount() const = 0;
+
+    //! Flush buffered records to the journal file.
+    virtual void flush() = 0;
+  };
+
+  //! Construct a QueueRecorder writing to the named file.
+  //! @param filename Name of the journal file.  An existing file is overwritten.
+  //! @param target The Dispatcher to which requests are forwarded.
+  //! @return Pointer to the new recorder; nullptr if the file could not be opened.
+  QueueRecorder *makeQueueRecorder(std::string const &filename,
+                                   Dispatcher *target);
+
+  //! Replay a journal written by a QueueRecorder, as fast as possible.
+  //! @param filename Name of the journal file.
+  //! @param manager The InterfaceManager whose queue is to be fed.
+  //! @param exec The Exec to be stepped.
+  //! @return true if the entire journal was replayed, false otherwise.
+  //! @note No interface adapters are required.  The replayer stands in
+  //!       for the Dispatcher, answering lookups and acknowledging
+  //!       commands from the journal.  Time is taken from the journal.
+  //! @note Library nodes loaded from the library path during
+  //!       recording must be available on the library path during replay.
+  bool replayQueueJournal(std::string const &filename,
+                          InterfaceManager &manager,
+                          PlexilExec &exec);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_QUEUE_JOURNAL_HH
@@ -0,0 +1,202 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_RING_QUEUE_HH
+#define PLEXIL_RING_QUEUE_HH
+
+#include <cstddef> // size_t
+#include <utility> // std::move()
+#include <vector>
+
+namespace PLEXIL
+{
+
+  //! @enum QueueDropPolicy
+  //! What a bounded queue does with a new item when it is full.
+  enum QueueDropPolicy
+    {
+     QUEUE_DROP_OLDEST = 0, //!< Discard the item at the head of the queue.
+     QUEUE_DROP_NEWEST      //!< Discard the new item.
+    };
+
+  //! @class RingQueue
+  //! A FIFO queue stored in a circular buffer, with an optional bound
+  //! on its length.
+  //! @details The buffer grows by doubling and is never shrunk, so a
+  //!          queue which has reached its working size does not
+  //!          allocate.  T must be default constructible and move
+  //!          assignable; a popped slot is reset to T().
+  //! @note Not thread safe.  Callers are responsible for locking.
+  template <typename T>
+  class RingQueue
+  {
+  public:
+
+    //! Constructor.
+    //! @param bound The maximum length; 0 means unbounded.
+    //! @param policy What to discard when the queue is full.
+    RingQueue(size_t bound = 0, QueueDropPolicy policy = QUEUE_DROP_OLDEST)
+      : m_buffer(),
+        m_head(0),
+        m_size(0),
+        m_bound(bound),
+        m_policy(policy)
+    {
+    }
+
+    ~RingQueue() = default;
+
+    bool empty() const
+    {
+      return !m_size;
+    }
+
+    size_t size() const
+    {
+      return m_size;
+    }
+
+    size_t bound() const
+    {
+      return m_bound;
+    }
+
+    QueueDropPolicy policy() const
+    {
+      return m_policy;
+    }
+
+    //! Set the bound and drop policy.
+    //! @param bound The maximum length; 0 means unbounded.
+    //! @param policy What to discard when the queue is full.
+    //! @return The number of items discarded to meet the new bound.
+    size_t setBound(size_t bound, QueueDropPolicy policy)
+    {
+      m_bound = bound;
+      m_policy = policy;
+      size_t dropped = 0;
+      while (m_bound && m_size > m_bound) {
+        if (m_policy == QUEUE_DROP_OLDEST)
+          pop();
+        else
+          m_buffer[index(--m_size)] = T();
+        ++dropped;
+      }
+      return dropped;
+    }
+
+    //! Get the item at the head of the queue.
+    //! @note The queue must not be empty.
+    T &front()
+    {
+      return m_buffer[m_head];
+    }
+
+    T const &front() const
+    {
+      return m_buffer[m_head];
+    }
+
+    //! Discard the item at the head of the queue.
+    //! @note The queue must not be empty.
+    void pop()
+    {
+      m_buffer[m_head] = T();
+      m_head = (m_head + 1) & (m_buffer.size() - 1);
+      --m_size;
+    }
+
+    //! Add an item at the tail of the queue.
+    //! @param item The item.
+    //! @return The number of items discarded to respect the bound,
+    //!         either 0 or 1.
+    size_t push(T &&item)
+    {
+      size_t dropped = 0;
+      if (m_bound && m_size >= m_bound) {
+        if (m_policy == QUEUE_DROP_NEWEST)
+          return 1; // item is destroyed by caller
+        pop();
+        dropped = 1;
+      }
+      if (m_size == m_buffer.size())
+        grow();
+      m_buffer[index(m_size++)] = std::move(item);
+      return dropped;
+    }
+
+    size_t push(T const &item)
+    {
+      T temp(item);
+      return push(std::move(temp));
+    }
+
+    //! Discard all items.
+    //! @return The number of items discarded.
+    size_t clear()
+    {
+      size_t result = m_size;
+      while (m_size)
+        pop();
+      m_head = 0;
+      return result;
+    }
+
+  private:
+
+    // Not implemented
+    RingQueue(RingQueue const &) = delete;
+    RingQueue(RingQueue &&) = delete;
+    RingQueue &operator=(RingQueue const &) = delete;
+    RingQueue &operator=(RingQueue &&) = delete;
+
+    //! Buffer index of the n'th item from the head.
+    size_t index(size_t n) const
+    {
+      return (m_head + n) & (m_buffer.size() - 1);
+    }
+
+    //! Double the buffer, moving the contents to its beginning.
+    void grow()
+    {
+      size_t newCapacity = m_buffer.empty() ? 8 : 2 * m_buffer.size();
+      std::vector<T> newBuffer(newCapacity);
+      for (size_t i = 0; i < m_size; ++i)
+        newBuffer[i] = std::move(m_buffer[index(i)]);
+      m_buffer.swap(newBuffer);
+      m_head = 0;
+    }
+
+    std::vector<T> m_buffer; //!< Capacity is always a power of 2.
+    size_t m_head;           //!< Index of the head item.
+    size_t m_size;           //!< Number of items in the queue.
+    size_t m_bound;          //!< Maximum length; 0 means unbounded.
+    QueueDropPolicy m_policy;
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_RING_QUEUE_HH
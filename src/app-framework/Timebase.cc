@@ -78,6 +78,11 @@ namespace PLEXIL
     return m_nextWakeup;
   }
 
+  bool Timebase::advance()
+  {
+    return false;
+  }
+
   double Timebase::queryTime()
   {
     if (s_instance)
@@ -85,6 +90,13 @@ namespace PLEXIL
     return 0;
   }
 
+  bool Timebase::advanceTime()
+  {
+    if (s_instance)
+      return s_instance->advance();
+    return false;
+  }
+
   void Timebase::timebaseWakeup(Timebase *tb)
   {
     tb->m_wakeupFn();
@@ -167,6 +179,8 @@ namespace PLEXIL
 #include "ItimerTimebase.cc"
 #endif
 
+#include "VirtualTimebase.cc"
+
 extern "C"
 void initTimebaseFactories()
 {
@@ -181,4 +195,6 @@ void initTimebaseFactories()
 #if defined(HAVE_SETITIMER)
   PLEXIL::registerItimerTimebase();
 #endif
+
+  PLEXIL::registerVirtualTimebase();
 }
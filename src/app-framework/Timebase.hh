@@ -78,6 +78,14 @@ namespace PLEXIL
     //!         existing timebase.
     static double queryTime();
 
+    //! \brief Convenience function. Advances an existing virtual
+    //!        timebase to its next scheduled wakeup.
+    //! \return true if time was advanced, false if there is no
+    //!         existing timebase, it does not implement virtual
+    //!         time, or no wakeup is scheduled.
+    //! \see advance()
+    static bool advanceTime();
+
     //! \brief Virtual destructor.
     virtual ~Timebase();
 
@@ -123,6 +131,16 @@ namespace PLEXIL
     //!       return 0.
     double getNextWakeup() const;
 
+    //! \brief If this timebase implements virtual time, move the
+    //!        current time forward to the next scheduled wakeup and
+    //!        call the wakeup function.
+    //! \return true if time was advanced, false otherwise.
+    //! \note The caller is responsible for ensuring the client of the
+    //!       timebase has nothing left to do at the current time.
+    //! \note The default method does nothing and returns false.
+    //!       Timebases tied to a real clock should not override it.
+    virtual bool advance();
+
   protected:
 
     //! \brief Constructor.
@@ -0,0 +1,185 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//
+// PLEXIL timebase implementation for discrete-event virtual time
+// Platform independent
+//
+
+// N.B. This file is included into Timebase.cc.
+
+#include <atomic>
+#include <cmath>   // std::ceil()
+#include <ctime>   // std::time()
+
+namespace PLEXIL
+{
+
+  //! \class VirtualTimebase
+  //! \brief An implementation of Timebase which does not consult any
+  //!        clock. Time only moves forward when the client calls
+  //!        advance(), at which point it jumps directly to the next
+  //!        scheduled wakeup.
+  //!
+  //! Intended for regression testing and Monte Carlo simulation,
+  //! where a plan's timed behavior matters but its wall clock
+  //! duration does not.  A plan which waits minutes between events
+  //! completes as fast as the Exec can step it.
+  //!
+  //! Virtual time starts at the wall clock time (in whole seconds)
+  //! when the timebase is constructed.
+  //!
+  //! In tick mode, advance() moves time forward to the first tick
+  //! boundary at or after the most recently requested deadline.
+  //!
+  //! \see Timebase
+  class VirtualTimebase : public Timebase
+  {
+  public:
+
+    //! \brief Primary constructor.
+    //! \param fn The function called at timer wakeup.
+    VirtualTimebase(WakeupFn const &fn)
+      : Timebase(fn),
+        m_now(static_cast<double>(std::time(nullptr))),
+        m_deadline(0)
+    {
+      debugMsg("VirtualTimebase", " constructor");
+    }
+
+    //! \brief Virtual destructor.
+    virtual ~VirtualTimebase() = default;
+
+    //
+    // Timebase class public API
+    //
+
+    virtual double getTime() const
+    {
+      return m_now.load();
+    }
+
+    virtual void setTickInterval(uint32_t intvl)
+    {
+      checkInterfaceError(!m_started,
+                          "VirtualTimebase: setTickInterval() called while running");
+      m_interval_usec = intvl;
+    }
+
+    virtual uint32_t getTickInterval() const
+    {
+      return m_interval_usec;
+    }
+
+    virtual void start()
+    {
+      if (m_started) {
+        debugMsg("VirtualTimebase:start", " already running, ignored");
+        return;
+      }
+
+      m_started = true;
+      debugMsg("VirtualTimebase:start",
+               (m_interval_usec ? " tick mode" : " deadline mode")
+               << ", time is " << std::fixed << std::setprecision(6) << m_now.load());
+    }
+
+    virtual void stop()
+    {
+      if (!m_started) {
+        debugMsg("VirtualTimebase:stop", " not running, ignored");
+        return;
+      }
+
+      m_started = false;
+      m_deadline = 0;
+      debugMsg("VirtualTimebase:stop", " complete");
+    }
+
+    virtual void setTimer(double d)
+    {
+      checkInterfaceError(m_started,
+                          "VirtualTimebase: setTimer() called when inactive");
+
+      debugMsg("VirtualTimebase:setTimer",
+               " deadline " << std::fixed << std::setprecision(6) << d);
+
+      if (d <= m_now.load()) {
+        // Already past the scheduled time
+        debugMsg("VirtualTimebase:setTimer",
+                 " new value " << std::fixed << std::setprecision(6) << d
+                 << " is in past, calling wakeup function now");
+        m_deadline = 0;
+        if (!m_interval_usec)
+          m_nextWakeup = 0;
+        m_wakeupFn();
+        return;
+      }
+
+      m_deadline = d;
+      if (!m_interval_usec)
+        m_nextWakeup = d;
+    }
+
+    //! \brief Jump to the pending deadline, if any, and call the
+    //!        wakeup function.
+    //! \return true if time was advanced, false if nothing is scheduled.
+    virtual bool advance()
+    {
+      if (!m_started || !m_deadline)
+        return false;
+
+      double next = m_deadline;
+      if (m_interval_usec) {
+        // Round up to the next tick boundary
+        double const tick = m_interval_usec / 1000000.0;
+        next = m_now.load() + tick * std::ceil((m_deadline - m_now.load()) / tick);
+      }
+      m_deadline = 0;
+      m_now.store(next);
+
+      debugMsg("VirtualTimebase:advance",
+               " time is now " << std::fixed << std::setprecision(6) << next);
+      m_wakeupFn();
+      return true;
+    }
+
+  private:
+
+    //
+    // Member variables
+    //
+
+    std::atomic<double> m_now;      //!< The current virtual time.
+    double              m_deadline; //!< The pending deadline; 0 if none.
+  };
+
+  void registerVirtualTimebase()
+  {
+    // Lowest priority of the standard timebases; normally requested by name.
+    REGISTER_TIMEBASE(VirtualTimebase, "Virtual", 0);
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,229 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "AdapterConfiguration.hh"
+#include "AdapterExecInterface.hh"
+#include "Command.hh"
+#include "ExecListener.hh"
+#include "ExecListenerHub.hh"
+#include "InterfaceManager.hh"
+#include "InterfaceSchema.hh"
+#include "LookupReceiver.hh"
+#include "NodeImpl.hh"
+#include "NodeTransition.hh"
+#include "ParserException.hh"
+#include "PlexilExec.hh"
+#include "State.hh"
+
+#include "pugixml.hpp"
+
+#include <iostream>
+
+using namespace PLEXIL;
+
+//! Appends every node transition to a log, and the number of
+//! transitions in each macro step to another.
+class TransitionLogger final : public ExecListener
+{
+public:
+  TransitionLogger(std::vector<std::string> &log, std::vector<size_t> &stepSizes)
+    : ExecListener(),
+      m_log(log),
+      m_stepSizes(stepSizes)
+  {
+  }
+
+  virtual ~TransitionLogger() = default;
+
+protected:
+  virtual void
+  implementNotifyNodeTransitions(std::vector<NodeTransition> const &transitions) const override
+  {
+    // The hub reports all the transitions of a macro step at once
+    m_stepSizes.push_back(transitions.size());
+    for (NodeTransition const &trans : transitions)
+      m_log.push_back(trans.node->getNodeId() + ' '
+                      + nodeStateName(trans.oldState) + "->"
+                      + nodeStateName(trans.newState));
+  }
+
+private:
+  std::vector<std::string> &m_log;
+  std::vector<size_t> &m_stepSizes;
+};
+
+TestApplication::TestApplication()
+  : m_app(),
+    m_lookups(),
+    m_transitions(),
+    m_stepSizes(),
+    m_held(),
+    m_time(0.0)
+{
+}
+
+TestApplication::~TestApplication()
+{
+  if (m_app)
+    m_app->stop();
+}
+
+bool TestApplication::start(std::map<std::string, std::string> const &configAttrs)
+{
+  m_app.reset(makeExecApplication());
+  AdapterConfiguration *config = m_app->configuration();
+
+  config->registerCommandHandlerFunction("GetValue",
+                                         [](Command *cmd, AdapterExecInterface *intf)
+                                         {
+                                           intf->handleCommandReturn(cmd, Value((Integer) 42));
+                                           intf->handleCommandAck(cmd, COMMAND_SUCCESS);
+                                         });
+  config->registerCommandHandlerFunction("Hold",
+                                         [this](Command *cmd, AdapterExecInterface *intf)
+                                         {
+                                           m_held.push_back(cmd);
+                                           intf->handleCommandAck(cmd, COMMAND_SENT_TO_SYSTEM);
+                                         },
+                                         [this](Command *cmd, AdapterExecInterface *intf)
+                                         {
+                                           for (std::vector<Command *>::iterator it = m_held.begin();
+                                                it != m_held.end();
+                                                ++it)
+                                             if (*it == cmd) {
+                                               m_held.erase(it);
+                                               break;
+                                             }
+                                           intf->handleCommandAbortAck(cmd, true);
+                                         });
+  config->registerLookupHandlerFunction("time",
+                                        [this](State const & /* state */, LookupReceiver *rcvr)
+                                        {
+                                          rcvr->update(m_time);
+                                        });
+  config->setDefaultLookupHandler([this](State const &state, LookupReceiver *rcvr)
+                                  {
+                                    std::map<std::string, Value>::const_iterator it =
+                                      m_lookups.find(state.name());
+                                    if (it == m_lookups.end())
+                                      rcvr->setUnknown();
+                                    else
+                                      rcvr->update(it->second);
+                                  });
+  m_app->listenerHub()->addListener(new TransitionLogger(m_transitions, m_stepSizes));
+
+  pugi::xml_document configDoc;
+  pugi::xml_node configXml = configDoc.append_child(InterfaceSchema::INTERFACES_TAG);
+  for (std::map<std::string, std::string>::value_type const &attr : configAttrs)
+    configXml.append_attribute(attr.first.c_str()).set_value(attr.second.c_str());
+  // Discard state left in the Exec's singletons by earlier tests
+  return m_app->initialize(configXml) && m_app->startInterfaces()
+    && m_app->reset();
+}
+
+bool TestApplication::addPlan(char const *planXml)
+{
+  pugi::xml_document doc;
+  if (doc.load_string(planXml).status != pugi::status_ok)
+    return false;
+  try {
+    m_app->manager()->handleAddPlan(doc.document_element());
+  }
+  catch (ParserException const &e) {
+    std::cout << "Plan parser error:\n" << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void TestApplication::run()
+{
+  m_app->runExec();
+}
+
+void TestApplication::setLookup(std::string const &name, Value const &value)
+{
+  m_lookups[name] = value;
+  m_app->manager()->handleValueChange(State(name), value);
+}
+
+void TestApplication::setLookupQuietly(std::string const &name, Value const &value)
+{
+  m_lookups[name] = value;
+}
+
+void TestApplication::setTime(double t)
+{
+  m_time = t;
+}
+
+void TestApplication::releaseHeld(CommandHandleValue handle)
+{
+  std::vector<Command *> held;
+  held.swap(m_held);
+  for (Command *cmd : held)
+    m_app->manager()->handleCommandAck(cmd, handle);
+}
+
+static Node *findNodeIn(NodeImpl *node, std::string const &nodeId)
+{
+  if (node->getNodeId() == nodeId)
+    return node;
+  for (NodeImplPtr &child : node->getChildren()) {
+    Node *result = findNodeIn(child.get(), nodeId);
+    if (result)
+      return result;
+  }
+  return nullptr;
+}
+
+Node *TestApplication::findNode(std::string const &nodeId)
+{
+  for (NodePtr const &plan : m_app->exec()->getPlans()) {
+    Node *result = findNodeIn(static_cast<NodeImpl *>(plan.get()), nodeId);
+    if (result)
+      return result;
+  }
+  return nullptr;
+}
+
+std::string chainPlan(std::string const &name, size_t length)
+{
+  std::string result =
+    "<PlexilPlan>\n <Node NodeType=\"NodeList\"><NodeId>" + name + "</NodeId>\n"
+    "  <NodeBody><NodeList>\n";
+  for (size_t i = 0; i < length; ++i) {
+    result += "   <Node NodeType=\"Empty\"><NodeId>" + name + std::to_string(i) + "</NodeId>\n";
+    if (i)
+      result += "    <StartCondition><Finished><NodeRef dir=\"sibling\">"
+        + name + std::to_string(i - 1) + "</NodeRef></Finished></StartCondition>\n";
+    result += "   </Node>\n";
+  }
+  result += "  </NodeList></NodeBody>\n </Node>\n</PlexilPlan>\n";
+  return result;
+}
@@ -0,0 +1,131 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_APP_TEST_SUPPORT_HH
+#define PLEXIL_APP_TEST_SUPPORT_HH
+
+#include "ExecApplication.hh"
+#include "Value.hh"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PLEXIL
+{
+  class Command;
+  class Node;
+}
+
+//! @class TestApplication
+//! An ExecApplication, driven synchronously by the test, with
+//! handlers for the commands and lookups used by the test plans,
+//! and a listener which logs every node transition.
+//! @note Commands:
+//!       GetValue() acknowledges success and returns 42 at once.
+//!       Hold() is acknowledged only when the test calls
+//!       releaseHeld(); its abort is acknowledged at once.
+//!       Lookups return the values given to setLookup(); "time"
+//!       returns the value given to setTime().
+class TestApplication final
+{
+public:
+  TestApplication();
+  ~TestApplication();
+
+  //! Construct the application and start its interfaces.
+  //! @param configAttrs Attributes of the Interfaces configuration
+  //!                    element, by name.
+  //! @return true if successful, false otherwise.
+  bool start(std::map<std::string, std::string> const &configAttrs = {});
+
+  //! Parse a plan and pass it to the Exec.
+  //! @return true if successful, false otherwise.
+  bool addPlan(char const *planXml);
+
+  //! Run the Exec until quiescent.
+  void run();
+
+  //! Set the value of a state, and post the change to the Exec.
+  void setLookup(std::string const &name, PLEXIL::Value const &value);
+
+  //! Set the value of a state without telling the Exec; only
+  //! lookups made after this will see the new value.
+  void setLookupQuietly(std::string const &name, PLEXIL::Value const &value);
+
+  //! Set the current time.
+  void setTime(double t);
+
+  //! Acknowledge every outstanding Hold() command with the given
+  //! handle value.
+  void releaseHeld(PLEXIL::CommandHandleValue handle);
+
+  //! Find a node of a running plan by its node ID.
+  //! @return Pointer to the node; nullptr if not found.
+  PLEXIL::Node *findNode(std::string const &nodeId);
+
+  PLEXIL::ExecApplication &app()
+  {
+    return *m_app;
+  }
+
+  //! The node transitions reported so far, as "node OLD->NEW".
+  std::vector<std::string> &transitions()
+  {
+    return m_transitions;
+  }
+
+  //! The number of transitions reported at the end of each macro
+  //! step which had any.
+  std::vector<size_t> &stepSizes()
+  {
+    return m_stepSizes;
+  }
+
+  //! The number of Hold() commands awaiting acknowledgement.
+  size_t heldCount() const
+  {
+    return m_held.size();
+  }
+
+private:
+  std::unique_ptr<PLEXIL::ExecApplication> m_app;
+  std::map<std::string, PLEXIL::Value> m_lookups;
+  std::vector<std::string> m_transitions;
+  std::vector<size_t> m_stepSizes;
+  std::vector<PLEXIL::Command *> m_held;
+  double m_time;
+};
+
+//! A plan whose children start one after another, so that it has
+//! nodes to check in every micro step until it finishes.
+//! @param name Node ID of the root; the children are numbered after it.
+//! @param length The number of children.
+//! @return The plan XML.
+std::string chainPlan(std::string const &name, size_t length);
+
+#endif // PLEXIL_APP_TEST_SUPPORT_HH
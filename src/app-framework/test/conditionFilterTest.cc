@@ -0,0 +1,200 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "InterfaceSchema.hh"
+#include "NodeImpl.hh"
+#include "PlexilExec.hh"
+#include "TestSupport.hh"
+
+using namespace PLEXIL;
+
+//! Counts the nodes put on the check queue, passing all calls on
+//! to the application's Exec.
+class CountingExec final : public PlexilExec
+{
+public:
+  CountingExec(PlexilExec *exec)
+    : m_exec(exec),
+      m_insertions(0)
+  {
+  }
+
+  virtual ~CountingExec() = default;
+
+  size_t insertions() const
+  {
+    return m_insertions;
+  }
+
+  virtual void addCandidateNode(Node *node) override
+  {
+    ++m_insertions;
+    m_exec->addCandidateNode(node);
+  }
+
+  virtual void enqueueAssignment(Assignment *assign) override { m_exec->enqueueAssignment(assign); }
+  virtual void enqueueAssignmentForRetraction(Assignment *assign) override { m_exec->enqueueAssignmentForRetraction(assign); }
+  virtual void enqueueCommand(CommandImpl *cmd) override { m_exec->enqueueCommand(cmd); }
+  virtual void enqueueAbortCommand(CommandImpl *cmd) override { m_exec->enqueueAbortCommand(cmd); }
+  virtual void enqueueUpdate(Update *upd) override { m_exec->enqueueUpdate(upd); }
+  virtual void markRootNodeFinished(Node *node) override { m_exec->markRootNodeFinished(node); }
+  virtual void setDispatcher(Dispatcher *intf) override { m_exec->setDispatcher(intf); }
+  virtual void setExecListener(ExecListenerBase *l) override { m_exec->setExecListener(l); }
+  virtual ExecListenerBase *getExecListener() override { return m_exec->getExecListener(); }
+  virtual ResourceArbiterInterface *getArbiter() override { return m_exec->getArbiter(); }
+  virtual void step(double startTime) override { m_exec->step(startTime); }
+  virtual bool needsStep() const override { return m_exec->needsStep(); }
+  virtual void setTimeSlice(unsigned int maxMicroSteps, double maxSeconds) override { m_exec->setTimeSlice(maxMicroSteps, maxSeconds); }
+  virtual void startTimeSlice() override { m_exec->startTimeSlice(); }
+  virtual bool timeSliceExpired() const override { return m_exec->timeSliceExpired(); }
+  virtual unsigned int getTimeSliceMicroSteps() const override { return m_exec->getTimeSliceMicroSteps(); }
+  virtual void setPlanWeight(std::string const &rootNodeId, unsigned int weight) override { m_exec->setPlanWeight(rootNodeId, weight); }
+  virtual NodeStateTable &getNodeStateTable() override { return m_exec->getNodeStateTable(); }
+  virtual NodeStateTable const &getNodeStateTable() const override { return m_exec->getNodeStateTable(); }
+  virtual bool addPlan(Node *root) override { return m_exec->addPlan(root); }
+  virtual void removePlan(Node *root) override { m_exec->removePlan(root); }
+  virtual void deleteFinishedPlans() override { m_exec->deleteFinishedPlans(); }
+  virtual bool allPlansFinished() const override { return m_exec->allPlansFinished(); }
+  virtual void reset() override { m_exec->reset(); }
+  virtual std::list<NodePtr> const &getPlans() const override { return m_exec->getPlans(); }
+
+private:
+  PlexilExec *m_exec;
+  size_t m_insertions;
+};
+
+// Waiter's start condition depends on x, which Count changes many
+// times before the condition becomes true, and on an external state.
+static char const *FILTER_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <StateDeclaration><Name>level</Name>"
+  "<Return><Name>_return_0</Name><Type>Integer</Type></Return></StateDeclaration>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"NodeList\"><NodeId>Filter</NodeId>\n"
+  "  <VariableDeclarations><DeclareVariable><Name>x</Name><Type>Integer</Type>"
+  "<InitialValue><IntegerValue>0</IntegerValue></InitialValue></DeclareVariable></VariableDeclarations>\n"
+  "  <NodeBody><NodeList>\n"
+  "   <Node NodeType=\"Assignment\"><NodeId>Count</NodeId>\n"
+  "    <RepeatCondition><LT><IntegerVariable>x</IntegerVariable>"
+  "<IntegerValue>50</IntegerValue></LT></RepeatCondition>\n"
+  "    <NodeBody><Assignment><IntegerVariable>x</IntegerVariable>"
+  "<NumericRHS><ADD><IntegerVariable>x</IntegerVariable><IntegerValue>1</IntegerValue></ADD>"
+  "</NumericRHS></Assignment></NodeBody>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Empty\"><NodeId>Waiter</NodeId>\n"
+  "    <StartCondition><AND>"
+  "<GE><IntegerVariable>x</IntegerVariable><IntegerValue>50</IntegerValue></GE>"
+  "<GE><LookupOnChange><Name><StringValue>level</StringValue></Name></LookupOnChange>"
+  "<IntegerValue>5</IntegerValue></GE>"
+  "</AND></StartCondition>\n"
+  "   </Node>\n"
+  "  </NodeList></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+struct FilterRun
+{
+  std::vector<std::string> transitions;
+  std::vector<size_t> stepSizes;
+  size_t insertions;
+};
+
+// The filter is enabled through the configuration, and disabled
+// through the application.
+static bool runFilterPlan(bool filter, FilterRun &result)
+{
+  bool const savedFilter = NodeImpl::getConditionNotificationFilter();
+  NodeImpl::setConditionNotificationFilter(!filter);
+
+  TestApplication app;
+  if (filter) {
+    assertTrue_1(app.start({{std::string(InterfaceSchema::FILTER_CONDITION_NOTIFICATIONS_ATTR), "true"}}));
+  }
+  else {
+    assertTrue_1(app.start());
+    app.app().setConditionNotificationFilter(false);
+  }
+  assertTrue_1(NodeImpl::getConditionNotificationFilter() == filter);
+  CountingExec counter(g_exec);
+  PlexilExec *const savedExec = g_exec;
+  g_exec = &counter;
+
+  app.setLookup("level", Value((Integer) 0));
+  bool ok = app.addPlan(FILTER_PLAN);
+  if (ok) {
+    app.run();
+    for (Integer level = 1; level <= 6; ++level) {
+      app.setTime((double) level);
+      app.setLookup("level", Value(level));
+      app.run();
+    }
+  }
+
+  g_exec = savedExec;
+  NodeImpl::setConditionNotificationFilter(savedFilter);
+  assertTrue_1(ok);
+  assertTrueMsg(app.app().allPlansFinished(),
+                "runFilterPlan: plan didn't finish with filter " << filter);
+  result.transitions.swap(app.transitions());
+  result.stepSizes.swap(app.stepSizes());
+  result.insertions = counter.insertions();
+  return true;
+}
+
+// The filter reduces the nodes put on the check queue, but not the
+// transitions made, nor the macro steps they are made in.
+static bool testFilterEquivalence()
+{
+  FilterRun unfiltered, filtered;
+  if (!runFilterPlan(false, unfiltered) || !runFilterPlan(true, filtered))
+    return false;
+
+  assertTrueMsg(filtered.insertions < unfiltered.insertions,
+                "testFilterEquivalence: " << filtered.insertions
+                << " check queue insertions with filter, "
+                << unfiltered.insertions << " without");
+  assertTrueMsg(filtered.stepSizes == unfiltered.stepSizes,
+                "testFilterEquivalence: macro steps differ with filter");
+  assertTrueMsg(filtered.transitions.size() == unfiltered.transitions.size(),
+                "testFilterEquivalence: " << filtered.transitions.size()
+                << " transitions with filter, "
+                << unfiltered.transitions.size() << " without");
+  for (size_t i = 0; i < unfiltered.transitions.size(); ++i)
+    assertTrueMsg(filtered.transitions[i] == unfiltered.transitions[i],
+                  "testFilterEquivalence: transition " << i << " is "
+                  << filtered.transitions[i] << " with filter, "
+                  << unfiltered.transitions[i] << " without");
+  return true;
+}
+
+bool conditionFilterTest()
+{
+  runTest(testFilterEquivalence);
+  return true;
+}
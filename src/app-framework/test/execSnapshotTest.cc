@@ -0,0 +1,289 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "Expression.hh"
+#include "Mutex.hh"
+#include "NodeImpl.hh"
+#include "PlexilExec.hh"
+#include "TestSupport.hh"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <cstdio> // remove()
+
+using namespace PLEXIL;
+
+static char const *SNAPSHOT_FILE = "execSnapshotTest.snapshot";
+
+static char const *SNAPSHOT_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>GetValue</Name>"
+  "<Return><Name>_return_0</Name><Type>Integer</Type></Return></CommandDeclaration>\n"
+  "  <CommandDeclaration><Name>Hold</Name></CommandDeclaration>\n"
+  "  <StateDeclaration><Name>counter</Name>"
+  "<Return><Name>_return_0</Name><Type>Integer</Type></Return></StateDeclaration>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"NodeList\"><NodeId>Snapshot</NodeId>\n"
+  "  <VariableDeclarations><DeclareVariable><Name>x</Name><Type>Integer</Type></DeclareVariable></VariableDeclarations>\n"
+  "  <NodeBody><NodeList>\n"
+  "   <Node NodeType=\"Command\"><NodeId>Fetch</NodeId>\n"
+  "    <EndCondition><IsKnown><IntegerVariable>x</IntegerVariable></IsKnown></EndCondition>\n"
+  "    <NodeBody><Command><IntegerVariable>x</IntegerVariable>"
+  "<Name><StringValue>GetValue</StringValue></Name></Command></NodeBody>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Command\"><NodeId>Wait</NodeId>\n"
+  "    <EndCondition><AND>"
+  "<GE><LookupOnChange><Name><StringValue>counter</StringValue></Name></LookupOnChange>"
+  "<IntegerValue>3</IntegerValue></GE>"
+  "<EQInternal><NodeCommandHandleVariable><NodeId>Wait</NodeId></NodeCommandHandleVariable>"
+  "<NodeCommandHandleValue>COMMAND_SUCCESS</NodeCommandHandleValue></EQInternal>"
+  "</AND></EndCondition>\n"
+  "    <NodeBody><Command><Name><StringValue>Hold</StringValue></Name></Command></NodeBody>\n"
+  "   </Node>\n"
+  "  </NodeList></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+//! Run the plan until Fetch has finished and Hold() is in flight,
+//! saving snapshots as it goes.
+static bool takeSnapshot()
+{
+  TestApplication app;
+  assertTrue_1(app.start());
+  assertTrue_1(app.app().startSnapshots(SNAPSHOT_FILE));
+  app.setLookup("counter", Value((Integer) 0));
+  assertTrue_1(app.addPlan(SNAPSHOT_PLAN));
+  app.run();
+  assertTrue_1(app.heldCount() == 1);
+  assertTrue_1(app.findNode("Fetch")->getState() == FINISHED_STATE);
+  assertTrue_1(app.findNode("Wait")->getState() == EXECUTING_STATE);
+  return true;
+}
+
+static bool testRestore()
+{
+  assertTrue_1(takeSnapshot());
+
+  TestApplication app;
+  assertTrue_1(app.start());
+  app.setLookup("counter", Value((Integer) 0));
+  assertTrue_1(app.app().restoreSnapshot(SNAPSHOT_FILE));
+  app.run();
+
+  Node *root = app.findNode("Snapshot");
+  assertTrueMsg(root, "testRestore: plan not restored");
+  assertTrueMsg(root->getState() == EXECUTING_STATE,
+                "testRestore: root restored in state " << nodeStateName(root->getState()));
+  assertTrueMsg(app.findNode("Fetch")->getState() == FINISHED_STATE,
+                "testRestore: Fetch restored in state "
+                << nodeStateName(app.findNode("Fetch")->getState()));
+  assertTrueMsg(app.findNode("Wait")->getState() == EXECUTING_STATE,
+                "testRestore: Wait restored in state "
+                << nodeStateName(app.findNode("Wait")->getState()));
+  Integer x = 0;
+  assertTrueMsg(static_cast<NodeImpl *>(root)->findVariable("x")->getValue(x) && x == 42,
+                "testRestore: variable x not restored");
+
+  // The command in flight when the snapshot was taken is issued again,
+  // and the plan runs to completion
+  assertTrueMsg(app.heldCount() == 1,
+                "testRestore: in-flight command not reissued");
+  app.transitions().clear();
+  app.releaseHeld(COMMAND_SUCCESS);
+  app.setLookup("counter", Value((Integer) 3));
+  app.run();
+  assertTrueMsg(app.app().allPlansFinished(),
+                "testRestore: restored plan did not finish");
+  // Fetch must not run again
+  for (std::string const &t : app.transitions())
+    assertTrueMsg(t.compare(0, 6, "Fetch ") != 0,
+                  "testRestore: unexpected transition " << t);
+
+  remove(SNAPSHOT_FILE);
+  return true;
+}
+
+static bool testMismatch()
+{
+  assertTrue_1(takeSnapshot());
+
+  // Rename Wait in its last saved record, leaving the plan intact
+  std::string data;
+  {
+    std::ifstream in(SNAPSHOT_FILE, std::ios::binary);
+    assertTrue_1(in);
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  std::string::size_type pos = data.rfind("Wait");
+  assertTrue_1(pos != std::string::npos && pos > data.find("</PlexilPlan>"));
+  data[pos + 3] = 'x';
+  {
+    std::ofstream out(SNAPSHOT_FILE, std::ios::binary | std::ios::trunc);
+    out << data;
+  }
+
+  TestApplication app;
+  assertTrue_1(app.start());
+  assertTrueMsg(!app.app().restoreSnapshot(SNAPSHOT_FILE),
+                "testMismatch: mismatched snapshot restored");
+  app.run();
+  assertTrueMsg(app.app().exec()->getPlans().empty(),
+                "testMismatch: mismatched plan was added to the Exec");
+  assertTrueMsg(app.transitions().empty(),
+                "testMismatch: mismatched plan was executed");
+  assertTrueMsg(app.heldCount() == 0,
+                "testMismatch: command of mismatched plan was issued");
+
+  remove(SNAPSHOT_FILE);
+  return true;
+}
+
+// Guarded holds RestoreOuter, and Use holds RestoreInner while Hold()
+// is in flight.
+static char const *GUARDED_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>Hold</Name></CommandDeclaration>\n"
+  "  <DeclareMutex><Name>RestoreOuter</Name></DeclareMutex>\n"
+  "  <DeclareMutex><Name>RestoreInner</Name></DeclareMutex>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"NodeList\"><NodeId>Guarded</NodeId>\n"
+  "  <UsingMutex><Name>RestoreOuter</Name></UsingMutex>\n"
+  "  <NodeBody><NodeList>\n"
+  "   <Node NodeType=\"Command\"><NodeId>Use</NodeId>\n"
+  "    <UsingMutex><Name>RestoreInner</Name></UsingMutex>\n"
+  "    <EndCondition><EQInternal><NodeCommandHandleVariable><NodeId>Use</NodeId></NodeCommandHandleVariable>"
+  "<NodeCommandHandleValue>COMMAND_SUCCESS</NodeCommandHandleValue></EQInternal></EndCondition>\n"
+  "    <NodeBody><Command><Name><StringValue>Hold</StringValue></Name></Command></NodeBody>\n"
+  "   </Node>\n"
+  "  </NodeList></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+static char const *OWNER_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>Hold</Name></CommandDeclaration>\n"
+  "  <DeclareMutex><Name>RestoreInner</Name></DeclareMutex>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"Command\"><NodeId>Owner</NodeId>\n"
+  "  <UsingMutex><Name>RestoreInner</Name></UsingMutex>\n"
+  "  <EndCondition><EQInternal><NodeCommandHandleVariable><NodeId>Owner</NodeId></NodeCommandHandleVariable>"
+  "<NodeCommandHandleValue>COMMAND_SUCCESS</NodeCommandHandleValue></EQInternal></EndCondition>\n"
+  "  <NodeBody><Command><Name><StringValue>Hold</StringValue></Name></Command></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+static char const *OUTER_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <DeclareMutex><Name>RestoreOuter</Name></DeclareMutex>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"Empty\"><NodeId>OuterUser</NodeId>\n"
+  "  <UsingMutex><Name>RestoreOuter</Name></UsingMutex>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+// A plan whose node cannot reacquire its mutex on restore is removed,
+// and the mutexes its other nodes reacquired are released.
+static bool testRestoreFailure()
+{
+  std::string data;
+  {
+    TestApplication app;
+    assertTrue_1(app.start());
+    assertTrue_1(app.app().startSnapshots(SNAPSHOT_FILE));
+    assertTrue_1(app.addPlan(GUARDED_PLAN));
+    app.run();
+    assertTrue_1(app.findNode("Use")->getState() == EXECUTING_STATE);
+    assertTrue_1(app.heldCount() == 1);
+    std::ifstream in(SNAPSHOT_FILE, std::ios::binary);
+    assertTrue_1(in);
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    // Let the plan release the global mutexes
+    app.releaseHeld(COMMAND_SUCCESS);
+    app.run();
+    assertTrue_1(app.app().allPlansFinished());
+  }
+  {
+    std::ofstream out(SNAPSHOT_FILE, std::ios::binary | std::ios::trunc);
+    out << data;
+  }
+
+  TestApplication app;
+  assertTrue_1(app.start());
+  assertTrue_1(app.addPlan(OWNER_PLAN));
+  app.run();
+  assertTrue_1(app.findNode("Owner")->getState() == EXECUTING_STATE);
+  assertTrue_1(app.heldCount() == 1);
+
+  assertTrueMsg(!app.app().restoreSnapshot(SNAPSHOT_FILE),
+                "testRestoreFailure: restore reported success");
+  app.run();
+  assertTrueMsg(app.app().exec()->getPlans().size() == 1,
+                "testRestoreFailure: partly restored plan left in the Exec");
+  assertTrueMsg(!app.findNode("Guarded"),
+                "testRestoreFailure: partly restored plan left in the Exec");
+  assertTrueMsg(app.heldCount() == 1,
+                "testRestoreFailure: command of unrestored plan was issued");
+
+  // Guarded reacquired RestoreOuter before Use failed; it must be free
+  Mutex *outer = getGlobalMutex("RestoreOuter");
+  assertTrue_1(outer);
+  assertTrueMsg(!outer->getHolder(),
+                "testRestoreFailure: mutex of removed plan still held");
+  app.transitions().clear();
+  assertTrue_1(app.addPlan(OUTER_PLAN));
+  app.run();
+  bool outerFinished = false;
+  for (std::string const &t : app.transitions())
+    if (t.compare(0, 10, "OuterUser ") == 0
+        && t.size() > 10 && t.compare(t.size() - 10, 10, "->FINISHED") == 0)
+      outerFinished = true;
+  assertTrueMsg(outerFinished,
+                "testRestoreFailure: plan using the freed mutex did not run");
+
+  app.releaseHeld(COMMAND_SUCCESS);
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+
+  remove(SNAPSHOT_FILE);
+  return true;
+}
+
+bool execSnapshotTest()
+{
+  runTest(testRestore);
+  runTest(testMismatch);
+  runTest(testRestoreFailure);
+  return true;
+}
@@ -0,0 +1,172 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "Expression.hh"
+#include "NodeImpl.hh"
+#include "PlanError.hh"
+#include "TestSupport.hh"
+
+using namespace PLEXIL;
+
+// Guard reads the state while it waits for Hold; Read reads it
+// again, through an identical LookupNow, after the state has changed
+// without the interface posting the change.
+static char const *LOOKUP_NOW_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>Hold</Name></CommandDeclaration>\n"
+  "  <StateDeclaration><Name>level</Name>"
+  "<Return><Name>_return_0</Name><Type>Integer</Type></Return></StateDeclaration>\n"
+  "  <StateDeclaration><Name>go</Name>"
+  "<Return><Name>_return_0</Name><Type>Boolean</Type></Return></StateDeclaration>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"NodeList\"><NodeId>Fresh</NodeId>\n"
+  "  <VariableDeclarations><DeclareVariable><Name>y</Name><Type>Integer</Type></DeclareVariable></VariableDeclarations>\n"
+  "  <NodeBody><NodeList>\n"
+  "   <Node NodeType=\"Command\"><NodeId>Guard</NodeId>\n"
+  "    <EndCondition><EQInternal>"
+  "<NodeCommandHandleVariable><NodeId>Guard</NodeId></NodeCommandHandleVariable>"
+  "<NodeCommandHandleValue>COMMAND_SUCCESS</NodeCommandHandleValue>"
+  "</EQInternal></EndCondition>\n"
+  "    <InvariantCondition><GE>"
+  "<LookupNow><Name><StringValue>level</StringValue></Name></LookupNow>"
+  "<IntegerValue>0</IntegerValue></GE></InvariantCondition>\n"
+  "    <NodeBody><Command><Name><StringValue>Hold</StringValue></Name></Command></NodeBody>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Assignment\"><NodeId>Read</NodeId>\n"
+  "    <StartCondition><LookupOnChange><Name><StringValue>go</StringValue></Name></LookupOnChange></StartCondition>\n"
+  "    <NodeBody><Assignment><IntegerVariable>y</IntegerVariable>"
+  "<NumericRHS><LookupNow><Name><StringValue>level</StringValue></Name></LookupNow></NumericRHS>"
+  "</Assignment></NodeBody>\n"
+  "   </Node>\n"
+  "  </NodeList></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+// Each activation of a LookupNow must read the current value, even
+// when another node's identical LookupNow is still active.
+static bool testLookupNowFreshness()
+{
+  TestApplication app;
+  assertTrue_1(app.start());
+  app.setLookup("level", Value((Integer) 1));
+  app.setLookup("go", Value(false));
+  assertTrue_1(app.addPlan(LOOKUP_NOW_PLAN));
+  app.run();
+  assertTrueMsg(app.heldCount() == 1, "testLookupNowFreshness: Hold not executed");
+
+  app.setLookupQuietly("level", Value((Integer) 5));
+  app.setLookup("go", Value(true));
+  app.run();
+  Node *read = app.findNode("Read");
+  assertTrueMsg(read && read->getState() == FINISHED_STATE,
+                "testLookupNowFreshness: Read did not finish");
+  Integer y = 0;
+  assertTrueMsg(static_cast<NodeImpl *>(app.findNode("Fresh"))->findVariable("y")->getValue(y),
+                "testLookupNowFreshness: y unknown");
+  assertTrueMsg(y == 5,
+                "testLookupNowFreshness: LookupNow returned stale value " << y);
+
+  app.releaseHeld(COMMAND_SUCCESS);
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+  return true;
+}
+
+// Above and Again test the same comparison, which is shared; Sum
+// tests a comparison of constants, which is folded.  Wait keeps the
+// plan running.
+static char const *FOLD_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>Hold</Name></CommandDeclaration>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"NodeList\"><NodeId>Pool</NodeId>\n"
+  "  <VariableDeclarations><DeclareVariable><Name>x</Name><Type>Integer</Type>"
+  "<InitialValue><IntegerValue>20</IntegerValue></InitialValue></DeclareVariable></VariableDeclarations>\n"
+  "  <NodeBody><NodeList>\n"
+  "   <Node NodeType=\"Empty\"><NodeId>Above</NodeId>\n"
+  "    <StartCondition><GT><IntegerVariable>x</IntegerVariable>"
+  "<IntegerValue>10</IntegerValue></GT></StartCondition>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Empty\"><NodeId>Again</NodeId>\n"
+  "    <StartCondition><GT><IntegerVariable>x</IntegerVariable>"
+  "<IntegerValue>10</IntegerValue></GT></StartCondition>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Empty\"><NodeId>Sum</NodeId>\n"
+  "    <StartCondition><EQNumeric><ADD><IntegerValue>2</IntegerValue>"
+  "<IntegerValue>3</IntegerValue></ADD><IntegerValue>5</IntegerValue></EQNumeric></StartCondition>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Command\"><NodeId>Wait</NodeId>\n"
+  "    <EndCondition><EQInternal>"
+  "<NodeCommandHandleVariable><NodeId>Wait</NodeId></NodeCommandHandleVariable>"
+  "<NodeCommandHandleValue>COMMAND_SUCCESS</NodeCommandHandleValue>"
+  "</EQInternal></EndCondition>\n"
+  "    <NodeBody><Command><Name><StringValue>Hold</StringValue></Name></Command></NodeBody>\n"
+  "   </Node>\n"
+  "  </NodeList></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+// Folding and sharing work with the application's default plan error
+// setting, and leave that setting as it was.
+static bool testDefaultConfiguration()
+{
+  assertTrue_1(!PlanError::throwEnabled());
+  TestApplication app;
+  assertTrue_1(app.start());
+  assertTrue_1(app.addPlan(FOLD_PLAN));
+  assertTrueMsg(!PlanError::throwEnabled(),
+                "testDefaultConfiguration: parser left plan errors throwing");
+  app.run();
+
+  NodeImpl *above = static_cast<NodeImpl *>(app.findNode("Above"));
+  NodeImpl *again = static_cast<NodeImpl *>(app.findNode("Again"));
+  NodeImpl *sum = static_cast<NodeImpl *>(app.findNode("Sum"));
+  assertTrue_1(above && again && sum);
+  assertTrueMsg(above->getStartCondition() == again->getStartCondition(),
+                "testDefaultConfiguration: identical comparisons not shared");
+  assertTrueMsg(sum->getStartCondition()->isConstant(),
+                "testDefaultConfiguration: constant comparison not folded");
+  assertTrueMsg(above->getState() == FINISHED_STATE
+                && again->getState() == FINISHED_STATE
+                && sum->getState() == FINISHED_STATE,
+                "testDefaultConfiguration: nodes didn't finish");
+
+  app.releaseHeld(COMMAND_SUCCESS);
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+  return true;
+}
+
+bool expressionPoolTest()
+{
+  runTest(testLookupNowFreshness);
+  runTest(testDefaultConfiguration);
+  return true;
+}
@@ -0,0 +1,189 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "AdapterConfiguration.hh"
+#include "AdapterExecInterface.hh"
+#include "CommandImpl.hh"
+#include "InterfaceManager.hh"
+#include "State.hh"
+#include "TestSupport.hh"
+
+#include <cstdio> // remove()
+
+using namespace PLEXIL;
+
+static char const *JOURNAL_FILE = "interfaceManagerTest.jnl";
+
+static char const *PROBE_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>Probe</Name></CommandDeclaration>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"Command\"><NodeId>Probe</NodeId>\n"
+  "  <NodeBody><Command><Name><StringValue>Probe</StringValue></Name></Command></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+static char const *STALL_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>Stall</Name></CommandDeclaration>\n"
+  "  <StateDeclaration><Name>stop</Name>"
+  "<Return><Name>_return_0</Name><Type>Boolean</Type></Return></StateDeclaration>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"Command\"><NodeId>Stall</NodeId>\n"
+  "  <ExitCondition><LookupOnChange><Name><StringValue>stop</StringValue></Name></LookupOnChange></ExitCondition>\n"
+  "  <EndCondition><BooleanValue>false</BooleanValue></EndCondition>\n"
+  "  <NodeBody><Command><Name><StringValue>Stall</StringValue></Name></Command></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+//! What a handler saw immediately after responding.
+struct Observation
+{
+  bool called = false;
+  bool applied = false; // response already visible to the Exec
+  bool queued = false;  // response waiting in the input queue
+};
+
+//! Register a Probe command which acknowledges success at once,
+//! noting whether the acknowledgement was applied or queued.
+static void registerProbe(TestApplication &app, Observation &obs)
+{
+  InterfaceManager *mgr = app.app().manager();
+  app.app().configuration()->registerCommandHandlerFunction
+    ("Probe",
+     [mgr, &obs](Command *cmd, AdapterExecInterface *intf)
+     {
+       intf->handleCommandAck(cmd, COMMAND_SUCCESS);
+       obs.called = true;
+       obs.applied =
+         static_cast<CommandImpl *>(cmd)->getCommandHandle() == COMMAND_SUCCESS;
+       obs.queued = !mgr->isQueueEmpty();
+     });
+}
+
+//! Register a Stall command which is never acknowledged, and whose
+//! abort is acknowledged at once; if queueFirst is true, a lookup
+//! value is posted before the abort acknowledgement.
+static void registerStall(TestApplication &app, Observation &obs, bool queueFirst)
+{
+  InterfaceManager *mgr = app.app().manager();
+  app.app().configuration()->registerCommandHandlerFunction
+    ("Stall",
+     [](Command *cmd, AdapterExecInterface *intf)
+     {
+       intf->handleCommandAck(cmd, COMMAND_SENT_TO_SYSTEM);
+     },
+     [mgr, &obs, queueFirst](Command *cmd, AdapterExecInterface *intf)
+     {
+       if (queueFirst)
+         intf->handleValueChange(State("noise"), Value((Integer) 1));
+       intf->handleCommandAbortAck(cmd, true);
+       bool ack = false;
+       obs.called = true;
+       obs.applied =
+         static_cast<CommandImpl *>(cmd)->getAbortComplete()->getValue(ack) && ack;
+       obs.queued = !mgr->isQueueEmpty();
+     });
+}
+
+// A synchronous acknowledgement is applied before the handler
+// returns, and the plan completes in the same Exec cycle.
+static bool testSameCycleAck()
+{
+  TestApplication app;
+  assertTrue_1(app.start());
+  Observation obs;
+  registerProbe(app, obs);
+  assertTrue_1(app.addPlan(PROBE_PLAN));
+  app.run();
+  assertTrueMsg(obs.called, "testSameCycleAck: Probe command not executed");
+  assertTrueMsg(obs.applied, "testSameCycleAck: acknowledgement not applied directly");
+  assertTrueMsg(!obs.queued, "testSameCycleAck: acknowledgement was queued");
+  assertTrueMsg(app.app().allPlansFinished(),
+                "testSameCycleAck: plan not finished in the same cycle");
+  return true;
+}
+
+// While recording, the journal must see every response, so the
+// acknowledgement goes through the queue.
+static bool testRecordingQueues()
+{
+  TestApplication app;
+  assertTrue_1(app.start());
+  Observation obs;
+  registerProbe(app, obs);
+  assertTrue_1(app.app().startRecording(JOURNAL_FILE));
+  assertTrue_1(app.addPlan(PROBE_PLAN));
+  app.run();
+  assertTrueMsg(obs.called, "testRecordingQueues: Probe command not executed");
+  assertTrueMsg(!obs.applied, "testRecordingQueues: acknowledgement applied while recording");
+  assertTrueMsg(obs.queued, "testRecordingQueues: acknowledgement not queued while recording");
+  assertTrueMsg(app.app().allPlansFinished(), "testRecordingQueues: plan not finished");
+  app.app().stopRecording();
+  remove(JOURNAL_FILE);
+  return true;
+}
+
+// An abort acknowledgement must not overtake responses already queued.
+static bool testAbortAck()
+{
+  for (int queueFirst = 0; queueFirst < 2; ++queueFirst) {
+    TestApplication app;
+    assertTrue_1(app.start());
+    Observation obs;
+    registerStall(app, obs, queueFirst);
+    app.setLookup("stop", Value(false));
+    assertTrue_1(app.addPlan(STALL_PLAN));
+    app.run();
+    assertTrueMsg(!obs.called, "testAbortAck: command aborted too soon");
+    app.setLookup("stop", Value(true));
+    app.run();
+    assertTrueMsg(obs.called, "testAbortAck: command not aborted");
+    if (queueFirst) {
+      assertTrueMsg(!obs.applied,
+                    "testAbortAck: abort ack overtook a queued response");
+      assertTrueMsg(obs.queued, "testAbortAck: abort ack not queued");
+    }
+    else {
+      assertTrueMsg(obs.applied, "testAbortAck: abort ack not applied directly");
+      assertTrueMsg(!obs.queued, "testAbortAck: abort ack was queued");
+    }
+    assertTrueMsg(app.app().allPlansFinished(), "testAbortAck: plan not finished");
+  }
+  return true;
+}
+
+bool interfaceManagerTest()
+{
+  runTest(testSameCycleAck);
+  runTest(testRecordingQueues);
+  runTest(testAbortAck);
+  return true;
+}
@@ -0,0 +1,227 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExecListener.hh"
+#include "ExecListenerHub.hh"
+#include "ListenerFilters.hh"
+#include "NodeImpl.hh"
+#include "NodeTransition.hh"
+#include "parsePlan.hh"
+#include "TestSupport.hh"
+
+#include "pugixml.hpp"
+
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace PLEXIL;
+
+// More listeners than there are bits in a listener mask
+static size_t const N_LISTENERS = 40;
+
+//! Records the IDs of the nodes whose transitions it reports.
+class RecordingListener final : public ExecListener
+{
+public:
+  RecordingListener(pugi::xml_node const xml)
+    : ExecListener(xml),
+      m_reported()
+  {
+  }
+
+  virtual ~RecordingListener() = default;
+
+  std::multiset<std::string> &reported()
+  {
+    return m_reported;
+  }
+
+protected:
+  virtual void implementNotifyNodeTransition(NodeTransition const &trans) const override
+  {
+    m_reported.insert(trans.node->getNodeId());
+  }
+
+private:
+  mutable std::multiset<std::string> m_reported;
+};
+
+//! A plan with one child per listener, "L<n>_Child".
+static std::string makePlan(char const *rootId)
+{
+  std::ostringstream s;
+  s << "<PlexilPlan><Node NodeType=\"NodeList\"><NodeId>" << rootId
+    << "</NodeId><NodeBody><NodeList>";
+  for (size_t i = 0; i < N_LISTENERS; ++i)
+    s << "<Node NodeType=\"Empty\"><NodeId>L" << i << "_Child</NodeId></Node>";
+  s << "</NodeList></NodeBody></Node></PlexilPlan>";
+  return s.str();
+}
+
+//! Listener n selects the transitions of its own child, "L<n>_Child".
+//! The last listener has no filter.
+struct HubFixture
+{
+  pugi::xml_document config;
+  ExecListenerHub hub;
+  std::vector<RecordingListener *> listeners;
+
+  HubFixture()
+    : config(),
+      hub(),
+      listeners()
+  {
+    for (size_t i = 0; i < N_LISTENERS; ++i) {
+      pugi::xml_node listenerXml = config.append_child("Listener");
+      std::ostringstream prefix;
+      prefix << 'L' << i << '_';
+      pugi::xml_node filterXml = listenerXml.append_child("Filter");
+      filterXml.append_attribute("FilterType").set_value("NodeSelection");
+      filterXml.append_child("NodeIdPrefixes").append_child(pugi::node_pcdata)
+        .set_value(prefix.str().c_str());
+      listeners.push_back(new RecordingListener(listenerXml));
+      hub.addListener(listeners.back());
+    }
+    listeners.push_back(new RecordingListener(pugi::xml_node()));
+    hub.addListener(listeners.back());
+  }
+
+  // Report one transition of every node in the plan.
+  void transitionAll(NodeImpl *root)
+  {
+    std::vector<NodeTransition> transitions;
+    transitions.push_back(NodeTransition(root, INACTIVE_STATE, WAITING_STATE));
+    for (NodeImplPtr const &child : root->getChildren())
+      transitions.push_back(NodeTransition(child.get(), INACTIVE_STATE, WAITING_STATE));
+    hub.notifyOfTransitions(transitions);
+    hub.stepComplete(1);
+  }
+
+  void clear()
+  {
+    for (RecordingListener *l : listeners)
+      l->reported().clear();
+  }
+};
+
+static NodeImpl *loadPlan(char const *rootId)
+{
+  pugi::xml_document doc;
+  std::string xml = makePlan(rootId);
+  if (doc.load_string(xml.c_str()).status != pugi::status_ok)
+    return nullptr;
+  return parsePlan(doc.document_element());
+}
+
+// Every listener reports exactly the nodes it selected.
+static bool checkReports(HubFixture &f, NodeImpl *root, char const *test)
+{
+  for (size_t i = 0; i < N_LISTENERS; ++i) {
+    std::multiset<std::string> const &reported = f.listeners[i]->reported();
+    std::string const &expected = root->getChildren()[i]->getNodeId();
+    assertTrueMsg(reported.size() == 1 && reported.count(expected) == 1,
+                  test << ": listener " << i << " reported " << reported.size()
+                  << " transitions, expected only " << expected);
+  }
+  assertTrueMsg(f.listeners[N_LISTENERS]->reported().size() == N_LISTENERS + 1,
+                test << ": unfiltered listener missed transitions");
+  return true;
+}
+
+static bool testIndexedMasks()
+{
+  HubFixture f;
+  assertTrue_1(f.hub.initialize());
+  std::unique_ptr<NodeImpl> root(loadPlan("Indexed"));
+  assertTrue_1(root);
+  f.hub.indexPlan(root.get());
+
+  uint32_t const overflowBit = ((uint32_t) 1) << 31;
+  // Only the unfiltered listener, which shares the last bit, selects the root
+  assertTrueMsg(root->getListenerMask() == overflowBit,
+                "testIndexedMasks: root mask " << std::hex << root->getListenerMask());
+  for (size_t i = 0; i < N_LISTENERS; ++i) {
+    uint32_t expected = overflowBit;
+    if (i < 31)
+      expected |= ((uint32_t) 1) << i;
+    uint32_t mask = root->getChildren()[i]->getListenerMask();
+    assertTrueMsg(mask == expected,
+                  "testIndexedMasks: child " << i << " mask " << std::hex << mask
+                  << ", expected " << expected);
+  }
+
+  f.transitionAll(root.get());
+  return checkReports(f, root.get(), "testIndexedMasks");
+}
+
+// The selection made at plan-add time is used for each event.
+static bool testRecordedSelection()
+{
+  HubFixture f;
+  assertTrue_1(f.hub.initialize());
+  std::unique_ptr<NodeImpl> root(loadPlan("Recorded"));
+  assertTrue_1(root);
+  f.hub.indexPlan(root.get());
+
+  // Hand listener 3 a node it did not select
+  Node *other = root->getChildren()[4].get();
+  other->setListenerMask(other->getListenerMask() | (((uint32_t) 1) << 3));
+  f.transitionAll(root.get());
+  assertTrueMsg(f.listeners[3]->reported().count(other->getNodeId()) == 1,
+                "testRecordedSelection: filter did not use the recorded selection");
+
+  // Listeners sharing the last bit still check each event
+  for (size_t i = 31; i < N_LISTENERS; ++i)
+    assertTrueMsg(f.listeners[i]->reported().size() == 1,
+                  "testRecordedSelection: listener " << i << " reported "
+                  << f.listeners[i]->reported().size() << " transitions");
+  return true;
+}
+
+// Plans which are not indexed are filtered event by event.
+static bool testUnindexedPlan()
+{
+  HubFixture f;
+  assertTrue_1(f.hub.initialize());
+  std::unique_ptr<NodeImpl> root(loadPlan("Unindexed"));
+  assertTrue_1(root);
+  assertTrue_1(root->getListenerMask() == ~(uint32_t) 0);
+
+  f.transitionAll(root.get());
+  return checkReports(f, root.get(), "testUnindexedPlan");
+}
+
+bool listenerHubTest()
+{
+  registerExecListenerFilters();
+  runTest(testIndexedMasks);
+  runTest(testRecordedSelection);
+  runTest(testUnindexedPlan);
+  return true;
+}
@@ -0,0 +1,287 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AdapterExecInterface.hh"
+#include "Command.hh"
+#include "MessageQueueMap.hh"
+#include "State.hh"
+#include "TestSupport.hh"
+
+#include "pugixml.hpp"
+
+#include <utility>
+#include <vector>
+
+using namespace PLEXIL;
+
+//! A Command which only has a name.
+class TestCommand final : public Command
+{
+public:
+  TestCommand(std::string const &name)
+    : m_state(name)
+  {
+  }
+
+  virtual ~TestCommand() = default;
+
+  virtual State const &getCommand() const override { return m_state; }
+  virtual std::string const &getName() const override { return m_state.name(); }
+  virtual std::vector<Value> const &getArgValues() const override { return m_state.parameters(); }
+  virtual bool isReturnExpected() const override { return true; }
+
+private:
+  State m_state;
+};
+
+//! Records the command return values it is given.
+class ReturnRecorder final : public AdapterExecInterface
+{
+public:
+  ReturnRecorder()
+    : returns(),
+      events(0)
+  {
+  }
+
+  virtual ~ReturnRecorder() = default;
+
+  virtual void handleValueChange(State const & /* state */, const Value & /* value */) override {}
+  virtual void handleValueChange(State const & /* state */, Value && /* value */) override {}
+  virtual void handleValueChange(State && /* state */, const Value & /* value */) override {}
+  virtual void handleValueChange(State && /* state */, Value && /* value */) override {}
+  virtual void handleCommandAck(Command * /* cmd */, CommandHandleValue /* value */) override {}
+
+  virtual void handleCommandReturn(Command *cmd, Value const &value) override
+  {
+    returns.emplace_back(cmd, value);
+  }
+
+  virtual void handleCommandReturn(Command *cmd, Value &&value) override
+  {
+    returns.emplace_back(cmd, std::move(value));
+  }
+
+  virtual void handleCommandAbortAck(Command * /* cmd */, bool /* ack */) override {}
+  virtual void handleUpdateAck(Update * /* upd */, bool /* ack */) override {}
+  virtual void notifyMessageReceived(Message * /* message */) override {}
+  virtual void notifyMessageQueueEmpty() override {}
+  virtual void notifyMessageAccepted(Message * /* message */, std::string const & /* handle */) override {}
+  virtual void notifyMessageHandleReleased(std::string const & /* handle */) override {}
+  virtual void handleAddPlan(pugi::xml_node const /* planXml */) override {}
+  virtual bool handleAddLibrary(pugi::xml_document * /* planXml */) override { return true; }
+  virtual void notifyOfExternalEvent() override { ++events; }
+  virtual void notifyAndWaitForCompletion() override {}
+
+  std::vector<std::pair<Command *, Value>> returns;
+  unsigned int events;
+};
+
+static bool checkReturn(ReturnRecorder const &rec, size_t i, Command *cmd, Integer expected)
+{
+  if (rec.returns.size() <= i)
+    return false;
+  Integer actual;
+  return rec.returns[i].first == cmd
+    && rec.returns[i].second.getValue(actual)
+    && actual == expected;
+}
+
+// Messages and recipients are paired in arrival order, whichever
+// arrives first.
+static bool testPairing()
+{
+  ReturnRecorder rec;
+  MessageQueueMap map(rec);
+  TestCommand a("a"), b("b"), c("c");
+
+  map.addMessage("m", Value((Integer) 1));
+  map.addMessage("m", Value((Integer) 2));
+  assertTrue_1(rec.returns.empty());
+  map.addRecipient("m", &a);
+  map.addRecipient("m", &b);
+  map.addRecipient("m", &c);
+  assertTrue_1(rec.returns.size() == 2);
+  assertTrue_1(checkReturn(rec, 0, &a, 1));
+  assertTrue_1(checkReturn(rec, 1, &b, 2));
+
+  // Messages of another name don't satisfy the waiting recipient
+  map.addMessage("other", Value((Integer) 9));
+  assertTrue_1(rec.returns.size() == 2);
+  map.addMessage("m", Value((Integer) 3));
+  assertTrue_1(checkReturn(rec, 2, &c, 3));
+  assertTrue_1(rec.events == 3);
+
+  MessageQueueStatistics stats;
+  assertTrue_1(map.getStatistics("m", stats));
+  assertTrue_1(stats.messagesReceived == 3);
+  assertTrue_1(stats.messagesDelivered == 3);
+  assertTrue_1(stats.messagesDropped == 0);
+  assertTrue_1(stats.recipientsAdded == 3);
+  assertTrue_1(stats.messagesPending == 0);
+  assertTrue_1(stats.recipientsWaiting == 0);
+  assertTrue_1(stats.messagesHighWater == 2);
+  assertTrue_1(map.getStatistics("other", stats));
+  assertTrue_1(stats.messagesPending == 1);
+  assertTrue_1(!map.getStatistics("none", stats));
+
+  std::vector<MessageQueueStatistics> all;
+  map.getAllStatistics(all);
+  assertTrue_1(all.size() == 2);
+  return true;
+}
+
+static bool testBound(QueueDropPolicy policy)
+{
+  ReturnRecorder rec;
+  MessageQueueMap map(rec);
+  map.setQueueBound(2, policy);
+  for (Integer i = 1; i <= 5; ++i)
+    map.addMessage("m", Value(i));
+
+  MessageQueueStatistics stats;
+  assertTrue_1(map.getStatistics("m", stats));
+  assertTrue_1(stats.messagesReceived == 5);
+  assertTrue_1(stats.messagesDropped == 3);
+  assertTrue_1(stats.messagesPending == 2);
+  assertTrue_1(stats.messagesHighWater == 2);
+
+  TestCommand a("a"), b("b");
+  map.addRecipient("m", &a);
+  map.addRecipient("m", &b);
+  Integer first = (policy == QUEUE_DROP_OLDEST) ? 4 : 1;
+  assertTrue_1(checkReturn(rec, 0, &a, first));
+  assertTrue_1(checkReturn(rec, 1, &b, first + 1));
+
+  // The bound applies to the messages waiting, not to recipients
+  TestCommand waiting[4] {{"w0"}, {"w1"}, {"w2"}, {"w3"}};
+  for (TestCommand &cmd : waiting)
+    map.addRecipient("m", &cmd);
+  assertTrue_1(map.getStatistics("m", stats));
+  assertTrue_1(stats.recipientsWaiting == 4);
+  return true;
+}
+
+static bool testDropOldest()
+{
+  return testBound(QUEUE_DROP_OLDEST);
+}
+
+static bool testDropNewest()
+{
+  return testBound(QUEUE_DROP_NEWEST);
+}
+
+// A new bound applies to queues which already exist.
+static bool testSetBound()
+{
+  ReturnRecorder rec;
+  MessageQueueMap map(rec);
+  for (Integer i = 1; i <= 5; ++i) {
+    map.addMessage("m", Value(i));
+    map.addMessage("n", Value(i));
+  }
+  map.setQueueBound(3, QUEUE_DROP_OLDEST);
+
+  MessageQueueStatistics stats;
+  assertTrue_1(map.getStatistics("m", stats));
+  assertTrue_1(stats.messagesPending == 3);
+  assertTrue_1(stats.messagesDropped == 2);
+  assertTrue_1(stats.messagesHighWater == 5);
+  assertTrue_1(map.getStatistics("n", stats));
+  assertTrue_1(stats.messagesPending == 3);
+
+  TestCommand a("a");
+  map.addRecipient("n", &a);
+  assertTrue_1(checkReturn(rec, 0, &a, 3));
+
+  // Unbounded again
+  map.setQueueBound(0, QUEUE_DROP_OLDEST);
+  for (Integer i = 0; i < 10; ++i)
+    map.addMessage("m", Value(i));
+  assertTrue_1(map.getStatistics("m", stats));
+  assertTrue_1(stats.messagesPending == 13);
+  return true;
+}
+
+// Without duplicates, only the newest message waits.
+static bool testNoDuplicates()
+{
+  ReturnRecorder rec;
+  MessageQueueMap map(rec, false);
+  assertTrue_1(!map.getAllowDuplicateMessages());
+  for (Integer i = 1; i <= 3; ++i)
+    map.addMessage("m", Value(i));
+
+  MessageQueueStatistics stats;
+  assertTrue_1(map.getStatistics("m", stats));
+  assertTrue_1(stats.messagesPending == 1);
+  assertTrue_1(stats.messagesDropped == 2);
+
+  TestCommand a("a");
+  map.addRecipient("m", &a);
+  assertTrue_1(checkReturn(rec, 0, &a, 3));
+  return true;
+}
+
+static bool testConfigure()
+{
+  ReturnRecorder rec;
+  MessageQueueMap map(rec);
+  pugi::xml_document doc;
+  pugi::xml_node xml = doc.append_child("Adapter");
+  xml.append_attribute("MessageQueueLimit").set_value(2);
+  xml.append_attribute("MessageQueueDropPolicy").set_value("Newest");
+  assertTrue_1(map.configure(xml));
+  for (Integer i = 1; i <= 3; ++i)
+    map.addMessage("m", Value(i));
+  TestCommand a("a");
+  map.addRecipient("m", &a);
+  assertTrue_1(checkReturn(rec, 0, &a, 1));
+
+  size_t bound = 7;
+  QueueDropPolicy policy = QUEUE_DROP_NEWEST;
+  pugi::xml_node empty = doc.append_child("Adapter");
+  assertTrue_1(parseMessageQueueBound(empty, bound, policy));
+  assertTrue_1(bound == 7 && policy == QUEUE_DROP_NEWEST);
+  xml.attribute("MessageQueueDropPolicy").set_value("Oldest");
+  assertTrue_1(parseMessageQueueBound(xml, bound, policy));
+  assertTrue_1(bound == 2 && policy == QUEUE_DROP_OLDEST);
+  xml.attribute("MessageQueueDropPolicy").set_value("Bogus");
+  assertTrue_1(!map.configure(xml));
+  return true;
+}
+
+bool messageQueueMapTest()
+{
+  runTest(testPairing);
+  runTest(testDropOldest);
+  runTest(testDropNewest);
+  runTest(testSetBound);
+  runTest(testNoDuplicates);
+  runTest(testConfigure);
+  return true;
+}
@@ -0,0 +1,192 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "ExecListenerBase.hh"
+#include "Node.hh"
+#include "NodeTransition.hh"
+#include "PlexilExec.hh"
+#include "TestSupport.hh"
+
+#include <string>
+#include <vector>
+
+using namespace PLEXIL;
+
+static char const *HEAVY = "Heavy";
+static char const *LIGHT = "Light";
+static size_t const CHAIN_LENGTH = 10;
+
+//! The transitions of each micro step.
+using StepLog = std::vector<std::vector<std::string>>;
+
+//! Stands between the Exec and its listener, logging the
+//! transitions of each micro step as the Exec reports them.
+class MicroStepRecorder final : public ExecListenerBase
+{
+public:
+  MicroStepRecorder(PlexilExec *exec, StepLog &steps)
+    : ExecListenerBase(),
+      m_exec(exec),
+      m_next(exec->getExecListener()),
+      m_steps(steps)
+  {
+    m_exec->setExecListener(this);
+  }
+
+  virtual ~MicroStepRecorder()
+  {
+    m_exec->setExecListener(m_next);
+  }
+
+  virtual void notifyOfTransitions(std::vector<NodeTransition> const &transitions) override
+  {
+    m_steps.emplace_back();
+    for (NodeTransition const &trans : transitions)
+      m_steps.back().push_back(trans.node->getNodeId() + ' '
+                               + nodeStateName(trans.oldState) + "->"
+                               + nodeStateName(trans.newState));
+    m_next->notifyOfTransitions(transitions);
+  }
+
+  virtual void notifyOfAssignment(Expression const *dest,
+                                  std::string const &destName,
+                                  Value const &value) override
+  {
+    m_next->notifyOfAssignment(dest, destName, value);
+  }
+
+  virtual void stepComplete(unsigned int cycleNum) override
+  {
+    m_next->stepComplete(cycleNum);
+  }
+
+private:
+  // Not implemented
+  MicroStepRecorder(MicroStepRecorder const &) = delete;
+  MicroStepRecorder &operator=(MicroStepRecorder const &) = delete;
+
+  PlexilExec *m_exec;
+  ExecListenerBase *m_next;
+  StepLog &m_steps;
+};
+
+static bool runPlans(unsigned int heavyWeight, StepLog &steps)
+{
+  TestApplication app;
+  assertTrue_1(app.start());
+  MicroStepRecorder recorder(app.app().exec(), steps);
+  app.app().setPlanWeight(HEAVY, heavyWeight);
+  // The light plan is older, so it would be served first at equal weight
+  assertTrue_1(app.addPlan(chainPlan(LIGHT, CHAIN_LENGTH).c_str()));
+  assertTrue_1(app.addPlan(chainPlan(HEAVY, CHAIN_LENGTH).c_str()));
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+  return true;
+}
+
+static bool servedIn(std::vector<std::string> const &step, std::string const &plan)
+{
+  for (std::string const &trans : step)
+    if (!trans.compare(0, plan.size(), plan))
+      return true;
+  return false;
+}
+
+// While both plans have work, weights of 3 and 1 give them micro
+// steps in the ratio 3:1, and the light plan still gets every third.
+static bool testWeightedService()
+{
+  StepLog steps;
+  if (!runPlans(3, steps))
+    return false;
+
+  std::string const heavyDone = std::string(HEAVY) + " ITERATION_ENDED->FINISHED";
+  size_t heavyServed = 0;
+  size_t lightServed = 0;
+  size_t sinceLight = 0;
+  bool heavyFinished = false;
+  for (std::vector<std::string> const &step : steps) {
+    if (servedIn(step, HEAVY))
+      ++heavyServed;
+    if (servedIn(step, LIGHT)) {
+      ++lightServed;
+      sinceLight = 0;
+    }
+    else
+      assertTrueMsg(++sinceLight < 3,
+                    "testWeightedService: light plan starved for "
+                    << sinceLight << " micro steps");
+    for (std::string const &trans : step)
+      if (trans == heavyDone)
+        heavyFinished = true;
+    if (heavyFinished)
+      break;
+  }
+  assertTrueMsg(heavyFinished, "testWeightedService: heavy plan never finished");
+  assertTrueMsg(heavyServed == 3 * lightServed,
+                "testWeightedService: heavy plan served in " << heavyServed
+                << " micro steps, light plan in " << lightServed);
+  return true;
+}
+
+// Nodes of one plan are checked, and so transition, in the order
+// they were queued, whatever the plan's weight.
+static bool testFifoWithinPlan()
+{
+  for (unsigned int weight : {1, 3}) {
+    StepLog steps;
+    if (!runPlans(weight, steps))
+      return false;
+    for (char const *plan : {HEAVY, LIGHT}) {
+      std::string const root(plan);
+      std::vector<std::string> started;
+      for (std::vector<std::string> const &step : steps)
+        for (std::string const &trans : step) {
+          std::string const nodeId = trans.substr(0, trans.find(' '));
+          if (nodeId != root && !nodeId.compare(0, root.size(), root)
+              && trans.find(" INACTIVE->WAITING") != std::string::npos)
+            started.push_back(nodeId);
+        }
+      assertTrueMsg(started.size() == CHAIN_LENGTH,
+                    "testFifoWithinPlan: " << started.size() << " children of "
+                    << plan << " started");
+      for (size_t i = 0; i < CHAIN_LENGTH; ++i)
+        assertTrueMsg(started[i] == root + std::to_string(i),
+                      "testFifoWithinPlan: weight " << weight << ", child " << i
+                      << " of " << plan << " is " << started[i]);
+    }
+  }
+  return true;
+}
+
+bool planSchedulerTest()
+{
+  runTest(testWeightedService);
+  runTest(testFifoWithinPlan);
+  return true;
+}
@@ -0,0 +1,226 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "CommandImpl.hh"
+#include "Constant.hh"
+#include "Dispatcher.hh"
+#include "QueueEntry.hh"
+#include "QueueJournal.hh"
+#include "TestSupport.hh"
+#include "Update.hh"
+
+#include <memory>
+
+#include <cstdio> // remove()
+
+using namespace PLEXIL;
+
+//! A Dispatcher which does nothing.
+class NullDispatcher final : public Dispatcher
+{
+public:
+  NullDispatcher() = default;
+  virtual ~NullDispatcher() = default;
+
+  virtual void lookupNow(State const & /* state */, LookupReceiver * /* rcvr */) override {}
+  virtual void setThresholds(const State & /* state */, Real /* hi */, Real /* lo */) override {}
+  virtual void setThresholds(const State & /* state */, Integer /* hi */, Integer /* lo */) override {}
+  virtual void clearThresholds(const State & /* state */) override {}
+  virtual void executeCommand(Command * /* cmd */) override {}
+  virtual void reportCommandArbitrationFailure(Command * /* cmd */) override {}
+  virtual void invokeAbort(Command * /* cmd */) override {}
+  virtual void executeUpdate(Update * /* upd */) override {}
+};
+
+//! An Update with no pairs.
+class TestUpdate final : public Update
+{
+public:
+  TestUpdate()
+    : m_pairs(),
+      m_nodeId("TestUpdate"),
+      m_next(nullptr)
+  {
+  }
+
+  virtual ~TestUpdate() = default;
+
+  virtual const PairValueMap &getPairs() const override { return m_pairs; }
+  virtual std::string const &getNodeId() const override { return m_nodeId; }
+  virtual void acknowledge(bool /* ack */) override {}
+  virtual Update *next() const override { return m_next; }
+  virtual Update **nextPtr() override { return &m_next; }
+
+private:
+  PairValueMap m_pairs;
+  std::string m_nodeId;
+  Update *m_next;
+};
+
+static char const *JOURNAL_FILE = "queueJournalTest.journal";
+
+static bool testIdRelease()
+{
+  NullDispatcher target;
+  std::unique_ptr<QueueRecorder> recorder(makeQueueRecorder(JOURNAL_FILE, &target));
+  assertTrue_1(recorder);
+
+  CommandImpl finished("Finished");
+  finished.setNameExpr(new StringConstant("Foo"), true);
+  finished.activate();
+  finished.fixValues();
+  CommandImpl aborted("Aborted");
+  aborted.setNameExpr(new StringConstant("Bar"), true);
+  aborted.activate();
+  aborted.fixValues();
+  TestUpdate update;
+
+  recorder->executeCommand(&finished);
+  recorder->executeCommand(&aborted);
+  recorder->executeUpdate(&update);
+  assertTrueMsg(recorder->pendingIdCount() == 3,
+                "testIdRelease: expected 3 pending IDs, got "
+                << recorder->pendingIdCount());
+
+  // Active commands survive the end of a step
+  recorder->stepComplete();
+  assertTrueMsg(recorder->pendingIdCount() == 3,
+                "testIdRelease: active command IDs released");
+
+  // The update acknowledgement is final
+  QueueEntry entry;
+  entry.initForUpdateAck(&update, true);
+  recorder->recordQueueEntry(entry);
+  assertTrueMsg(recorder->pendingIdCount() == 2,
+                "testIdRelease: update ID not released after acknowledgement");
+
+  // So is the abort acknowledgement
+  entry.initForCommandAbort(&aborted, true);
+  recorder->recordQueueEntry(entry);
+  assertTrueMsg(recorder->pendingIdCount() == 1,
+                "testIdRelease: command ID not released after abort acknowledgement");
+
+  // A command's handle may change many times while it is active
+  entry.initForCommandAck(&finished, COMMAND_SENT_TO_SYSTEM);
+  recorder->recordQueueEntry(entry);
+  entry.initForCommandAck(&finished, COMMAND_SUCCESS);
+  recorder->recordQueueEntry(entry);
+  assertTrueMsg(recorder->pendingIdCount() == 1,
+                "testIdRelease: command ID released while the command is active");
+
+  finished.deactivate(nullptr);
+  aborted.deactivate(nullptr);
+  recorder->stepComplete();
+  assertTrueMsg(recorder->pendingIdCount() == 0,
+                "testIdRelease: inactive command ID not released");
+
+  recorder.reset();
+  finished.cleanUp();
+  aborted.cleanUp();
+  remove(JOURNAL_FILE);
+  return true;
+}
+
+static char const *ROUND_TRIP_PLAN =
+  "<PlexilPlan>\n"
+  " <GlobalDeclarations>\n"
+  "  <CommandDeclaration><Name>GetValue</Name>"
+  "<Return><Name>_return_0</Name><Type>Integer</Type></Return></CommandDeclaration>\n"
+  "  <CommandDeclaration><Name>Hold</Name></CommandDeclaration>\n"
+  "  <StateDeclaration><Name>counter</Name>"
+  "<Return><Name>_return_0</Name><Type>Integer</Type></Return></StateDeclaration>\n"
+  " </GlobalDeclarations>\n"
+  " <Node NodeType=\"NodeList\"><NodeId>RoundTrip</NodeId>\n"
+  "  <VariableDeclarations><DeclareVariable><Name>x</Name><Type>Integer</Type></DeclareVariable></VariableDeclarations>\n"
+  "  <NodeBody><NodeList>\n"
+  "   <Node NodeType=\"Command\"><NodeId>Fetch</NodeId>\n"
+  "    <EndCondition><IsKnown><IntegerVariable>x</IntegerVariable></IsKnown></EndCondition>\n"
+  "    <NodeBody><Command><IntegerVariable>x</IntegerVariable>"
+  "<Name><StringValue>GetValue</StringValue></Name></Command></NodeBody>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Command\"><NodeId>Wait</NodeId>\n"
+  "    <EndCondition><AND>"
+  "<GE><LookupOnChange><Name><StringValue>counter</StringValue></Name></LookupOnChange>"
+  "<IntegerValue>3</IntegerValue></GE>"
+  "<EQInternal><NodeCommandHandleVariable><NodeId>Wait</NodeId></NodeCommandHandleVariable>"
+  "<NodeCommandHandleValue>COMMAND_SUCCESS</NodeCommandHandleValue></EQInternal>"
+  "</AND></EndCondition>\n"
+  "    <NodeBody><Command><Name><StringValue>Hold</StringValue></Name></Command></NodeBody>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Empty\"><NodeId>After</NodeId>\n"
+  "    <StartCondition><Finished><NodeRef dir=\"sibling\">Wait</NodeRef></Finished></StartCondition>\n"
+  "   </Node>\n"
+  "  </NodeList></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+static bool testRecordReplay()
+{
+  TestApplication app;
+  assertTrue_1(app.start());
+  assertTrue_1(app.app().startRecording(JOURNAL_FILE));
+  app.setLookup("counter", Value((Integer) 0));
+  assertTrue_1(app.addPlan(ROUND_TRIP_PLAN));
+  app.run();
+  for (Integer i = 1; i <= 3; ++i) {
+    app.setTime((double) i);
+    app.setLookup("counter", Value(i));
+    app.run();
+  }
+  assertTrueMsg(app.heldCount() == 1,
+                "testRecordReplay: Hold command not executed");
+  app.releaseHeld(COMMAND_SUCCESS);
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+  app.app().stopRecording();
+
+  std::vector<std::string> recorded;
+  recorded.swap(app.transitions());
+  assertTrueMsg(!recorded.empty(), "testRecordReplay: no transitions recorded");
+
+  assertTrue_1(app.app().reset());
+  assertTrue_1(app.app().replay(JOURNAL_FILE));
+  std::vector<std::string> const &replayed = app.transitions();
+  assertTrueMsg(replayed.size() == recorded.size(),
+                "testRecordReplay: recorded " << recorded.size()
+                << " transitions, replayed " << replayed.size());
+  for (size_t i = 0; i < recorded.size(); ++i)
+    assertTrueMsg(replayed[i] == recorded[i],
+                  "testRecordReplay: transition " << i << " recorded as "
+                  << recorded[i] << ", replayed as " << replayed[i]);
+
+  remove(JOURNAL_FILE);
+  return true;
+}
+
+bool queueJournalTest()
+{
+  runTest(testIdRelease);
+  runTest(testRecordReplay);
+  return true;
+}
@@ -0,0 +1,153 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "RingQueue.hh"
+#include "TestSupport.hh"
+
+#include <memory>
+
+using namespace PLEXIL;
+
+// Items come out in the order they went in, across buffer growth and
+// wraparound.
+static bool testFifo()
+{
+  RingQueue<int> q;
+  assertTrue_1(q.empty());
+  assertTrue_1(q.bound() == 0);
+
+  // Move the head partway into the initial buffer, so that the
+  // contents wrap around before the buffer grows
+  int next = 0, expected = 0;
+  for (int i = 0; i < 6; ++i)
+    assertTrue_1(q.push(next++) == 0);
+  for (int i = 0; i < 4; ++i) {
+    assertTrue_1(q.front() == expected++);
+    q.pop();
+  }
+  for (int i = 0; i < 30; ++i)
+    assertTrue_1(q.push(next++) == 0);
+  assertTrue_1(q.size() == 32);
+  while (!q.empty()) {
+    assertTrueMsg(q.front() == expected,
+                  "testFifo: expected " << expected << ", got " << q.front());
+    ++expected;
+    q.pop();
+  }
+  assertTrue_1(expected == next);
+  return true;
+}
+
+static bool testDropOldest()
+{
+  RingQueue<int> q(3, QUEUE_DROP_OLDEST);
+  for (int i = 1; i <= 3; ++i)
+    assertTrue_1(q.push(i) == 0);
+  assertTrue_1(q.push(4) == 1);
+  assertTrue_1(q.push(5) == 1);
+  assertTrue_1(q.size() == 3);
+  for (int i = 3; i <= 5; ++i) {
+    assertTrue_1(q.front() == i);
+    q.pop();
+  }
+  assertTrue_1(q.empty());
+  return true;
+}
+
+static bool testDropNewest()
+{
+  RingQueue<int> q(3, QUEUE_DROP_NEWEST);
+  for (int i = 1; i <= 3; ++i)
+    assertTrue_1(q.push(i) == 0);
+  assertTrue_1(q.push(4) == 1);
+  assertTrue_1(q.push(5) == 1);
+  assertTrue_1(q.size() == 3);
+  for (int i = 1; i <= 3; ++i) {
+    assertTrue_1(q.front() == i);
+    q.pop();
+  }
+  assertTrue_1(q.empty());
+  return true;
+}
+
+// Lowering the bound discards items according to the new policy.
+static bool testSetBound()
+{
+  RingQueue<int> q;
+  for (int i = 1; i <= 6; ++i)
+    q.push(i);
+
+  assertTrue_1(q.setBound(4, QUEUE_DROP_OLDEST) == 2);
+  assertTrue_1(q.size() == 4);
+  assertTrue_1(q.front() == 3);
+
+  assertTrue_1(q.setBound(2, QUEUE_DROP_NEWEST) == 2);
+  assertTrue_1(q.size() == 2);
+  assertTrue_1(q.policy() == QUEUE_DROP_NEWEST);
+  assertTrue_1(q.push(7) == 1);
+  assertTrue_1(q.front() == 3);
+  q.pop();
+  assertTrue_1(q.front() == 4);
+
+  // Raising the bound discards nothing
+  assertTrue_1(q.setBound(0, QUEUE_DROP_OLDEST) == 0);
+  for (int i = 0; i < 20; ++i)
+    assertTrue_1(q.push(i) == 0);
+  assertTrue_1(q.size() == 21);
+  assertTrue_1(q.clear() == 21);
+  assertTrue_1(q.empty());
+  return true;
+}
+
+// Items which leave the queue, by any route, are released at once.
+static bool testRelease()
+{
+  std::shared_ptr<int> item = std::make_shared<int>(0);
+  RingQueue<std::shared_ptr<int>> q(2, QUEUE_DROP_OLDEST);
+  q.push(item);
+  q.push(item);
+  assertTrue_1(item.use_count() == 3);
+  q.pop();
+  assertTrue_1(item.use_count() == 2);
+  q.push(item);
+  q.push(item); // drops one
+  assertTrue_1(item.use_count() == 3);
+  q.setBound(1, QUEUE_DROP_NEWEST);
+  assertTrue_1(item.use_count() == 2);
+  q.clear();
+  assertTrue_1(item.use_count() == 1);
+  return true;
+}
+
+bool ringQueueTest()
+{
+  runTest(testFifo);
+  runTest(testDropOldest);
+  runTest(testDropNewest);
+  runTest(testSetBound);
+  runTest(testRelease);
+  return true;
+}
@@ -0,0 +1,209 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "AppTestSupport.hh"
+
+#include "PlexilExec.hh"
+#include "TestSupport.hh"
+
+#include <algorithm> // std::find()
+#include <cstdio> // remove()
+
+using namespace PLEXIL;
+
+static char const *JOURNAL_FILE = "timeSliceTest.journal";
+
+// Runs to completion in two macro steps, the first of many micro
+// steps; the assignment ends the first
+static char const *CHAIN_PLAN =
+  "<PlexilPlan>\n"
+  " <Node NodeType=\"NodeList\"><NodeId>Chain</NodeId>\n"
+  "  <VariableDeclarations><DeclareVariable><Name>x</Name><Type>Integer</Type>"
+  "<InitialValue><IntegerValue>0</IntegerValue></InitialValue></DeclareVariable></VariableDeclarations>\n"
+  "  <NodeBody><NodeList>\n"
+  "   <Node NodeType=\"Assignment\"><NodeId>One</NodeId>\n"
+  "    <NodeBody><Assignment><IntegerVariable>x</IntegerVariable>"
+  "<NumericRHS><IntegerValue>1</IntegerValue></NumericRHS></Assignment></NodeBody>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Empty\"><NodeId>Two</NodeId>\n"
+  "    <StartCondition><Finished><NodeRef dir=\"sibling\">One</NodeRef></Finished></StartCondition>\n"
+  "   </Node>\n"
+  "   <Node NodeType=\"Empty\"><NodeId>Three</NodeId>\n"
+  "    <StartCondition><Finished><NodeRef dir=\"sibling\">Two</NodeRef></Finished></StartCondition>\n"
+  "   </Node>\n"
+  "  </NodeList></NodeBody>\n"
+  " </Node>\n"
+  "</PlexilPlan>\n";
+
+static bool sameTransitions(char const *test,
+                            std::vector<std::string> const &expected,
+                            std::vector<std::string> const &actual)
+{
+  assertTrueMsg(actual.size() == expected.size(),
+                test << ": expected " << expected.size()
+                << " transitions, got " << actual.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+    assertTrueMsg(actual[i] == expected[i],
+                  test << ": transition " << i << " expected "
+                  << expected[i] << ", got " << actual[i]);
+  return true;
+}
+
+// A budget never divides a plan's step: the plan runs on to
+// quiescence after the budget is spent, and steps just as it would
+// without one.
+static bool testPlanStepAtomic()
+{
+  std::vector<std::string> expected;
+  std::vector<size_t> expectedSizes;
+  {
+    TestApplication app;
+    assertTrue_1(app.start());
+    assertTrue_1(app.addPlan(CHAIN_PLAN));
+    app.run();
+    assertTrue_1(app.app().allPlansFinished());
+    expectedSizes.swap(app.stepSizes());
+    expected.swap(app.transitions());
+  }
+
+  TestApplication app;
+  assertTrue_1(app.start());
+  app.app().setTimeSlice(1, 0);
+  assertTrue_1(app.addPlan(CHAIN_PLAN));
+  assertTrue_1(app.app().step());
+  assertTrueMsg(app.app().exec()->timeSliceExpired(),
+                "testPlanStepAtomic: first step didn't exhaust its slice");
+  assertTrueMsg(app.app().exec()->getTimeSliceMicroSteps() == 1,
+                "testPlanStepAtomic: " << app.app().exec()->getTimeSliceMicroSteps()
+                << " micro steps charged to a slice of 1");
+  assertTrueMsg(app.stepSizes().size() == 1 && app.stepSizes()[0] == expectedSizes[0],
+                "testPlanStepAtomic: first step divided by the budget");
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+  assertTrueMsg(app.stepSizes() == expectedSizes,
+                "testPlanStepAtomic: budget changed the macro steps");
+  return sameTransitions("testPlanStepAtomic", expected, app.transitions());
+}
+
+static char const *HEAVY = "Heavy";
+static char const *LIGHT = "Light";
+static size_t const CHAIN_LENGTH = 5;
+
+static bool startWeightedPlans(TestApplication &app, char const *journal = nullptr)
+{
+  assertTrue_1(app.start());
+  app.app().setPlanWeight(HEAVY, 3);
+  app.app().setTimeSlice(1, 0);
+  if (journal)
+    assertTrue_1(app.app().startRecording(journal));
+  assertTrue_1(app.addPlan(chainPlan(LIGHT, CHAIN_LENGTH).c_str()));
+  assertTrue_1(app.addPlan(chainPlan(HEAVY, CHAIN_LENGTH).c_str()));
+  return true;
+}
+
+static size_t countTransitions(std::vector<std::string> const &transitions,
+                               size_t begin, size_t end,
+                               std::string const &plan)
+{
+  size_t result = 0;
+  for (size_t i = begin; i < end; ++i)
+    if (!transitions[i].compare(0, plan.size(), plan))
+      ++result;
+  return result;
+}
+
+// A plan not yet served when the budget runs out waits for the next
+// step, after the input queue has been processed.
+static bool testDeferUnservedPlans()
+{
+  TestApplication app;
+  if (!startWeightedPlans(app))
+    return false;
+
+  // The light plan is outweighed in the first micro step
+  assertTrue_1(app.app().step());
+  std::vector<std::string> const &transitions = app.transitions();
+  size_t const firstStep = transitions.size();
+  std::string const heavyDone = std::string(HEAVY) + " ITERATION_ENDED->FINISHED";
+  assertTrueMsg(std::find(transitions.begin(), transitions.end(), heavyDone)
+                != transitions.end(),
+                "testDeferUnservedPlans: heavy plan didn't finish its step");
+  assertTrueMsg(countTransitions(transitions, 0, firstStep, LIGHT) == 0,
+                "testDeferUnservedPlans: light plan served after the budget ran out");
+  assertTrueMsg(app.app().exec()->needsStep(),
+                "testDeferUnservedPlans: light plan lost its queued nodes");
+
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+  assertTrueMsg(countTransitions(transitions, firstStep, transitions.size(), LIGHT)
+                == transitions.size() - firstStep,
+                "testDeferUnservedPlans: light plan not run in later steps");
+  return true;
+}
+
+// Replay defers the plans the recorded step deferred, even when no
+// budget is in effect during replay.
+static bool testStepLimitReplay()
+{
+  TestApplication app;
+  if (!startWeightedPlans(app, JOURNAL_FILE))
+    return false;
+  app.run();
+  assertTrue_1(app.app().allPlansFinished());
+  app.app().stopRecording();
+
+  std::vector<std::string> recorded;
+  recorded.swap(app.transitions());
+  std::vector<size_t> recordedSizes;
+  recordedSizes.swap(app.stepSizes());
+  assertTrueMsg(recordedSizes.size() > 1,
+                "testStepLimitReplay: budget deferred no plan");
+
+  app.app().setTimeSlice(0, 0);
+  assertTrue_1(app.app().reset());
+  assertTrue_1(app.app().replay(JOURNAL_FILE));
+  std::vector<size_t> const &replayedSizes = app.stepSizes();
+  assertTrueMsg(replayedSizes.size() == recordedSizes.size(),
+                "testStepLimitReplay: recorded " << recordedSizes.size()
+                << " macro steps, replayed " << replayedSizes.size());
+  for (size_t i = 0; i < recordedSizes.size(); ++i)
+    assertTrueMsg(replayedSizes[i] == recordedSizes[i],
+                  "testStepLimitReplay: macro step " << i << " recorded with "
+                  << recordedSizes[i] << " transitions, replayed with "
+                  << replayedSizes[i]);
+  bool result = sameTransitions("testStepLimitReplay", recorded, app.transitions());
+
+  remove(JOURNAL_FILE);
+  return result;
+}
+
+bool timeSliceTest()
+{
+  runTest(testPlanStepAtomic);
+  runTest(testDeferUnservedPlans);
+  runTest(testStepLimitReplay);
+  return true;
+}
@@ -30,6 +30,7 @@
 #include "ThreadSemaphore.hh"
 #include "TimebaseFactory.hh"
 
+#include <algorithm> // std::find()
 #include <fstream>
 #include <iomanip> // std::fixed, std::setprecision()
 #include <memory>
@@ -206,6 +207,74 @@ static bool testTimebaseTick(std::string const &name)
   return false;
 }
 
+//! \brief Test the virtual time functionality of a timebase class.
+//! \param name Registered name of the timebase class to test.
+static bool testVirtualTimebase(std::string const &name)
+{
+  std::cout << "testVirtualTimebase: Testing " << name << std::endl;
+  try {
+    int wakeups = 0;
+    WakeupFn f = [&wakeups]() -> void { ++wakeups; };
+    std::unique_ptr<Timebase> tb {TimebaseFactory::get(name)->create(f)};
+    assertTrue_1(tb->getTickInterval() == 0);
+    assertTrue_1(tb->getNextWakeup() == 0);
+
+    // Time stands still until advanced
+    double startTime = tb->getTime();
+    assertTrue_1(0 != startTime);
+    sleep(1);
+    assertTrue_1(startTime == tb->getTime());
+
+    // Nothing to do before start, or with no deadline
+    assertTrue_1(!tb->advance());
+    tb->start();
+    assertTrue_1(!Timebase::advanceTime());
+    assertTrue_1(wakeups == 0);
+
+    // Jump to the deadline
+    double scheduledTime = startTime + 600.0;
+    tb->setTimer(scheduledTime);
+    assertTrue_1(eq_within_epsilon(tb->getNextWakeup(), scheduledTime));
+    assertTrue_1(wakeups == 0);
+    assertTrue_1(Timebase::advanceTime());
+    assertTrue_1(wakeups == 1);
+    assertTrue_1(scheduledTime == tb->getTime());
+    assertTrue_1(scheduledTime == Timebase::queryTime());
+
+    // Deadline consumed
+    assertTrue_1(!tb->advance());
+    assertTrue_1(wakeups == 1);
+
+    // Deadline in the past wakes immediately, without advancing
+    tb->setTimer(startTime);
+    assertTrue_1(wakeups == 2);
+    assertTrue_1(scheduledTime == tb->getTime());
+    assertTrue_1(!tb->advance());
+    tb->stop();
+
+    // Tick mode rounds up to the next tick
+    std::unique_ptr<Timebase> ttb {TimebaseFactory::get(name)->create(f)};
+    ttb->setTickInterval(USEC_PER_SEC);
+    ttb->start();
+    startTime = ttb->getTime();
+    ttb->setTimer(startTime + 2.5);
+    assertTrue_1(wakeups == 2);
+    assertTrue_1(ttb->getNextWakeup() == 0);
+    assertTrue_1(ttb->advance());
+    assertTrue_1(wakeups == 3);
+    assertTrue_1(eq_within_epsilon(ttb->getTime(), startTime + 3.0));
+    ttb->stop();
+
+    std::cout << "testVirtualTimebase: " << name << " passed\n" << std::endl;
+    return true;
+  } catch (Error const &e) {
+    std::cerr << "*** Test error: " << e.what() << std::endl;
+  }
+
+  std::cout << "\ntestVirtualTimebase: " << name << " failed\n" << std::endl;
+  return false;
+}
+
 int main(int argc, char *argv[])
 {
   // Read Debug.cfg in current directory, if it exists
@@ -228,6 +297,15 @@ int main(int argc, char *argv[])
 
   std::vector<std::string> timebaseNames = TimebaseFactory::allFactoryNames();
 
+  // The virtual timebase doesn't track the wall clock; test it separately
+  std::vector<std::string>::iterator virt =
+    std::find(timebaseNames.begin(), timebaseNames.end(), "Virtual");
+  if (virt != timebaseNames.end()) {
+    timebaseNames.erase(virt);
+    std::cout << "Testing virtual time" << std::endl;
+    success = testVirtualTimebase("Virtual");
+  }
+
   std::cout << "Testing getTime() and queryTime()" << std::endl;
   for (std::string const &name : timebaseNames) {
     success = success && testGetTime(name);
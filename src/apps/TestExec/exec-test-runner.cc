@@ -48,11 +48,28 @@
 #include "LuvListener.hh"
 #endif
 
+#include "pugixml.hpp"
+
 #include <fstream>
+#include <sstream>
 #include <string>
 
+#include <cerrno>
 #include <cstring>
 
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H) && defined(HAVE_FCNTL_H)
+#define TEST_EXEC_BATCH 1
+#endif
+
+#ifdef TEST_EXEC_BATCH
+#include <chrono>
+#include <iomanip>  // std::setprecision()
+
+#include <fcntl.h>    // open()
+#include <sys/wait.h> // waitpid()
+#include <unistd.h>   // fork(), dup2(), sysconf()
+#endif
+
 using std::endl;
 using std::set;
 using std::string;
@@ -60,7 +77,29 @@ using std::vector;
 
 using namespace PLEXIL;
 
+//! Settings shared by every plan run in this process.
+struct RunOptions
+{
+  string resourceFile;
+  bool useResourceFile;
+#ifdef HAVE_LUV_LISTENER
+  string luvHost;
+  int luvPort;
+  bool luvRequest;
+  bool luvBlock;
+#endif
+};
+
 static int run(int argc, char** argv);
+static int runTest(string const &planName,
+                   string const &scriptName,
+                   RunOptions const &opts);
+#ifdef TEST_EXEC_BATCH
+static int runBatch(string const &manifestName,
+                    string const &reportName,
+                    long jobs,
+                    RunOptions const &opts);
+#endif
 
 int main(int argc, char** argv)
 {
@@ -85,6 +124,13 @@ int run(int argc, char** argv)
                         [+d]                     (disable debug messages)\n\
                         [-r <resource_file>]     (default ./resource.data)\n\
                         [+r]                     (don't read resource data)\n");
+#ifdef TEST_EXEC_BATCH
+  string batchManifest;
+  string batchReport;
+  long batchJobs = 0;
+  usage += "   or: exec-test-runner -B <manifest> [-j <jobs>] [-o <report_file>]\n\
+                        [<options above other than -p, -s>]\n";
+#endif
 
 #ifdef HAVE_LUV_LISTENER
   string luvHost = LUV_DEFAULT_HOSTNAME;
@@ -101,7 +147,7 @@ int run(int argc, char** argv)
 
   // if not enough parameters, print usage
 
-  if (argc < 5) {
+  if (argc < 3) {
     if (argc >= 2 && strcmp(argv[1], "-h") == 0) {
       // print usage and exit
       std::cout << usage << std::endl;
@@ -226,6 +272,38 @@ int run(int argc, char** argv)
       buffer >> luvPort;
       SHOW(luvPort);
     } 
+#endif
+#ifdef TEST_EXEC_BATCH
+    else if (strcmp(argv[i], "-B") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      batchManifest = argv[i];
+    }
+    else if (strcmp(argv[i], "-o") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      batchReport = argv[i];
+    }
+    else if (strcmp(argv[i], "-j") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      std::istringstream buffer(argv[i]);
+      buffer >> batchJobs;
+      if (buffer.fail() || batchJobs < 1) {
+        warn("Invalid argument '" << argv[i] << "' to the -j option.\n"
+             << usage);
+        return 2;
+      }
+    }
 #endif
     else if (strcmp(argv[i], "-log") == 0) {
       if (argc == (++i)) {
@@ -246,15 +324,38 @@ int run(int argc, char** argv)
     }
   }
 
-  // if no plan or script supplied, error out
-  if (scriptName == "error") {
-    warn("No -s option found.\n" << usage);
-    return 2;
+  bool batchMode = false;
+#ifdef TEST_EXEC_BATCH
+  if (!batchManifest.empty()) {
+    if (planName != "error" || scriptName != "error") {
+      warn("The -B option may not be combined with -p or -s.\n" << usage);
+      return 2;
+    }
+#ifdef HAVE_LUV_LISTENER
+    if (luvRequest) {
+      warn("The -B option may not be combined with -v.\n" << usage);
+      return 2;
+    }
+#endif
+    batchMode = true;
   }
-  if (planName == "error") {
-    warn("No -p option found.\n" << usage);
+  else if (!batchReport.empty() || batchJobs) {
+    warn("The -j and -o options require the -B option.\n" << usage);
     return 2;
   }
+#endif
+
+  if (!batchMode) {
+    // if no plan or script supplied, error out
+    if (scriptName == "error") {
+      warn("No -s option found.\n" << usage);
+      return 2;
+    }
+    if (planName == "error") {
+      warn("No -p option found.\n" << usage);
+      return 2;
+    }
+  }
 
   if (Logging::ENABLE_LOGGING) {
 
@@ -281,6 +382,55 @@ int run(int argc, char** argv)
 
   setLibraryPaths(libraryPaths);
 
+  // if specified on command line, load libraries
+  for (vector<string>::const_iterator libraryName = libraryNames.begin(); 
+       libraryName != libraryNames.end();
+       ++libraryName) {
+    std::string fname = *libraryName;
+    if (fname.rfind(".plx") == std::string::npos)
+      fname += ".plx";
+    
+    Library const *l;
+    try {
+      l = loadLibraryNode(fname.c_str());
+      if (!l) {
+        warn("Unable to find file for library " << *libraryName);
+        return 1;
+      }
+    }
+    catch (ParserException const &e) {
+      warn("Error while reading library " << *libraryName << ": \n" << e.what());
+      return 1;
+    }
+  }
+
+  RunOptions opts;
+  opts.resourceFile = resourceFile;
+  opts.useResourceFile = useResourceFile;
+#ifdef HAVE_LUV_LISTENER
+  opts.luvHost = luvHost;
+  opts.luvPort = luvPort;
+  opts.luvRequest = luvRequest;
+  opts.luvBlock = luvBlock;
+#endif
+
+#ifdef TEST_EXEC_BATCH
+  if (batchMode)
+    return runBatch(batchManifest, batchReport, batchJobs, opts);
+#endif
+
+  return runTest(planName, scriptName, opts);
+}
+
+//! Execute one plan against one script.
+//! @param planName Name of the plan file.
+//! @param scriptName Name of the simulation script file.
+//! @param opts Settings shared by all runs.
+//! @return 0 if successful, 1 otherwise.
+static int runTest(string const &planName,
+                   string const &scriptName,
+                   RunOptions const &opts)
+{
   // create external interface
 
   TestExternalInterface intf;
@@ -292,8 +442,8 @@ int run(int argc, char** argv)
   g_exec->setDispatcher(g_dispatcher);
   ExecListenerHub hub;
   g_exec->setExecListener(&hub);
-  if (useResourceFile) {
-    g_exec->getArbiter()->readResourceHierarchyFile(resourceFile);
+  if (opts.useResourceFile) {
+    g_exec->getArbiter()->readResourceHierarchyFile(opts.resourceFile);
   }
 
 
@@ -304,55 +454,21 @@ int run(int argc, char** argv)
 
 #ifdef HAVE_LUV_LISTENER
   // if a Plexil Viewer is to be attached
-  if (luvRequest) {
+  if (opts.luvRequest) {
     // create and add luv listener
-    LuvListener* ll = makeLuvListener(luvHost.c_str(), luvPort, luvBlock);
+    LuvListener* ll = makeLuvListener(opts.luvHost.c_str(), opts.luvPort, opts.luvBlock);
     if (ll->start()) {
       hub.addListener(ll);
     }
     else {
       warn("WARNING: Unable to connect to Plexil Viewer at "
-           << luvHost << ":" << luvPort
+           << opts.luvHost << ":" << opts.luvPort
            << "\nExecution will continue without the viewer.");
       delete ll;
     }
   }
 #endif
 
-  // if specified on command line, load libraries
-  for (vector<string>::const_iterator libraryName = libraryNames.begin(); 
-       libraryName != libraryNames.end();
-       ++libraryName) {
-    std::string fname = *libraryName;
-    if (fname.rfind(".plx") == std::string::npos)
-      fname += ".plx";
-    
-    Library const *l;
-    try {
-      l = loadLibraryNode(fname.c_str());
-      if (!l) {
-        warn("Unable to find file for library " << *libraryName);
-        
-        // Clean up
-        delete g_exec;
-        g_exec = nullptr;
-        g_dispatcher = nullptr;
-
-        return 1;
-      }
-    }
-    catch (ParserException const &e) {
-      warn("Error while reading library " << *libraryName << ": \n" << e.what());
-
-      // Clean up
-      delete g_exec;
-      g_exec = nullptr;
-      g_dispatcher = nullptr;
-
-      return 1;
-    }
-  }
-
   // Load the plan
   {
     pugi::xml_document *planDoc;
@@ -456,6 +572,222 @@ int run(int argc, char** argv)
   return 0;
 }
 
+#ifdef TEST_EXEC_BATCH
+
+//
+// Batch mode
+//
+// Each test runs in its own child process, so each gets a fresh Exec,
+// state cache, and dispatcher.  Libraries named with -l are loaded
+// before the children are forked, so every test shares the parsed
+// copies.
+//
+
+//! Bookkeeping for one test in a batch.
+struct BatchTest
+{
+  string plan;
+  string script;
+  string output;
+  std::chrono::steady_clock::time_point started;
+  double seconds;
+  pid_t pid;
+  int status;
+};
+
+//! Read the batch manifest.
+//! @param manifestName Name of the manifest file.
+//! @param tests Vector to receive the tests.
+//! @return true if successful, false otherwise.
+//! @note Each non-blank line which does not begin with '#' names a
+//!       plan file, a script file, and optionally an output file, 
+//!       separated by whitespace.  If the output file is omitted,
+//!       the test's standard output is discarded.
+static bool readManifest(string const &manifestName, vector<BatchTest> &tests)
+{
+  std::ifstream manifest(manifestName.c_str());
+  if (!manifest.good()) {
+    warn("Error: manifest file " << manifestName << " not found or not readable");
+    return false;
+  }
+
+  string line;
+  size_t lineNo = 0;
+  while (std::getline(manifest, line)) {
+    ++lineNo;
+    std::istringstream fields(line);
+    BatchTest test;
+    if (!(fields >> test.plan) || test.plan[0] == '#')
+      continue;
+    if (!(fields >> test.script)) {
+      warn("Error: manifest " << manifestName << ", line " << lineNo
+           << ": missing script file name");
+      return false;
+    }
+    fields >> test.output;
+    test.seconds = 0;
+    test.pid = 0;
+    test.status = -1;
+    tests.push_back(test);
+  }
+  return true;
+}
+
+//! Fork a child process to run one test.
+//! @param test The test.
+//! @param opts Settings shared by all runs.
+//! @return true if the child was started, false otherwise.
+static bool startTest(BatchTest &test, RunOptions const &opts)
+{
+  // Don't duplicate buffered output in the child
+  std::cout.flush();
+  std::cerr.flush();
+
+  test.started = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid < 0) {
+    warn("Error: fork failed for plan " << test.plan
+         << ", errno = " << errno << ": " << strerror(errno));
+    return false;
+  }
+
+  if (pid) {
+    // Parent
+    test.pid = pid;
+    return true;
+  }
+
+  // Child
+  char const *outName = test.output.empty() ? "/dev/null" : test.output.c_str();
+  int fd = open(outName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0) {
+    warn("Error: unable to open output file " << outName
+         << ", errno = " << errno << ": " << strerror(errno));
+    _exit(1);
+  }
+  close(fd);
+
+  int status = runTest(test.plan, test.script, opts);
+  std::cout.flush();
+  std::cerr.flush();
+  _exit(status);
+}
+
+//! Write the batch results.
+//! @param tests The tests.
+//! @param manifestName Name of the manifest file.
+//! @param reportName Name of the report file; if empty, write to standard output.
+//! @param jobs Number of worker processes used.
+//! @param seconds Elapsed time for the whole batch.
+//! @return Number of tests which failed.
+static size_t writeReport(vector<BatchTest> const &tests,
+                          string const &manifestName,
+                          string const &reportName,
+                          long jobs,
+                          double seconds)
+{
+  pugi::xml_document doc;
+  pugi::xml_node root = doc.append_child("TestExecBatch");
+  root.append_attribute("Manifest").set_value(manifestName.c_str());
+  root.append_attribute("Jobs").set_value(jobs);
+  root.append_attribute("Tests").set_value((unsigned long) tests.size());
+  pugi::xml_attribute failuresAttr = root.append_attribute("Failures");
+  root.append_attribute("Seconds").set_value(seconds);
+
+  size_t failures = 0;
+  for (BatchTest const &test : tests) {
+    pugi::xml_node elt = root.append_child("Test");
+    elt.append_attribute("Plan").set_value(test.plan.c_str());
+    elt.append_attribute("Script").set_value(test.script.c_str());
+    if (!test.output.empty())
+      elt.append_attribute("Output").set_value(test.output.c_str());
+    elt.append_attribute("Status").set_value(test.status);
+    elt.append_attribute("Seconds").set_value(test.seconds);
+    if (test.status)
+      ++failures;
+  }
+  failuresAttr.set_value((unsigned long) failures);
+
+  if (reportName.empty())
+    doc.save(std::cout, "  ");
+  else if (!doc.save_file(reportName.c_str(), "  "))
+    warn("Error: unable to write report file " << reportName);
+  return failures;
+}
+
+//! Run every test in the manifest, several at a time.
+//! @param manifestName Name of the manifest file.
+//! @param reportName Name of the report file; if empty, write to standard output.
+//! @param jobs Maximum number of tests to run at once; if 0, use
+//!             the number of online processors.
+//! @param opts Settings shared by all runs.
+//! @return 0 if all tests succeeded, 1 otherwise.
+static int runBatch(string const &manifestName,
+                    string const &reportName,
+                    long jobs,
+                    RunOptions const &opts)
+{
+  vector<BatchTest> tests;
+  if (!readManifest(manifestName, tests))
+    return 1;
+  if (tests.empty()) {
+    warn("Error: manifest " << manifestName << " contains no tests");
+    return 1;
+  }
+
+  if (!jobs) {
+    jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs < 1)
+      jobs = 1;
+  }
+
+  std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+  size_t next = 0;
+  long running = 0;
+  while (next < tests.size() || running) {
+    // Keep the pool full
+    while (next < tests.size() && running < jobs) {
+      BatchTest &test = tests[next++];
+      if (startTest(test, opts))
+        ++running;
+    }
+    if (!running)
+      break;
+
+    // Reap a finished child
+    int wstatus = 0;
+    pid_t pid = waitpid(-1, &wstatus, 0);
+    if (pid < 0) {
+      if (errno == EINTR)
+        continue;
+      warn("Error: waitpid failed, errno = " << errno << ": " << strerror(errno));
+      break;
+    }
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (BatchTest &test : tests) {
+      if (test.pid == pid) {
+        test.seconds = std::chrono::duration<double>(now - test.started).count();
+        if (WIFEXITED(wstatus))
+          test.status = WEXITSTATUS(wstatus);
+        else if (WIFSIGNALED(wstatus))
+          test.status = 128 + WTERMSIG(wstatus);
+        debugMsg("TestExec:batch",
+                 ' ' << test.plan << " finished with status " << test.status
+                 << " in " << std::setprecision(6) << test.seconds << " seconds");
+        test.pid = 0;
+        --running;
+        break;
+      }
+    }
+  }
+
+  double elapsed =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+  return writeReport(tests, manifestName, reportName, jobs, elapsed) ? 1 : 0;
+}
+
+#endif // TEST_EXEC_BATCH
+
 #if defined(__VXWORKS__)
 extern "C"
 int test_exec_for_vxworks(char* plan, char* script, char* debug_cfg)
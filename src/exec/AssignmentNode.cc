@@ -96,12 +96,12 @@ namespace PLEXIL
     m_assignment.reset(assn);
 
     // Set action-complete condition
-    m_conditions[actionCompleteIdx] = m_assignment->getAck();
-    m_garbageConditions[actionCompleteIdx] = false;
+    m_conditions.set(actionCompleteIdx, m_assignment->getAck());
+    m_conditions.setGarbage(actionCompleteIdx, false);
 
     // Set abort-complete condition
-    m_conditions[abortCompleteIdx] = m_assignment->getAbortComplete();
-    m_garbageConditions[abortCompleteIdx] = false;
+    m_conditions.set(abortCompleteIdx, m_assignment->getAbortComplete());
+    m_conditions.setGarbage(abortCompleteIdx, false);
   }
 
   // Unit test variant of above
@@ -152,7 +152,7 @@ namespace PLEXIL
                << this << " is inactive.");
 #endif
     bool temp;
-    if (!cond->getValue(temp) || !temp) {
+    if (!getConditionValue(actionCompleteIdx, temp) || !temp) {
       debugMsg("Node:getDestState",
                ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> no change. Assignment node and assignment-complete false.");
@@ -165,7 +165,7 @@ namespace PLEXIL
                  "Node::getDestStateFromExecuting: Ancestor exit for " << m_nodeId << ' '
                  << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Assignment node and ANCESTOR_EXIT_CONDITION true.");
@@ -182,7 +182,7 @@ namespace PLEXIL
                  "Node::getDestStateFromExecuting: Exit condition for " << m_nodeId << ' '
                  << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Assignment node and EXIT_CONDITION true.");
@@ -199,7 +199,7 @@ namespace PLEXIL
                  "Node::getDestStateFromExecuting: Ancestor invariant for " << m_nodeId << ' '
                  << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Assignment node and Ancestor invariant false.");
@@ -216,7 +216,7 @@ namespace PLEXIL
                  "Node::getDestStateFromExecuting: Invariant for " << m_nodeId << ' '
                  << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(invariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Assignment node and Invariant false.");
@@ -227,7 +227,7 @@ namespace PLEXIL
       }
     }
 
-    if ((cond = getEndCondition()) && (!cond->getValue(temp) || !temp)) {
+    if ((cond = getEndCondition()) && (!getConditionValue(endIdx, temp) || !temp)) {
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
       checkError(cond->isActive(),
                  "Node::getDestStateFromExecuting: End for " << m_nodeId << ' '
@@ -240,7 +240,7 @@ namespace PLEXIL
              ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
              << " -> ITERATION_ENDED. Assignment node and End condition true.");
     m_nextState = ITERATION_ENDED_STATE;
-    if ((cond = getPostCondition()) && (!cond->getValue(temp) || !temp)) { 
+    if ((cond = getPostCondition()) && (!getConditionValue(postIdx, temp) || !temp)) { 
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
       checkError(cond->isActive(),
                  "Node::getDestState: Post for " << m_nodeId << ' ' << this << " is inactive.");
@@ -306,13 +306,13 @@ namespace PLEXIL
 
   bool AssignmentNode::getDestStateFromFailing()
   {
-    Expression *cond = getAbortCompleteCondition();
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
+    Expression *cond = getAbortCompleteCondition();
     checkError(cond->isActive(),
                "Abort complete for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
     bool temp;
-    if (!cond->getValue(temp) || !temp) {
+    if (!getConditionValue(abortCompleteIdx, temp) || !temp) {
       debugMsg("Node:getDestState",
                ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                << " -> no change. Assignment node and abort complete false.");
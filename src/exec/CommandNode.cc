@@ -150,8 +150,8 @@ namespace PLEXIL
 
     debugMsg("CommandNode:cleanUpNodeBody", '<' << m_nodeId << "> entered");
     if (m_command) {
-      m_conditions[actionCompleteIdx] = nullptr;
-      m_conditions[abortCompleteIdx] = nullptr;
+      m_conditions.set(actionCompleteIdx, nullptr);
+      m_conditions.set(abortCompleteIdx, nullptr);
       m_command->cleanUp();
     }
     m_cleanedBody = true;
@@ -163,12 +163,12 @@ namespace PLEXIL
     m_command.reset(cmd);
 
     // Set action-complete condition from command
-    m_conditions[actionCompleteIdx] = m_command->getCommandHandleKnownFn();
-    m_garbageConditions[actionCompleteIdx] = false;
+    m_conditions.set(actionCompleteIdx, m_command->getCommandHandleKnownFn());
+    m_conditions.setGarbage(actionCompleteIdx, false);
 
     // Set command-aborted condition from command
-    m_conditions[abortCompleteIdx] = m_command->getAbortComplete();
-    m_garbageConditions[abortCompleteIdx] = false;
+    m_conditions.set(abortCompleteIdx, m_command->getAbortComplete());
+    m_conditions.setGarbage(abortCompleteIdx, false);
   }
 
   void CommandNode::specializedCreateConditionWrappers()
@@ -176,13 +176,13 @@ namespace PLEXIL
     // No need to wrap if end condition is default - (True || anything) == True
     if (m_conditions[endIdx] && m_conditions[endIdx] != TRUE_EXP()) {
       // Construct real end condition by wrapping existing
-      m_conditions[endIdx] = 
+      m_conditions.set(endIdx,
         makeFunction(BooleanOr::instance(),
                      new NodeFunction(CommandHandleInterruptible::instance(), this),
                      m_conditions[endIdx],
                      true,
-                     m_garbageConditions[endIdx]);
-      m_garbageConditions[endIdx] = true;
+                     m_conditions.isGarbage(endIdx)));
+      m_conditions.setGarbage(endIdx, true);
     }
   }
 
@@ -215,7 +215,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor exit for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node and ancestor exit true.");
@@ -231,7 +231,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Exit for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node and exit true.");
@@ -247,7 +247,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node and ancestor invariant false.");
@@ -263,7 +263,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(invariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node and invariant false.");
@@ -274,7 +274,7 @@ namespace PLEXIL
       }
     }
 
-    if ((cond = getEndCondition()) && (!cond->getValue(temp) || !temp )) {
+    if ((cond = getEndCondition()) && (!getConditionValue(endIdx, temp) || !temp )) {
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
       checkError(cond->isActive(),
                  "End for " << getNodeId() << ' ' << this << " is inactive.");
@@ -335,7 +335,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor exit for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node and ancestor exit true.");
@@ -351,7 +351,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Exit for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node and exit true.");
@@ -367,7 +367,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node and ancestor invariant false.");
@@ -383,7 +383,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(invariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Command node, invariant false and end false or unknown.");
@@ -399,12 +399,12 @@ namespace PLEXIL
     checkError(cond->isActive(),
                "Action complete for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-    if (cond->getValue(temp) && temp) {
+    if (getConditionValue(actionCompleteIdx, temp) && temp) {
       debugMsg("Node:getDestState",
                ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                << " -> ITERATION_ENDED. Command node and action complete true.");
       m_nextState = ITERATION_ENDED_STATE;
-      if ((cond = getPostCondition()) && (!cond->getValue(temp) || !temp)) {
+      if ((cond = getPostCondition()) && (!getConditionValue(postIdx, temp) || !temp)) {
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
         checkError(cond->isActive(),
                    "Node::getDestState: Post for " << m_nodeId << ' ' << this << " is inactive.");
@@ -463,13 +463,13 @@ namespace PLEXIL
 
   bool CommandNode::getDestStateFromFailing()
   {
-    Expression *cond = getAbortCompleteCondition();
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
+    Expression *cond = getAbortCompleteCondition();
     checkError(cond->isActive(),
                "Abort complete for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
     bool temp;
-    if (cond->getValue(temp) && temp) {
+    if (getConditionValue(abortCompleteIdx, temp) && temp) {
       if (getFailureType() == PARENT_FAILED) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
@@ -0,0 +1,244 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ConditionProfiler.hh"
+
+#include "Expression.hh"
+#include "NodeImpl.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace PLEXIL
+{
+
+  namespace
+  {
+    //! Timing data for one condition.
+    struct ConditionTiming
+    {
+      uint64_t evaluations;
+      uint64_t samples;
+      uint64_t sampledNanoseconds;
+    };
+
+    //! Data for one condition of a live node.
+    struct LiveCondition
+    {
+      Expression const *condition;
+      ConditionTiming timing;
+    };
+
+    //! Summary data for one condition, by node path and index.
+    struct ConditionSummary
+    {
+      ConditionTiming timing;
+      ExpressionProfiler::Counters counters;
+      uint64_t instances;
+    };
+
+    using LiveConditions = std::vector<LiveCondition>;
+    using LiveMap = std::unordered_map<NodeImpl const *, LiveConditions>;
+    using SummaryKey = std::pair<std::string, size_t>;
+    using SummaryMap = std::map<SummaryKey, ConditionSummary>;
+
+    unsigned int s_sampleInterval = 16;
+
+    LiveMap &liveMap()
+    {
+      static LiveMap sl_live;
+      return sl_live;
+    }
+
+    SummaryMap &summaryMap()
+    {
+      static SummaryMap sl_summary;
+      return sl_summary;
+    }
+
+    std::string nodePath(NodeImpl const *node)
+    {
+      std::string result = node->getNodeId();
+      for (NodeImpl const *parent = node->getParentNode();
+           parent;
+           parent = parent->getParentNode())
+        result = parent->getNodeId() + '/' + result;
+      return result;
+    }
+
+    void accumulate(SummaryMap &summaries, NodeImpl const *node,
+                    LiveConditions const &conditions)
+    {
+      std::string path = nodePath(node);
+      for (size_t i = 0; i < conditions.size(); ++i) {
+        LiveCondition const &live = conditions[i];
+        if (!live.condition)
+          continue;
+        ConditionSummary &summary = summaries[SummaryKey(path, i)];
+        summary.timing.evaluations += live.timing.evaluations;
+        summary.timing.samples += live.timing.samples;
+        summary.timing.sampledNanoseconds += live.timing.sampledNanoseconds;
+        ExpressionProfiler::Counters counters =
+          ExpressionProfiler::getTotalCounters(live.condition);
+        summary.counters.evaluations += counters.evaluations;
+        summary.counters.notifications += counters.notifications;
+        summary.counters.listenersNotified += counters.listenersNotified;
+        ++summary.instances;
+      }
+    }
+
+    double estimatedNanoseconds(ConditionTiming const &timing)
+    {
+      if (!timing.samples)
+        return 0;
+      return (double) timing.sampledNanoseconds * timing.evaluations / timing.samples;
+    }
+
+  } // anonymous namespace
+
+  void ConditionProfiler::enable(unsigned int sampleInterval)
+  {
+    s_sampleInterval = sampleInterval ? sampleInterval : 1;
+    ExpressionProfiler::setEnabled(true);
+  }
+
+  void ConditionProfiler::disable()
+  {
+    ExpressionProfiler::setEnabled(false);
+  }
+
+  void ConditionProfiler::reset()
+  {
+    for (LiveMap::value_type &entry : liveMap())
+      for (LiveCondition &live : entry.second)
+        live.timing = ConditionTiming {0, 0, 0};
+    summaryMap().clear();
+    ExpressionProfiler::reset();
+  }
+
+  bool ConditionProfiler::evaluate(NodeImpl const *owner, size_t idx,
+                                   Expression const *cond, Boolean &result)
+  {
+    LiveConditions &conditions = liveMap()[owner];
+    if (conditions.empty())
+      conditions.resize(NodeImpl::conditionIndexMax,
+                        LiveCondition {nullptr, {0, 0, 0}});
+    LiveCondition &live = conditions[idx];
+    live.condition = cond;
+
+    if (live.timing.evaluations++ % s_sampleInterval)
+      return cond->getValue(result);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool known = cond->getValue(result);
+    live.timing.sampledNanoseconds +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    ++live.timing.samples;
+    return known;
+  }
+
+  void ConditionProfiler::retire(NodeImpl const *node)
+  {
+    LiveMap &live = liveMap();
+    if (live.empty())
+      return;
+    LiveMap::iterator it = live.find(node);
+    if (it == live.end())
+      return;
+    accumulate(summaryMap(), node, it->second);
+    live.erase(it);
+  }
+
+  void ConditionProfiler::report(std::ostream &s, size_t maxEntries)
+  {
+    // Combine the summary with the nodes which are still live
+    SummaryMap summaries = summaryMap();
+    for (LiveMap::value_type const &entry : liveMap())
+      accumulate(summaries, entry.first, entry.second);
+
+    typedef std::pair<SummaryKey, ConditionSummary> Entry;
+    std::vector<Entry> entries(summaries.begin(), summaries.end());
+    std::sort(entries.begin(), entries.end(),
+              [](Entry const &a, Entry const &b) -> bool {
+                return estimatedNanoseconds(a.second.timing) > estimatedNanoseconds(b.second.timing);
+              });
+
+    uint64_t totalEvaluations = 0;
+    double totalNanoseconds = 0;
+    for (Entry const &entry : entries) {
+      totalEvaluations += entry.second.timing.evaluations;
+      totalNanoseconds += estimatedNanoseconds(entry.second.timing);
+    }
+
+    std::ios_base::fmtflags oldFlags = s.flags();
+    s << "Condition profile: " << entries.size() << " conditions, "
+      << totalEvaluations << " evaluations, estimated "
+      << std::fixed << std::setprecision(3) << totalNanoseconds / 1e6
+      << " ms (1 in " << s_sampleInterval << " evaluations timed)\n"
+      << std::setw(12) << "est. ms"
+      << std::setw(8) << "% time"
+      << std::setw(12) << "evals"
+      << std::setw(10) << "mean ns"
+      << std::setw(14) << "subexpr evals"
+      << std::setw(12) << "notifies"
+      << std::setw(12) << "fan-out"
+      << "  node / condition\n";
+
+    size_t n = entries.size();
+    if (maxEntries && maxEntries < n)
+      n = maxEntries;
+    for (size_t i = 0; i < n; ++i) {
+      Entry const &entry = entries[i];
+      ConditionTiming const &timing = entry.second.timing;
+      ExpressionProfiler::Counters const &counters = entry.second.counters;
+      double estimate = estimatedNanoseconds(timing);
+      s << std::setw(12) << std::setprecision(3) << estimate / 1e6
+        << std::setw(8) << std::setprecision(1)
+        << (totalNanoseconds > 0 ? 100 * estimate / totalNanoseconds : 0.0)
+        << std::setw(12) << timing.evaluations
+        << std::setw(10) << std::setprecision(0)
+        << (timing.samples ? (double) timing.sampledNanoseconds / timing.samples : 0.0)
+        << std::setw(14) << counters.evaluations
+        << std::setw(12) << counters.notifications
+        << std::setw(12) << counters.listenersNotified
+        << "  " << entry.first.first
+        << ' ' << NodeImpl::getConditionName(entry.first.second);
+      if (entry.second.instances > 1)
+        s << " (" << entry.second.instances << " instances)";
+      s << '\n';
+    }
+    if (n < entries.size())
+      s << "... " << entries.size() - n << " more conditions not shown\n";
+    s.flags(oldFlags);
+    s << std::flush;
+  }
+
+} // namespace PLEXIL
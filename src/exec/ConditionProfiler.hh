@@ -0,0 +1,116 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_CONDITION_PROFILER_HH
+#define PLEXIL_CONDITION_PROFILER_HH
+
+#include "ExpressionProfiler.hh"
+#include "ValueType.hh"
+
+#include <iosfwd>
+
+namespace PLEXIL
+{
+  class Expression;
+  class NodeImpl;
+
+  //! \class ConditionProfiler
+  //! \brief Attributes runtime expression evaluation cost to the
+  //!        node conditions responsible for it.
+  //!
+  //! While enabled, every evaluation of a node condition is counted,
+  //! and one evaluation in every sampleInterval is timed.  The
+  //! ExpressionProfiler counters for the condition's expression tree
+  //! are charged to the condition as well.  Conditions are folded
+  //! into a summary when their node's conditions are cleaned up, so
+  //! the report covers plans which have already finished; repeated
+  //! instances of a node are summed by node path.
+  //!
+  //! Conditions are evaluated through their expression trees, not
+  //! their compiled forms, while profiling is enabled, so that the
+  //! per-expression counters are complete.
+  //!
+  //! \note Not synchronized.  Only the Exec thread may evaluate
+  //!       conditions while profiling is enabled.
+  //! \see ExpressionProfiler
+  //! \ingroup Exec-Core
+  class ConditionProfiler final
+  {
+  public:
+
+    //! \brief Enable profiling.
+    //! \param sampleInterval Time one condition evaluation in this many.
+    static void enable(unsigned int sampleInterval = 16);
+
+    //! \brief Disable profiling.  The data collected so far are kept.
+    static void disable();
+
+    //! \brief Query whether profiling is enabled.
+    //! \return True if enabled, false if not.
+    static bool isEnabled()
+    {
+      return ExpressionProfiler::isEnabled();
+    }
+
+    //! \brief Discard all profiling data.
+    static void reset();
+
+    //! \brief Print the most expensive conditions, by estimated
+    //!        total evaluation time, to a stream.
+    //! \param s The stream.
+    //! \param maxEntries The maximum number of conditions to list;
+    //!                   0 to list all.
+    static void report(std::ostream &s, size_t maxEntries = 25);
+
+    //! \brief Evaluate a node condition, recording its cost.
+    //! \param owner The node which owns the condition.
+    //! \param idx The condition index.
+    //! \param cond The condition expression.
+    //! \param result Reference to the result variable.
+    //! \return True if the value is known, false if unknown.
+    //! \note Called by NodeImpl when profiling is enabled.
+    static bool evaluate(NodeImpl const *owner, size_t idx,
+                         Expression const *cond, Boolean &result);
+
+    //! \brief Fold the data for a node's conditions into the summary.
+    //! \param node The node whose conditions are about to be deleted.
+    //! \note Called by NodeImpl whether or not profiling is enabled.
+    static void retire(NodeImpl const *node);
+
+  private:
+
+    // Not implemented
+    ConditionProfiler() = delete;
+    ConditionProfiler(ConditionProfiler const &) = delete;
+    ConditionProfiler(ConditionProfiler &&) = delete;
+    ConditionProfiler &operator=(ConditionProfiler const &) = delete;
+    ConditionProfiler &operator=(ConditionProfiler &&) = delete;
+    ~ConditionProfiler() = delete;
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_CONDITION_PROFILER_HH
@@ -57,7 +57,7 @@ namespace PLEXIL
 
     debugMsg("LibraryCallNode:cleanUpNodeBody", " for " << m_nodeId);
 
-    // Aliases may point to expressions owned by m_localVariables,
+    // Aliases may point to expressions owned by the local variables,
     // so delete alias map first.
     delete m_aliasMap.release();
 
@@ -74,17 +74,17 @@ namespace PLEXIL
   bool LibraryCallNode::addAlias(char const *name, Expression *exp, bool isGarbage)
   {
     assertTrue_1(m_aliasMap);
-    if (m_aliasMap->find(name) != m_aliasMap->end())
+    if (!m_aliasMap->insert(name, exp))
       return false; // duplicate
-    (*m_aliasMap)[name] = exp;
     if (isGarbage) {
       // Allocate a place to store alias if it doesn't already exist.
-      if (!m_localVariables)
-        m_localVariables.reset(new std::vector<std::unique_ptr<Expression>>());
+      ColdData &c = cold();
+      if (!c.localVariables)
+        c.localVariables.reset(new std::vector<std::unique_ptr<Expression>>());
 
       // N.B. Aliases can refer to local variables,
       // so ensure the alias gets cleaned up first by inserting it in the front.
-      m_localVariables->insert(m_localVariables->begin(),
+      c.localVariables->insert(c.localVariables->begin(),
                                std::unique_ptr<Expression>(exp)); // std::make_unique() is C++14
     }
     return true;
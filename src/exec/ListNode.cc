@@ -217,8 +217,8 @@ namespace PLEXIL
 
   NodeVariableMap const *ListNode::getChildVariableMap() const
   {
-    if (m_variablesByName)
-      return m_variablesByName.get();
+    if (coldData().variablesByName)
+      return coldData().variablesByName.get();
 
     // Search ancestors for first in chain
     NodeImpl *n = m_parent;
@@ -236,66 +236,66 @@ namespace PLEXIL
   void ListNode::specializedCreateConditionWrappers()
   {
     // Not really a "wrapper", but this is best place to add it.
-    m_conditions[actionCompleteIdx] = &m_actionCompleteFn;
-    m_garbageConditions[actionCompleteIdx] = false;
+    m_conditions.set(actionCompleteIdx, &m_actionCompleteFn);
+    m_conditions.setGarbage(actionCompleteIdx, false);
 
     if (m_parent) {
       if (getExitCondition()) {
         if (getAncestorExitCondition()) {
-          m_conditions[ancestorExitIdx] =
+          m_conditions.set(ancestorExitIdx,
             makeFunction(BooleanOr::instance(),
                          getExitCondition(),
                          getAncestorExitCondition(),
                          false,
-                         false);
-          m_garbageConditions[ancestorExitIdx] = true;
+                         false));
+          m_conditions.setGarbage(ancestorExitIdx, true);
         }
         else 
-          m_conditions[ancestorExitIdx] = getExitCondition();
+          m_conditions.set(ancestorExitIdx, getExitCondition());
       }
       else 
-        m_conditions[ancestorExitIdx] = getAncestorExitCondition(); // could be null
+        m_conditions.set(ancestorExitIdx, getAncestorExitCondition()); // could be null
 
       if (getInvariantCondition()) {
         if (getAncestorInvariantCondition()) {
-          m_conditions[ancestorInvariantIdx] =
+          m_conditions.set(ancestorInvariantIdx,
             makeFunction(BooleanAnd::instance(),
                          getInvariantCondition(),
                          getAncestorInvariantCondition(), // from parent
                          false,
-                         false);
-          m_garbageConditions[ancestorInvariantIdx] = true;
+                         false));
+          m_conditions.setGarbage(ancestorInvariantIdx, true);
         }
         else {
-          m_conditions[ancestorInvariantIdx] = getInvariantCondition();
-          m_garbageConditions[ancestorInvariantIdx] = false;
+          m_conditions.set(ancestorInvariantIdx, getInvariantCondition());
+          m_conditions.setGarbage(ancestorInvariantIdx, false);
         }
       }
       else {
-        m_conditions[ancestorInvariantIdx] = getAncestorInvariantCondition(); // could be null
-        m_garbageConditions[ancestorInvariantIdx] = false;
+        m_conditions.set(ancestorInvariantIdx, getAncestorInvariantCondition()); // could be null
+        m_conditions.setGarbage(ancestorInvariantIdx, false);
       }
 
       // End is special
       if (getEndCondition()) {
         if (getAncestorEndCondition()) {
-          m_conditions[ancestorEndIdx] =
+          m_conditions.set(ancestorEndIdx,
             makeFunction(BooleanOr::instance(),
                          getEndCondition(),
                          getAncestorEndCondition(), // from parent
                          false,
-                         false);
-          m_garbageConditions[ancestorEndIdx] = true;
+                         false));
+          m_conditions.setGarbage(ancestorEndIdx, true);
         }
         else {
-          m_conditions[ancestorEndIdx] = getEndCondition();
-          m_garbageConditions[ancestorEndIdx] = false;
+          m_conditions.set(ancestorEndIdx, getEndCondition());
+          m_conditions.setGarbage(ancestorEndIdx, false);
         }
       }
       else {
         // No user-spec'd end condition - build one
-        m_conditions[endIdx] = &m_allFinishedFn;
-        m_garbageConditions[endIdx] = false;
+        m_conditions.set(endIdx, &m_allFinishedFn);
+        m_conditions.setGarbage(endIdx, false);
         // *** N.B. ***
         // Normally ancestor-end is our end condition ORed with parent's ancestor-end.
         // But default all-children-finished end condition will always be false
@@ -303,32 +303,32 @@ namespace PLEXIL
         // See node state transition diagrams for proof.
         // Since false OR <anything> == <anything>,
         // just use parent's ancestor-end (which may be empty).
-        m_conditions[ancestorEndIdx] = getAncestorEndCondition();
-        m_garbageConditions[ancestorEndIdx] = false;
+        m_conditions.set(ancestorEndIdx, getAncestorEndCondition());
+        m_conditions.setGarbage(ancestorEndIdx, false);
       }
     }
     else {
       // No parent - simply reuse existing conditions, if any
-      m_conditions[ancestorExitIdx] = m_conditions[exitIdx]; // could be null
-      m_conditions[ancestorInvariantIdx] = m_conditions[invariantIdx]; // could be null
+      m_conditions.set(ancestorExitIdx, m_conditions[exitIdx]); // could be null
+      m_conditions.set(ancestorInvariantIdx, m_conditions[invariantIdx]); // could be null
       // End is special
       if (m_conditions[endIdx]) {
         // User-spec'd end condition doubles as ancestor-end
-        m_conditions[ancestorEndIdx] = m_conditions[endIdx];
-        m_garbageConditions[ancestorEndIdx] = false;
+        m_conditions.set(ancestorEndIdx, m_conditions[endIdx]);
+        m_conditions.setGarbage(ancestorEndIdx, false);
       }
       else {
         // No user-spec'd end condition - build one
-        m_conditions[endIdx] = &m_allFinishedFn;
-        m_garbageConditions[endIdx] = false;
+        m_conditions.set(endIdx, &m_allFinishedFn);
+        m_conditions.setGarbage(endIdx, false);
         // *** N.B. ***
         // Normally for root nodes, ancestor-end is same as end. 
         // But default all-children-finished end condition will always be false
         // when child evaluates ancestor-end.
         // See node state transition diagrams for proof.
         // So if no parent and no user end condition, just leave ancestor-end empty.
-        m_conditions[ancestorEndIdx] = nullptr;
-        m_garbageConditions[ancestorEndIdx] = false;
+        m_conditions.set(ancestorEndIdx, nullptr);
+        m_conditions.setGarbage(ancestorEndIdx, false);
       }
     }
   }
@@ -467,7 +467,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor exit for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and ANCESTOR_EXIT_CONDITION true.");
@@ -483,7 +483,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Exit condition for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and EXIT_CONDITION true.");
@@ -499,7 +499,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and ANCESTOR_INVARIANT_CONDITION false.");
@@ -515,7 +515,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(invariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and INVARIANT_CONDITION false.");
@@ -526,7 +526,7 @@ namespace PLEXIL
       }
     }
 
-    if ((cond = getEndCondition()) && (!cond->getValue(temp) || !temp)) {
+    if ((cond = getEndCondition()) && (!getConditionValue(endIdx, temp) || !temp)) {
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
       checkError(cond->isActive(),
                  "End for " << getNodeId() << ' ' << this << " is inactive.");
@@ -591,7 +591,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor exit for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and ANCESTOR_EXIT_CONDITION true.");
@@ -607,7 +607,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Exit condition for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and EXIT_CONDITION true.");
@@ -623,7 +623,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and ANCESTOR_INVARIANT_CONDITION false.");
@@ -639,7 +639,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Invariant for " << getNodeId() << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(invariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. List node and INVARIANT_CONDITION false.");
@@ -656,13 +656,13 @@ namespace PLEXIL
                "Children waiting or finished for " << getNodeId() << ' ' << this
                << " is inactive.");
 #endif
-    cond->getValue(temp); // cannot be unknown, see above
+    getConditionValue(actionCompleteIdx, temp); // cannot be unknown, see above
     if (temp) {
       m_nextState = ITERATION_ENDED_STATE;
       debugMsg("Node:getDestState",
                ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                << " -> ITERATION_ENDED. List node and ALL_CHILDREN_WAITING_OR_FINISHED true.");
-      if ((cond = getPostCondition()) && (!cond->getValue(temp) || !temp)) {
+      if ((cond = getPostCondition()) && (!getConditionValue(postIdx, temp) || !temp)) {
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
         checkError(cond->isActive(),
                    "ListNode::getDestStateFromFinishing: Post for " << m_nodeId << " is inactive.");
@@ -730,14 +730,14 @@ namespace PLEXIL
 
   bool ListNode::getDestStateFromFailing()
   {
-    Expression *cond = getActionCompleteCondition();
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
+    Expression *cond = getActionCompleteCondition();
     checkError(cond->isActive(),
                "Children waiting or finished for " << getNodeId() << ' ' << this
                << " is inactive.");
 #endif
     bool tempb;
-    cond->getValue(tempb); // AllWaitingOrFinished is always known
+    getConditionValue(actionCompleteIdx, tempb); // AllWaitingOrFinished is always known
     if (tempb) {
       if (this->getFailureType() == PARENT_EXITED) {
         debugMsg("Node:getDestState",
@@ -98,4 +98,11 @@ namespace PLEXIL
     return result;
   }
 
+  void clearGlobalMutexes()
+  {
+    debugMsg("Mutex:clearGlobalMutexes",
+             " deleting " << s_globalMutexes.size() << " mutexes");
+    s_globalMutexes.clear();
+  }
+
 }
@@ -87,6 +87,10 @@ namespace PLEXIL
   //! \note Should never return null.
   Mutex *ensureGlobalMutex(char const *name);
 
+  //! \brief Delete all global mutexes.
+  //! \note Should only be called when no plans are loaded.
+  void clearGlobalMutexes();
+
 }
 
 #endif // PLEXIL_MUTEX_HH
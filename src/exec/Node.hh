@@ -41,6 +41,7 @@ namespace PLEXIL {
   // Forward references
   class Assignable;
   class Mutex;
+  class NodeStateTable;
   class PlexilExec;
 
   //! \enum QueueStatus
@@ -107,6 +108,10 @@ namespace PLEXIL {
     //!         null for root nodes.
     virtual Node const *getParent() const = 0;
 
+    //! \brief Get the root node of the plan containing this node.
+    //! \return Const pointer to the root Node; this node if it has no parent.
+    virtual Node const *getRoot() const = 0;
+
     //
     // Accessors of dynamic node state
     //
@@ -123,6 +128,35 @@ namespace PLEXIL {
     //! \return The FailureType value.
     virtual FailureType getFailureType() const = 0;
 
+    //
+    // Exec listener support
+    //
+
+    //! \brief Get the set of Exec listeners interested in this node's events.
+    //! \return The bitmask; bit N set means listener N may report them.
+    //! \note Maintained by the listener hub; all bits are set by default.
+    virtual uint32_t getListenerMask() const = 0;
+
+    //! \brief Set the set of Exec listeners interested in this node's events.
+    //! \param mask The new bitmask.
+    virtual void setListenerMask(uint32_t mask) = 0;
+
+    //
+    // Node state table support
+    //
+
+    //! \brief Add this node and its descendants to the table.
+    //! \param table The table.
+    //! \param parent The table index of this node's parent, or
+    //!               NodeStateTable::NO_INDEX if none.
+    //! \note Called by the PlexilExec when the plan is added.
+    virtual void addToStateTable(NodeStateTable &table, uint32_t parent) = 0;
+
+    //! \brief Remove this node and its descendants from the table.
+    //! \param table The table.
+    //! \note Called by the PlexilExec before the plan is deleted.
+    virtual void removeFromStateTable(NodeStateTable &table) = 0;
+
     //
     // Queue management API
     //
@@ -202,6 +236,11 @@ namespace PLEXIL {
     //! \see Reservable
     virtual void releaseResourceReservations() = 0;
 
+    //! \brief Release every resource held or awaited by this node and
+    //!        its descendants.
+    //! \note Used when removing a plan which has not finished.
+    virtual void releaseAllResources() = 0;
+
     //
     // Printed representation
     //
@@ -0,0 +1,79 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "NodeConditionSet.hh"
+
+#include "Error.hh"
+
+namespace PLEXIL
+{
+
+  NodeConditionSet::~NodeConditionSet()
+  {
+    delete[] m_slots;
+  }
+
+  void NodeConditionSet::set(size_t idx, Expression *exp)
+  {
+    assertTrue_2(idx < MAX_CONDITIONS, "NodeConditionSet::set: index out of range");
+    uint16_t bit = (uint16_t) (1 << idx);
+    size_t pos = slotIndex(idx);
+    if (!exp)
+      // An absent condition is never deleted with the node
+      m_garbage &= (uint16_t) ~bit;
+    if (m_present & bit) {
+      if (exp) {
+        m_slots[pos] = exp;
+        return;
+      }
+      // Remove the slot
+      size_t n = size();
+      for (size_t i = pos + 1; i < n; ++i)
+        m_slots[i - 1] = m_slots[i];
+      m_present &= (uint16_t) ~bit;
+      if (!m_present) {
+        delete[] m_slots;
+        m_slots = nullptr;
+      }
+      return;
+    }
+    if (!exp)
+      return;
+
+    // Insert a slot.  Conditions are only added during plan loading,
+    // so grow exactly.
+    size_t n = size();
+    Expression **newSlots = new Expression*[n + 1];
+    for (size_t i = 0; i < pos; ++i)
+      newSlots[i] = m_slots[i];
+    newSlots[pos] = exp;
+    for (size_t i = pos; i < n; ++i)
+      newSlots[i + 1] = m_slots[i];
+    delete[] m_slots;
+    m_slots = newSlots;
+    m_present |= bit;
+  }
+
+} // namespace PLEXIL
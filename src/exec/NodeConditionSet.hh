@@ -0,0 +1,137 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_NODE_CONDITION_SET_HH
+#define PLEXIL_NODE_CONDITION_SET_HH
+
+#include <cstddef> // size_t
+#include <cstdint>
+
+namespace PLEXIL
+{
+  // Forward reference
+  class Expression;
+
+  //! \class NodeConditionSet
+  //! \brief Sparse storage for a node's condition expressions and
+  //!        their ownership flags, indexed by NodeImpl::ConditionIndex.
+  //! \note Most nodes have few conditions, so only the pointers
+  //!       actually set are stored, in index order.
+  //! \ingroup Exec-Core
+  class NodeConditionSet final
+  {
+  public:
+
+    //! \brief The maximum number of conditions.
+    static constexpr size_t MAX_CONDITIONS = 16;
+
+    //! \brief Default constructor.
+    NodeConditionSet()
+      : m_slots(nullptr),
+        m_present(0),
+        m_garbage(0)
+    {
+    }
+
+    //! \brief Destructor.
+    //! \note Does not delete the expressions.
+    ~NodeConditionSet();
+
+    //! \brief Get the condition at the index.
+    //! \param idx The index.
+    //! \return Pointer to the condition; null if not set.
+    Expression *operator[](size_t idx) const
+    {
+      uint16_t bit = (uint16_t) (1 << idx);
+      if (!(m_present & bit))
+        return nullptr;
+      return m_slots[slotIndex(idx)];
+    }
+
+    //! \brief Set or clear the condition at the index.
+    //! \param idx The index.
+    //! \param exp Pointer to the condition; may be null.
+    //! \note Clearing a condition also clears its garbage flag.
+    void set(size_t idx, Expression *exp);
+
+    //! \brief Query whether the condition at the index is to be
+    //!        deleted with the node.
+    //! \param idx The index.
+    //! \return True if owned by the node, false if not.
+    bool isGarbage(size_t idx) const
+    {
+      return m_garbage & (1 << idx);
+    }
+
+    //! \brief Mark whether the condition at the index is to be
+    //!        deleted with the node.
+    //! \param idx The index.
+    //! \param garbage True if owned by the node, false if not.
+    void setGarbage(size_t idx, bool garbage)
+    {
+      if (garbage)
+        m_garbage |= (uint16_t) (1 << idx);
+      else
+        m_garbage &= (uint16_t) ~(1 << idx);
+    }
+
+    //! \brief Get the number of conditions stored.
+    //! \return The count.
+    size_t size() const
+    {
+      return countBits(m_present);
+    }
+
+  private:
+
+    // Not implemented
+    NodeConditionSet(NodeConditionSet const &) = delete;
+    NodeConditionSet(NodeConditionSet &&) = delete;
+    NodeConditionSet &operator=(NodeConditionSet const &) = delete;
+    NodeConditionSet &operator=(NodeConditionSet &&) = delete;
+
+    //! \brief Count the bits set in a mask.
+    static size_t countBits(uint16_t mask)
+    {
+      mask = mask - ((mask >> 1) & 0x5555);
+      mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+      mask = (mask + (mask >> 4)) & 0x0F0F;
+      return (mask + (mask >> 8)) & 0x1F;
+    }
+
+    //! \brief Get the position in m_slots of the condition at the index.
+    size_t slotIndex(size_t idx) const
+    {
+      return countBits(m_present & (uint16_t) ((1 << idx) - 1));
+    }
+
+    Expression **m_slots; //!< The conditions present, in index order.
+    uint16_t m_present;   //!< Bit set for each condition present.
+    uint16_t m_garbage;   //!< Bit set for each condition owned by the node.
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_NODE_CONDITION_SET_HH
@@ -26,6 +26,7 @@
 
 #include "NodeFunction.hh"
 
+#include "ExpressionProfiler.hh"
 #include "NodeImpl.hh"
 #include "NodeOperator.hh"
 #include "Value.hh"
@@ -79,6 +80,7 @@ namespace PLEXIL
 
   bool NodeFunction::getValue(Boolean &result) const
   {
+    PROFILE_EXPRESSION_EVALUATION(this);
     return (*m_op)(result, m_node);
   }
 
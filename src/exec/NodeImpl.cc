@@ -25,10 +25,13 @@
 
 #include "NodeImpl.hh"
 
+#include "CompiledExpression.hh"
+#include "ConditionProfiler.hh"
 #include "Debug.hh"
 #include "Error.hh"
 #include "Mutex.hh"
 #include "NodeConstants.hh"
+#include "NodeStateTable.hh"
 #include "NodeTimepointValue.hh"
 #include "NodeVariableMap.hh"
 #include "PlanError.hh"
@@ -138,6 +141,9 @@ namespace PLEXIL
     return result;
   }
 
+  static_assert(NodeImpl::conditionIndexMax <= NodeConditionSet::MAX_CONDITIONS,
+                "Too many conditions for NodeConditionSet");
+
   char const *NodeImpl::getConditionName(size_t idx)
   {
     return ALL_CONDITIONS[idx];
@@ -150,27 +156,24 @@ namespace PLEXIL
       m_state(INACTIVE_STATE),
       m_outcome(NO_OUTCOME),
       m_failureType(NO_FAILURE),
-      m_pad(),
       m_nextState(NO_NODE_STATE),
       m_nextOutcome(NO_OUTCOME),
       m_nextFailureType(NO_FAILURE),
+      m_cleanedBody(false),
+      m_cleanedConditions(false),
+      m_cleanedVars(false),
+      m_conditionListenerCount(0),
       m_parent(parent),
+      m_root(parent ? parent->m_root : this),
       m_conditions(),
-      m_localVariables(),
-      m_localMutexes(),
-      m_usingMutexes(),
-      m_stateVariable(*this),
-      m_outcomeVariable(*this),
-      m_failureTypeVariable(*this),
-      m_variablesByName(),
-      m_nodeId(nodeId),
-      m_priority(WORST_PRIORITY),
+      m_compiledConditions(),
+      m_conditionListeners(),
       m_currentStateStartTime(0.0),
-      m_timepoints(),
-      m_garbageConditions(),
-      m_cleanedBody(false),
-      m_cleanedConditions(false),
-      m_cleanedVars(false)
+      m_priority(WORST_PRIORITY),
+      m_listenerMask(~(uint32_t) 0),
+      m_stateTableIndex(NodeStateTable::NO_INDEX),
+      m_cold(),
+      m_nodeId(nodeId)
   {
     debugMsg("NodeImpl:NodeImpl", " Constructor for \"" << m_nodeId << "\"");
     commonInit();
@@ -187,27 +190,24 @@ namespace PLEXIL
       m_state(state),
       m_outcome(NO_OUTCOME),
       m_failureType(NO_FAILURE),
-      m_pad(),
       m_nextState(NO_NODE_STATE),
       m_nextOutcome(NO_OUTCOME),
       m_nextFailureType(NO_FAILURE),
+      m_cleanedBody(false),
+      m_cleanedConditions(false),
+      m_cleanedVars(false),
+      m_conditionListenerCount(0),
       m_parent(parent),
+      m_root(parent ? parent->m_root : this),
       m_conditions(),
-      m_localVariables(),
-      m_localMutexes(),
-      m_usingMutexes(),
-      m_stateVariable(*this),
-      m_outcomeVariable(*this),
-      m_failureTypeVariable(*this),
-      m_variablesByName(),
-      m_nodeId(name),
-      m_priority(WORST_PRIORITY),
+      m_compiledConditions(),
+      m_conditionListeners(),
       m_currentStateStartTime(0.0),
-      m_timepoints(),
-      m_garbageConditions(),
-      m_cleanedBody(false),
-      m_cleanedConditions(false), 
-      m_cleanedVars(false)
+      m_priority(WORST_PRIORITY),
+      m_listenerMask(~(uint32_t) 0),
+      m_stateTableIndex(NodeStateTable::NO_INDEX),
+      m_cold(),
+      m_nodeId(name)
   {
     static Value const falseValue(false);
 
@@ -220,12 +220,16 @@ namespace PLEXIL
       debugMsg("NodeImpl:NodeImpl", ' ' << m_nodeId
                << " Created internal variable " << varName <<
                " with value FALSE");
-      m_conditions[i] = expr;
-      m_garbageConditions[i] = true;
+      m_conditions.set(i, expr);
+      m_conditions.setGarbage(i, true);
+    }
+
+    createConditionListeners();
+    for (size_t i = 0; i < conditionIndexMax; ++i) {
       // N.B. Ancestor-end, ancestor-exit, and ancestor-invariant belong to parent;
       // will be nullptr if this node has no parent
       if (i != preIdx && i != postIdx && getCondition(i))
-        getCondition(i)->addListener(this);
+        getCondition(i)->addListener(getConditionListener(i));
     }
 
     PlexilNodeType nodeType = parseNodeType(type.c_str());
@@ -287,14 +291,15 @@ namespace PLEXIL
 
   void NodeImpl::allocateVariables(size_t n)
   {
-    assertTrue_1(!m_localVariables); // illegal to call this twice
-    m_localVariables.reset(new std::vector<ExpressionPtr>());
-    m_localVariables->reserve(n);
+    ColdData &c = cold();
+    assertTrue_1(!c.localVariables); // illegal to call this twice
+    c.localVariables.reset(new std::vector<ExpressionPtr>());
+    c.localVariables->reserve(n);
     NodeVariableMap const *parentMap = nullptr;
     if (m_parent)
       parentMap = m_parent->getChildVariableMap();
-    m_variablesByName = NodeVariableMapPtr(new NodeVariableMap(parentMap));
-    m_variablesByName->grow(n);
+    c.variablesByName = NodeVariableMapPtr(new NodeVariableMap(parentMap));
+    c.variablesByName->grow(n);
   }
 
   NodeVariableMap const *NodeImpl::getChildVariableMap() const
@@ -304,47 +309,57 @@ namespace PLEXIL
 
   bool NodeImpl::addLocalVariable(char const *name, Expression *var)
   {
-    assertTrueMsg(m_localVariables && m_variablesByName,
+    assertTrueMsg(m_cold && m_cold->localVariables && m_cold->variablesByName,
                   "Internal error: failed to allocate variables");
-    if (m_variablesByName->find(name) != m_variablesByName->end())
+    if (!m_cold->variablesByName->insert(name, var))
       return false; // duplicate
-    (*m_variablesByName)[name] = var;
-    m_localVariables->emplace_back(ExpressionPtr(var));
+    m_cold->localVariables->emplace_back(ExpressionPtr(var));
     return true;
   }
 
+  void NodeImpl::addSharedExpression(Expression *exp)
+  {
+    ColdData &c = cold();
+    if (!c.sharedExpressions)
+      c.sharedExpressions.reset(new std::vector<ExpressionPtr>());
+    c.sharedExpressions->emplace_back(ExpressionPtr(exp));
+  }
+
   void NodeImpl::allocateMutexes(size_t n)
   {
-    assertTrue_1(!m_localMutexes); // illegal to call this twice
-    m_localMutexes.reset(new std::vector<MutexPtr>());
-    m_localMutexes->reserve(n);
+    ColdData &c = cold();
+    assertTrue_1(!c.localMutexes); // illegal to call this twice
+    c.localMutexes.reset(new std::vector<MutexPtr>());
+    c.localMutexes->reserve(n);
   }
 
   void NodeImpl::addMutex(Mutex *m)
   {
-    assertTrueMsg(m_localMutexes,
+    assertTrueMsg(m_cold && m_cold->localMutexes,
                   "Internal error: failed to allocate local mutex vector");
-    m_localMutexes->emplace_back(MutexPtr(m));
+    m_cold->localMutexes->emplace_back(MutexPtr(m));
   }
 
   void NodeImpl::allocateUsingMutexes(size_t n)
   {
-    assertTrue_1(!m_usingMutexes); // illegal to call this twice
-    m_usingMutexes.reset(new std::vector<Mutex *>());
-    m_usingMutexes->reserve(n);
+    ColdData &c = cold();
+    assertTrue_1(!c.usingMutexes); // illegal to call this twice
+    c.usingMutexes.reset(new std::vector<Mutex *>());
+    c.usingMutexes->reserve(n);
   }
 
   void NodeImpl::addUsingMutex(Mutex *m)
   {
-    assertTrueMsg(m_usingMutexes,
+    assertTrueMsg(m_cold && m_cold->usingMutexes,
                   "Internal error: failed to allocate using mutex vector");
-    m_usingMutexes->push_back(m);
+    m_cold->usingMutexes->push_back(m);
   }
 
   void NodeImpl::finalizeConditions()
   {
     // Create conditions that may wrap user-defined conditions
     createConditionWrappers();
+    createConditionListeners();
 
     //
     // *** N.B. ***
@@ -361,7 +376,7 @@ namespace PLEXIL
 
       default:
         if (m_conditions[condIdx])
-          m_conditions[condIdx]->addListener(this);
+          m_conditions[condIdx]->addListener(getConditionListener(condIdx));
         break;
       }
 
@@ -370,15 +385,31 @@ namespace PLEXIL
     if (m_parent) {
       Expression *ancestorCond = getAncestorExitCondition();
       if (ancestorCond)
-        ancestorCond->addListener(this);
+        ancestorCond->addListener(getConditionListener(ancestorExitIdx));
 
       ancestorCond = getAncestorInvariantCondition();
       if (ancestorCond)
-        ancestorCond->addListener(this);
+        ancestorCond->addListener(getConditionListener(ancestorInvariantIdx));
 
       ancestorCond = getAncestorEndCondition();
       if (ancestorCond)
-        ancestorCond->addListener(this);
+        ancestorCond->addListener(getConditionListener(ancestorEndIdx));
+    }
+
+    // Compile the conditions this node owns, including the ancestor
+    // conditions it provides to its children
+    for (size_t condIdx = 0; condIdx < conditionIndexMax; ++condIdx) {
+      if (!m_conditions[condIdx])
+        continue;
+      CompiledExpression *compiled =
+        CompiledExpression::compile(m_conditions[condIdx]);
+      if (!compiled)
+        continue;
+      debugMsg("Node:finalizeConditions",
+               ' ' << m_nodeId << " compiled " << getConditionName(condIdx));
+      if (!m_compiledConditions)
+        m_compiledConditions.reset(new std::vector<CompiledExpressionPtr>(conditionIndexMax));
+      (*m_compiledConditions)[condIdx].reset(compiled);
     }
   }
 
@@ -391,8 +422,8 @@ namespace PLEXIL
     assertTrueMsg(which >= skipIdx && which <= repeatIdx,
                   "Internal error: Invalid condition name \"" << cname << "\" for user condition");
 
-    m_conditions[which] = cond;
-    m_garbageConditions[which] = isGarbage;
+    m_conditions.set(which, cond);
+    m_conditions.setGarbage(which, isGarbage);
   }
 
   void NodeImpl::createConditionWrappers()
@@ -418,12 +449,66 @@ namespace PLEXIL
     // Now safe to delete variables
     cleanUpVars();
 
-    // Delete timepoints, if any
-    delete m_timepoints.release();
+    if (m_cold) {
+      // Delete timepoints, if any
+      delete m_cold->timepoints.release();
     
-    // Delete mutex vectors
-    delete m_usingMutexes.release();
-    delete m_localMutexes.release();
+      // Delete mutex vectors
+      delete m_cold->usingMutexes.release();
+      delete m_cold->localMutexes.release();
+
+      // Shared expressions may refer to variables of this node or its
+      // descendants, but do not touch them when deleted
+      delete m_cold->sharedExpressions.release();
+    }
+  }
+
+  NodeImpl::ColdData::ColdData()
+    : localVariables(),
+      localMutexes(),
+      usingMutexes(),
+      sharedExpressions(),
+      variablesByName(),
+      timepoints(),
+      stateVariable(),
+      outcomeVariable(),
+      failureTypeVariable()
+  {
+  }
+
+  NodeImpl::ColdData::~ColdData() = default;
+
+  NodeImpl::ColdData const NodeImpl::s_emptyColdData;
+
+  NodeImpl::ColdData &NodeImpl::cold()
+  {
+    if (!m_cold)
+      m_cold.reset(new ColdData());
+    return *m_cold;
+  }
+
+  Expression *NodeImpl::getStateVariable()
+  {
+    ColdData &c = cold();
+    if (!c.stateVariable)
+      c.stateVariable.reset(new StateVariable(*this));
+    return c.stateVariable.get();
+  }
+
+  Expression *NodeImpl::getOutcomeVariable()
+  {
+    ColdData &c = cold();
+    if (!c.outcomeVariable)
+      c.outcomeVariable.reset(new OutcomeVariable(*this));
+    return c.outcomeVariable.get();
+  }
+
+  Expression *NodeImpl::getFailureTypeVariable()
+  {
+    ColdData &c = cold();
+    if (!c.failureTypeVariable)
+      c.failureTypeVariable.reset(new FailureVariable(*this));
+    return c.failureTypeVariable.get();
   }
 
   void NodeImpl::cleanUpConditions() 
@@ -433,39 +518,45 @@ namespace PLEXIL
 
     debugMsg("Node:cleanUpConditions", " for " << m_nodeId);
 
+    // Compiled conditions refer to the expressions about to be deleted
+    delete m_compiledConditions.release();
+
+    // As do any profiling data
+    ConditionProfiler::retire(this);
+
     // Remove listeners from ancestor invariant and ancestor end conditions
     if (m_parent) {
       Expression *ancestorCond = getAncestorExitCondition();
       if (ancestorCond)
-        ancestorCond->removeListener(this);
+        ancestorCond->removeListener(getConditionListener(ancestorExitIdx));
 
       ancestorCond = getAncestorInvariantCondition();
       if (ancestorCond)
-        ancestorCond->removeListener(this);
+        ancestorCond->removeListener(getConditionListener(ancestorInvariantIdx));
 
       ancestorCond = getAncestorEndCondition();
       if (ancestorCond)
-        ancestorCond->removeListener(this);
+        ancestorCond->removeListener(getConditionListener(ancestorEndIdx));
     }
 
     // Remove condition listeners
     for (size_t i = 0; i < conditionIndexMax; ++i) {
       Expression *cond = getCondition(i);
       if (cond)
-        cond->removeListener(this);
+        cond->removeListener(getConditionListener(i));
     }
 
     // Clean up conditions
     // N.B.: Ancestor-end, ancestor-exit, and ancestor-invariant
     // MUST be cleaned up before end, exit, and invariant, respectively. 
     for (size_t i = 0; i < conditionIndexMax; ++i) {
-      if (m_garbageConditions[i]) {
+      if (m_conditions.isGarbage(i)) {
         debugMsg("Node:cleanUpConds",
                  ' ' << m_nodeId << " Removing condition " << getConditionName(i));
         delete m_conditions[i];
       }
-      m_conditions[i] = nullptr;
-      m_garbageConditions[i] = false;
+      m_conditions.set(i, nullptr);
+      m_conditions.setGarbage(i, false);
     }
 
     m_cleanedConditions = true;
@@ -487,17 +578,19 @@ namespace PLEXIL
 
     debugMsg("Node:cleanUpVars", " for " << m_nodeId);
 
-    // Delete map
-    delete m_variablesByName.release();
+    if (m_cold) {
+      // Delete map
+      delete m_cold->variablesByName.release();
 
-    // Delete user-spec'd variables
-    if (m_localVariables) {
-      for (ExpressionPtr &var : *m_localVariables) {
-        debugMsg("Node:cleanUpVars",
-                 ' ' << m_nodeId << " Removing " << *var);
-        delete var.release();
+      // Delete user-spec'd variables
+      if (m_cold->localVariables) {
+        for (ExpressionPtr &var : *m_cold->localVariables) {
+          debugMsg("Node:cleanUpVars",
+                   ' ' << m_nodeId << " Removing " << *var);
+          delete var.release();
+        }
+        delete m_cold->localVariables.release();
       }
-      delete m_localVariables.release();
     }
 
     // Delete internal variables
@@ -553,6 +646,32 @@ namespace PLEXIL
     }
   }
 
+  bool NodeImpl::getConditionValue(size_t idx, Boolean &result) const
+  {
+    NodeImpl const *owner = this;
+    switch (idx) {
+
+    case ancestorEndIdx:
+    case ancestorExitIdx:
+    case ancestorInvariantIdx:
+      owner = m_parent;
+      break;
+
+    default:
+      break;
+    }
+
+    Expression const *cond = owner->m_conditions[idx];
+    if (ConditionProfiler::isEnabled())
+      return ConditionProfiler::evaluate(owner, idx, cond, result);
+    if (owner->m_compiledConditions) {
+      CompiledExpression const *compiled = (*owner->m_compiledConditions)[idx].get();
+      if (compiled && compiled->source() == cond)
+        return compiled->getValue(result);
+    }
+    return cond->getValue(result);
+  }
+
   // Default methods.
   std::vector<NodeImplPtr>& NodeImpl::getChildren()
   {
@@ -570,6 +689,106 @@ namespace PLEXIL
   {
     notify(g_exec);
   }
+
+  //
+  // Node state table support
+  //
+
+  // Parents are added before children, so a scan in index order
+  // visits each subtree top down.
+  void NodeImpl::addToStateTable(NodeStateTable &table, uint32_t parent)
+  {
+    assertTrue_2(m_stateTableIndex == NodeStateTable::NO_INDEX,
+                 "NodeImpl::addToStateTable: node is already in a state table");
+    m_stateTableIndex = table.add(this, parent, m_currentStateStartTime);
+    for (NodeImplPtr const &child : getChildren())
+      child->addToStateTable(table, m_stateTableIndex);
+  }
+
+  void NodeImpl::removeFromStateTable(NodeStateTable &table)
+  {
+    for (NodeImplPtr const &child : getChildren())
+      child->removeFromStateTable(table);
+    if (m_stateTableIndex != NodeStateTable::NO_INDEX) {
+      table.remove(m_stateTableIndex);
+      m_stateTableIndex = NodeStateTable::NO_INDEX;
+    }
+  }
+
+  void NodeImpl::updateStateTable(PlexilExec *exec)
+  {
+    if (m_stateTableIndex == NodeStateTable::NO_INDEX || !exec)
+      return;
+    exec->getNodeStateTable().update(m_stateTableIndex, m_state, m_outcome,
+                                     m_failureType, m_currentStateStartTime);
+  }
+
+  // Off by default, so that traces of the check queue are unchanged
+  static bool s_filterConditionNotifications = false;
+
+  void NodeImpl::setConditionNotificationFilter(bool enable)
+  {
+    s_filterConditionNotifications = enable;
+  }
+
+  bool NodeImpl::getConditionNotificationFilter()
+  {
+    return s_filterConditionNotifications;
+  }
+
+  void NodeImpl::createConditionListeners()
+  {
+    if (m_conditionListeners || !s_filterConditionNotifications)
+      return;
+
+    // Pre- and postconditions are never listened to
+    uint8_t n = 0;
+    for (size_t i = 0; i < conditionIndexMax; ++i)
+      if (i != preIdx && i != postIdx && getCondition(i))
+        ++n;
+    if (!n)
+      return;
+
+    m_conditionListeners.reset(new ConditionListener[n]);
+    m_conditionListenerCount = n;
+    n = 0;
+    for (size_t i = 0; i < conditionIndexMax; ++i)
+      if (i != preIdx && i != postIdx && getCondition(i))
+        m_conditionListeners[n++].setup(this, i);
+  }
+
+  ExpressionListener *NodeImpl::getConditionListener(size_t idx)
+  {
+    for (size_t i = 0; i < m_conditionListenerCount; ++i)
+      if (m_conditionListeners[i].index() == idx)
+        return &m_conditionListeners[i];
+    return this;
+  }
+
+  void NodeImpl::ConditionListener::notifyChanged()
+  {
+    // A node already queued or transitioning will be checked anyway,
+    // so don't evaluate the condition now.  The value it is checked
+    // with is not known, so the next change must not be filtered.
+    if (m_node->m_queueStatus != QUEUE_NONE) {
+      m_lastValue = UNSEEN;
+      m_node->notifyChanged();
+      return;
+    }
+
+    Boolean value;
+    uint8_t newValue = UNKNOWN_VALUE;
+    if (m_node->getConditionValue(m_index, value))
+      newValue = value ? TRUE_VALUE : FALSE_VALUE;
+    if (newValue == m_lastValue) {
+      debugMsg("Node:conditionFilter",
+               ' ' << m_node->m_nodeId << ' ' << m_node << ' '
+               << getConditionName(m_index) << " unchanged, ignored");
+      return;
+    }
+    m_lastValue = newValue;
+    m_node->notifyChanged();
+  }
   
   void NodeImpl::notify(PlexilExec *exec)
   {
@@ -630,7 +849,7 @@ namespace PLEXIL
   //! @note AssignmentNode overrides this method.
   bool NodeImpl::acquiresResources() const
   {
-    return (m_usingMutexes && !m_usingMutexes->empty());
+    return (coldData().usingMutexes && !coldData().usingMutexes->empty());
   }
 
   //! Reserve the resource(s)
@@ -641,8 +860,8 @@ namespace PLEXIL
   bool NodeImpl::tryResourceAcquisition()
   {
     bool success = true;
-    if (m_usingMutexes) {
-      for (Mutex *m : *m_usingMutexes) {
+    if (coldData().usingMutexes) {
+      for (Mutex *m : *coldData().usingMutexes) {
         success = m->acquire(this);
         if (!success) {
           // Check for recursive acquisition on failure
@@ -679,8 +898,8 @@ namespace PLEXIL
 
     if (!success) {
       // If we couldn't get all the resources, release the resources we got
-      if (m_usingMutexes) {
-        for (Mutex *m : *m_usingMutexes) {
+      if (coldData().usingMutexes) {
+        for (Mutex *m : *coldData().usingMutexes) {
           if (this == dynamic_cast<Node const *>(m->getHolder()))
             m->release(this);
           m->addWaitingNode(this); // no harm if already there
@@ -695,12 +914,29 @@ namespace PLEXIL
   //! @note AssignmentNode wraps this method.
   void NodeImpl::releaseResourceReservations()
   {
-    if (m_usingMutexes) {
-      for (Mutex *m : *m_usingMutexes)
+    if (coldData().usingMutexes) {
+      for (Mutex *m : *coldData().usingMutexes)
         m->removeWaitingNode(this);
     }
   }
 
+  void NodeImpl::releaseAllResources()
+  {
+    for (NodeImplPtr const &child : getChildren())
+      child->releaseAllResources();
+    releaseResourceReservations();
+    if (coldData().usingMutexes) {
+      for (Mutex *m : *coldData().usingMutexes)
+        if (this == dynamic_cast<Node const *>(m->getHolder()))
+          m->release(this);
+    }
+    if (this->getType() == NodeType_Assignment) {
+      Variable *var = this->getAssignmentVariable()->getBaseVariable();
+      if (this == dynamic_cast<Node const *>(var->getHolder()))
+        var->release(this);
+    }
+  }
+
   void NodeImpl::notifyResourceAvailable()
   {
     switch (m_queueStatus) {
@@ -825,6 +1061,7 @@ namespace PLEXIL
       if (m_nextFailureType != NO_FAILURE) 
         setNodeFailureType((FailureType) m_nextFailureType);
     }
+    updateStateTable(exec);
 
     // Execute the node if appropriate
     if (m_nextState == EXECUTING_STATE)
@@ -888,7 +1125,7 @@ namespace PLEXIL
           checkError(cond->isActive(),
                      "NodeImpl::getDestStateFromInactive: Ancestor exit for "
                      << m_nodeId << ' ' << this << " is inactive.");
-          if (cond->getValue(temp) && temp) {
+          if (getConditionValue(ancestorExitIdx, temp) && temp) {
             debugMsg("Node:getDestState",
                      ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                      << " -> FINISHED. Parent EXECUTING and ANCESTOR_EXIT_CONDITION true.");
@@ -902,7 +1139,7 @@ namespace PLEXIL
           checkError(cond->isActive(),
                      "NodeImpl::getDestStateFromInactive: Ancestor invariant for "
                      << m_nodeId << ' ' << this << " is inactive.");
-          if (cond->getValue(temp) && !temp) {
+          if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
             debugMsg("Node:getDestState",
                      ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                      << " -> FINISHED. Parent EXECUTING and ANCESTOR_INVARIANT_CONDITION false.");
@@ -916,7 +1153,7 @@ namespace PLEXIL
           checkError(cond->isActive(),
                      "NodeImpl::getDestStateFromInactive: Ancestor end for "
                      << m_nodeId << ' ' << this << " is inactive.");
-          if (cond->getValue(temp) && temp) {
+          if (getConditionValue(ancestorEndIdx, temp) && temp) {
             debugMsg("Node:getDestState",
                      ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                      << " -> FINISHED. Parent EXECUTING and ANCESTOR_END_CONDITION true.");
@@ -988,7 +1225,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromWaiting: Ancestor exit for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. ANCESTOR_EXIT_CONDITION true.");
@@ -1002,7 +1239,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromWaiting: Exit condition for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. EXIT_CONDITION true.");
@@ -1016,7 +1253,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromWaiting: Ancestor invariant for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. ANCESTOR_INVARIANT_CONDITION false.");
@@ -1030,7 +1267,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromWaiting: Ancestor end for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorEndIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. ANCESTOR_END_CONDITION true.");
@@ -1044,7 +1281,7 @@ namespace PLEXIL
       checkError(cond->isActive(), 
                  "NodeImpl::getDestStateFromWaiting: Skip for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(skipIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. SKIP_CONDITION true.");
@@ -1058,14 +1295,14 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromWaiting: Start for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (!cond->getValue(temp) || !temp) {
+      if (!getConditionValue(startIdx, temp) || !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> no change. START_CONDITION false or unknown");
         return false;
       }
     }
-    if ((cond = getPreCondition()) && (!cond->getValue(temp) || !temp)) {
+    if ((cond = getPreCondition()) && (!getConditionValue(preIdx, temp) || !temp)) {
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromWaiting: Pre for "
                  << m_nodeId << ' ' << this << " is inactive.");
@@ -1137,7 +1374,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromExecuting: Ancestor exit for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. ANCESTOR_EXIT_CONDITION true.");
@@ -1152,7 +1389,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromExecuting: Exit condition for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> ITERATION_ENDED. EXIT_CONDITION true.");
@@ -1167,7 +1404,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromExecuting: Ancestor invariant for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. Ancestor invariant false.");
@@ -1182,7 +1419,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromExecuting: Invariant for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(invariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> ITERATION_ENDED. Invariant false.");
@@ -1193,7 +1430,7 @@ namespace PLEXIL
       }
     }
 
-    if ((cond = getEndCondition()) && (!cond->getValue(temp) || !temp)) {
+    if ((cond = getEndCondition()) && (!getConditionValue(endIdx, temp) || !temp)) {
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromExecuting: End for "
                  << m_nodeId << ' ' << this << " is inactive.");
@@ -1204,7 +1441,7 @@ namespace PLEXIL
              ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
              << " -> ITERATION_ENDED. End condition true.");
     m_nextState = ITERATION_ENDED_STATE;
-    if ((cond = getPostCondition()) && (!cond->getValue(temp) || !temp)) {
+    if ((cond = getPostCondition()) && (!getConditionValue(postIdx, temp) || !temp)) {
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromExecuting: Post for "
                  << m_nodeId << ' ' << this << " is inactive.");
@@ -1258,8 +1495,8 @@ namespace PLEXIL
   void NodeImpl::transitionToIterationEnded() 
   {
     // Release any mutexes held by this node
-    if (m_usingMutexes && m_state != WAITING_STATE) {
-      for (Mutex *m : *m_usingMutexes)
+    if (coldData().usingMutexes && m_state != WAITING_STATE) {
+      for (Mutex *m : *coldData().usingMutexes)
         m->release(this);
     }
     activateRepeatCondition();
@@ -1274,7 +1511,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromIterationEnded: Ancestor exit for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. ANCESTOR_EXIT_CONDITION true.");
@@ -1289,7 +1526,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromIterationEnded: Ancestor invariant for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. ANCESTOR_INVARIANT false.");
@@ -1304,7 +1541,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "NodeImpl::getDestStateFromIterationEnded: Ancestor end for "
                  << m_nodeId << ' ' << this << " is inactive.");
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorEndIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FINISHED. ANCESTOR_END true.");
@@ -1315,7 +1552,7 @@ namespace PLEXIL
     }
 
     if ((cond = getRepeatCondition())) {
-      if (!cond->getValue(temp)) {
+      if (!getConditionValue(repeatIdx, temp)) {
         checkError(cond->isActive(),
                    "NodeImpl::getDestStateFromIterationEnded: Repeat for "
                    << m_nodeId << ' ' << this << " is inactive.");
@@ -1377,8 +1614,8 @@ namespace PLEXIL
   void NodeImpl::transitionToFinished()
   {
     // If transitioning from FAILING,, Release any mutexes held by this node
-    if (m_usingMutexes && m_state == WAITING_STATE) {
-      for (Mutex *m : *m_usingMutexes)
+    if (coldData().usingMutexes && m_state == WAITING_STATE) {
+      for (Mutex *m : *coldData().usingMutexes)
         m->release(this);
     }
   }
@@ -1482,6 +1719,10 @@ namespace PLEXIL
     assertTrue_1(exec);
     logTransition(tym, newValue);
     m_state = newValue;
+    // The node is about to be checked in its new state.
+    // Conditions may have changed unseen while inactive.
+    for (size_t i = 0; i < m_conditionListenerCount; ++i)
+      m_conditionListeners[i].reset();
     if (m_state == FINISHED_STATE && !m_parent)
       // Mark this node as ready to be deleted -
       // with no parent, it cannot be reset, therefore cannot transition again.
@@ -1490,6 +1731,50 @@ namespace PLEXIL
       notify(exec); // check for potential of additional transitions
   }
 
+  bool NodeImpl::restoreState(PlexilExec *exec,
+                              NodeState dest,
+                              NodeOutcome outcome,
+                              FailureType failure,
+                              double tym)
+  {
+    assertTrue_1(m_state == INACTIVE_STATE);
+    debugMsg("Node:restoreState",
+             ' ' << m_nodeId << ' ' << this << " to " << nodeStateName(dest));
+
+    // Shortest legal path from INACTIVE to each state
+    static NodeState const sl_paths[NODE_STATE_MAX][4] =
+      {{NO_NODE_STATE},                                                  // NO_NODE_STATE
+       {NO_NODE_STATE},                                                  // INACTIVE
+       {WAITING_STATE, NO_NODE_STATE},                                   // WAITING
+       {WAITING_STATE, EXECUTING_STATE, NO_NODE_STATE},                  // EXECUTING
+       {WAITING_STATE, ITERATION_ENDED_STATE, NO_NODE_STATE},            // ITERATION_ENDED
+       {FINISHED_STATE, NO_NODE_STATE},                                  // FINISHED
+       {WAITING_STATE, EXECUTING_STATE, FAILING_STATE, NO_NODE_STATE},   // FAILING
+       {WAITING_STATE, EXECUTING_STATE, FINISHING_STATE, NO_NODE_STATE}  // FINISHING
+      };
+    assertTrue_2(dest < NODE_STATE_MAX, "NodeImpl::restoreState: invalid node state");
+
+    bool result = true;
+    for (NodeState const *next = sl_paths[dest]; *next != NO_NODE_STATE; ++next) {
+      if (*next == EXECUTING_STATE && acquiresResources() && !tryResourceAcquisition()) {
+        warn("Node " << m_nodeId << ": unable to reacquire resources on restore");
+        result = false;
+      }
+      m_nextState = *next;
+      m_nextOutcome = NO_OUTCOME;
+      m_nextFailureType = NO_FAILURE;
+      transition(exec, tym);
+    }
+
+    if (outcome != NO_OUTCOME) {
+      setNodeOutcome(outcome);
+      if (failure != NO_FAILURE)
+        setNodeFailureType(failure);
+      updateStateTable(exec);
+    }
+    return result;
+  }
+
   //
   // Transition time trace methods
   //
@@ -1497,17 +1782,17 @@ namespace PLEXIL
   void NodeImpl::logTransition(double tym, NodeState newState)
   {
     m_currentStateStartTime = tym;
-    if (!m_timepoints)
+    NodeTimepointValue *tp = coldData().timepoints.get();
+    if (!tp)
       return;
 
-    NodeTimepointValue *tp = m_timepoints.get();
     if (newState == INACTIVE_STATE) {
       // Reset timepoints
       while (tp) {
         tp->reset();
         tp = tp->next();
       }
-      tp = m_timepoints.get();
+      tp = m_cold->timepoints.get();
     }
 
     // Update relevant timepoints
@@ -1526,7 +1811,7 @@ namespace PLEXIL
 
     // Search for the desired state
     double result = -DBL_MAX; // default value if not found
-    NodeTimepointValue *tp = m_timepoints.get();
+    NodeTimepointValue *tp = coldData().timepoints.get();
     while (tp) {
       if (tp->state() == state && !tp->isEnd()) {
         tp->getValue(result);
@@ -1566,7 +1851,8 @@ namespace PLEXIL
 
   Expression *NodeImpl::ensureTimepoint(NodeState st, bool isEnd)
   {
-    NodeTimepointValue *result = m_timepoints.get();
+    ColdData &c = cold();
+    NodeTimepointValue *result = c.timepoints.get();
     while (result) {
       if (st == result->state() && isEnd == result->isEnd())
         return result;
@@ -1575,8 +1861,8 @@ namespace PLEXIL
 
     // Not found, create it
     result = new NodeTimepointValue(this, st, isEnd);
-    result->setNext(m_timepoints.release());
-    m_timepoints.reset(result);
+    result->setNext(c.timepoints.release());
+    c.timepoints.reset(result);
     return result;
   }
 
@@ -1586,8 +1872,8 @@ namespace PLEXIL
     debugMsg("Node:findVariable",
              " node " << m_nodeId << ", for " << name);
     Expression *result = nullptr;
-    if (m_variablesByName) {
-      result = m_variablesByName->findVariable(name); // searches ancestor maps
+    if (coldData().variablesByName) {
+      result = coldData().variablesByName->findVariable(name); // includes ancestors' variables
       condDebugMsg(result,
                    "Node:findVariable",
                    " node " << m_nodeId << " returning " << result->toString());
@@ -1619,11 +1905,11 @@ namespace PLEXIL
 
   Expression *NodeImpl::findLocalVariable(char const *name)
   {
-    if (!m_variablesByName)
+    if (!coldData().variablesByName)
       return nullptr;
 
-    NodeVariableMap::const_iterator it = m_variablesByName->find(name);
-    if (it != m_variablesByName->end()) {
+    NodeVariableMap::const_iterator it = coldData().variablesByName->find(name);
+    if (it != coldData().variablesByName->end()) {
       debugMsg("Node:findLocalVariable",
                ' ' << m_nodeId << " Returning " << it->second->toString());
       return it->second;
@@ -1655,7 +1941,7 @@ namespace PLEXIL
     Mutex *result = nullptr;
     NodeImpl const *node = this;
     while (node) {
-      std::vector<MutexPtr> const *mutexvec = node->m_localMutexes.get();
+      std::vector<MutexPtr> const *mutexvec = node->coldData().localMutexes.get();
       if (mutexvec) {
         result = findMutexInVector(name, *mutexvec);
         if (result) {
@@ -1823,16 +2109,16 @@ namespace PLEXIL
 
   void NodeImpl::activateLocalVariables()
   {
-    if (m_localVariables) {
-      for (ExpressionPtr &var : *m_localVariables)
+    if (coldData().localVariables) {
+      for (ExpressionPtr &var : *coldData().localVariables)
         var->activate();
     }
   }
 
   void NodeImpl::deactivateLocalVariables()
   {
-    if (m_localVariables) {
-      for (ExpressionPtr &var : *m_localVariables)
+    if (coldData().localVariables) {
+      for (ExpressionPtr &var : *coldData().localVariables)
         var->deactivate();
     }
   }
@@ -1921,12 +2207,12 @@ namespace PLEXIL
   // Print variables
   void NodeImpl::printVariables(std::ostream& stream, const unsigned int indent) const
   {
-    if (!m_variablesByName)
+    if (!coldData().variablesByName)
       return;
     
     std::string indentStr(indent, ' ');
-    for (NodeVariableMap::const_iterator it = m_variablesByName->begin();
-         it != m_variablesByName->end();
+    for (NodeVariableMap::const_iterator it = coldData().variablesByName->begin();
+         it != coldData().variablesByName->end();
          ++it) {
       stream << indentStr << ' ' << it->first << ": " <<
         *(it->second) << '\n';
@@ -1936,18 +2222,18 @@ namespace PLEXIL
   // Print mutexes
   void NodeImpl::printMutexes(std::ostream& stream, const unsigned int indent) const
   {
-    if (!m_localMutexes && !m_usingMutexes)
+    if (!coldData().localMutexes && !coldData().usingMutexes)
       return;
 
     std::string indentStr(indent, ' ');
-    if (m_localMutexes) {
+    if (coldData().localMutexes) {
       stream << indentStr << " Mutexes owned:\n";
-      for (MutexPtr const &mp : *m_localMutexes)
+      for (MutexPtr const &mp : *coldData().localMutexes)
         mp->print(stream, indent + 2);
     }
-    if (m_usingMutexes) {
+    if (coldData().usingMutexes) {
       stream << indentStr << " Mutexes used:\n";
-      for (Mutex const *m : *m_usingMutexes)
+      for (Mutex const *m : *coldData().usingMutexes)
         m->print(stream, indent + 2);
     }
   }
@@ -32,6 +32,7 @@
 // #define PARANOID_ABOUT_CONDITION_ACTIVATION 1
 
 #include "Node.hh"
+#include "NodeConditionSet.hh"
 #include "NodeVariables.hh"
 #include "Notifier.hh"
 
@@ -41,12 +42,14 @@ namespace PLEXIL
 {
 
   // Forward declarations
+  class CompiledExpression;
   class Mutex;
   class NodeImpl;
   class NodeTimepointValue;
   class NodeVariableMap;
 
   // Type aliases
+  using CompiledExpressionPtr = std::unique_ptr<CompiledExpression>;
   using ExpressionPtr = std::unique_ptr<Expression>;
   using MutexPtr = std::unique_ptr<Mutex>;
   using NodeImplPtr = std::unique_ptr<NodeImpl>;
@@ -158,6 +161,19 @@ namespace PLEXIL
     //! \brief Notify this object of a change.
     virtual void notifyChanged() override;
 
+    //! \brief Enable or disable filtering of condition change
+    //!        notifications for nodes constructed subsequently.
+    //! \param enable True to filter, false to pass every notification.
+    //! \note When filtering, a change in a condition's operands only
+    //!       puts the node on the exec's check queue if the
+    //!       condition's value (true, false, or unknown) has changed.
+    //!       Default is false.
+    static void setConditionNotificationFilter(bool enable);
+
+    //! \brief Query whether condition change notifications are filtered.
+    //! \return True if filtering, false if not.
+    static bool getConditionNotificationFilter();
+
     //
     // Listenable API
     //
@@ -219,6 +235,13 @@ namespace PLEXIL
       return dynamic_cast<Node const *>(m_parent);
     }
 
+    //! \brief Get the root node of the plan containing this node.
+    //! \return Const pointer to the root Node.
+    virtual Node const *getRoot() const override
+    {
+      return m_root;
+    }
+
     //
     // Accessors of dynamic node state
     //
@@ -269,6 +292,45 @@ namespace PLEXIL
       m_queueStatus = newval;
     }
 
+    //
+    // Exec listener support
+    //
+
+    //! \brief Get the set of Exec listeners interested in this node's events.
+    //! \return The bitmask.
+    virtual uint32_t getListenerMask() const override
+    {
+      return m_listenerMask;
+    }
+
+    //! \brief Set the set of Exec listeners interested in this node's events.
+    //! \param mask The new bitmask.
+    virtual void setListenerMask(uint32_t mask) override
+    {
+      m_listenerMask = mask;
+    }
+
+    //
+    // Node state table support
+    //
+
+    //! \brief Add this node and its descendants to the table.
+    //! \param table The table.
+    //! \param parent The table index of this node's parent, or
+    //!               NodeStateTable::NO_INDEX if none.
+    virtual void addToStateTable(NodeStateTable &table, uint32_t parent) override;
+
+    //! \brief Remove this node and its descendants from the table.
+    //! \param table The table.
+    virtual void removeFromStateTable(NodeStateTable &table) override;
+
+    //! \brief Get this node's index in the exec's node state table.
+    //! \return The index; NodeStateTable::NO_INDEX if not in the table.
+    uint32_t getStateTableIndex() const
+    {
+      return m_stateTableIndex;
+    }
+
     //
     // Node state transition API
     //
@@ -327,6 +389,10 @@ namespace PLEXIL
     //!        resources it was trying to acquire.
     virtual void releaseResourceReservations() override;
 
+    //! \brief Release every resource held or awaited by this node and
+    //!        its descendants.
+    virtual void releaseAllResources() override;
+
     //
     // Printed representation
     //
@@ -393,6 +459,33 @@ namespace PLEXIL
     //! \note Used by PlanDebugListener.
     double getStateStartTime(NodeState state) const;
 
+    //! \brief Get the first of the node's state transition timepoints.
+    //! \return Pointer to the timepoint; null if the plan references none.
+    //! \note The remaining timepoints are reached through NodeTimepointValue::next().
+    //! \note Used by the Exec snapshot facility.
+    NodeTimepointValue *getTimepoints() const
+    {
+      return coldData().timepoints.get();
+    }
+
+    //! \brief Bring a freshly activated node into a previously saved state,
+    //!        as if it had reached that state by normal execution.
+    //! \param exec The Exec to notify of the transitions.
+    //! \param dest The saved NodeState.
+    //! \param outcome The saved NodeOutcome.
+    //! \param failure The saved FailureType.
+    //! \param tym The time at which the node entered the saved state.
+    //! \return True if the node's resources could be reacquired, false otherwise.
+    //! \note The node is transitioned along the shortest legal path to
+    //!       the saved state, bypassing its transition conditions.
+    //!       The node's parent must already have been restored.
+    //! \note Used by the Exec snapshot facility.
+    bool restoreState(PlexilExec *exec,
+                      NodeState dest,
+                      NodeOutcome outcome,
+                      FailureType failure,
+                      double tym);
+
     //! \brief Find the named variable in this node, ignoring its ancestors.
     //! \param name Name of the variable, as a pointer to const character string.
     //! \return Pointer to the variable.  Will be null if no variable with that name was declared in this node.
@@ -440,6 +533,13 @@ namespace PLEXIL
     //! \return true if successful, false if name is a duplicate
     bool addLocalVariable(char const *name, Expression *var);
 
+    //! \brief Take ownership of an expression which may be shared
+    //!        among this node and any of its descendants.
+    //! \param exp Pointer to the expression.
+    //!            It will be deleted after this node's variables.
+    //! \note Only called on the root node of a plan, by the plan parser.
+    void addSharedExpression(Expression *exp);
+
     //! \brief Pre-allocate the node's vector of declared mutexes to the requested size.
     //! \param n The size.
     //! \note This is an optimization for use by the plan parser.
@@ -469,7 +569,7 @@ namespace PLEXIL
     //! \return Const pointer to the map.  May be null.
     NodeVariableMap const *getVariableMap() const
     {
-      return m_variablesByName.get();
+      return coldData().variablesByName.get();
     }
 
     //! \brief Add a condition expression to the node.
@@ -492,26 +592,17 @@ namespace PLEXIL
     //! \brief Get a pointer to the node's state variable.
     //! \return Pointer to the variable.
     //! \note Only used by plan parser.
-    Expression *getStateVariable()
-    {
-      return &m_stateVariable;
-    }
+    Expression *getStateVariable();
 
     //! \brief Get a pointer to the node's outcome variable.
     //! \return Pointer to the variable.
     //! \note Only used by plan parser.
-    Expression *getOutcomeVariable()
-    {
-      return &m_outcomeVariable;
-    }
+    Expression *getOutcomeVariable();
 
     //! \brief Get a pointer to the node's failure type variable.
     //! \return Pointer to the variable.
     //! \note Only used by plan parser.
-    Expression *getFailureTypeVariable()
-    {
-      return &m_failureTypeVariable;
-    }
+    Expression *getFailureTypeVariable();
 
     //! \brief Get a pointer to the variable representing the named
     //!        node state transition timepoint.
@@ -528,7 +619,7 @@ namespace PLEXIL
     //! \note Used by plan parser, plan analyzer, and parser unit tests.
     const std::vector<ExpressionPtr> *getLocalVariables() const
     {
-      return m_localVariables.get();
+      return coldData().localVariables.get();
     }
 
     // Condition accessors
@@ -580,6 +671,90 @@ namespace PLEXIL
     //! \return Pointer to the requested condition.  May be null.
     Expression *getCondition(size_t idx);
 
+    //! \brief Get the value of the condition indicated by the index,
+    //!        using its compiled form if there is one and profiling
+    //!        is not enabled.
+    //! \param idx A valid ConditionIndex value.
+    //! \param result Reference to the result variable.
+    //! \return True if the value is known, false if unknown.
+    //! \note The condition must not be null.
+    bool getConditionValue(size_t idx, Boolean &result) const;
+
+    //! \class ConditionListener
+    //! \brief Listens to one condition on behalf of the node, and
+    //!        notifies the node only when the condition's value has
+    //!        changed since the last notification.
+    class ConditionListener final : public ExpressionListener
+    {
+    public:
+      ConditionListener()
+        : m_node(nullptr),
+          m_index(0),
+          m_lastValue(UNSEEN)
+      {
+      }
+
+      virtual ~ConditionListener() = default;
+
+      //! \brief Bind this listener to a condition of a node.
+      //! \param node The node.
+      //! \param idx The condition's ConditionIndex.
+      void setup(NodeImpl *node, size_t idx)
+      {
+        m_node = node;
+        m_index = (uint8_t) idx;
+      }
+
+      //! \brief Get the index of the condition this listens to.
+      //! \return The ConditionIndex.
+      size_t index() const
+      {
+        return m_index;
+      }
+
+      //! \brief Forget the last value, so that the next notification
+      //!        is passed on unconditionally.
+      void reset()
+      {
+        m_lastValue = UNSEEN;
+      }
+
+      //! \brief Notify this object of a change.
+      virtual void notifyChanged() override;
+
+    private:
+
+      // Not implemented
+      ConditionListener(ConditionListener const &) = delete;
+      ConditionListener(ConditionListener &&) = delete;
+      ConditionListener &operator=(ConditionListener const &) = delete;
+      ConditionListener &operator=(ConditionListener &&) = delete;
+
+      //! \brief Values of m_lastValue.
+      enum LastValue : uint8_t {
+        UNKNOWN_VALUE = 0,
+        FALSE_VALUE,
+        TRUE_VALUE,
+        UNSEEN
+      };
+
+      NodeImpl *m_node;    //!< The node.
+      uint8_t m_index;     //!< Which condition.
+      uint8_t m_lastValue; //!< The value at the last notification passed on.
+    };
+
+    //! \brief Get the listener to attach to the condition indicated
+    //!        by the index.
+    //! \param idx A valid ConditionIndex value.
+    //! \return Pointer to the listener.
+    ExpressionListener *getConditionListener(size_t idx);
+
+    //! \brief Construct the filtering condition listeners,
+    //!        if filtering is enabled.
+    //! \note Only conditions which are present get a listener, so
+    //!       call this after all the node's conditions are set.
+    void createConditionListeners();
+
     //! \brief Get the map of variables accessible to children of this node.
     //! \return Const pointer to the map.  May return null.
     //! \note This default method always returns null.
@@ -817,8 +992,49 @@ namespace PLEXIL
     //! \indent indent The number of spaces to indent.
     virtual void printCommandHandle(std::ostream& stream, const unsigned int indent) const;
 
+    //! \struct ColdData
+    //! \brief Node data rarely used once the plan is loaded.  Only
+    //!        allocated for nodes which have some.
+    struct ColdData final
+    {
+      ColdData();
+      ~ColdData();
+
+      std::unique_ptr<std::vector<ExpressionPtr>> localVariables;    //!< Variables created in this node.
+      std::unique_ptr<std::vector<MutexPtr>>      localMutexes;      //!< Mutexes created in this node.
+      std::unique_ptr<std::vector<Mutex *>>       usingMutexes;      //!< Mutexes to be acquired by this node.
+      std::unique_ptr<std::vector<ExpressionPtr>> sharedExpressions; //!< Expressions shared among this node's descendants.
+      NodeVariableMapPtr    variablesByName; //!< Locally declared variables or references to variables gotten through an interface.
+      NodeTimepointValuePtr timepoints;      //!< The state transition timepoints referenced by the plan.
+      std::unique_ptr<StateVariable>   stateVariable;       //!< The node's state, as an expression.
+      std::unique_ptr<OutcomeVariable> outcomeVariable;     //!< The node's outcome, as an expression.
+      std::unique_ptr<FailureVariable> failureTypeVariable; //!< The node's failure type, as an expression.
+
+    private:
+
+      // Not implemented
+      ColdData(ColdData const &) = delete;
+      ColdData(ColdData &&) = delete;
+      ColdData &operator=(ColdData const &) = delete;
+      ColdData &operator=(ColdData &&) = delete;
+    };
+
+    //! \brief Get the node's cold data, allocating it if necessary.
+    //! \return Reference to the data.
+    ColdData &cold();
+
+    //! \brief Get the node's cold data without allocating it.
+    //! \return Const reference to the data; empty if none was allocated.
+    ColdData const &coldData() const
+    {
+      return m_cold ? *m_cold : s_emptyColdData;
+    }
+
+    static ColdData const s_emptyColdData; //!< Stands in for absent cold data.
+
     //
     // Common state
+    // The fields used in checking conditions and transitioning come first.
     //
 
     Node        *m_next;                //!< For LinkedQueue<Node>
@@ -826,46 +1042,33 @@ namespace PLEXIL
     NodeState    m_state;               //!< The current state of the node.
     NodeOutcome  m_outcome;             //!< The current outcome.
     FailureType  m_failureType;         //!< The current failure.
-
-    bool         m_pad; // to ensure 8 byte alignment
     NodeState    m_nextState;           //!< The state returned by getDestState() the last time checkConditions() was called.
     NodeOutcome  m_nextOutcome;         //!< The pending outcome.
     FailureType  m_nextFailureType;     //!< The pending failure.
 
-    NodeImpl    *m_parent;                          //!< The parent of this node.*/
-    Expression  *m_conditions[conditionIndexMax]; //!< The condition expressions.
- 
-    std::unique_ptr<std::vector<ExpressionPtr>> m_localVariables;  //!< Variables created in this node.
-    std::unique_ptr<std::vector<MutexPtr>>      m_localMutexes;    //!< Mutexes created in this node.
-    std::unique_ptr<std::vector<Mutex *>>       m_usingMutexes;    //!< Mutexes to be acquired by this node.
+    uint8_t m_cleanedBody : 1;          //!< true if node body has been cleaned up, false otherwise.
+    uint8_t m_cleanedConditions : 1;    //!< true if node conditions have been cleaned up, false otherwise.
+    uint8_t m_cleanedVars : 1;          //!< true if node variables have been cleaned up, false otherwise.
+    uint8_t m_conditionListenerCount : 4; //!< Number of entries in m_conditionListeners.
 
-    StateVariable    m_stateVariable;
-    OutcomeVariable  m_outcomeVariable;
-    FailureVariable  m_failureTypeVariable;
-
-    NodeVariableMapPtr m_variablesByName;  //!< Locally declared variables or references to variables gotten through an interface.
-    std::string        m_nodeId;           //!< The NodeId.
-    int32_t            m_priority;         //!< The priority.
+    NodeImpl    *m_parent;              //!< The parent of this node.
+    NodeImpl    *m_root;                //!< The root of this node's plan; cached for the Exec's run queues.
+    NodeConditionSet m_conditions;      //!< The condition expressions, and which to delete.
+    std::unique_ptr<std::vector<CompiledExpressionPtr>> m_compiledConditions; //!< Compiled forms of the conditions, by index.
+    std::unique_ptr<ConditionListener[]> m_conditionListeners; //!< Filtering listeners, in condition index order.
 
   private:
-    
-    //
-    // Node transition history trace
-    //
 
-    double m_currentStateStartTime;        //!< The time of the last node state transition.
-    NodeTimepointValuePtr m_timepoints;    //!< Pointer to the structure holding the state transition history.
+    double m_currentStateStartTime;     //!< The time of the last node state transition.
 
   protected:
 
-    //
-    // Housekeeping details
-    //
+    int32_t      m_priority;            //!< The priority.
+    uint32_t     m_listenerMask;        //!< Exec listeners interested in this node.
+    uint32_t     m_stateTableIndex;     //!< Index in the exec's NodeStateTable.
 
-    bool m_garbageConditions[conditionIndexMax]; //!< Flags indicating which conditions to delete.
-    bool m_cleanedBody;                          //!< true if node body has been cleaned up, false otherwise.
-    bool m_cleanedConditions;                    //!< true if node conditions have been cleaned up, false otherwise.
-    bool m_cleanedVars;                          //!< true if node variables have been cleaned up, false otherwise.
+    std::unique_ptr<ColdData> m_cold;   //!< Rarely used data, if any.
+    std::string  m_nodeId;              //!< The NodeId.
 
   private:
 
@@ -877,6 +1080,10 @@ namespace PLEXIL
     //! \param o The new NodeOutcome value.
     void setNodeOutcome(NodeOutcome o);
     
+    //! \brief Copy the node's current state to the exec's node state table.
+    //! \param exec The PlexilExec.
+    void updateStateTable(PlexilExec *exec);
+
     //! \brief Log the transition from the previous state to the specified state.
     //! \param time The time to log for the transition.
     //! \param newState The state being transitioned into.
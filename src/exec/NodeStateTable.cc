@@ -0,0 +1,163 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "NodeStateTable.hh"
+
+#include "Error.hh"
+#include "Node.hh"
+
+#include <iomanip>
+#include <ostream>
+
+namespace PLEXIL
+{
+
+  constexpr uint32_t NodeStateTable::NO_INDEX;
+
+  NodeStateTable::NodeStateTable()
+    : m_nodes(),
+      m_parents(),
+      m_states(),
+      m_outcomes(),
+      m_failureTypes(),
+      m_times(),
+      m_free()
+  {
+  }
+
+  uint32_t NodeStateTable::add(Node const *node, uint32_t parent, double time)
+  {
+    uint32_t idx;
+    if (m_free.empty()) {
+      idx = (uint32_t) m_nodes.size();
+      assertTrue_2(idx != NO_INDEX, "NodeStateTable::add: table full");
+      m_nodes.push_back(node);
+      m_parents.push_back(parent);
+      m_states.push_back(node->getState());
+      m_outcomes.push_back(node->getOutcome());
+      m_failureTypes.push_back(node->getFailureType());
+      m_times.push_back(time);
+      return idx;
+    }
+
+    idx = m_free.back();
+    m_free.pop_back();
+    m_nodes[idx] = node;
+    m_parents[idx] = parent;
+    update(idx, node->getState(), node->getOutcome(), node->getFailureType(), time);
+    return idx;
+  }
+
+  void NodeStateTable::remove(uint32_t idx)
+  {
+    assertTrue_2(idx < m_nodes.size() && m_nodes[idx],
+                 "NodeStateTable::remove: invalid index");
+    m_nodes[idx] = nullptr;
+    m_parents[idx] = NO_INDEX;
+    update(idx, NO_NODE_STATE, NO_OUTCOME, NO_FAILURE, 0.0);
+    m_free.push_back(idx);
+
+    // Trim unused entries from the end
+    if (m_free.size() == m_nodes.size())
+      clear();
+  }
+
+  void NodeStateTable::clear()
+  {
+    m_nodes.clear();
+    m_parents.clear();
+    m_states.clear();
+    m_outcomes.clear();
+    m_failureTypes.clear();
+    m_times.clear();
+    m_free.clear();
+  }
+
+  size_t NodeStateTable::countInState(NodeState state) const
+  {
+    size_t result = 0;
+    for (NodeState s : m_states)
+      if (s == state)
+        ++result;
+    return result;
+  }
+
+  void NodeStateTable::countByState(size_t (&counts)[NODE_STATE_MAX]) const
+  {
+    for (size_t i = 0; i < NODE_STATE_MAX; ++i)
+      counts[i] = 0;
+    for (NodeState s : m_states)
+      ++counts[s];
+  }
+
+  NodeStateRecord NodeStateTable::record(uint32_t idx) const
+  {
+    return NodeStateRecord {m_nodes[idx],
+                            idx,
+                            m_parents[idx],
+                            m_states[idx],
+                            m_outcomes[idx],
+                            m_failureTypes[idx],
+                            m_times[idx]};
+  }
+
+  void NodeStateTable::dump(std::vector<NodeStateRecord> &result) const
+  {
+    result.clear();
+    result.reserve(nodeCount());
+    uint32_t n = (uint32_t) m_states.size();
+    for (uint32_t i = 0; i < n; ++i)
+      if (m_states[i] != NO_NODE_STATE)
+        result.push_back(record(i));
+  }
+
+  void NodeStateTable::dumpChangedSince(double since,
+                                        std::vector<NodeStateRecord> &result) const
+  {
+    result.clear();
+    uint32_t n = (uint32_t) m_times.size();
+    for (uint32_t i = 0; i < n; ++i)
+      if (m_times[i] > since && m_states[i] != NO_NODE_STATE)
+        result.push_back(record(i));
+  }
+
+  void NodeStateTable::print(std::ostream &s) const
+  {
+    uint32_t n = (uint32_t) m_states.size();
+    for (uint32_t i = 0; i < n; ++i) {
+      if (m_states[i] == NO_NODE_STATE)
+        continue;
+      s << i << ' ' << m_nodes[i]->getNodeId()
+        << ' ' << nodeStateName(m_states[i]);
+      if (m_outcomes[i] != NO_OUTCOME) {
+        s << ' ' << outcomeName(m_outcomes[i]);
+        if (m_failureTypes[i] != NO_FAILURE)
+          s << ' ' << failureTypeName(m_failureTypes[i]);
+      }
+      s << ' ' << std::setprecision(15) << m_times[i] << '\n';
+    }
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,193 @@
+// Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_NODE_STATE_TABLE_HH
+#define PLEXIL_NODE_STATE_TABLE_HH
+
+#include "NodeConstants.hh"
+
+#include <iosfwd>
+#include <vector>
+
+namespace PLEXIL
+{
+  // Forward reference
+  class Node;
+
+  //! \struct NodeStateRecord
+  //! \brief One node's entry in a dump of the NodeStateTable.
+  //! \see NodeStateTable::dump
+  //! \ingroup Exec-Core
+  struct NodeStateRecord final
+  {
+    Node const *node;        //!< The node.
+    uint32_t index;          //!< The node's index in the table.
+    uint32_t parent;         //!< The parent's index, or NodeStateTable::NO_INDEX for a root.
+    NodeState state;         //!< The node's state.
+    NodeOutcome outcome;     //!< The node's outcome.
+    FailureType failureType; //!< The node's failure type.
+    double time;             //!< The time of the node's last transition.
+  };
+
+  //! \class NodeStateTable
+  //! \brief Contiguous, structure-of-arrays table of the state, outcome,
+  //!        failure type, and last transition time of every node in
+  //!        every active plan.
+  //!
+  //! The PlexilExec adds each plan's nodes when the plan is added,
+  //! and removes them when the plan is deleted.  Nodes update their
+  //! entries as they transition.  Queries over all nodes are linear
+  //! scans of one or two small columns, rather than walks of the node
+  //! trees.
+  //!
+  //! Entries of deleted nodes are reused.  An unused entry has a null
+  //! node and the state NO_NODE_STATE.
+  //!
+  //! \note Not thread safe.  The table changes as the Exec runs;
+  //!       callers on other threads must synchronize with it.
+  //! \ingroup Exec-Core
+  class NodeStateTable final
+  {
+  public:
+
+    //! \brief The index of a node not in the table.
+    static constexpr uint32_t NO_INDEX = 0xFFFFFFFF;
+
+    //! \brief Default constructor.
+    NodeStateTable();
+
+    //! \brief Destructor.
+    ~NodeStateTable() = default;
+
+    //! \brief Add a node to the table.
+    //! \param node The node.
+    //! \param parent The table index of the node's parent, or NO_INDEX.
+    //! \param time The time the node entered its current state.
+    //! \return The node's index.
+    uint32_t add(Node const *node, uint32_t parent, double time);
+
+    //! \brief Remove the node at the index from the table.
+    //! \param idx The index.
+    void remove(uint32_t idx);
+
+    //! \brief Remove all nodes from the table.
+    void clear();
+
+    //! \brief Record a node's state.
+    //! \param idx The node's index.
+    //! \param state The state.
+    //! \param outcome The outcome.
+    //! \param failure The failure type.
+    //! \param time The time of the last transition.
+    void update(uint32_t idx,
+                NodeState state,
+                NodeOutcome outcome,
+                FailureType failure,
+                double time)
+    {
+      m_states[idx] = state;
+      m_outcomes[idx] = outcome;
+      m_failureTypes[idx] = failure;
+      m_times[idx] = time;
+    }
+
+    //! \brief Get the number of entries, including unused ones.
+    //! \return The number of entries.
+    size_t size() const
+    {
+      return m_nodes.size();
+    }
+
+    //! \brief Get the number of nodes in the table.
+    //! \return The number of nodes.
+    size_t nodeCount() const
+    {
+      return m_nodes.size() - m_free.size();
+    }
+
+    //
+    // Column accessors
+    // Each returns a pointer to size() contiguous entries.
+    //
+
+    Node const *const *nodes() const         { return m_nodes.data(); }
+    uint32_t const *parents() const          { return m_parents.data(); }
+    NodeState const *states() const          { return m_states.data(); }
+    NodeOutcome const *outcomes() const      { return m_outcomes.data(); }
+    FailureType const *failureTypes() const  { return m_failureTypes.data(); }
+    double const *times() const              { return m_times.data(); }
+
+    //
+    // Bulk queries
+    //
+
+    //! \brief Count the nodes in the given state.
+    //! \param state The state.
+    //! \return The count.
+    size_t countInState(NodeState state) const;
+
+    //! \brief Count the nodes in each state.
+    //! \param counts Array to receive the counts, indexed by NodeState.
+    void countByState(size_t (&counts)[NODE_STATE_MAX]) const;
+
+    //! \brief Copy the state of every node in the table.
+    //! \param result Vector to receive the records, in index order.
+    //!               Any previous contents are replaced.
+    void dump(std::vector<NodeStateRecord> &result) const;
+
+    //! \brief Copy the state of every node which has transitioned
+    //!        since the given time.
+    //! \param since The time.
+    //! \param result Vector to receive the records, in index order.
+    //!               Any previous contents are replaced.
+    void dumpChangedSince(double since, std::vector<NodeStateRecord> &result) const;
+
+    //! \brief Print the state of every node in the table, one per line.
+    //! \param s The stream.
+    void print(std::ostream &s) const;
+
+  private:
+
+    // Not implemented
+    NodeStateTable(NodeStateTable const &) = delete;
+    NodeStateTable(NodeStateTable &&) = delete;
+    NodeStateTable &operator=(NodeStateTable const &) = delete;
+    NodeStateTable &operator=(NodeStateTable &&) = delete;
+
+    //! \brief Construct the record for the node at the index.
+    NodeStateRecord record(uint32_t idx) const;
+
+    std::vector<Node const *> m_nodes;        //!< The nodes.
+    std::vector<uint32_t>     m_parents;      //!< Their parents' indices.
+    std::vector<NodeState>    m_states;       //!< Their states.
+    std::vector<NodeOutcome>  m_outcomes;     //!< Their outcomes.
+    std::vector<FailureType>  m_failureTypes; //!< Their failure types.
+    std::vector<double>       m_times;        //!< Their last transition times.
+    std::vector<uint32_t>     m_free;         //!< Unused entries.
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_NODE_STATE_TABLE_HH
@@ -25,18 +25,192 @@
 
 #include "NodeVariableMap.hh"
 
-#include <cstring>  // strdup()
+#include "Debug.hh"
+#include "Error.hh"
+
+#include <cstdint>
+#include <cstdlib>  // free()
+#include <cstring>  // strcmp(), strdup()
+#include <unordered_map>
+#include <vector>
 
 namespace PLEXIL
 {
 
+  //! \class VariableScopeTable
+  //! \brief Interns the variable names used in one plan, assigning each
+  //!        distinct name a small integer symbol, and keeps the bindings
+  //!        of the open variable maps in one flat table indexed by
+  //!        symbol.
+  //! \ingroup Exec-Core
+  class VariableScopeTable final
+  {
+  public:
+    VariableScopeTable()
+      : m_symbols(),
+        m_bindings(),
+        m_open()
+    {
+    }
+
+    ~VariableScopeTable()
+    {
+      for (SymbolMap::value_type &entry : m_symbols)
+        free(const_cast<char *>(entry.first));
+    }
+
+    //! \brief Look up a name, interning it if not already present.
+    //! \param name The name.
+    //! \param sym Reference to a symbol; set on return.
+    //! \return The interned copy of the name.
+    char const *intern(char const *name, uint32_t &sym)
+    {
+      SymbolMap::const_iterator it = m_symbols.find(name);
+      if (it == m_symbols.end()) {
+        sym = (uint32_t) m_symbols.size();
+        it = m_symbols.emplace(strdup(name), sym).first;
+      }
+      else
+        sym = it->second;
+      return it->first;
+    }
+
+    //! \brief Look up a name.
+    //! \param name The name.
+    //! \param sym Reference to a symbol; set on return if found.
+    //! \return True if the name has been interned, false if not.
+    bool find(char const *name, uint32_t &sym) const
+    {
+      SymbolMap::const_iterator it = m_symbols.find(name);
+      if (it == m_symbols.end())
+        return false;
+      sym = it->second;
+      return true;
+    }
+
+    //! \brief Get the most recently opened map which is still open.
+    //! \return Const pointer to the map; null if none is open.
+    NodeVariableMap const *innermost() const
+    {
+      return m_open.empty() ? nullptr : m_open.back();
+    }
+
+    //! \brief Note that a map has been opened.
+    //! \param map Const pointer to the map.
+    //! \return The map's level, counting from 1 for the outermost.
+    size_t open(NodeVariableMap const *map)
+    {
+      m_open.push_back(map);
+      return m_open.size();
+    }
+
+    //! \brief Note that the innermost open map has been closed.
+    void close()
+    {
+      m_open.pop_back();
+      if (m_open.empty())
+        BindingTable().swap(m_bindings); // every stack is empty now
+    }
+
+    //! \brief Get the variable a name refers to in the innermost open map.
+    //! \param sym The name's symbol.
+    //! \return Pointer to the variable; null if no open map binds the name.
+    Expression *visible(uint32_t sym) const
+    {
+      if (sym >= m_bindings.size() || m_bindings[sym].empty())
+        return nullptr;
+      return m_bindings[sym].back().var;
+    }
+
+    //! \brief Add the binding of a name in an open map.
+    //! \param sym The name's symbol.
+    //! \param level The map's level.
+    //! \param var Pointer to the variable.
+    void bind(uint32_t sym, size_t level, Expression *var)
+    {
+      if (sym >= m_bindings.size())
+        m_bindings.resize(sym + 1);
+      // Bindings in maps opened later stay on top
+      BindingStack &stack = m_bindings[sym];
+      BindingStack::iterator it = stack.end();
+      while (it != stack.begin() && (it - 1)->level > level)
+        --it;
+      stack.insert(it, Binding {level, var});
+    }
+
+    //! \brief Remove the binding of a name in an open map.
+    //! \param sym The name's symbol.
+    //! \param level The map's level.
+    void unbind(uint32_t sym, size_t level)
+    {
+      if (sym >= m_bindings.size())
+        return;
+      BindingStack &stack = m_bindings[sym];
+      for (BindingStack::iterator it = stack.end(); it != stack.begin(); --it)
+        if ((it - 1)->level == level) {
+          stack.erase(it - 1);
+          return;
+        }
+    }
+
+  private:
+
+    // Not implemented
+    VariableScopeTable(VariableScopeTable const &) = delete;
+    VariableScopeTable(VariableScopeTable &&) = delete;
+    VariableScopeTable &operator=(VariableScopeTable const &) = delete;
+    VariableScopeTable &operator=(VariableScopeTable &&) = delete;
+
+    // FNV-1a over the null-terminated string
+    struct NameHash
+    {
+      size_t operator()(char const *s) const
+      {
+        size_t h = (size_t) 2166136261u;
+        while (*s)
+          h = (h ^ (unsigned char) *s++) * (size_t) 16777619u;
+        return h;
+      }
+    };
+
+    struct NameEqual
+    {
+      bool operator()(char const *a, char const *b) const
+      {
+        return !strcmp(a, b);
+      }
+    };
+
+    //! \brief A name's binding in one open map.
+    struct Binding
+    {
+      size_t level;    //!< Level of the map.
+      Expression *var; //!< The variable.
+    };
+
+    using SymbolMap = std::unordered_map<char const *, uint32_t, NameHash, NameEqual>;
+    using BindingStack = std::vector<Binding>;
+    using BindingTable = std::vector<BindingStack>;
+
+    SymbolMap m_symbols;                       //!< Symbol of each interned name.
+    BindingTable m_bindings;                   //!< Bindings in the open maps, by symbol.
+    std::vector<NodeVariableMap const *> m_open; //!< The open maps, outermost first.
+  };
+
   // Type alias
   using BaseMap = SimpleMap<char const *, Expression *, CStringComparator>;
 
   NodeVariableMap::NodeVariableMap(NodeVariableMap const *parentMap)
     : BaseMap(),
-      m_parentMap(parentMap)
+      m_scopes(),
+      m_parentMap(parentMap),
+      m_scopeLevel(0)
   {
+    // Share the plan's scope table
+    if (m_parentMap)
+      m_scopes = m_parentMap->m_scopes;
+    else
+      m_scopes = std::make_shared<VariableScopeTable>();
   }
 
   NodeVariableMap::~NodeVariableMap()
@@ -46,39 +220,79 @@ namespace PLEXIL
 
   void NodeVariableMap::clear()
   {
-    // Delete all the key strings we've copied
-    for (MAP_STORE_TYPE::iterator it = BaseMap::m_store.begin();
-         it != BaseMap::m_store.end();
-         ++it) {
-      free(const_cast<char *>(it->first));
-      it->first = nullptr;
+    // Take the variables out of scope, but leave the map open.
+    if (m_scopeLevel) {
+      for (MAP_ENTRY_TYPE const &entry : m_store) {
+        uint32_t sym;
+        m_scopes->find(entry.first, sym);
+        m_scopes->unbind(sym, m_scopeLevel);
+      }
     }
+    // Key strings belong to the scope table.
+    BaseMap::clear();
   }
 
   Expression *NodeVariableMap::findVariable(char const *name) const
   {
-    const_iterator it = this->find(name);
-    if (it != end())
-      return it->second;
-    // Iteratively search ancestors for this name
-    for (NodeVariableMap const *ancestor = m_parentMap;
-         ancestor;
-         ancestor = ancestor->m_parentMap) {
-      it = ancestor->find(name);
-      if (it != ancestor->end())
+    uint32_t sym;
+    if (!m_scopes->find(name, sym))
+      return nullptr; // not declared anywhere in this plan
+    if (m_scopes->innermost() == this)
+      return m_scopes->visible(sym);
+
+    // Not open, or not innermost:
+    // iteratively search this map and its ancestors
+    for (NodeVariableMap const *map = this; map; map = map->m_parentMap) {
+      const_iterator it = map->BaseMap::find(name);
+      if (it != map->end())
         return it->second;
     }
     return nullptr;
   }
+
+  void NodeVariableMap::openScope() const
+  {
+    if (m_scopeLevel || m_scopes->innermost() != m_parentMap) {
+      debugMsg("NodeVariableMap:openScope",
+               ' ' << this << " parent map not innermost, not opening");
+      return;
+    }
+    m_scopeLevel = m_scopes->open(this);
+    for (MAP_ENTRY_TYPE const &entry : m_store) {
+      uint32_t sym;
+      m_scopes->find(entry.first, sym);
+      m_scopes->bind(sym, m_scopeLevel, entry.second);
+    }
+  }
+
+  void NodeVariableMap::closeScope() const
+  {
+    if (!m_scopeLevel)
+      return; // wasn't opened
+    assertTrue_2(m_scopes->innermost() == this,
+                 "NodeVariableMap::closeScope: map is not the innermost open map");
+    for (MAP_ENTRY_TYPE const &entry : m_store) {
+      uint32_t sym;
+      m_scopes->find(entry.first, sym);
+      m_scopes->unbind(sym, m_scopeLevel);
+    }
+    m_scopes->close();
+    m_scopeLevel = 0;
+  }
    
-  // Copy key on insert
+  // Intern key on insert
   BaseMap::iterator 
   NodeVariableMap::insertEntry(BaseMap::iterator it,
                                char const * const &k,
                                Expression * const &v)
   {
-    return BaseMap::m_store.emplace(it, BaseMap::MAP_ENTRY_TYPE(strdup(k), v));
+    uint32_t sym;
+    char const *name = m_scopes->intern(k, sym);
+    BaseMap::iterator result =
+      BaseMap::m_store.emplace(it, BaseMap::MAP_ENTRY_TYPE(name, v));
+    if (m_scopeLevel)
+      m_scopes->bind(sym, m_scopeLevel, v);
+    return result;
   }
 
-
 } // namespace PLEXIL
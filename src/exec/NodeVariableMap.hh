@@ -29,15 +29,25 @@
 #include "SimpleMap.hh"
 #include "map-utils.hh"
 
+#include <memory>        // std::shared_ptr
+
 namespace PLEXIL
 {
 
   // Forward declarations
   class Expression;
+  class VariableScopeTable;
 
   //! \class NodeVariableMap
   //! \brief A name-to-variable mapping representing the variables accessible
-  //!        within a node.  Has a link to the parent node for recursive lookup.
+  //!        within a node.  Has a link to the parent node's map.
+  //! \note Every map in a plan shares one flat scope table, which
+  //!       interns the variable names and keeps, for each name, a
+  //!       stack of the bindings in the maps currently open.  A lookup
+  //!       from the innermost open map takes the top of the name's
+  //!       stack; lookups from other maps search the map and its
+  //!       ancestors.
+  //! \see NodeVariableScope
   //! \ingroup Exec-Core
   class NodeVariableMap final:
     public SimpleMap<char const *, Expression *, CStringComparator>
@@ -57,8 +67,22 @@ namespace PLEXIL
     //! \brief Find the named variable in this map or its ancestors.
     //! \param name Pointer to const null-terminated string.
     //! \return Pointer to the variable, as an Expression.
+    //! \note Bindings in this map shadow those of its ancestors.
     Expression *findVariable(char const *name) const;
 
+    //! \brief Bring this map's variables into scope, shadowing those
+    //!        of its ancestors, until closeScope() is called.
+    //! \note The parent map, if any, must be the innermost open map.
+    void openScope() const;
+
+    //! \brief Remove this map's variables from scope.
+    //! \note This map must be the innermost open map.
+    void closeScope() const;
+
+    //! \brief Not implemented.  Inserting through a reference would
+    //!        bypass the scope table; use insert() instead.
+    Expression *&operator[](char const * const &) = delete;
+
   protected:
 
     //! \brief Insert a new variable into the map.
@@ -77,7 +101,46 @@ namespace PLEXIL
     NodeVariableMap &operator=(NodeVariableMap const &) = delete;
     NodeVariableMap &operator=(NodeVariableMap &&) = delete;
 
+    std::shared_ptr<VariableScopeTable> m_scopes; //!< The plan's scope table.
     NodeVariableMap const *m_parentMap; //!< Pointer to the map in an ancestor Node.  May be null.
+    mutable size_t m_scopeLevel;        //!< Position among the open maps, from 1; 0 if not open.
+  };
+
+  //! \class NodeVariableScope
+  //! \brief Keeps a variable map open for the lifetime of the object.
+  //!        The plan parser opens each node's map while it resolves the
+  //!        names used in the node.
+  //! \ingroup Exec-Core
+  class NodeVariableScope final
+  {
+  public:
+
+    //! \brief Constructor.
+    //! \param map Const pointer to the map to open.  May be null.
+    NodeVariableScope(NodeVariableMap const *map)
+      : m_map(map)
+    {
+      if (m_map)
+        m_map->openScope();
+    }
+
+    //! \brief Destructor.  Closes the map.
+    ~NodeVariableScope()
+    {
+      if (m_map)
+        m_map->closeScope();
+    }
+
+  private:
+
+    // Not implemented
+    NodeVariableScope() = delete;
+    NodeVariableScope(NodeVariableScope const &) = delete;
+    NodeVariableScope(NodeVariableScope &&) = delete;
+    NodeVariableScope &operator=(NodeVariableScope const &) = delete;
+    NodeVariableScope &operator=(NodeVariableScope &&) = delete;
+
+    NodeVariableMap const *m_map;
   };
 
 } // namespace PLEXIL
@@ -35,12 +35,17 @@
 #include "Mutex.hh"
 #include "Node.hh"
 #include "NodeConstants.hh"
+#include "NodeStateTable.hh"
 #include "ResourceArbiterInterface.hh"
 #include "StateCache.hh"
 #include "Update.hh"
 #include "Variable.hh"
 
-#include <algorithm> // std::remove_if()
+#include <algorithm> // std::remove_if(), std::stable_sort()
+#include <chrono>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace PLEXIL 
 {
@@ -71,17 +76,46 @@ namespace PLEXIL
   {
   private:
 
+    //! \brief Run queue and scheduling state for one root plan.
+    struct PlanQueue
+    {
+      PlanQueue(Node const *r, unsigned int w, size_t seq)
+        : candidates(),
+          root(r),
+          weight(w),
+          credit(0),
+          sequence(seq),
+          lastStep(0)
+      {
+      }
+
+      LinkedQueue<Node> candidates; //!< Nodes of this plan whose conditions have changed.
+      Node const *root;             //!< The plan's root node.
+      unsigned int weight;          //!< Relative share of micro steps when plans compete.
+      unsigned int credit;          //!< Share accumulated while waiting.
+      size_t sequence;              //!< Order in which the plan was first seen.
+      size_t lastStep;              //!< Latest macro step in which the plan was served.
+    };
+
     //
     // Private member variables
     //
 
     // Working storage
     std::list<NodePtr> m_plan;                           //!< Active root nodes.
-    LinkedQueue<Node> m_candidateQueue;                  //!< Nodes whose conditions have changed and
-                                                         //!< may be eligible to transition.
+    std::unordered_map<Node const *, std::unique_ptr<PlanQueue>> m_planQueues;
+                                                         //!< Nodes whose conditions have changed and
+                                                         //!< may be eligible to transition, by root node.
+    std::vector<PlanQueue *> m_schedule;                 //!< Run queues in order of service.
+    std::map<std::string, unsigned int> m_planWeights;   //!< Weights set by root node ID.
+    PlanQueue *m_lastPlanQueue;                          //!< Most recently used run queue.
+    size_t m_candidateCount;                             //!< Nodes in all run queues.
+    size_t m_planSequence;                               //!< Count of run queues ever created.
+    size_t m_stepSerial;                                 //!< Count of macro steps begun.
     LinkedQueue<Node> m_stateChangeQueue;                //!< Nodes actively transitioning.
     PriorityQueue<Node, PriorityCompare> m_pendingQueue; //!< Nodes eligible to transition, but
                                                          //!< waiting on resources in use.
+    NodeStateTable m_stateTable;                         //!< States of all nodes in all plans.
 
     // Output queues
     LinkedQueue<Assignment>  m_assignmentsToExecute; //!< Assignments to be executed.
@@ -98,6 +132,13 @@ namespace PLEXIL
     Dispatcher                                *m_dispatcher;  //!< The external interface.
     ExecListenerBase                          *m_listener;    //!< The Exec listener.
 
+    // Time slice
+    std::chrono::steady_clock::duration m_sliceDuration;   //!< Maximum time slice duration; zero if unlimited.
+    std::chrono::steady_clock::time_point m_sliceStart;    //!< Start of the current time slice.
+    unsigned int m_sliceMaxMicroSteps;                     //!< Maximum micro steps per slice; 0 if unlimited.
+    unsigned int m_sliceMicroSteps;                        //!< Micro steps charged to the current slice.
+    bool m_sliceExhausted;                                 //!< True once a micro step exhausts the slice.
+
     // Flag
     bool m_finishedRootNodesDeleted; //!< True if at least one finished plan has been deleted */
 
@@ -110,9 +151,16 @@ namespace PLEXIL
     //! \brief Default constructor.
     PlexilExecImpl()
       : m_plan(),
-        m_candidateQueue(),
+        m_planQueues(),
+        m_schedule(),
+        m_planWeights(),
+        m_lastPlanQueue(nullptr),
+        m_candidateCount(0),
+        m_planSequence(0),
+        m_stepSerial(0),
         m_stateChangeQueue(),
         m_pendingQueue(),
+        m_stateTable(),
         m_assignmentsToExecute(),
         m_assignmentsToRetract(),
         m_commandsToExecute(),
@@ -123,13 +171,18 @@ namespace PLEXIL
         m_arbiter(makeResourceArbiter()),
         m_dispatcher(),
         m_listener(),
+        m_sliceDuration(std::chrono::steady_clock::duration::zero()),
+        m_sliceStart(),
+        m_sliceMaxMicroSteps(0),
+        m_sliceMicroSteps(0),
+        m_sliceExhausted(false),
         m_finishedRootNodesDeleted(false)
     {}
 
     //! \brief Virtual destructor.
     virtual ~PlexilExecImpl() 
     {
-      m_candidateQueue.clear();
+      clearPlanQueues();
       m_stateChangeQueue.clear();
       m_finishedRootNodes.clear();
       m_pendingQueue.clear();
@@ -139,6 +192,7 @@ namespace PLEXIL
       m_commandsToExecute.clear();
       m_commandsToAbort.clear();
       m_plan.clear();
+      m_stateTable.clear();
     }
 
     //! \brief Get the command resource arbiter.
@@ -182,6 +236,7 @@ namespace PLEXIL
     virtual bool addPlan(Node *root) override
     {
       m_plan.emplace_back(NodePtr(root));
+      root->addToStateTable(m_stateTable, NodeStateTable::NO_INDEX);
       debugMsg("PlexilExec:addPlan",
                "Added plan: \n" << root->toString());
       root->notify(this); // make sure root is considered first
@@ -211,6 +266,32 @@ namespace PLEXIL
       return result;
     }
 
+    //! \brief Delete all plans, empty all queues, and release all
+    //!        resource reservations.
+    virtual void reset() override
+    {
+      debugMsg("PlexilExec:reset", " deleting " << m_plan.size() << " plans");
+
+      // Empty the queues before deleting the nodes they point into
+      clearPlanQueues();
+      m_stateChangeQueue.clear();
+      m_pendingQueue.clear();
+      m_finishedRootNodes.clear();
+      m_transitionsToPublish.clear();
+      m_assignmentsToExecute.clear();
+      m_assignmentsToRetract.clear();
+      m_commandsToExecute.clear();
+      m_commandsToAbort.clear();
+      m_updatesToExecute.clear();
+
+      m_plan.clear();
+      m_stateTable.clear();
+      clearGlobalMutexes();
+      if (m_arbiter)
+        m_arbiter->reset();
+      m_finishedRootNodesDeleted = false;
+    }
+
     //! \brief Mark node as finished and no longer eligible for execution.
     //! \param node Pointer to the Node.
     virtual void markRootNodeFinished(Node *node) override
@@ -221,6 +302,17 @@ namespace PLEXIL
     }
 
     //! \brief Delete any plans (root nodes) which have finished.
+    virtual void removePlan(Node *root) override
+    {
+      debugMsg("PlexilExec:removePlan",
+               " removing " << root->getNodeId() << ' ' << root);
+      root->releaseAllResources();
+      removePlanQueue(root);
+      root->removeFromStateTable(m_stateTable);
+      m_plan.remove_if([root] (NodePtr const &n) -> bool
+                       { return root == n.get(); });
+    }
+
     virtual void deleteFinishedPlans() override
     {
       while (!m_finishedRootNodes.empty()) {
@@ -228,6 +320,8 @@ namespace PLEXIL
         m_finishedRootNodes.pop();
         debugMsg("PlexilExec:deleteFinishedPlans",
                  " deleting node " << node->getNodeId() << ' ' << node);
+        removePlanQueue(node);
+        node->removeFromStateTable(m_stateTable);
         m_plan.remove_if([node] (NodePtr const &n) -> bool
                          { return node == n.get(); });
       }
@@ -240,12 +334,89 @@ namespace PLEXIL
     //! \return True if the Exec needs to be stepped, false otherwise.
     virtual bool needsStep() const override
     {
-      return !m_candidateQueue.empty();
+      return m_candidateCount != 0;
+    }
+
+    //! \brief Set the scheduling weight of a plan.
+    //! \param rootNodeId The node ID of the plan's root node.
+    //! \param weight The weight.  0 is treated as 1.
+    virtual void setPlanWeight(std::string const &rootNodeId, unsigned int weight) override
+    {
+      if (!weight)
+        weight = 1;
+      m_planWeights[rootNodeId] = weight;
+      for (PlanQueue *q : m_schedule)
+        if (q->root->getNodeId() == rootNodeId)
+          q->weight = weight;
+      sortSchedule();
+      debugMsg("PlexilExec:setPlanWeight", ' ' << rootNodeId << " = " << weight);
+    }
+
+    //! \brief Get the table of node states.
+    //! \return Reference to the table.
+    virtual NodeStateTable &getNodeStateTable() override
+    {
+      return m_stateTable;
+    }
+
+    virtual NodeStateTable const &getNodeStateTable() const override
+    {
+      return m_stateTable;
+    }
+
+    //! \brief Limit the work done in one time slice.
+    //! \param maxMicroSteps Maximum number of micro steps per slice.
+    //!                      0 for no limit.
+    //! \param maxSeconds Maximum duration of a slice, in seconds.
+    //!                   0 for no limit.
+    virtual void setTimeSlice(unsigned int maxMicroSteps, double maxSeconds) override
+    {
+      m_sliceMaxMicroSteps = maxMicroSteps;
+      if (maxSeconds > 0)
+        m_sliceDuration =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>
+          (std::chrono::duration<double>(maxSeconds));
+      else
+        m_sliceDuration = std::chrono::steady_clock::duration::zero();
+      debugMsg("PlexilExec:setTimeSlice",
+               ' ' << maxMicroSteps << " micro steps, " << maxSeconds << " seconds");
+    }
+
+    //! \brief Begin a new time slice.
+    virtual void startTimeSlice() override
+    {
+      m_sliceMicroSteps = 0;
+      m_sliceExhausted = false;
+      if (m_sliceDuration != std::chrono::steady_clock::duration::zero())
+        m_sliceStart = std::chrono::steady_clock::now();
+    }
+
+    //! \brief Query whether the current time slice is exhausted.
+    //! \return True if exhausted, false if not or if there is no limit.
+    virtual bool timeSliceExpired() const override
+    {
+      if (m_sliceExhausted)
+        return true;
+      if (m_sliceMaxMicroSteps && m_sliceMicroSteps >= m_sliceMaxMicroSteps)
+        return true;
+      return m_sliceDuration != std::chrono::steady_clock::duration::zero()
+        && std::chrono::steady_clock::now() - m_sliceStart >= m_sliceDuration;
+    }
+
+    //! \brief Get the number of micro steps charged to the current
+    //!        time slice.
+    //! \return The count.
+    virtual unsigned int getTimeSliceMicroSteps() const override
+    {
+      return m_sliceMicroSteps;
     }
 
     //! \brief Run a single "macro step" i.e. the entire quiescence cycle.
     //! \param startTime The time at which the step is run.  Used as the
     //!                  timestamp for node transitions in this step.
+    //! \note Once the current time slice is exhausted, only the plans
+    //!       served earlier in this step are served again, until
+    //!       they reach quiescence.  The others wait for the next step.
     virtual void step(double startTime) override
     {
       //
@@ -262,6 +433,7 @@ namespace PLEXIL
 #endif
 
       debugMsg("PlexilExec:step", " ==>Start cycle " << cycleNum);
+      ++m_stepSerial;
 
       // A Node is initially inserted on the pending queue when it is eligible to
       // transition to EXECUTING, and it needs to acquire one or more resources.
@@ -287,23 +459,41 @@ namespace PLEXIL
                         printPendingQueue();
                       });
 
-        // Evaluate conditions of nodes reporting a change
-        while (!m_candidateQueue.empty()) {
-          Node *candidate = getCandidateNode();
-          bool canTransition = candidate->getDestState(); // sets node's next state
-          if (canTransition) {
-            debugMsg("PlexilExec:step",
-                     " Node " << candidate->getNodeId() << ' ' << candidate
-                     << " can transition from "
-                     << nodeStateName(candidate->getState())
-                     << " to " << nodeStateName(candidate->getNextState()));
-            if (!resourceCheckRequired(candidate)) {
-              // The node is eligible to transition now
-              addStateChangeNode(candidate);
-            }
-            else {
-              // Possibility of conflict - set it aside to evaluate as a batch
-              addPendingNode(candidate);
+        // Evaluate conditions of nodes reporting a change, plan by
+        // plan in order of service.  When several plans have
+        // candidates, a plan whose weight is less than the greatest
+        // among them waits out some micro steps, accumulating credit.
+        // Each plan's candidates are evaluated together.
+        unsigned int maxWeight = 0;
+        for (PlanQueue const *q : m_schedule)
+          if (isServable(q) && q->weight > maxWeight)
+            maxWeight = q->weight;
+        for (PlanQueue *q : m_schedule) {
+          if (!isServable(q))
+            continue;
+          q->credit += q->weight;
+          if (q->credit < maxWeight)
+            continue;
+          q->credit -= maxWeight;
+          q->lastStep = m_stepSerial;
+
+          while (!q->candidates.empty()) {
+            Node *candidate = getCandidateNode(q);
+            bool canTransition = candidate->getDestState(); // sets node's next state
+            if (canTransition) {
+              debugMsg("PlexilExec:step",
+                       " Node " << candidate->getNodeId() << ' ' << candidate
+                       << " can transition from "
+                       << nodeStateName(candidate->getState())
+                       << " to " << nodeStateName(candidate->getNextState()));
+              if (!resourceCheckRequired(candidate)) {
+                // The node is eligible to transition now
+                addStateChangeNode(candidate);
+              }
+              else {
+                // Possibility of conflict - set it aside to evaluate as a batch
+                addPendingNode(candidate);
+              }
             }
           }
         }
@@ -319,8 +509,11 @@ namespace PLEXIL
           resolveResourceConflicts();
         }
 
-        if (m_stateChangeQueue.empty())
+        if (m_stateChangeQueue.empty()) {
+          if (haveServableCandidates())
+            continue; // plans left waiting get their turn
           break; // nothing to do, exit quiescence loop
+        }
 
         debugStmt("PlexilExec:step",
                   {
@@ -339,7 +532,7 @@ namespace PLEXIL
           m_transitionsToPublish.reserve(m_stateChangeQueue.size());
 
         // Transition the nodes
-        // Transition may put node on m_candidateQueue or m_finishedRootNodes
+        // Transition may put node on a plan's run queue or m_finishedRootNodes
         while (!m_stateChangeQueue.empty()) {
           Node *node = getStateChangeNode();
           NodeState oldState = node->getState(); // for listener
@@ -349,6 +542,7 @@ namespace PLEXIL
                    << " node " << node->getNodeId() << ' ' << node
                    << " from " << nodeStateName(node->getState())
                    << " to " << nodeStateName(node->getNextState()));
+          getPlanQueue(node)->lastStep = m_stepSerial;
           node->transition(this, startTime);
           if (m_listener)
             // After transition, old state is lost, so use cached state
@@ -372,12 +566,22 @@ namespace PLEXIL
 #ifndef NO_DEBUG_MESSAGE_SUPPORT 
         ++stepCount;
 #endif
+        if (!m_sliceExhausted) {
+          ++m_sliceMicroSteps;
+          if (timeSliceExpired()) {
+            // Plans already in this step run on to quiescence
+            debugMsg("PlexilExec:step",
+                     "[" << cycleNum << ":" << stepCount
+                     << "] Time slice expired, deferring plans not yet served");
+            m_sliceExhausted = true;
+          }
+        }
       }
       while (m_assignmentsToExecute.empty()
              && m_assignmentsToRetract.empty()
              && m_commandsToExecute.empty()
              && m_commandsToAbort.empty()
-             && !m_candidateQueue.empty());
+             && haveServableCandidates());
       // END QUIESCENCE LOOP
 
       // Perform side effects
@@ -402,7 +606,8 @@ namespace PLEXIL
     //! \note Node's queue status must be QUEUE_NONE.
     virtual void addCandidateNode(Node *node) override
     {
-      m_candidateQueue.push(node);
+      getPlanQueue(node)->candidates.push(node);
+      ++m_candidateCount;
     }
 
     //! \brief Schedule this assignment for execution.
@@ -655,19 +860,115 @@ namespace PLEXIL
 
     // N.B. A node can be in only one queue at a time.
 
-    //! \brief Dequeue a node from the candidate queue.
+    //! \brief Dequeue a node from a plan's run queue.
+    //! \param q The run queue.
     //! \return Pointer to the top node in the queue, or nullptr if queue empty.
-    Node *getCandidateNode()
+    Node *getCandidateNode(PlanQueue *q)
     {
-      Node *result = m_candidateQueue.front();
+      Node *result = q->candidates.front();
       if (!result)
         return nullptr;
 
-      m_candidateQueue.pop();
+      q->candidates.pop();
+      --m_candidateCount;
       result->setQueueStatus(QUEUE_NONE);
       return result;
     }
 
+    //! \brief Query whether a plan may be served in the current step.
+    //! \param q Pointer to the plan's run queue.
+    //! \return True if the plan has candidates, and either the time
+    //!         slice has time left or the plan was already served in
+    //!         this step; false otherwise.
+    bool isServable(PlanQueue const *q) const
+    {
+      return !q->candidates.empty()
+        && (!m_sliceExhausted || q->lastStep == m_stepSerial);
+    }
+
+    //! \brief Query whether any plan may be served in the current step.
+    //! \return True if so, false otherwise.
+    bool haveServableCandidates() const
+    {
+      if (!m_sliceExhausted)
+        return m_candidateCount != 0;
+      for (PlanQueue const *q : m_schedule)
+        if (isServable(q))
+          return true;
+      return false;
+    }
+
+    //! \brief Get the run queue for the plan containing a node,
+    //!        creating it if necessary.
+    //! \param node Pointer to the node.
+    //! \return Pointer to the run queue.
+    PlanQueue *getPlanQueue(Node const *node)
+    {
+      Node const *root = node->getRoot();
+      if (m_lastPlanQueue && m_lastPlanQueue->root == root)
+        return m_lastPlanQueue;
+
+      std::unique_ptr<PlanQueue> &entry = m_planQueues[root];
+      if (!entry) {
+        unsigned int weight = 1;
+        std::map<std::string, unsigned int>::const_iterator it =
+          m_planWeights.find(root->getNodeId());
+        if (it != m_planWeights.end())
+          weight = it->second;
+        entry.reset(new PlanQueue(root, weight, m_planSequence++));
+        m_schedule.push_back(entry.get());
+        sortSchedule();
+        condDebugMsg(weight != 1, "PlexilExec:getPlanQueue",
+                     " new run queue for " << root->getNodeId() << ", weight " << weight);
+      }
+      m_lastPlanQueue = entry.get();
+      return m_lastPlanQueue;
+    }
+
+    //! \brief Delete the run queue for a plan.
+    //! \param root Pointer to the plan's root node.
+    void removePlanQueue(Node const *root)
+    {
+      std::unordered_map<Node const *, std::unique_ptr<PlanQueue>>::iterator it =
+        m_planQueues.find(root);
+      if (it == m_planQueues.end())
+        return;
+      PlanQueue *q = it->second.get();
+      m_candidateCount -= q->candidates.size();
+      q->candidates.clear();
+      m_schedule.erase(std::remove(m_schedule.begin(), m_schedule.end(), q),
+                       m_schedule.end());
+      if (m_lastPlanQueue == q)
+        m_lastPlanQueue = nullptr;
+      m_planQueues.erase(it);
+    }
+
+    //! \brief Empty and delete all run queues.
+    void clearPlanQueues()
+    {
+      for (PlanQueue *q : m_schedule)
+        q->candidates.clear();
+      m_schedule.clear();
+      m_planQueues.clear();
+      m_lastPlanQueue = nullptr;
+      m_candidateCount = 0;
+    }
+
+    //! \brief Order the run queues for service: by descending weight,
+    //!        then by root node priority, then by age.
+    void sortSchedule()
+    {
+      std::stable_sort(m_schedule.begin(), m_schedule.end(),
+                       [](PlanQueue const *a, PlanQueue const *b) -> bool
+                       {
+                         if (a->weight != b->weight)
+                           return a->weight > b->weight;
+                         if (a->root->getPriority() != b->root->getPriority())
+                           return a->root->getPriority() < b->root->getPriority();
+                         return a->sequence < b->sequence;
+                       });
+    }
+
     //! \brief Dequeue a node from the state change queue.
     //! \return Pointer to the top node in the queue, or NULL if queue empty.
     Node *getStateChangeNode()
@@ -775,7 +1076,8 @@ namespace PLEXIL
       switch (node->getQueueStatus()) {
       
       case QUEUE_CHECK: // seems plausible?
-        m_candidateQueue.remove(node);
+        getPlanQueue(node)->candidates.remove(node);
+        --m_candidateCount;
         // fall thru
 
       case QUEUE_NONE:
@@ -802,10 +1104,12 @@ namespace PLEXIL
     std::string conditionCheckQueueStr() const
     {
       std::ostringstream retval;
-      Node *node = m_candidateQueue.front();
-      while (node) {
-        retval << node->getNodeId() << ' ' << node << ' ';
-        node = node->next();
+      for (PlanQueue const *q : m_schedule) {
+        Node *node = q->candidates.front();
+        while (node) {
+          retval << node->getNodeId() << ' ' << node << ' ';
+          node = node->next();
+        }
       }
       return retval.str();
     }
@@ -830,10 +1134,12 @@ namespace PLEXIL
 #ifndef NO_DEBUG_MESSAGE_SUPPORT
       std::ostream &s = getDebugOutputStream();
       s << " Check queue: ";
-      Node *node = m_candidateQueue.front();
-      while (node) {
-        s << node->getNodeId() << " ";
-        node = node->next();
+      for (PlanQueue const *q : m_schedule) {
+        Node *node = q->candidates.front();
+        while (node) {
+          s << node->getNodeId() << " ";
+          node = node->next();
+        }
       }
       s << std::endl;
 #endif
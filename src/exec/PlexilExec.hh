@@ -28,6 +28,7 @@
 
 #include <list>
 #include <memory>
+#include <string>
 
 namespace PLEXIL 
 {
@@ -38,6 +39,7 @@ namespace PLEXIL
   class Dispatcher;
   class ExecListenerBase; 
   class Node;
+  class NodeStateTable;
   class ResourceArbiterInterface;
   class Update;
 
@@ -121,11 +123,70 @@ namespace PLEXIL
     //! \return True if the Exec needs to be stepped, false otherwise.
     virtual bool needsStep() const = 0;
 
+    //! \brief Limit the work done in one time slice, i.e. between
+    //!        opportunities for the application to process input.
+    //! \param maxMicroSteps Maximum number of micro steps per slice.
+    //!                      0 for no limit.
+    //! \param maxSeconds Maximum duration of a slice, in seconds.
+    //!                   0 for no limit.
+    //! \note A macro step which exhausts the slice continues only
+    //!       the plans it has already served, until each reaches
+    //!       quiescence; no plan's step is divided.  Plans not yet
+    //!       served keep their nodes queued for the next macro step.
+    //!       Micro steps performed after the slice is exhausted are
+    //!       not charged to it.
+    //! \note Default is no limit.
+    virtual void setTimeSlice(unsigned int maxMicroSteps, double maxSeconds) = 0;
+
+    //! \brief Begin a new time slice.
+    virtual void startTimeSlice() = 0;
+
+    //! \brief Query whether the current time slice is exhausted.
+    //! \return True if exhausted, false if not or if there is no limit.
+    virtual bool timeSliceExpired() const = 0;
+
+    //! \brief Get the number of micro steps charged to the current
+    //!        time slice.
+    //! \return The count.
+    virtual unsigned int getTimeSliceMicroSteps() const = 0;
+
+    //! \brief Set the scheduling weight of a plan.
+    //! \param rootNodeId The node ID of the plan's root node.
+    //! \param weight The weight.  0 is treated as 1.
+    //! \note Each plan has its own queue of nodes awaiting condition
+    //!       evaluation.  Queues are served in order of descending
+    //!       weight, then by the root node's Priority (lower first),
+    //!       then in the order the plans were added; a plan's state
+    //!       changes, and so its assignments and commands, precede
+    //!       those of plans served after it.  While plans of different
+    //!       weight all have work, one of weight W is served in
+    //!       W micro steps out of every M, where M is the largest
+    //!       weight among them.
+    //! \note The weight applies to running plans with that root node
+    //!       ID, and to any added later.  Default is 1.
+    virtual void setPlanWeight(std::string const &rootNodeId, unsigned int weight) = 0;
+
+    //! \brief Get the table of node states.
+    //! \return Reference to the table.
+    //! \note The table holds every node of every plan not yet deleted,
+    //!       and is updated as nodes transition.
+    //! \see NodeStateTable
+    virtual NodeStateTable &getNodeStateTable() = 0;
+    virtual NodeStateTable const &getNodeStateTable() const = 0;
+
     //! \brief Prepare the given plan for execution.
     //! \param root Pointer to the plan's root node.
     //! \return True if succesful, false otherwise.
     virtual bool addPlan(Node *root) = 0;
 
+    //! \brief Remove a plan which has not finished, and delete it.
+    //! \param root Pointer to the plan's root node.
+    //! \note Any resources held by the plan's nodes are released.
+    //! \note Must not be called while the plan is stepping, nor once
+    //!       the plan has actions in the output queues.
+    //! \note Used when a plan cannot be restored from a snapshot.
+    virtual void removePlan(Node *root) = 0;
+
     //! \brief Delete any plans (root nodes) which have finished.
     virtual void deleteFinishedPlans() = 0;
 
@@ -133,6 +194,15 @@ namespace PLEXIL
     //! \return true if at least one plan has been run and all have finished, false otherwise.
     virtual bool allPlansFinished() const = 0;
 
+    //! \brief Delete all plans, empty all queues, and release all
+    //!        resource reservations, returning the Exec to the state
+    //!        it was in immediately after construction.
+    //! \note The dispatcher, listener, and resource hierarchy are retained.
+    //! \note The caller is responsible for ensuring that no external
+    //!       interface holds references to commands or updates
+    //!       belonging to the deleted plans.
+    virtual void reset() = 0;
+
     //
     // Introspection
     //
@@ -249,8 +249,8 @@ namespace PLEXIL
     m_update.reset(upd);
 
     // Get action-complete condition
-    m_conditions[actionCompleteIdx] = m_update->getAck();
-    m_garbageConditions[actionCompleteIdx] = false;
+    m_conditions.set(actionCompleteIdx, m_update->getAck());
+    m_conditions.setGarbage(actionCompleteIdx, false);
   }
 
   void UpdateNode::specializedCreateConditionWrappers()
@@ -258,18 +258,18 @@ namespace PLEXIL
     Expression *ack = m_update->getAck();
     if (!(m_conditions[endIdx]) || m_conditions[endIdx] == TRUE_EXP()) {
       // Default - don't wrap, replace - (True && anything) == anything
-      m_conditions[endIdx] = ack;
-      m_garbageConditions[endIdx] = false;
+      m_conditions.set(endIdx, ack);
+      m_conditions.setGarbage(endIdx, false);
     }
     else {
       // Wrap user-provided condition
-      m_conditions[endIdx] =
+      m_conditions.set(endIdx,
         makeFunction(BooleanAnd::instance(),
                      ack,
                      m_conditions[endIdx],
                      false,
-                     m_garbageConditions[endIdx]);
-      m_garbageConditions[endIdx] = true;
+                     m_conditions.isGarbage(endIdx)));
+      m_conditions.setGarbage(endIdx, true);
     }
   }
 
@@ -301,7 +301,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor exit for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(ancestorExitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Update node and ancestor exit true.");
@@ -317,7 +317,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Exit for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && temp) {
+      if (getConditionValue(exitIdx, temp) && temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Update node and exit true.");
@@ -333,7 +333,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Ancestor invariant for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(ancestorInvariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Update node and ancestor invariant false.");
@@ -349,7 +349,7 @@ namespace PLEXIL
       checkError(cond->isActive(),
                  "Invariant for " << m_nodeId << ' ' << this << " is inactive.");
 #endif
-      if (cond->getValue(temp) && !temp) {
+      if (getConditionValue(invariantIdx, temp) && !temp) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
                  << " -> FAILING. Update node and invariant false.");
@@ -360,7 +360,7 @@ namespace PLEXIL
       }
     }
 
-    if ((cond = getEndCondition()) && (!cond->getValue(temp) || !temp)) {
+    if ((cond = getEndCondition()) && (!getConditionValue(endIdx, temp) || !temp)) {
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
       checkError(cond->isActive(),
                  "End for " << m_nodeId << ' ' << this << " is inactive.");
@@ -375,7 +375,7 @@ namespace PLEXIL
              ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
              << " -> ITERATION_ENDED. Update node and end condition true.");
     m_nextState = ITERATION_ENDED_STATE;
-    if ((cond = getPostCondition()) && (!cond->getValue(temp) || !temp)) { 
+    if ((cond = getPostCondition()) && (!getConditionValue(postIdx, temp) || !temp)) { 
 #ifdef PARANOID_ABOUT_CONDITION_ACTIVATION
       checkError(cond->isActive(),
                  "Node::getDestState: Post for " << m_nodeId << ' ' << this << " is inactive.");
@@ -429,9 +429,8 @@ namespace PLEXIL
 
   bool UpdateNode::getDestStateFromFailing()
   {
-    Expression *cond = getActionCompleteCondition();
     bool temp;
-    if (cond->getValue(temp) && temp) {
+    if (getConditionValue(actionCompleteIdx, temp) && temp) {
       if (getFailureType() == PARENT_FAILED) {
         debugMsg("Node:getDestState",
                  ' ' << m_nodeId << ' ' << this << ' ' << nodeStateName(m_state)
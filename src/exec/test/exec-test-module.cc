@@ -28,6 +28,7 @@
 #include "Debug.hh"
 #include "NodeImpl.hh"
 #include "NodeFactory.hh"
+#include "NodeStateTable.hh"
 #include "PlexilExec.hh"
 #include "StateCache.hh"
 #include "TestSupport.hh"
@@ -60,13 +61,25 @@ public:
   virtual bool addPlan(Node * /* root */) override { return false; }
   virtual void step(double /* startTime */) override {}
   virtual bool needsStep() const override {return false;}
+  virtual void setTimeSlice(unsigned int /* maxMicroSteps */, double /* maxSeconds */) override {}
+  virtual void startTimeSlice() override {}
+  virtual bool timeSliceExpired() const override { return false; }
+  virtual unsigned int getTimeSliceMicroSteps() const override { return 0; }
+  virtual void setPlanWeight(std::string const & /* rootNodeId */, unsigned int /* weight */) override {}
+  virtual NodeStateTable &getNodeStateTable() override { return m_stateTable; }
+  virtual NodeStateTable const &getNodeStateTable() const override { return m_stateTable; }
   virtual void setDispatcher(Dispatcher * /* intf */) override {}
   virtual void setExecListener(ExecListenerBase * /* l */) override {}
   virtual ExecListenerBase *getExecListener() override { return nullptr; }
   virtual ResourceArbiterInterface *getArbiter() override { return nullptr; }
+  virtual void removePlan(Node * /* root */) override {}
   virtual void deleteFinishedPlans() override {}
   virtual bool allPlansFinished() const override { return true; }
+  virtual void reset() override {}
   virtual std::list<NodePtr> const &getPlans() const override { return g_dummyPlanList; }
+
+private:
+  NodeStateTable m_stateTable;
 };
 
 static bool inactiveDestTest() 
@@ -36,10 +36,16 @@
 #include <cstring>  // strcmp()
 
 // Declarations of tests
+extern bool nodeConditionSetTest();
+extern bool nodeStateTableTest();
+extern bool nodeVariableMapTest();
 extern bool stateTransitionTests();
 
 void runTests()
 {
+  runTestSuite(nodeConditionSetTest);
+  runTestSuite(nodeStateTableTest);
+  runTestSuite(nodeVariableMapTest);
   runTestSuite(stateTransitionTests);
 
   std::cout << "Finished" << std::endl;
@@ -0,0 +1,217 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// node-benchmark - measure the size and speed of a large plan of list
+// and empty nodes
+//
+
+#include "plexil-config.h"
+
+#include "Dispatcher.hh"
+#include "Error.hh"
+#include "ListNode.hh"
+#include "LookupReceiver.hh"
+#include "NodeConstants.hh"
+#include "NodeFactory.hh"
+#include "PlexilExec.hh"
+#include "PlexilNodeType.hh"
+#include "lifecycle-utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h> // mallinfo2()
+#define HEAP_IN_USE() (mallinfo2().uordblks)
+#else
+// Heap usage is not reported
+#define HEAP_IN_USE() ((size_t) 0)
+#endif
+
+using namespace PLEXIL;
+
+//! Empty and list nodes never call the dispatcher.
+class NullDispatcher final : public Dispatcher
+{
+public:
+  NullDispatcher() = default;
+  virtual ~NullDispatcher() = default;
+
+  virtual void lookupNow(State const & /* state */, LookupReceiver *receiver) override
+  {
+    receiver->setUnknown();
+  }
+
+  virtual void setThresholds(const State & /* state */, Real /* hi */, Real /* lo */) override {}
+  virtual void setThresholds(const State & /* state */, Integer /* hi */, Integer /* lo */) override {}
+  virtual void clearThresholds(const State & /* state */) override {}
+  virtual void executeCommand(Command * /* cmd */) override {}
+  virtual void reportCommandArbitrationFailure(Command * /* cmd */) override {}
+  virtual void invokeAbort(Command * /* cmd */) override {}
+  virtual void executeUpdate(Update * /* update */) override {}
+};
+
+struct RunResult
+{
+  size_t nodes;
+  size_t heapBytes;
+  double milliseconds;
+  bool finished;
+};
+
+// Build a root list of 'lists' lists of 'children' empty nodes, and
+// run it to completion.
+static RunResult runPlan(unsigned int lists, unsigned int children)
+{
+  NullDispatcher dispatcher;
+  PlexilExec *exec = makePlexilExec();
+  g_exec = exec;
+  g_dispatcher = &dispatcher;
+  exec->setDispatcher(&dispatcher);
+
+  RunResult result;
+  size_t heapBefore = HEAP_IN_USE();
+  std::vector<NodeImpl *> nodes;
+  NodeImpl *root = NodeFactory::createNode("Root", NodeType_NodeList, nullptr);
+  nodes.push_back(root);
+  for (unsigned int i = 0; i < lists; ++i) {
+    std::string listName = "List" + std::to_string(i);
+    NodeImpl *list = NodeFactory::createNode(listName.c_str(), NodeType_NodeList, root);
+    static_cast<ListNode *>(root)->addChild(list);
+    nodes.push_back(list);
+    for (unsigned int j = 0; j < children; ++j) {
+      std::string name = "Empty" + std::to_string(j);
+      NodeImpl *node = NodeFactory::createNode(name.c_str(), NodeType_Empty, list);
+      static_cast<ListNode *>(list)->addChild(node);
+      nodes.push_back(node);
+    }
+  }
+  for (NodeImpl *node : nodes)
+    node->finalizeConditions();
+  result.nodes = nodes.size();
+  result.heapBytes = HEAP_IN_USE() - heapBefore;
+
+  exec->addPlan(root);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double step = 0;
+  while (exec->needsStep())
+    exec->step(step++);
+  std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+  result.milliseconds =
+    std::chrono::duration<double, std::milli>(finish - start).count();
+  result.finished = exec->allPlansFinished();
+
+  exec->deleteFinishedPlans();
+  g_exec = nullptr;
+  g_dispatcher = nullptr;
+  delete exec;
+  return result;
+}
+
+void usage()
+{
+  std::cout << "Usage: node-benchmark [options]\n"
+            << " Options:\n"
+            << "  -l <number>  Number of list nodes under the root (default 1000)\n"
+            << "  -c <number>  Number of empty nodes in each list (default 100)\n"
+            << "  -n <number>  Number of runs; the median time is reported (default 9)\n"
+            << "  -h           Display this message and exit\n"
+            << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int lists = 1000;
+  unsigned int children = 100;
+  unsigned int runs = 9;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    else if ((!strcmp(argv[i], "-l") || !strcmp(argv[i], "-c") || !strcmp(argv[i], "-n"))
+             && i + 1 < argc) {
+      int value = atoi(argv[i + 1]);
+      if (value <= 0) {
+        std::cerr << argv[i] << " option value out of range or invalid" << std::endl;
+        usage();
+        return 1;
+      }
+      if (!strcmp(argv[i], "-l"))
+        lists = (unsigned int) value;
+      else if (!strcmp(argv[i], "-c"))
+        children = (unsigned int) value;
+      else
+        runs = (unsigned int) value;
+      ++i;
+    }
+    else {
+      std::cerr << "Invalid option " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+  }
+
+  std::vector<double> times;
+  RunResult first;
+  try {
+    Error::doThrowExceptions();
+    for (unsigned int i = 0; i < runs; ++i) {
+      RunResult result = runPlan(lists, children);
+      if (!result.finished) {
+        std::cerr << "Plan did not finish" << std::endl;
+        std::cout << "Aborted." << std::endl;
+        return 1;
+      }
+      if (!i)
+        first = result;
+      times.push_back(result.milliseconds);
+    }
+    plexilRunFinalizers();
+  }
+  catch (Error const &e) {
+    std::cerr << "Aborting benchmark due to error:\n" << e << std::endl;
+    std::cout << "Aborted." << std::endl;
+    return 1;
+  }
+
+  std::sort(times.begin(), times.end());
+  std::cout << "sizeof(NodeImpl) " << sizeof(NodeImpl) << " bytes\n"
+            << "Nodes " << first.nodes << '\n';
+  if (first.heapBytes)
+    std::cout << "Heap per node " << first.heapBytes / first.nodes << " bytes\n";
+  std::cout << "Run time, median of " << runs << ": "
+            << times[times.size() / 2] << " ms" << std::endl;
+  return 0;
+}
@@ -0,0 +1,180 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "NodeConditionSet.hh"
+#include "TestSupport.hh"
+#include "UserVariable.hh"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace PLEXIL;
+
+static size_t const N = NodeConditionSet::MAX_CONDITIONS;
+
+// Check every index of the set against the expected contents.
+static bool checkContents(NodeConditionSet const &conds,
+                          std::vector<Expression *> const &expected)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < N; ++i) {
+    assertTrueMsg(conds[i] == expected[i],
+                  "checkContents: wrong condition at index " << i);
+    if (expected[i])
+      ++count;
+  }
+  assertTrueMsg(conds.size() == count,
+                "checkContents: size " << conds.size() << ", expected " << count);
+  return true;
+}
+
+static bool testEmpty()
+{
+  NodeConditionSet conds;
+  assertTrue_1(conds.size() == 0);
+  for (size_t i = 0; i < N; ++i) {
+    assertTrue_1(!conds[i]);
+    assertTrue_1(!conds.isGarbage(i));
+  }
+
+  // Clearing an absent condition changes nothing
+  conds.set(3, nullptr);
+  assertTrue_1(conds.size() == 0);
+  assertTrue_1(!conds[3]);
+  return true;
+}
+
+static bool testInsertionOrder()
+{
+  std::vector<IntegerVariable> vars(N);
+  std::vector<size_t> order(N);
+  for (size_t i = 0; i < N; ++i)
+    order[i] = i;
+
+  std::vector<std::vector<size_t> > orders;
+  orders.push_back(order);
+  orders.push_back(std::vector<size_t>(order.rbegin(), order.rend()));
+  // Odd indices, then even
+  std::vector<size_t> interleaved;
+  for (size_t i = 1; i < N; i += 2)
+    interleaved.push_back(i);
+  for (size_t i = 0; i < N; i += 2)
+    interleaved.push_back(i);
+  orders.push_back(interleaved);
+  std::mt19937 gen(12345);
+  for (int k = 0; k < 20; ++k) {
+    std::shuffle(order.begin(), order.end(), gen);
+    orders.push_back(order);
+  }
+
+  for (std::vector<size_t> const &o : orders) {
+    NodeConditionSet conds;
+    std::vector<Expression *> expected(N, nullptr);
+    for (size_t idx : o) {
+      conds.set(idx, &vars[idx]);
+      expected[idx] = &vars[idx];
+      if (!checkContents(conds, expected))
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool testReplaceAndRemove()
+{
+  std::vector<IntegerVariable> vars(N), others(N);
+  NodeConditionSet conds;
+  std::vector<Expression *> expected(N, nullptr);
+  size_t const present[] = {0, 2, 5, 6, 11, 15};
+  for (size_t idx : present) {
+    conds.set(idx, &vars[idx]);
+    expected[idx] = &vars[idx];
+  }
+  assertTrue_1(checkContents(conds, expected));
+
+  // Replacing doesn't disturb the neighbors
+  conds.set(5, &others[5]);
+  expected[5] = &others[5];
+  assertTrue_1(checkContents(conds, expected));
+
+  // Remove from the middle, the ends, then everything
+  size_t const removals[] = {6, 0, 15, 2, 11, 5};
+  for (size_t idx : removals) {
+    conds.set(idx, nullptr);
+    expected[idx] = nullptr;
+    assertTrue_1(checkContents(conds, expected));
+  }
+
+  // The set is usable after being emptied
+  conds.set(9, &vars[9]);
+  expected[9] = &vars[9];
+  assertTrue_1(checkContents(conds, expected));
+  return true;
+}
+
+static bool testGarbage()
+{
+  IntegerVariable a, b, c;
+  NodeConditionSet conds;
+  conds.set(1, &a);
+  conds.set(4, &b);
+  conds.set(7, &c);
+  conds.setGarbage(1, true);
+  conds.setGarbage(7, true);
+  assertTrue_1(conds.isGarbage(1));
+  assertTrue_1(!conds.isGarbage(4));
+  assertTrue_1(conds.isGarbage(7));
+
+  // Flags stay with their index as slots move
+  conds.set(0, &a);
+  conds.set(4, nullptr);
+  assertTrue_1(conds.isGarbage(1));
+  assertTrue_1(!conds.isGarbage(0));
+  assertTrue_1(conds.isGarbage(7));
+
+  // Replacing a condition keeps the flag; the caller decides
+  conds.set(7, &b);
+  assertTrue_1(conds.isGarbage(7));
+  conds.setGarbage(7, false);
+  assertTrue_1(!conds.isGarbage(7));
+
+  // Removing a condition clears its flag
+  conds.set(1, nullptr);
+  assertTrue_1(!conds.isGarbage(1));
+  conds.set(1, &c);
+  assertTrue_1(!conds.isGarbage(1));
+  return true;
+}
+
+bool nodeConditionSetTest()
+{
+  runTest(testEmpty);
+  runTest(testInsertionOrder);
+  runTest(testReplaceAndRemove);
+  runTest(testGarbage);
+  return true;
+}
@@ -0,0 +1,312 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Dispatcher.hh"
+#include "ListNode.hh"
+#include "LookupReceiver.hh"
+#include "NodeFactory.hh"
+#include "NodeImpl.hh"
+#include "NodeStateTable.hh"
+#include "PlexilExec.hh"
+#include "TestSupport.hh"
+
+#include <sstream>
+
+using namespace PLEXIL;
+
+//! Empty and list nodes never call the dispatcher.
+class NullDispatcher final : public Dispatcher
+{
+public:
+  NullDispatcher() = default;
+  virtual ~NullDispatcher() = default;
+
+  virtual void lookupNow(State const & /* state */, LookupReceiver *receiver) override
+  {
+    receiver->setUnknown();
+  }
+
+  virtual void setThresholds(const State & /* state */, Real /* hi */, Real /* lo */) override {}
+  virtual void setThresholds(const State & /* state */, Integer /* hi */, Integer /* lo */) override {}
+  virtual void clearThresholds(const State & /* state */) override {}
+  virtual void executeCommand(Command * /* cmd */) override {}
+  virtual void reportCommandArbitrationFailure(Command * /* cmd */) override {}
+  virtual void invokeAbort(Command * /* cmd */) override {}
+  virtual void executeUpdate(Update * /* update */) override {}
+};
+
+// Build a list node with the given number of empty children.
+static NodeImpl *makeList(char const *name, size_t children)
+{
+  NodeImpl *root = NodeFactory::createNode(name, NodeType_NodeList, nullptr);
+  for (size_t i = 0; i < children; ++i) {
+    std::string childName = std::string(name) + "Child" + std::to_string(i);
+    NodeImpl *child = NodeFactory::createNode(childName.c_str(), NodeType_Empty, root);
+    static_cast<ListNode *>(root)->addChild(child);
+  }
+  root->finalizeConditions();
+  for (NodeImplPtr const &child : root->getChildren())
+    child->finalizeConditions();
+  return root;
+}
+
+// Check that the table entry of every node in the tree matches the node.
+static bool checkTree(NodeStateTable const &table, NodeImpl const *node, uint32_t parent)
+{
+  uint32_t idx = node->getStateTableIndex();
+  assertTrueMsg(idx < table.size(),
+                "checkTree: " << node->getNodeId() << " not in table");
+  assertTrue_1(table.nodes()[idx] == node);
+  assertTrue_1(table.parents()[idx] == parent);
+  assertTrueMsg(table.states()[idx] == node->getState(),
+                "checkTree: " << node->getNodeId() << " is "
+                << nodeStateName(node->getState()) << ", table has "
+                << nodeStateName(table.states()[idx]));
+  assertTrue_1(table.outcomes()[idx] == node->getOutcome());
+  assertTrue_1(table.failureTypes()[idx] == node->getFailureType());
+  assertTrue_1(table.times()[idx] == node->getCurrentStateStartTime());
+  for (NodeImplPtr const &child : node->getChildren())
+    if (!checkTree(table, child.get(), idx))
+      return false;
+  return true;
+}
+
+static bool testAddRemove()
+{
+  NodeImpl *a = NodeFactory::createNode("a", NodeType_Empty, nullptr);
+  NodeImpl *b = NodeFactory::createNode("b", NodeType_Empty, nullptr);
+  NodeImpl *c = NodeFactory::createNode("c", NodeType_Empty, nullptr);
+  NodeImpl *d = NodeFactory::createNode("d", NodeType_Empty, nullptr);
+
+  NodeStateTable table;
+  assertTrue_1(table.size() == 0);
+  assertTrue_1(table.nodeCount() == 0);
+
+  assertTrue_1(table.add(a, NodeStateTable::NO_INDEX, 1) == 0);
+  assertTrue_1(table.add(b, 0, 2) == 1);
+  assertTrue_1(table.add(c, 0, 3) == 2);
+  assertTrue_1(table.size() == 3);
+  assertTrue_1(table.nodeCount() == 3);
+  assertTrue_1(table.nodes()[1] == b);
+  assertTrue_1(table.parents()[0] == NodeStateTable::NO_INDEX);
+  assertTrue_1(table.parents()[2] == 0);
+  assertTrue_1(table.states()[2] == INACTIVE_STATE);
+  assertTrue_1(table.times()[2] == 3);
+  assertTrue_1(table.countInState(INACTIVE_STATE) == 3);
+
+  // A removed entry is unused until reused
+  table.remove(1);
+  assertTrue_1(table.size() == 3);
+  assertTrue_1(table.nodeCount() == 2);
+  assertTrue_1(!table.nodes()[1]);
+  assertTrue_1(table.parents()[1] == NodeStateTable::NO_INDEX);
+  assertTrue_1(table.states()[1] == NO_NODE_STATE);
+  assertTrue_1(table.countInState(INACTIVE_STATE) == 2);
+
+  std::vector<NodeStateRecord> records;
+  table.dump(records);
+  assertTrue_1(records.size() == 2);
+  assertTrue_1(records[0].node == a && records[0].index == 0);
+  assertTrue_1(records[1].node == c && records[1].index == 2);
+
+  assertTrue_1(table.add(d, 2, 4) == 1);
+  assertTrue_1(table.size() == 3);
+  assertTrue_1(table.nodeCount() == 3);
+  assertTrue_1(table.nodes()[1] == d);
+  assertTrue_1(table.parents()[1] == 2);
+  assertTrue_1(table.times()[1] == 4);
+
+  table.update(2, FINISHED_STATE, FAILURE_OUTCOME, PRE_CONDITION_FAILED, 5);
+  size_t counts[NODE_STATE_MAX];
+  table.countByState(counts);
+  assertTrue_1(counts[INACTIVE_STATE] == 2);
+  assertTrue_1(counts[FINISHED_STATE] == 1);
+  assertTrue_1(counts[NO_NODE_STATE] == 0);
+
+  std::ostringstream s;
+  table.print(s);
+  assertTrueMsg(s.str() == "0 a INACTIVE 1\n1 d INACTIVE 4\n2 c FINISHED FAILURE PRE_CONDITION_FAILED 5\n",
+                "testAddRemove: print output is\n" << s.str());
+
+  // Removing every node empties the table
+  table.remove(0);
+  table.remove(2);
+  assertTrue_1(table.size() == 3);
+  table.remove(1);
+  assertTrue_1(table.size() == 0);
+  assertTrue_1(table.nodeCount() == 0);
+  assertTrue_1(table.add(b, NodeStateTable::NO_INDEX, 6) == 0);
+
+  delete (Node *) a;
+  delete (Node *) b;
+  delete (Node *) c;
+  delete (Node *) d;
+  return true;
+}
+
+static bool testDumpChangedSince()
+{
+  NodeImpl *a = NodeFactory::createNode("a", NodeType_Empty, nullptr);
+  NodeImpl *b = NodeFactory::createNode("b", NodeType_Empty, nullptr);
+  NodeImpl *c = NodeFactory::createNode("c", NodeType_Empty, nullptr);
+
+  NodeStateTable table;
+  table.add(a, NodeStateTable::NO_INDEX, 1);
+  table.add(b, 0, 2);
+  table.add(c, 0, 3);
+
+  std::vector<NodeStateRecord> records;
+  table.dumpChangedSince(0, records);
+  assertTrue_1(records.size() == 3);
+
+  // Only transitions strictly after the time are reported
+  table.dumpChangedSince(2, records);
+  assertTrue_1(records.size() == 1);
+  assertTrue_1(records[0].node == c);
+
+  table.update(0, WAITING_STATE, NO_OUTCOME, NO_FAILURE, 4);
+  table.dumpChangedSince(2, records);
+  assertTrue_1(records.size() == 2);
+  assertTrue_1(records[0].node == a);
+  assertTrue_1(records[0].state == WAITING_STATE);
+  assertTrue_1(records[0].time == 4);
+  assertTrue_1(records[1].node == c);
+
+  // Unused entries are never reported
+  table.remove(2);
+  table.dumpChangedSince(-1, records);
+  assertTrue_1(records.size() == 2);
+  table.dumpChangedSince(4, records);
+  assertTrue_1(records.empty());
+
+  delete (Node *) a;
+  delete (Node *) b;
+  delete (Node *) c;
+  return true;
+}
+
+// The Exec adds a plan's nodes, the nodes keep their entries current
+// as they transition, and the Exec removes them with the plan.
+static bool testTransitions()
+{
+  NullDispatcher dispatcher;
+  PlexilExec *exec = makePlexilExec();
+  g_exec = exec;
+  g_dispatcher = &dispatcher;
+  exec->setDispatcher(&dispatcher);
+  NodeStateTable const &table = exec->getNodeStateTable();
+
+  NodeImpl *root = makeList("Root", 3);
+  exec->addPlan(root);
+  assertTrue_1(table.nodeCount() == 4);
+  assertTrue_1(root->getStateTableIndex() == 0);
+  assertTrue_1(checkTree(table, root, NodeStateTable::NO_INDEX));
+
+  std::vector<NodeStateRecord> records;
+  double step = 1;
+  while (exec->needsStep()) {
+    exec->step(step);
+    assertTrue_1(checkTree(table, root, NodeStateTable::NO_INDEX));
+    // Every node transitions in every step of this plan
+    table.dumpChangedSince(step - 0.5, records);
+    assertTrueMsg(records.size() == 4,
+                  "testTransitions: " << records.size() << " changed in step " << step);
+    ++step;
+  }
+  assertTrue_1(root->getState() == FINISHED_STATE);
+  assertTrue_1(table.countInState(FINISHED_STATE) == 4);
+
+  // A second plan reuses nothing while the first is present
+  NodeImpl *second = makeList("Second", 1);
+  exec->addPlan(second);
+  assertTrue_1(second->getStateTableIndex() == 4);
+  assertTrue_1(table.nodeCount() == 6);
+
+  // The finished plan's entries are freed, then reused
+  exec->deleteFinishedPlans();
+  assertTrue_1(table.nodeCount() == 2);
+  assertTrue_1(table.size() == 6);
+  NodeImpl *third = makeList("Third", 1);
+  exec->addPlan(third);
+  assertTrue_1(third->getStateTableIndex() < 4);
+  assertTrue_1(table.nodeCount() == 4);
+  assertTrue_1(table.size() == 6);
+  assertTrue_1(checkTree(table, second, NodeStateTable::NO_INDEX));
+  assertTrue_1(checkTree(table, third, NodeStateTable::NO_INDEX));
+
+  delete exec;
+  g_exec = nullptr;
+  g_dispatcher = nullptr;
+  return true;
+}
+
+static bool testRestoreState()
+{
+  NullDispatcher dispatcher;
+  PlexilExec *exec = makePlexilExec();
+  g_exec = exec;
+  g_dispatcher = &dispatcher;
+  exec->setDispatcher(&dispatcher);
+  NodeStateTable const &table = exec->getNodeStateTable();
+
+  NodeImpl *root = makeList("Restored", 2);
+  exec->addPlan(root);
+  NodeImpl *first = root->getChildren()[0].get();
+  NodeImpl *second = root->getChildren()[1].get();
+
+  assertTrue_1(root->restoreState(exec, EXECUTING_STATE, NO_OUTCOME, NO_FAILURE, 10));
+  assertTrue_1(first->restoreState(exec, FINISHED_STATE, FAILURE_OUTCOME,
+                                   INVARIANT_CONDITION_FAILED, 11));
+  assertTrue_1(second->restoreState(exec, WAITING_STATE, NO_OUTCOME, NO_FAILURE, 12));
+  assertTrue_1(checkTree(table, root, NodeStateTable::NO_INDEX));
+
+  uint32_t idx = first->getStateTableIndex();
+  assertTrue_1(table.states()[idx] == FINISHED_STATE);
+  assertTrue_1(table.outcomes()[idx] == FAILURE_OUTCOME);
+  assertTrue_1(table.failureTypes()[idx] == INVARIANT_CONDITION_FAILED);
+  assertTrue_1(table.times()[idx] == 11);
+
+  std::vector<NodeStateRecord> records;
+  table.dumpChangedSince(10, records);
+  assertTrue_1(records.size() == 2);
+  assertTrue_1(records[0].node == first);
+  assertTrue_1(records[1].node == second);
+  assertTrue_1(records[1].parent == root->getStateTableIndex());
+
+  delete exec;
+  g_exec = nullptr;
+  g_dispatcher = nullptr;
+  return true;
+}
+
+bool nodeStateTableTest()
+{
+  runTest(testAddRemove);
+  runTest(testDumpChangedSince);
+  runTest(testTransitions);
+  runTest(testRestoreState);
+  return true;
+}
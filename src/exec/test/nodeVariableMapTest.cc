@@ -0,0 +1,170 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "NodeVariableMap.hh"
+#include "TestSupport.hh"
+#include "UserVariable.hh"
+
+using namespace PLEXIL;
+
+static bool testShadowing()
+{
+  IntegerVariable outerX("x"), innerX("x"), outerY("y");
+  NodeVariableMap root;
+  root.insert("x", &outerX);
+  root.insert("y", &outerY);
+  NodeVariableMap child(&root);
+  NodeVariableMap grandchild(&child);
+
+  assertTrue_1(child.findVariable("x") == &outerX);
+  assertTrue_1(grandchild.findVariable("x") == &outerX);
+
+  // A local declaration hides the outer one here and below
+  child.insert("x", &innerX);
+  assertTrue_1(root.findVariable("x") == &outerX);
+  assertTrue_1(child.findVariable("x") == &innerX);
+  assertTrue_1(grandchild.findVariable("x") == &innerX);
+  assertTrue_1(grandchild.findVariable("y") == &outerY);
+
+  // Names not declared anywhere
+  assertTrue_1(!grandchild.findVariable("z"));
+  assertTrue_1(!root.findVariable("z"));
+
+  // A map with no parent sees only its own variables
+  NodeVariableMap other;
+  assertTrue_1(!other.findVariable("x"));
+  return true;
+}
+
+static bool testLateBinding()
+{
+  IntegerVariable rootA("a"), childA("a"), rootB("b");
+  NodeVariableMap root;
+  NodeVariableMap child(&root);
+  NodeVariableMap grandchild(&child);
+
+  assertTrue_1(!grandchild.findVariable("a"));
+
+  // Variables added to an ancestor after its descendants exist
+  root.insert("a", &rootA);
+  assertTrue_1(child.findVariable("a") == &rootA);
+  assertTrue_1(grandchild.findVariable("a") == &rootA);
+
+  child.insert("a", &childA);
+  assertTrue_1(grandchild.findVariable("a") == &childA);
+
+  // Adding to the root doesn't undo the shadowing
+  root.insert("b", &rootB);
+  assertTrue_1(grandchild.findVariable("a") == &childA);
+  assertTrue_1(grandchild.findVariable("b") == &rootB);
+  return true;
+}
+
+static bool testClear()
+{
+  IntegerVariable outerX("x"), innerX("x"), innerW("w");
+  NodeVariableMap root;
+  root.insert("x", &outerX);
+  NodeVariableMap child(&root);
+  child.insert("x", &innerX);
+  child.insert("w", &innerW);
+  NodeVariableMap grandchild(&child);
+  assertTrue_1(grandchild.findVariable("x") == &innerX);
+  assertTrue_1(grandchild.findVariable("w") == &innerW);
+
+  // Clearing the child restores the outer binding
+  child.clear();
+  assertTrue_1(child.empty());
+  assertTrue_1(child.findVariable("x") == &outerX);
+  assertTrue_1(grandchild.findVariable("x") == &outerX);
+  assertTrue_1(!grandchild.findVariable("w"));
+
+  // The map is usable again after clearing
+  child.insert("x", &innerX);
+  assertTrue_1(grandchild.findVariable("x") == &innerX);
+
+  root.clear();
+  assertTrue_1(!root.findVariable("x"));
+  assertTrue_1(grandchild.findVariable("x") == &innerX);
+  return true;
+}
+
+// Lookups from the innermost open map take the scope table's
+// bindings, which must agree with a search of the ancestors.
+static bool testOpenScopes()
+{
+  IntegerVariable outerX("x"), innerX("x"), outerY("y"), lateY("y"), lateZ("z");
+  NodeVariableMap root;
+  root.insert("x", &outerX);
+  root.insert("y", &outerY);
+  NodeVariableMap child(&root);
+  child.insert("x", &innerX);
+  NodeVariableMap grandchild(&child);
+  NodeVariableMap sibling(&root);
+
+  {
+    NodeVariableScope rootScope(&root);
+    assertTrue_1(root.findVariable("x") == &outerX);
+    {
+      NodeVariableScope childScope(&child);
+      // A map whose parent isn't innermost isn't opened
+      NodeVariableScope siblingScope(&sibling);
+      NodeVariableScope grandchildScope(&grandchild);
+      assertTrue_1(grandchild.findVariable("x") == &innerX);
+      assertTrue_1(grandchild.findVariable("y") == &outerY);
+      assertTrue_1(!grandchild.findVariable("z"));
+
+      // Variables added to the innermost map, and to an open ancestor
+      grandchild.insert("z", &lateZ);
+      root.insert("w", &outerY);
+      assertTrue_1(grandchild.findVariable("z") == &lateZ);
+      assertTrue_1(grandchild.findVariable("w") == &outerY);
+
+      // A binding added to an open ancestor doesn't hide a nearer one
+      child.insert("y", &lateY);
+      assertTrue_1(grandchild.findVariable("y") == &lateY);
+      assertTrue_1(root.findVariable("y") == &outerY);
+      assertTrue_1(sibling.findVariable("y") == &outerY);
+    }
+    // Closing restores the outer bindings
+    assertTrue_1(root.findVariable("x") == &outerX);
+    assertTrue_1(root.findVariable("y") == &outerY);
+    assertTrue_1(!root.findVariable("z"));
+  }
+  // Closed maps still find their variables
+  assertTrue_1(grandchild.findVariable("z") == &lateZ);
+  assertTrue_1(grandchild.findVariable("x") == &innerX);
+  return true;
+}
+
+bool nodeVariableMapTest()
+{
+  runTest(testShadowing);
+  runTest(testLateBinding);
+  runTest(testClear);
+  runTest(testOpenScopes);
+  return true;
+}
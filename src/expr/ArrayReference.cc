@@ -125,11 +125,10 @@ namespace PLEXIL
     idx = (size_t) idxTemp;
     if (!m_array->getValuePointer(valuePtr))
       return false; // array unknown or invalid
-    std::vector<bool> const &knownVec = valuePtr->getKnownVector();
-    checkPlanError(idx < knownVec.size(),
+    checkPlanError(idx < valuePtr->size(),
                    "Array index " << idx
-                   << " equals or exceeds array size " << knownVec.size());
-    return knownVec[idx];
+                   << " equals or exceeds array size " << valuePtr->size());
+    return valuePtr->elementKnown(idx);
   }
 
   // Local macro
@@ -454,12 +454,7 @@ namespace PLEXIL
       dynamic_cast<ArrayImpl<T> const *>(ary);
     if (!typed_ary)
       return false; // different type
-    if (m_value->getKnownVector() != ary->getKnownVector())
-      return false; // different elements known
-    std::vector<T> const *my_contents, *ary_contents;
-    typed_value->getContentsVector(my_contents);
-    typed_ary->getContentsVector(ary_contents);
-    return *my_contents == *ary_contents;
+    return *typed_value == *typed_ary; // compares known masks first
   }
 
   bool ArrayVariableImpl<Integer>::equals(Array const *ary) const
@@ -475,12 +470,7 @@ namespace PLEXIL
       dynamic_cast<ArrayImpl<Integer> const *>(ary);
     if (!typed_ary)
       return false; // different type
-    if (m_value->getKnownVector() != ary->getKnownVector())
-      return false; // different elements known
-    std::vector<Integer> const *my_contents, *ary_contents;
-    typed_value->getContentsVector(my_contents);
-    typed_ary->getContentsVector(ary_contents);
-    return *my_contents == *ary_contents;
+    return *typed_value == *typed_ary; // compares known masks first
   }
 
   bool ArrayVariableImpl<String>::equals(Array const *ary) const
@@ -496,12 +486,7 @@ namespace PLEXIL
       dynamic_cast<ArrayImpl<String> const *>(ary);
     if (!typed_ary)
       return false; // different type
-    if (m_value->getKnownVector() != ary->getKnownVector())
-      return false; // different elements known
-    std::vector<String> const *my_contents, *ary_contents;
-    typed_value->getContentsVector(my_contents);
-    typed_ary->getContentsVector(ary_contents);
-    return *my_contents == *ary_contents;
+    return *typed_value == *typed_ary; // compares known masks first
   }
 
   template <typename T>
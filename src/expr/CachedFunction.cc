@@ -25,6 +25,7 @@
 */
 
 #include "CachedFunction.hh"
+#include "ExpressionProfiler.hh"
 #include "Function.hh"
 #include "Operator.hh"
 #include "PlanError.hh"
@@ -70,12 +71,14 @@ namespace PLEXIL
     // Strings are legal with CachedFunction
     virtual bool getValue(String &result) const
     {
+      PROFILE_EXPRESSION_EVALUATION(this);
       return (*m_op)(result, *this);
     }
 
 #define DEFINE_CACHED_FUNC_DEFAULT_GET_VALUE_PTR_METHOD(_type) \
     virtual bool getValuePointer(_type const *&ptr) const               \
     {                                                                   \
+      PROFILE_EXPRESSION_EVALUATION(this);                              \
       bool result = (*m_op)(*static_cast<_type *>(m_valueCache), *this); \
       if (result)                                                       \
         ptr = static_cast<_type const *>(m_valueCache); /* trust me */  \
@@ -244,12 +247,14 @@ namespace PLEXIL
 
     virtual bool getValue(String &result) const
     {
+      PROFILE_EXPRESSION_EVALUATION(this);
       return (*m_op)(result, *this);
     }
 
 #define DEFINE_FIXED_ARG_CACHED_GET_VALUE_PTR_METHOD(_type) \
     virtual bool getValuePointer(_type const *&ptr) const   \
     {                                                                   \
+      PROFILE_EXPRESSION_EVALUATION(this);                              \
       bool result = (*m_op)(*static_cast<_type *>(m_valueCache), this); \
       if (result)                                                       \
         ptr = static_cast<_type const *>(m_valueCache); /* trust me */  \
@@ -323,12 +328,14 @@ namespace PLEXIL
   template <>
   bool FixedSizeCachedFunction<1>::getValue(String &result) const
   {
+    PROFILE_EXPRESSION_EVALUATION(this);
     return (*m_op)(result, exprs[0]);
   }
 
 #define DEFINE_ONE_ARG_CACHED_GET_VALUE_PTR_METHOD(_type) \
   template <> bool FixedSizeCachedFunction<1>::getValuePointer(_type const *&ptr) const \
   {                                                                     \
+    PROFILE_EXPRESSION_EVALUATION(this);                                \
     bool result = (*m_op)(*static_cast<_type *>(m_valueCache), exprs[0]); \
     if (result)                                                         \
       ptr = static_cast<_type const *>(m_valueCache); /* trust me */    \
@@ -402,12 +409,14 @@ namespace PLEXIL
   template <>
   bool FixedSizeCachedFunction<2>::getValue(String &result) const
   {
+    PROFILE_EXPRESSION_EVALUATION(this);
     return (*m_op)(result, exprs[0], exprs[1]);
   }
 
 #define DEFINE_TWO_ARG_CACHED_GET_VALUE_PTR_METHOD(_type) \
   template <> bool FixedSizeCachedFunction<2>::getValuePointer(_type const *&ptr) const \
   { \
+    PROFILE_EXPRESSION_EVALUATION(this); \
     bool result = (*m_op)(*static_cast<_type *>(m_valueCache), exprs[0], exprs[1]); \
     if (result) \
       ptr = static_cast<_type const *>(m_valueCache); /* trust me */ \
@@ -0,0 +1,932 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "CompiledExpression.hh"
+
+#include "ArithmeticOperators.hh"
+#include "BooleanOperators.hh"
+#include "Comparisons.hh"
+#include "Constant.hh"
+#include "Debug.hh"
+#include "Error.hh"
+#include "Function.hh"
+#include "UserVariable.hh"
+
+#include <iostream>
+
+namespace PLEXIL
+{
+
+  //
+  // Opcodes
+  //
+  // Register operands are named by the Instruction fields dst, a, b.
+  //
+
+  enum CompiledOpcode : uint8_t
+    {
+      // dst <- value of m_leaves[a], read as the named type.
+      // Internal enumerations are stored in the Integer field.
+      LOAD_BOOLEAN = 0,
+      LOAD_INTEGER,
+      LOAD_REAL,
+      LOAD_NODE_STATE,
+      LOAD_OUTCOME,
+      LOAD_FAILURE,
+      LOAD_COMMAND_HANDLE,
+
+      // dst <- m_leaves[a]->isKnown(); always known
+      LOAD_IS_KNOWN,
+
+      // dst <- value of user variable m_slots[a]
+      SLOT_BOOLEAN,
+      SLOT_INTEGER,
+      SLOT_REAL,
+
+      // dst <- a, converted from Integer to Real
+      INTEGER_TO_REAL,
+
+      // dst <- !a
+      NOT,
+
+      // AND: dst <- true; each step: if a is known false, dst <- false
+      // and jump to b; if a is unknown, dst becomes unknown.
+      AND_INIT,
+      AND_STEP,
+
+      // Two-argument OR: dst <- known false; each step: if a is known
+      // true, dst <- true and jump to b; if a is unknown, dst becomes
+      // unknown.
+      OR_INIT,
+      OR_STEP,
+
+      // N-ary OR: dst <- unknown false; each step: if a is known true,
+      // dst <- true and jump to b; if a is known, dst becomes known.
+      OR_ANY_INIT,
+      OR_ANY_STEP,
+
+      // dst <- a op b; unknown if either is unknown
+      ADD_INTEGER,
+      ADD_REAL,
+      SUB_INTEGER,
+      SUB_REAL,
+      MUL_INTEGER,
+      MUL_REAL,
+      // Also unknown if b is zero
+      DIV_INTEGER,
+      DIV_REAL,
+
+      // dst <- -a
+      NEG_INTEGER,
+      NEG_REAL,
+
+      // dst <- a compare b; unknown if either is unknown
+      EQ_BOOLEAN,
+      EQ_INTEGER,
+      EQ_REAL,
+      NE_BOOLEAN,
+      NE_INTEGER,
+      NE_REAL,
+      LT_INTEGER,
+      LT_REAL,
+      LE_INTEGER,
+      LE_REAL,
+      GT_INTEGER,
+      GT_REAL,
+      GE_INTEGER,
+      GE_REAL,
+
+      OPCODE_MAX
+    };
+
+  static char const *s_opcodeNames[OPCODE_MAX] =
+    {
+      "LOAD_BOOLEAN",
+      "LOAD_INTEGER",
+      "LOAD_REAL",
+      "LOAD_NODE_STATE",
+      "LOAD_OUTCOME",
+      "LOAD_FAILURE",
+      "LOAD_COMMAND_HANDLE",
+      "LOAD_IS_KNOWN",
+      "SLOT_BOOLEAN",
+      "SLOT_INTEGER",
+      "SLOT_REAL",
+      "INTEGER_TO_REAL",
+      "NOT",
+      "AND_INIT",
+      "AND_STEP",
+      "OR_INIT",
+      "OR_STEP",
+      "OR_ANY_INIT",
+      "OR_ANY_STEP",
+      "ADD_INTEGER",
+      "ADD_REAL",
+      "SUB_INTEGER",
+      "SUB_REAL",
+      "MUL_INTEGER",
+      "MUL_REAL",
+      "DIV_INTEGER",
+      "DIV_REAL",
+      "NEG_INTEGER",
+      "NEG_REAL",
+      "EQ_BOOLEAN",
+      "EQ_INTEGER",
+      "EQ_REAL",
+      "NE_BOOLEAN",
+      "NE_INTEGER",
+      "NE_REAL",
+      "LT_INTEGER",
+      "LT_REAL",
+      "LE_INTEGER",
+      "LE_REAL",
+      "GT_INTEGER",
+      "GT_REAL",
+      "GE_INTEGER",
+      "GE_REAL"
+    };
+
+  //! \brief Beyond this many instructions, subexpressions are
+  //!        compiled as leaves.
+  static constexpr size_t MAX_INSTRUCTIONS = 1024;
+
+  //
+  // Operators the compiler recognizes
+  //
+
+  enum OperationKind : uint8_t
+    {
+      OP_NOT,
+      OP_AND,
+      OP_OR,
+      OP_IS_KNOWN,
+      OP_EQUAL,
+      OP_NOT_EQUAL,
+      OP_LESS_THAN,
+      OP_LESS_EQUAL,
+      OP_GREATER_THAN,
+      OP_GREATER_EQUAL,
+      OP_ADD,
+      OP_SUBTRACT,
+      OP_MULTIPLY,
+      OP_DIVIDE
+    };
+
+  struct OperationInfo
+  {
+    Operator const *op;
+    OperationKind kind;
+    ValueType resultType;
+    ValueType argType; // UNKNOWN_TYPE if determined by the arguments
+  };
+
+  static OperationInfo const *getOperationInfo(Operator const *op)
+  {
+    static OperationInfo const sl_info[] =
+      {
+        {BooleanNot::instance(), OP_NOT, BOOLEAN_TYPE, BOOLEAN_TYPE},
+        {BooleanAnd::instance(), OP_AND, BOOLEAN_TYPE, BOOLEAN_TYPE},
+        {BooleanOr::instance(), OP_OR, BOOLEAN_TYPE, BOOLEAN_TYPE},
+        {IsKnown::instance(), OP_IS_KNOWN, BOOLEAN_TYPE, UNKNOWN_TYPE},
+        {Equal::instance(), OP_EQUAL, BOOLEAN_TYPE, UNKNOWN_TYPE},
+        {NotEqual::instance(), OP_NOT_EQUAL, BOOLEAN_TYPE, UNKNOWN_TYPE},
+        {LessThan<Integer>::instance(), OP_LESS_THAN, BOOLEAN_TYPE, INTEGER_TYPE},
+        {LessThan<Real>::instance(), OP_LESS_THAN, BOOLEAN_TYPE, REAL_TYPE},
+        {LessEqual<Integer>::instance(), OP_LESS_EQUAL, BOOLEAN_TYPE, INTEGER_TYPE},
+        {LessEqual<Real>::instance(), OP_LESS_EQUAL, BOOLEAN_TYPE, REAL_TYPE},
+        {GreaterThan<Integer>::instance(), OP_GREATER_THAN, BOOLEAN_TYPE, INTEGER_TYPE},
+        {GreaterThan<Real>::instance(), OP_GREATER_THAN, BOOLEAN_TYPE, REAL_TYPE},
+        {GreaterEqual<Integer>::instance(), OP_GREATER_EQUAL, BOOLEAN_TYPE, INTEGER_TYPE},
+        {GreaterEqual<Real>::instance(), OP_GREATER_EQUAL, BOOLEAN_TYPE, REAL_TYPE},
+        {Addition<Integer>::instance(), OP_ADD, INTEGER_TYPE, INTEGER_TYPE},
+        {Addition<Real>::instance(), OP_ADD, REAL_TYPE, REAL_TYPE},
+        {Subtraction<Integer>::instance(), OP_SUBTRACT, INTEGER_TYPE, INTEGER_TYPE},
+        {Subtraction<Real>::instance(), OP_SUBTRACT, REAL_TYPE, REAL_TYPE},
+        {Multiplication<Integer>::instance(), OP_MULTIPLY, INTEGER_TYPE, INTEGER_TYPE},
+        {Multiplication<Real>::instance(), OP_MULTIPLY, REAL_TYPE, REAL_TYPE},
+        {Division<Integer>::instance(), OP_DIVIDE, INTEGER_TYPE, INTEGER_TYPE},
+        {Division<Real>::instance(), OP_DIVIDE, REAL_TYPE, REAL_TYPE}
+      };
+
+    for (OperationInfo const &info : sl_info)
+      if (info.op == op)
+        return &info;
+    return nullptr;
+  }
+
+  //! \brief Can a value of the actual type be read as the wanted type
+  //!        without an error?
+  static bool canReadAs(ValueType actual, ValueType wanted)
+  {
+    return actual == wanted
+      || (actual == INTEGER_TYPE && wanted == REAL_TYPE);
+  }
+
+  static bool isLiteral(Expression const *exp)
+  {
+    return dynamic_cast<Constant<Boolean> const *>(exp)
+      || dynamic_cast<Constant<Integer> const *>(exp)
+      || dynamic_cast<Constant<Real> const *>(exp)
+      || dynamic_cast<Constant<NodeState> const *>(exp)
+      || dynamic_cast<Constant<NodeOutcome> const *>(exp)
+      || dynamic_cast<Constant<FailureType> const *>(exp)
+      || dynamic_cast<Constant<CommandHandleValue> const *>(exp);
+  }
+
+  //
+  // CompiledExpression
+  //
+
+  CompiledExpression *CompiledExpression::compile(Expression const *exp)
+  {
+    // Only worth the trouble if the root is an operation we understand
+    Function const *fn = dynamic_cast<Function const *>(exp);
+    if (!fn
+        || exp->valueType() != BOOLEAN_TYPE
+        || !getOperationInfo(fn->getOperator()))
+      return nullptr;
+
+    CompiledExpression *result = new CompiledExpression(exp);
+    result->m_result = result->compileAs(exp, BOOLEAN_TYPE);
+    debugMsg("CompiledExpression:compile",
+             ' ' << result->m_code.size() << " instructions, "
+             << result->m_registers.size() << " registers, "
+             << result->m_leaves.size() << " leaves for "
+             << *exp);
+    return result;
+  }
+
+  CompiledExpression::CompiledExpression(Expression const *source)
+    : m_code(),
+      m_registers(),
+      m_slots(),
+      m_leaves(),
+      m_source(source),
+      m_result(0)
+  {
+  }
+
+  CompiledExpression::~CompiledExpression()
+  {
+  }
+
+  bool CompiledExpression::getValue(Boolean &result) const
+  {
+    // Direct reads of variables are only valid while the tree is active
+    if (!m_source->isActive())
+      return m_source->getValue(result);
+
+    Register *const reg = m_registers.data();
+    Instruction const *const code = m_code.data();
+    size_t const n = m_code.size();
+    size_t pc = 0;
+    while (pc < n) {
+      Instruction const &ins = code[pc++];
+      Register &dst = reg[ins.dst];
+      switch (ins.op) {
+
+      case LOAD_BOOLEAN:
+        dst.known = m_leaves[ins.a]->getValue(dst.b);
+        break;
+
+      case LOAD_INTEGER:
+        dst.known = m_leaves[ins.a]->getValue(dst.i);
+        break;
+
+      case LOAD_REAL:
+        dst.known = m_leaves[ins.a]->getValue(dst.r);
+        break;
+
+      case LOAD_NODE_STATE: {
+        NodeState temp;
+        if ((dst.known = m_leaves[ins.a]->getValue(temp)))
+          dst.i = temp;
+        break;
+      }
+
+      case LOAD_OUTCOME: {
+        NodeOutcome temp;
+        if ((dst.known = m_leaves[ins.a]->getValue(temp)))
+          dst.i = temp;
+        break;
+      }
+
+      case LOAD_FAILURE: {
+        FailureType temp;
+        if ((dst.known = m_leaves[ins.a]->getValue(temp)))
+          dst.i = temp;
+        break;
+      }
+
+      case LOAD_COMMAND_HANDLE: {
+        CommandHandleValue temp;
+        if ((dst.known = m_leaves[ins.a]->getValue(temp)))
+          dst.i = temp;
+        break;
+      }
+
+      case LOAD_IS_KNOWN:
+        dst.b = m_leaves[ins.a]->isKnown();
+        dst.known = true;
+        break;
+
+      case SLOT_BOOLEAN:
+        if ((dst.known = *m_slots[ins.a].known))
+          dst.b = *static_cast<Boolean const *>(m_slots[ins.a].value);
+        break;
+
+      case SLOT_INTEGER:
+        if ((dst.known = *m_slots[ins.a].known))
+          dst.i = *static_cast<Integer const *>(m_slots[ins.a].value);
+        break;
+
+      case SLOT_REAL:
+        if ((dst.known = *m_slots[ins.a].known))
+          dst.r = *static_cast<Real const *>(m_slots[ins.a].value);
+        break;
+
+      case INTEGER_TO_REAL:
+        if ((dst.known = reg[ins.a].known))
+          dst.r = reg[ins.a].i;
+        break;
+
+      case NOT:
+        dst.b = !reg[ins.a].b;
+        dst.known = reg[ins.a].known;
+        break;
+
+      case AND_INIT:
+        dst.b = true;
+        dst.known = true;
+        break;
+
+      case AND_STEP:
+        if (!reg[ins.a].known)
+          dst.known = false;
+        else if (!reg[ins.a].b) {
+          dst.b = false;
+          dst.known = true;
+          pc = ins.b;
+        }
+        break;
+
+      case OR_INIT:
+        dst.b = false;
+        dst.known = true;
+        break;
+
+      case OR_STEP:
+        if (!reg[ins.a].known)
+          dst.known = false;
+        else if (reg[ins.a].b) {
+          dst.b = true;
+          dst.known = true;
+          pc = ins.b;
+        }
+        break;
+
+      case OR_ANY_INIT:
+        dst.b = false;
+        dst.known = false;
+        break;
+
+      case OR_ANY_STEP:
+        if (reg[ins.a].known) {
+          dst.known = true;
+          if (reg[ins.a].b) {
+            dst.b = true;
+            pc = ins.b;
+          }
+        }
+        break;
+
+        // Binary operations may use dst as an operand (accumulator),
+        // so compute the known flag before storing anything.
+
+#define COMPILED_BINARY_OP(OPCODE, FIELD, RESULT, OP)                   \
+      case OPCODE: {                                                    \
+        bool known = reg[ins.a].known && reg[ins.b].known;              \
+        if (known)                                                      \
+          dst.RESULT = (reg[ins.a].FIELD OP reg[ins.b].FIELD);          \
+        dst.known = known;                                              \
+        break;                                                          \
+      }
+
+        COMPILED_BINARY_OP(ADD_INTEGER, i, i, +)
+        COMPILED_BINARY_OP(ADD_REAL, r, r, +)
+        COMPILED_BINARY_OP(SUB_INTEGER, i, i, -)
+        COMPILED_BINARY_OP(SUB_REAL, r, r, -)
+        COMPILED_BINARY_OP(MUL_INTEGER, i, i, *)
+        COMPILED_BINARY_OP(MUL_REAL, r, r, *)
+        COMPILED_BINARY_OP(EQ_BOOLEAN, b, b, ==)
+        COMPILED_BINARY_OP(EQ_INTEGER, i, b, ==)
+        COMPILED_BINARY_OP(EQ_REAL, r, b, ==)
+        COMPILED_BINARY_OP(NE_BOOLEAN, b, b, !=)
+        COMPILED_BINARY_OP(NE_INTEGER, i, b, !=)
+        COMPILED_BINARY_OP(NE_REAL, r, b, !=)
+        COMPILED_BINARY_OP(LT_INTEGER, i, b, <)
+        COMPILED_BINARY_OP(LT_REAL, r, b, <)
+        COMPILED_BINARY_OP(LE_INTEGER, i, b, <=)
+        COMPILED_BINARY_OP(LE_REAL, r, b, <=)
+        COMPILED_BINARY_OP(GT_INTEGER, i, b, >)
+        COMPILED_BINARY_OP(GT_REAL, r, b, >)
+        COMPILED_BINARY_OP(GE_INTEGER, i, b, >=)
+        COMPILED_BINARY_OP(GE_REAL, r, b, >=)
+
+#undef COMPILED_BINARY_OP
+
+      case DIV_INTEGER: {
+        bool known =
+          reg[ins.a].known && reg[ins.b].known && reg[ins.b].i != 0;
+        if (known)
+          dst.i = reg[ins.a].i / reg[ins.b].i;
+        dst.known = known;
+        break;
+      }
+
+      case DIV_REAL: {
+        bool known =
+          reg[ins.a].known && reg[ins.b].known && reg[ins.b].r != 0;
+        if (known)
+          dst.r = reg[ins.a].r / reg[ins.b].r;
+        dst.known = known;
+        break;
+      }
+
+      case NEG_INTEGER:
+        if ((dst.known = reg[ins.a].known))
+          dst.i = -reg[ins.a].i;
+        break;
+
+      case NEG_REAL:
+        if ((dst.known = reg[ins.a].known))
+          dst.r = -reg[ins.a].r;
+        break;
+
+      default:
+        errorMsg("CompiledExpression::getValue: invalid opcode "
+                 << (int) ins.op);
+        return false;
+      }
+    }
+
+    Register const &r = reg[m_result];
+    if (r.known)
+      result = r.b;
+    return r.known;
+  }
+
+  void CompiledExpression::print(std::ostream &s) const
+  {
+    for (size_t pc = 0; pc < m_code.size(); ++pc) {
+      Instruction const &ins = m_code[pc];
+      s << pc << ": " << s_opcodeNames[ins.op]
+        << " r" << ins.dst << ' ' << ins.a << ' ' << ins.b << '\n';
+    }
+    s << "result r" << m_result << '\n';
+  }
+
+  //
+  // Compiler
+  //
+
+  uint16_t CompiledExpression::compileAs(Expression const *exp, ValueType type)
+  {
+    ValueType actual = exp->valueType();
+    if (canReadAs(actual, type)) {
+      if (isLiteral(exp))
+        return compileLiteral(exp, type);
+
+      uint16_t result;
+      Function const *fn = dynamic_cast<Function const *>(exp);
+      if (fn && m_code.size() < MAX_INSTRUCTIONS) {
+        if (compileFunction(fn, actual, result)) {
+          if (actual == type)
+            return result;
+          uint16_t converted = newRegister();
+          emit(INTEGER_TO_REAL, converted, result);
+          return converted;
+        }
+      }
+      else if (compileSlot(exp, type, result))
+        return result;
+    }
+    return compileLeaf(exp, type);
+  }
+
+  bool CompiledExpression::compileFunction(Function const *fn,
+                                           ValueType type,
+                                           uint16_t &result)
+  {
+    OperationInfo const *info = getOperationInfo(fn->getOperator());
+    if (!info || info->resultType != type)
+      return false;
+    size_t n = fn->size();
+    if (!n)
+      return false;
+
+    switch (info->kind) {
+
+    case OP_NOT: {
+      if (n != 1)
+        return false;
+      uint16_t arg = compileAs((*fn)[0], BOOLEAN_TYPE);
+      result = newRegister();
+      emit(NOT, result, arg);
+      return true;
+    }
+
+    case OP_AND:
+    case OP_OR: {
+      // Single argument: value of the argument
+      if (n == 1) {
+        result = compileAs((*fn)[0], BOOLEAN_TYPE);
+        return true;
+      }
+      uint8_t init, step;
+      if (info->kind == OP_AND) {
+        init = AND_INIT;
+        step = AND_STEP;
+      }
+      else if (n == 2) {
+        init = OR_INIT;
+        step = OR_STEP;
+      }
+      else {
+        // N-ary OR is known if any argument is known
+        init = OR_ANY_INIT;
+        step = OR_ANY_STEP;
+      }
+      result = newRegister();
+      emit(init, result);
+      std::vector<size_t> jumps;
+      jumps.reserve(n);
+      for (size_t i = 0; i < n; ++i) {
+        uint16_t arg = compileAs((*fn)[i], BOOLEAN_TYPE);
+        jumps.push_back(emit(step, result, arg));
+      }
+      // Short circuit jumps to the end of the operation
+      for (size_t j : jumps)
+        m_code[j].b = (uint16_t) m_code.size();
+      return true;
+    }
+
+    case OP_IS_KNOWN: {
+      if (n != 1)
+        return false;
+      result = newRegister();
+      emit(LOAD_IS_KNOWN, result, addLeaf((*fn)[0]));
+      return true;
+    }
+
+    case OP_EQUAL:
+    case OP_NOT_EQUAL: {
+      if (n != 2)
+        return false;
+      // Mirror the type dispatch of the Equal operator
+      ValueType typeA = (*fn)[0]->valueType();
+      ValueType typeB = (*fn)[1]->valueType();
+      ValueType compareType;
+      switch (typeA) {
+      case BOOLEAN_TYPE:
+        if (typeB != BOOLEAN_TYPE)
+          return false;
+        compareType = BOOLEAN_TYPE;
+        break;
+
+      case INTEGER_TYPE:
+        if (typeB == INTEGER_TYPE)
+          compareType = INTEGER_TYPE;
+        else if (typeB == REAL_TYPE)
+          compareType = REAL_TYPE;
+        else
+          return false;
+        break;
+
+      case REAL_TYPE:
+        if (typeB != INTEGER_TYPE && typeB != REAL_TYPE)
+          return false;
+        compareType = REAL_TYPE;
+        break;
+
+      case NODE_STATE_TYPE:
+      case OUTCOME_TYPE:
+      case FAILURE_TYPE:
+      case COMMAND_HANDLE_TYPE:
+        if (typeB != typeA)
+          return false;
+        compareType = typeA;
+        break;
+
+      default:
+        return false;
+      }
+
+      uint16_t argA = compileAs((*fn)[0], compareType);
+      uint16_t argB = compileAs((*fn)[1], compareType);
+      bool equal = (info->kind == OP_EQUAL);
+      uint8_t op;
+      switch (compareType) {
+      case BOOLEAN_TYPE:
+        op = equal ? EQ_BOOLEAN : NE_BOOLEAN;
+        break;
+
+      case REAL_TYPE:
+        op = equal ? EQ_REAL : NE_REAL;
+        break;
+
+      default: // Integer and internal enumerations
+        op = equal ? EQ_INTEGER : NE_INTEGER;
+        break;
+      }
+      result = newRegister();
+      emit(op, result, argA, argB);
+      return true;
+    }
+
+    case OP_LESS_THAN:
+    case OP_LESS_EQUAL:
+    case OP_GREATER_THAN:
+    case OP_GREATER_EQUAL: {
+      if (n != 2)
+        return false;
+      bool isInt = (info->argType == INTEGER_TYPE);
+      uint8_t op;
+      switch (info->kind) {
+      case OP_LESS_THAN:
+        op = isInt ? LT_INTEGER : LT_REAL;
+        break;
+
+      case OP_LESS_EQUAL:
+        op = isInt ? LE_INTEGER : LE_REAL;
+        break;
+
+      case OP_GREATER_THAN:
+        op = isInt ? GT_INTEGER : GT_REAL;
+        break;
+
+      default:
+        op = isInt ? GE_INTEGER : GE_REAL;
+        break;
+      }
+      uint16_t argA = compileAs((*fn)[0], info->argType);
+      uint16_t argB = compileAs((*fn)[1], info->argType);
+      result = newRegister();
+      emit(op, result, argA, argB);
+      return true;
+    }
+
+    case OP_ADD:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE: {
+      bool isInt = (info->argType == INTEGER_TYPE);
+      uint8_t op;
+      switch (info->kind) {
+      case OP_ADD:
+        op = isInt ? ADD_INTEGER : ADD_REAL;
+        break;
+
+      case OP_SUBTRACT:
+        op = isInt ? SUB_INTEGER : SUB_REAL;
+        break;
+
+      case OP_MULTIPLY:
+        op = isInt ? MUL_INTEGER : MUL_REAL;
+        break;
+
+      default:
+        if (n != 2)
+          return false;
+        op = isInt ? DIV_INTEGER : DIV_REAL;
+        break;
+      }
+
+      uint16_t first = compileAs((*fn)[0], info->argType);
+      if (n == 1) {
+        if (info->kind == OP_SUBTRACT) {
+          // Unary minus
+          result = newRegister();
+          emit(isInt ? NEG_INTEGER : NEG_REAL, result, first);
+        }
+        else
+          result = first;
+        return true;
+      }
+
+      // Accumulate left to right
+      uint16_t second = compileAs((*fn)[1], info->argType);
+      result = newRegister();
+      emit(op, result, first, second);
+      for (size_t i = 2; i < n; ++i)
+        emit(op, result, result, compileAs((*fn)[i], info->argType));
+      return true;
+    }
+
+    default:
+      return false;
+    }
+  }
+
+  uint16_t CompiledExpression::compileLiteral(Expression const *exp, ValueType type)
+  {
+    uint16_t result = newRegister();
+    Register &reg = m_registers[result];
+    switch (type) {
+    case BOOLEAN_TYPE:
+      reg.known = exp->getValue(reg.b);
+      break;
+
+    case INTEGER_TYPE:
+      reg.known = exp->getValue(reg.i);
+      break;
+
+    case REAL_TYPE:
+      reg.known = exp->getValue(reg.r);
+      break;
+
+    case NODE_STATE_TYPE: {
+      NodeState temp;
+      if ((reg.known = exp->getValue(temp)))
+        reg.i = temp;
+      break;
+    }
+
+    case OUTCOME_TYPE: {
+      NodeOutcome temp;
+      if ((reg.known = exp->getValue(temp)))
+        reg.i = temp;
+      break;
+    }
+
+    case FAILURE_TYPE: {
+      FailureType temp;
+      if ((reg.known = exp->getValue(temp)))
+        reg.i = temp;
+      break;
+    }
+
+    case COMMAND_HANDLE_TYPE: {
+      CommandHandleValue temp;
+      if ((reg.known = exp->getValue(temp)))
+        reg.i = temp;
+      break;
+    }
+
+    default:
+      errorMsg("CompiledExpression: can't compile literal of type "
+               << valueTypeName(type));
+      break;
+    }
+    return result;
+  }
+
+  bool CompiledExpression::compileSlot(Expression const *exp,
+                                       ValueType type,
+                                       uint16_t &result)
+  {
+    Slot slot;
+    uint8_t op;
+    bool convert = false;
+    switch (exp->valueType()) {
+    case BOOLEAN_TYPE: {
+      UserVariable<Boolean> const *var =
+        dynamic_cast<UserVariable<Boolean> const *>(exp);
+      if (!var)
+        return false;
+      Boolean const *valuePtr;
+      var->getStorage(valuePtr, slot.known);
+      slot.value = valuePtr;
+      op = SLOT_BOOLEAN;
+      break;
+    }
+
+    case INTEGER_TYPE: {
+      UserVariable<Integer> const *var =
+        dynamic_cast<UserVariable<Integer> const *>(exp);
+      if (!var)
+        return false;
+      Integer const *valuePtr;
+      var->getStorage(valuePtr, slot.known);
+      slot.value = valuePtr;
+      op = SLOT_INTEGER;
+      convert = (type == REAL_TYPE);
+      break;
+    }
+
+    case REAL_TYPE: {
+      UserVariable<Real> const *var =
+        dynamic_cast<UserVariable<Real> const *>(exp);
+      if (!var)
+        return false;
+      Real const *valuePtr;
+      var->getStorage(valuePtr, slot.known);
+      slot.value = valuePtr;
+      op = SLOT_REAL;
+      break;
+    }
+
+    default:
+      return false;
+    }
+
+    uint16_t index = (uint16_t) m_slots.size();
+    m_slots.push_back(slot);
+    result = newRegister();
+    emit(op, result, index);
+    if (convert) {
+      uint16_t converted = newRegister();
+      emit(INTEGER_TO_REAL, converted, result);
+      result = converted;
+    }
+    return true;
+  }
+
+  uint16_t CompiledExpression::compileLeaf(Expression const *exp, ValueType type)
+  {
+    uint8_t op;
+    switch (type) {
+    case BOOLEAN_TYPE:
+      op = LOAD_BOOLEAN;
+      break;
+
+    case INTEGER_TYPE:
+      op = LOAD_INTEGER;
+      break;
+
+    case REAL_TYPE:
+      op = LOAD_REAL;
+      break;
+
+    case NODE_STATE_TYPE:
+      op = LOAD_NODE_STATE;
+      break;
+
+    case OUTCOME_TYPE:
+      op = LOAD_OUTCOME;
+      break;
+
+    case FAILURE_TYPE:
+      op = LOAD_FAILURE;
+      break;
+
+    case COMMAND_HANDLE_TYPE:
+      op = LOAD_COMMAND_HANDLE;
+      break;
+
+    default:
+      errorMsg("CompiledExpression: can't load leaf of type "
+               << valueTypeName(type));
+      return 0;
+    }
+    uint16_t result = newRegister();
+    emit(op, result, addLeaf(exp));
+    return result;
+  }
+
+  uint16_t CompiledExpression::addLeaf(Expression const *exp)
+  {
+    uint16_t result = (uint16_t) m_leaves.size();
+    m_leaves.push_back(exp);
+    return result;
+  }
+
+  uint16_t CompiledExpression::newRegister()
+  {
+    uint16_t result = (uint16_t) m_registers.size();
+    m_registers.push_back(Register());
+    m_registers.back().known = false;
+    return result;
+  }
+
+  size_t CompiledExpression::emit(uint8_t op, uint16_t dst, uint16_t a, uint16_t b)
+  {
+    size_t result = m_code.size();
+    m_code.push_back({op, dst, a, b});
+    return result;
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,164 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_COMPILED_EXPRESSION_HH
+#define PLEXIL_COMPILED_EXPRESSION_HH
+
+#include "ValueType.hh"
+
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+namespace PLEXIL
+{
+  class Expression;
+  class Function;
+
+  //! \class CompiledExpression
+  //! \brief A Boolean expression tree lowered to a compact, typed
+  //!        register bytecode.
+  //!
+  //! Logical, comparison, and arithmetic operations on Boolean,
+  //! Integer, and Real values are compiled to instructions operating
+  //! on registers which carry a known flag alongside the value.  AND
+  //! and OR short-circuit by jumping.  Literals are loaded into
+  //! registers once, at compile time; user variables are read
+  //! directly from their storage.  Any other subexpression is a leaf,
+  //! read through its getValue() method.
+  //!
+  //! The result is identical to that of the source expression's
+  //! getValue() method, including the treatment of unknown values.
+  //! The source expression remains responsible for activation and
+  //! change notification.
+  //!
+  //! \note Evaluation uses the instance's registers, so an instance
+  //!       must only be evaluated by one thread at a time.
+  //! \ingroup Expressions
+  class CompiledExpression final
+  {
+  public:
+
+    //! \brief Compile a Boolean expression.
+    //! \param exp Pointer to the expression.
+    //! \return Pointer to the compiled expression; null if the
+    //!         expression would not benefit from compiling.
+    static CompiledExpression *compile(Expression const *exp);
+
+    //! \brief Destructor.
+    ~CompiledExpression();
+
+    //! \brief Get the expression from which this was compiled.
+    //! \return Const pointer to the expression.
+    Expression const *source() const
+    {
+      return m_source;
+    }
+
+    //! \brief Evaluate the compiled expression.
+    //! \param result Reference to the result variable.
+    //! \return True if the result is known, false if unknown.
+    //! \note If the source expression is inactive, delegates to it.
+    bool getValue(Boolean &result) const;
+
+    //! \brief Print the instructions to a stream, for debugging.
+    //! \param s The stream.
+    void print(std::ostream &s) const;
+
+  private:
+
+    // Not implemented
+    CompiledExpression() = delete;
+    CompiledExpression(CompiledExpression const &) = delete;
+    CompiledExpression(CompiledExpression &&) = delete;
+    CompiledExpression &operator=(CompiledExpression const &) = delete;
+    CompiledExpression &operator=(CompiledExpression &&) = delete;
+
+    //! \brief One instruction.  The meaning of the operands depends on
+    //!        the opcode; see CompiledExpression.cc.
+    struct Instruction
+    {
+      uint8_t op;   //!< The opcode.
+      uint16_t dst; //!< Destination register.
+      uint16_t a;   //!< Source register, leaf, or slot.
+      uint16_t b;   //!< Source register or jump target.
+    };
+
+    //! \brief A register holds a value and its known flag.
+    struct Register
+    {
+      union {
+        Boolean b;
+        Integer i;  //!< Also holds internal enumerated values.
+        Real r;
+      };
+      bool known;
+    };
+
+    //! \brief Direct reference to a user variable's storage.
+    struct Slot
+    {
+      void const *value;
+      bool const *known;
+    };
+
+    //! \brief Constructor.
+    //! \param source The expression being compiled.
+    CompiledExpression(Expression const *source);
+
+    //
+    // Compiler
+    //
+
+    //! \brief Compile an expression to yield a value of the given type.
+    //! \return Index of the register which will hold the value.
+    uint16_t compileAs(Expression const *exp, ValueType type);
+
+    //! \brief Compile a recognized operation inline.
+    //! \return True if compiled, false if the caller should treat it
+    //!         as a leaf.  Nothing is emitted if false.
+    bool compileFunction(Function const *fn, ValueType type, uint16_t &result);
+
+    uint16_t compileLiteral(Expression const *exp, ValueType type);
+    bool compileSlot(Expression const *exp, ValueType type, uint16_t &result);
+    uint16_t compileLeaf(Expression const *exp, ValueType type);
+    uint16_t addLeaf(Expression const *exp);
+    uint16_t newRegister();
+    size_t emit(uint8_t op, uint16_t dst, uint16_t a = 0, uint16_t b = 0);
+
+    std::vector<Instruction> m_code;
+    mutable std::vector<Register> m_registers;
+    std::vector<Slot> m_slots;
+    std::vector<Expression const *> m_leaves;
+    Expression const *m_source;
+    uint16_t m_result;
+  };
+
+  typedef std::unique_ptr<CompiledExpression> CompiledExpressionPtr;
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_COMPILED_EXPRESSION_HH
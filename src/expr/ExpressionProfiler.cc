@@ -0,0 +1,113 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExpressionProfiler.hh"
+
+#include "Listenable.hh"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace PLEXIL
+{
+
+  bool ExpressionProfiler::s_enabled = false;
+
+  namespace
+  {
+    using CounterMap =
+      std::unordered_map<Listenable const *, ExpressionProfiler::Counters>;
+
+    // Constructed on first use, so instrumented static destructors
+    // cannot outlive it.
+    CounterMap &counterMap()
+    {
+      static CounterMap sl_counters;
+      return sl_counters;
+    }
+  }
+
+  void ExpressionProfiler::setEnabled(bool enable)
+  {
+    s_enabled = enable;
+  }
+
+  void ExpressionProfiler::reset()
+  {
+    counterMap().clear();
+  }
+
+  void ExpressionProfiler::recordEvaluation(Listenable const *exp)
+  {
+    ++counterMap()[exp].evaluations;
+  }
+
+  void ExpressionProfiler::recordNotification(Listenable const *exp, size_t fanOut)
+  {
+    Counters &ctrs = counterMap()[exp];
+    ++ctrs.notifications;
+    ctrs.listenersNotified += fanOut;
+  }
+
+  ExpressionProfiler::Counters
+  ExpressionProfiler::getCounters(Listenable const *exp)
+  {
+    CounterMap const &counters = counterMap();
+    CounterMap::const_iterator it = counters.find(exp);
+    if (it == counters.end())
+      return Counters {0, 0, 0};
+    return it->second;
+  }
+
+  ExpressionProfiler::Counters
+  ExpressionProfiler::getTotalCounters(Listenable const *exp)
+  {
+    // doSubexprs() is not a const member function, but nothing here
+    // modifies the expressions.
+    Counters result {0, 0, 0};
+    std::unordered_set<Listenable const *> visited;
+    ListenableUnaryOperator accumulate =
+      [&result, &visited, &accumulate](Listenable *l) -> void {
+        if (!visited.insert(l).second)
+          return;
+        Counters ctrs = getCounters(l);
+        result.evaluations += ctrs.evaluations;
+        result.notifications += ctrs.notifications;
+        result.listenersNotified += ctrs.listenersNotified;
+        l->doSubexprs(accumulate);
+      };
+    accumulate(const_cast<Listenable *>(exp));
+    return result;
+  }
+
+  void ExpressionProfiler::forget(Listenable const *exp)
+  {
+    CounterMap &counters = counterMap();
+    if (!counters.empty())
+      counters.erase(exp);
+  }
+
+} // namespace PLEXIL
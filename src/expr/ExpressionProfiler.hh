@@ -0,0 +1,126 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_EXPRESSION_PROFILER_HH
+#define PLEXIL_EXPRESSION_PROFILER_HH
+
+#include <cstddef> // size_t
+#include <cstdint>
+
+namespace PLEXIL
+{
+  class Listenable;
+
+  //! \class ExpressionProfiler
+  //! \brief Runtime counters of expression evaluation and change
+  //!        notification, kept per expression instance.
+  //!
+  //! When enabled, function and lookup getValue() calls, and change
+  //! notifications published by Notifier instances, are counted
+  //! against the expression responsible.  When disabled, the only
+  //! cost is a test of a static flag at each instrumented site.
+  //!
+  //! \note The counters are not synchronized.  Only the Exec thread
+  //!       may evaluate expressions while profiling is enabled.
+  //! \ingroup Expressions
+  class ExpressionProfiler final
+  {
+  public:
+
+    //! \brief Counters for one expression.
+    struct Counters
+    {
+      uint64_t evaluations;       //!< Calls to getValue() and friends.
+      uint64_t notifications;     //!< Calls to publishChange() while active.
+      uint64_t listenersNotified; //!< Total notifyChanged() fan-out.
+    };
+
+    //! \brief Query whether profiling is enabled.
+    //! \return True if enabled, false if not.
+    static bool isEnabled()
+    {
+      return s_enabled;
+    }
+
+    //! \brief Enable or disable profiling.
+    //! \param enable True to enable, false to disable.
+    //! \note Disabling does not discard the counters collected so far.
+    static void setEnabled(bool enable);
+
+    //! \brief Discard all counters.
+    static void reset();
+
+    //! \brief Count one evaluation of the expression.
+    //! \param exp The expression.
+    static void recordEvaluation(Listenable const *exp);
+
+    //! \brief Count one change notification published by the expression.
+    //! \param exp The expression.
+    //! \param fanOut The number of listeners notified.
+    static void recordNotification(Listenable const *exp, size_t fanOut);
+
+    //! \brief Get the counters for one expression.
+    //! \param exp The expression.
+    //! \return The counters; all zero if nothing was recorded.
+    static Counters getCounters(Listenable const *exp);
+
+    //! \brief Sum the counters for an expression and all of its
+    //!        subexpressions.  Subexpressions shared within the tree
+    //!        are counted once.
+    //! \param exp The root expression.
+    //! \return The totals.
+    static Counters getTotalCounters(Listenable const *exp);
+
+    //! \brief Discard the counters for an expression being deleted,
+    //!        so a later expression allocated at the same address does
+    //!        not inherit them.
+    //! \param exp The expression.
+    //! \note Called by the Notifier destructor whether or not
+    //!       profiling is enabled.
+    static void forget(Listenable const *exp);
+
+  private:
+
+    // Not implemented
+    ExpressionProfiler() = delete;
+    ExpressionProfiler(ExpressionProfiler const &) = delete;
+    ExpressionProfiler(ExpressionProfiler &&) = delete;
+    ExpressionProfiler &operator=(ExpressionProfiler const &) = delete;
+    ExpressionProfiler &operator=(ExpressionProfiler &&) = delete;
+    ~ExpressionProfiler() = delete;
+
+    static bool s_enabled;
+  };
+
+} // namespace PLEXIL
+
+//! \brief Count an evaluation of the given expression, if profiling
+//!        is enabled.
+#define PROFILE_EXPRESSION_EVALUATION(_exp_) \
+  if (PLEXIL::ExpressionProfiler::isEnabled()) \
+    PLEXIL::ExpressionProfiler::recordEvaluation(_exp_)
+
+#endif // PLEXIL_EXPRESSION_PROFILER_HH
@@ -28,6 +28,7 @@
 
 #include "ArrayImpl.hh"
 #include "Error.hh"
+#include "ExpressionProfiler.hh"
 #include "Operator.hh"
 #include "PlanError.hh"
 #include "Value.hh"
@@ -78,6 +79,7 @@ namespace PLEXIL
 #define DEFINE_FUNC_DEFAULT_GET_VALUE_METHOD(_type) \
   bool Function::getValue(_type &result) const \
   { \
+    PROFILE_EXPRESSION_EVALUATION(this); \
     return (*m_op)(result, *this); \
   }
 
@@ -252,6 +254,7 @@ namespace PLEXIL
 #define DEFINE_FIXED_ARG_GET_VALUE_METHOD(_type) \
   virtual bool getValue(_type &result) const override \
   { \
+    PROFILE_EXPRESSION_EVALUATION(this); \
     return (*m_op)(result, *this); \
   }
 
@@ -329,6 +332,7 @@ namespace PLEXIL
 #define DEFINE_ONE_ARG_GET_VALUE_METHOD(_type) \
   template <> bool FixedSizeFunction<1>::getValue(_type &result) const \
   { \
+    PROFILE_EXPRESSION_EVALUATION(this); \
     return (*m_op)(result, exprs[0]); \
   }
 
@@ -400,6 +404,7 @@ namespace PLEXIL
 #define DEFINE_TWO_ARG_GET_VALUE_METHOD(_type) \
   template <> bool FixedSizeFunction<2>::getValue(_type &result) const  \
   { \
+    PROFILE_EXPRESSION_EVALUATION(this); \
     return (*m_op)(result, exprs[0], exprs[1]); \
   }
 
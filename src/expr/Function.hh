@@ -111,6 +111,13 @@ namespace PLEXIL
     virtual bool getValuePointer(RealArray const *&ptr) const override;
     virtual bool getValuePointer(StringArray const *&ptr) const override;
 
+    //! \brief Get the operator of this Function.
+    //! \return Const pointer to the Operator.
+    Operator const *getOperator() const
+    {
+      return m_op;
+    }
+
     // Delegated to implementation classes
 
     // Argument accessors
@@ -27,6 +27,7 @@
 #include "Notifier.hh"
 
 #include "Error.hh"
+#include "ExpressionProfiler.hh"
 
 #include <algorithm> // for std::find()
 
@@ -74,6 +75,8 @@ namespace PLEXIL
     assertTrue_2(m_outgoingListeners.empty(),
                  "Error: Expression still has outgoing listeners.");
 
+    ExpressionProfiler::forget(this);
+
 #ifdef RECORD_EXPRESSION_STATS
     // Delete this from instance list
     if (m_prev)
@@ -179,11 +182,14 @@ namespace PLEXIL
  
   void Notifier::publishChange()
   {
-    if (isActive())
-      for (std::vector<ExpressionListener *>::iterator it = m_outgoingListeners.begin();
-           it != m_outgoingListeners.end();
-           ++it)
-        (*it)->notifyChanged();
+    if (!isActive())
+      return;
+    if (ExpressionProfiler::isEnabled())
+      ExpressionProfiler::recordNotification(this, m_outgoingListeners.size());
+    for (std::vector<ExpressionListener *>::iterator it = m_outgoingListeners.begin();
+         it != m_outgoingListeners.end();
+         ++it)
+      (*it)->notifyChanged();
   }
 
 #ifdef RECORD_EXPRESSION_STATS
@@ -200,6 +200,13 @@ namespace PLEXIL
     return m_known;
   }
 
+  template <typename T>
+  void UserVariable<T>::getStorage(T const *&valuePtr, bool const *&knownPtr) const
+  {
+    valuePtr = &m_value;
+    knownPtr = &m_known;
+  }
+
   bool UserVariable<String>::getValue(String &result) const
   {
     if (!this->isActive())
@@ -130,6 +130,17 @@ namespace PLEXIL
     //! \param val Const reference to the expression providing the new value for this object.
     virtual void setValue(Expression const &val);
 
+    //
+    // Compiled expression support
+    //
+
+    //! \brief Get the addresses of the current value and known flag.
+    //! \param valuePtr Reference to a pointer to receive the value's address.
+    //! \param knownPtr Reference to a pointer to receive the known flag's address.
+    //! \note The caller must check that the variable is active before
+    //!       reading through these pointers.
+    void getStorage(T const *&valuePtr, bool const *&knownPtr) const;
+
   protected:
 
     //
@@ -0,0 +1,248 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ArithmeticOperators.hh"
+#include "BooleanOperators.hh"
+#include "Comparisons.hh"
+#include "CompiledExpression.hh"
+#include "Constant.hh"
+#include "Function.hh"
+#include "TestSupport.hh"
+#include "UserVariable.hh"
+#include "Value.hh"
+
+#include <vector>
+
+using namespace PLEXIL;
+
+//
+// Each test builds expression trees over a few variables, compiles
+// them, and checks that the compiled result agrees with the tree for
+// every combination of variable values, known and unknown.
+//
+
+class Trees
+{
+public:
+  Trees() = default;
+
+  ~Trees()
+  {
+    for (std::vector<Function *>::reverse_iterator it = m_functions.rbegin();
+         it != m_functions.rend();
+         ++it)
+      delete *it;
+  }
+
+  Function *make(Operator const *op, std::vector<Expression *> const &args)
+  {
+    Function *result = makeFunction(op, args.size());
+    for (size_t i = 0; i < args.size(); ++i)
+      result->setArgument(i, args[i], false);
+    m_functions.push_back(result);
+    return result;
+  }
+
+  void addRoot(Function *root)
+  {
+    CompiledExpression *compiled = CompiledExpression::compile(root);
+    assertTrue_2(compiled, "Expression was not compiled");
+    root->activate();
+    m_roots.push_back(root);
+    m_compiled.push_back(CompiledExpressionPtr(compiled));
+  }
+
+  bool agree() const
+  {
+    for (size_t i = 0; i < m_roots.size(); ++i) {
+      Boolean treeValue = false, compiledValue = false;
+      bool treeKnown = m_roots[i]->getValue(treeValue);
+      bool compiledKnown = m_compiled[i]->getValue(compiledValue);
+      if (treeKnown != compiledKnown
+          || (treeKnown && treeValue != compiledValue)) {
+        std::cout << "Mismatch for " << *m_roots[i]
+                  << ": tree " << (treeKnown ? (treeValue ? "true" : "false") : "unknown")
+                  << ", compiled " << (compiledKnown ? (compiledValue ? "true" : "false") : "unknown")
+                  << std::endl;
+        m_compiled[i]->print(std::cout);
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  std::vector<Function *> m_functions;
+  std::vector<Function *> m_roots;
+  std::vector<CompiledExpressionPtr> m_compiled;
+};
+
+static void setBoolean(BooleanVariable &var, int state)
+{
+  if (state == 2)
+    var.setUnknown();
+  else
+    var.setValue(Value((Boolean) state));
+}
+
+static bool testBooleanLogic()
+{
+  BooleanVariable a, b, c;
+  BooleanConstant troo(true);
+  Trees t;
+
+  Operator const *andOp = BooleanAnd::instance();
+  Operator const *orOp = BooleanOr::instance();
+  Operator const *notOp = BooleanNot::instance();
+
+  t.addRoot(t.make(andOp, {&a, &b}));
+  t.addRoot(t.make(orOp, {&a, &b}));
+  t.addRoot(t.make(andOp, {&a, &b, &c}));
+  t.addRoot(t.make(orOp, {&a, &b, &c}));
+  t.addRoot(t.make(notOp, {&a}));
+  t.addRoot(t.make(notOp, {t.make(orOp, {&a, t.make(andOp, {&b, &c})})}));
+  t.addRoot(t.make(andOp, {t.make(orOp, {&a, &b, &c}), &troo, t.make(notOp, {&c})}));
+  t.addRoot(t.make(IsKnown::instance(), {&a}));
+  t.addRoot(t.make(Equal::instance(), {&a, &b}));
+  t.addRoot(t.make(NotEqual::instance(), {&a, t.make(andOp, {&b, &c})}));
+
+  for (int i = 0; i < 3; ++i) {
+    setBoolean(a, i);
+    for (int j = 0; j < 3; ++j) {
+      setBoolean(b, j);
+      for (int k = 0; k < 3; ++k) {
+        setBoolean(c, k);
+        assertTrue_1(t.agree());
+      }
+    }
+  }
+  return true;
+}
+
+static bool testArithmetic()
+{
+  IntegerVariable i, j;
+  RealVariable r;
+  BooleanVariable a;
+  IntegerConstant zero(0), two(2), unknownInt;
+  RealConstant twoPointFive(2.5);
+  Trees t;
+
+  t.addRoot(t.make(GreaterThan<Integer>::instance(),
+                   {t.make(Addition<Integer>::instance(), {&i, &j}), &two}));
+  t.addRoot(t.make(LessThan<Real>::instance(),
+                   {t.make(Division<Real>::instance(), {&r, &i}), &twoPointFive}));
+  t.addRoot(t.make(Equal::instance(),
+                   {t.make(Subtraction<Integer>::instance(), {&i}), &j}));
+  t.addRoot(t.make(Equal::instance(), {&i, &r}));
+  t.addRoot(t.make(NotEqual::instance(), {&r, &zero}));
+  t.addRoot(t.make(GreaterEqual<Integer>::instance(),
+                   {t.make(Division<Integer>::instance(), {&i, &j}),
+                    t.make(Multiplication<Integer>::instance(), {&i, &j, &two})}));
+  t.addRoot(t.make(LessEqual<Integer>::instance(),
+                   {t.make(Subtraction<Integer>::instance(), {&i, &j, &two}), &unknownInt}));
+  t.addRoot(t.make(BooleanOr::instance(),
+                   {t.make(BooleanAnd::instance(),
+                           {t.make(GreaterThan<Integer>::instance(), {&i, &zero}),
+                            t.make(BooleanNot::instance(), {&a})}),
+                    t.make(LessEqual<Real>::instance(),
+                           {t.make(Multiplication<Real>::instance(), {&r, &i}), &twoPointFive})}));
+  t.addRoot(t.make(GreaterThan<Real>::instance(),
+                   {t.make(Addition<Real>::instance(),
+                           {&r, t.make(Addition<Integer>::instance(), {&i, &two})}),
+                    &j}));
+
+  Integer const ints[] = {-2, 0, 3};
+  Real const reals[] = {-1.5, 0, 2.5};
+  for (int ii = 0; ii < 4; ++ii) {
+    if (ii == 3)
+      i.setUnknown();
+    else
+      i.setValue(Value(ints[ii]));
+    for (int jj = 0; jj < 4; ++jj) {
+      if (jj == 3)
+        j.setUnknown();
+      else
+        j.setValue(Value(ints[jj]));
+      for (int rr = 0; rr < 4; ++rr) {
+        if (rr == 3)
+          r.setUnknown();
+        else
+          r.setValue(Value(reals[rr]));
+        for (int aa = 0; aa < 3; ++aa) {
+          setBoolean(a, aa);
+          assertTrue_1(t.agree());
+        }
+      }
+    }
+  }
+  return true;
+}
+
+static bool testCompileAndActivation()
+{
+  BooleanVariable a, b;
+  BooleanConstant troo(true);
+
+  // Not worth compiling
+  assertTrue_1(!CompiledExpression::compile(&a));
+  assertTrue_1(!CompiledExpression::compile(&troo));
+
+  Function *andFn = makeFunction(BooleanAnd::instance(), &a, &b, false, false);
+  CompiledExpressionPtr compiled(CompiledExpression::compile(andFn));
+  assertTrue_1(compiled);
+  assertTrue_1(compiled->source() == andFn);
+
+  // Inactive: both unknown
+  Boolean temp;
+  assertTrue_1(!andFn->getValue(temp));
+  assertTrue_1(!compiled->getValue(temp));
+
+  andFn->activate();
+  a.setValue(Value(true));
+  b.setValue(Value(true));
+  assertTrue_1(compiled->getValue(temp));
+  assertTrue_1(temp);
+  b.setValue(Value(false));
+  assertTrue_1(compiled->getValue(temp));
+  assertTrue_1(!temp);
+
+  andFn->deactivate();
+  assertTrue_1(!compiled->getValue(temp));
+
+  compiled.reset();
+  delete andFn;
+  return true;
+}
+
+bool compiledExpressionTest()
+{
+  runTest(testBooleanLogic);
+  runTest(testArithmetic);
+  runTest(testCompileAndActivation);
+
+  return true;
+}
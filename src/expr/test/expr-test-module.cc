@@ -45,8 +45,10 @@ extern bool arrayReferenceTest();
 extern bool arrayVariableTest();
 extern bool booleanOperatorsTest();
 extern bool comparisonsTest();
+extern bool compiledExpressionTest();
 extern bool conversionsTest();
 extern bool constantsTest();
+extern bool expressionProfilerTest();
 extern bool functionsTest();
 extern bool listenerTest();
 extern bool simpleBooleanVariableTest();
@@ -72,6 +74,8 @@ static void runExprTests()
   runTestSuite(conversionsTest)
   runTestSuite(stringTest);
   runTestSuite(arrayOperatorsTest);
+  runTestSuite(compiledExpressionTest);
+  runTestSuite(expressionProfilerTest);
 
   std::cout << "Finished" << std::endl;
 }
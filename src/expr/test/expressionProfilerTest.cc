@@ -0,0 +1,145 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "BooleanOperators.hh"
+#include "ExpressionProfiler.hh"
+#include "Function.hh"
+#include "TestSupport.hh"
+#include "TrivialListener.hh"
+#include "UserVariable.hh"
+#include "Value.hh"
+
+using namespace PLEXIL;
+
+static bool testDisabled()
+{
+  ExpressionProfiler::reset();
+  assertTrue_1(!ExpressionProfiler::isEnabled());
+
+  BooleanVariable a, b;
+  Function *andFn = makeFunction(BooleanAnd::instance(), 2);
+  andFn->setArgument(0, &a, false);
+  andFn->setArgument(1, &b, false);
+  andFn->activate();
+
+  Boolean temp;
+  andFn->getValue(temp);
+  a.setValue(Value(true));
+
+  ExpressionProfiler::Counters ctrs = ExpressionProfiler::getTotalCounters(andFn);
+  assertTrue_1(ctrs.evaluations == 0);
+  assertTrue_1(ctrs.notifications == 0);
+
+  andFn->deactivate();
+  delete andFn;
+  return true;
+}
+
+static bool testCounting()
+{
+  ExpressionProfiler::reset();
+  ExpressionProfiler::setEnabled(true);
+
+  BooleanVariable a, b;
+  Function *notFn = makeFunction(BooleanNot::instance(), 1);
+  notFn->setArgument(0, &a, false);
+  Function *andFn = makeFunction(BooleanAnd::instance(), 2);
+  andFn->setArgument(0, notFn, false);
+  andFn->setArgument(1, &b, false);
+
+  bool changed = false;
+  TrivialListener l1(changed), l2(changed);
+  andFn->addListener(&l1);
+  andFn->addListener(&l2);
+  andFn->activate();
+
+  Boolean temp;
+  andFn->getValue(temp);
+  andFn->getValue(temp);
+  ExpressionProfiler::Counters ctrs = ExpressionProfiler::getCounters(andFn);
+  assertTrue_1(ctrs.evaluations == 2);
+  // Evaluating AND evaluates its NOT operand (a is unknown)
+  assertTrue_1(ExpressionProfiler::getCounters(notFn).evaluations == 2);
+
+  // A change to a reaches AND directly, and AND notifies both listeners
+  a.setValue(Value(false));
+  assertTrue_1(changed);
+  ctrs = ExpressionProfiler::getCounters(andFn);
+  assertTrue_1(ctrs.notifications == 1);
+  assertTrue_1(ctrs.listenersNotified == 2);
+
+  ExpressionProfiler::Counters total = ExpressionProfiler::getTotalCounters(andFn);
+  assertTrue_1(total.evaluations == 4);
+  assertTrue_1(total.notifications == 2); // a and AND
+  assertTrue_1(total.listenersNotified == 3);
+
+  // Counters stop when disabled, but are kept until reset
+  ExpressionProfiler::setEnabled(false);
+  andFn->getValue(temp);
+  assertTrue_1(ExpressionProfiler::getCounters(andFn).evaluations == 2);
+  ExpressionProfiler::reset();
+  assertTrue_1(ExpressionProfiler::getCounters(andFn).evaluations == 0);
+
+  andFn->deactivate();
+  andFn->removeListener(&l1);
+  andFn->removeListener(&l2);
+  delete andFn;
+  delete notFn;
+  return true;
+}
+
+static bool testForget()
+{
+  ExpressionProfiler::reset();
+  ExpressionProfiler::setEnabled(true);
+
+  BooleanVariable a;
+  Function *notFn = makeFunction(BooleanNot::instance(), 1);
+  notFn->setArgument(0, &a, false);
+  notFn->activate();
+  Boolean temp;
+  notFn->getValue(temp);
+  Listenable const *addr = notFn;
+  assertTrue_1(ExpressionProfiler::getCounters(addr).evaluations == 1);
+
+  // Deleting the expression discards its counters
+  notFn->deactivate();
+  delete notFn;
+  assertTrue_1(ExpressionProfiler::getCounters(addr).evaluations == 0);
+
+  ExpressionProfiler::setEnabled(false);
+  ExpressionProfiler::reset();
+  return true;
+}
+
+bool expressionProfilerTest()
+{
+  runTest(testDisabled);
+  runTest(testCounting);
+  runTest(testForget);
+
+  return true;
+}
@@ -0,0 +1,139 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_FLIGHT_RECORD_HH
+#define PLEXIL_FLIGHT_RECORD_HH
+
+//
+// Binary format shared by the FlightRecorder listener and the
+// flightRecorderQuery tool.
+//
+// A recording is a ring of fixed-size segment files named
+// <prefix>-<n>.flr, n = 0 .. count-1.  Each segment begins with a
+// FlightSegmentHeader, followed by a packed sequence of records.
+// All fields are in host byte order; the byte order marker in the
+// segment header lets a reader detect a foreign recording.
+//
+// Every record starts with a FlightRecordHeader, and is padded to a
+// multiple of 8 bytes.  Node and variable names are interned: a name
+// record is written the first time a name is used in each segment,
+// so every segment can be decoded independently of the others.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PLEXIL
+{
+  namespace FlightRecord
+  {
+    //! Magic number identifying a segment file.
+    constexpr char const MAGIC[8] = {'P', 'X', 'F', 'L', 'T', 'R', 'E', 'C'};
+
+    //! Format version.
+    constexpr uint32_t VERSION = 1;
+
+    //! Byte order marker, as written by the recording host.
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    //! File name suffix for segment files.
+    constexpr char const *SEGMENT_SUFFIX = ".flr";
+
+    //! Record types.
+    enum RecordType : uint16_t
+      {
+       NAME_RECORD = 1,       //!< Interned name
+       TRANSITION_RECORD = 2, //!< Node state transition
+       ASSIGNMENT_RECORD = 3  //!< Variable assignment
+      };
+
+    //! Header at the start of every segment file.
+    struct SegmentHeader
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t byteOrder;
+      uint64_t sequence;  //!< Increases by one with each new segment
+      uint64_t capacity;  //!< Total size of the segment file in bytes
+      uint64_t used;      //!< Bytes written, including this header
+      double startTime;   //!< Exec time at which the segment was opened
+      char pad[16];
+    };
+    static_assert(sizeof(SegmentHeader) == 64, "SegmentHeader size changed");
+
+    //! Header at the start of every record.
+    struct RecordHeader
+    {
+      uint32_t length;    //!< Total length of record, including padding
+      uint16_t type;      //!< A RecordType
+      uint16_t reserved;
+    };
+    static_assert(sizeof(RecordHeader) == 8, "RecordHeader size changed");
+
+    //! Interned name; followed by nameLength bytes of name, unterminated.
+    struct NameRecord
+    {
+      RecordHeader header;
+      uint32_t id;
+      uint32_t nameLength;
+    };
+    static_assert(sizeof(NameRecord) == 16, "NameRecord size changed");
+
+    //! Node state transition.
+    struct TransitionRecord
+    {
+      RecordHeader header;
+      uint32_t nodeId;    //!< Interned node ID
+      uint8_t oldState;   //!< NodeState
+      uint8_t newState;   //!< NodeState
+      uint8_t outcome;    //!< NodeOutcome
+      uint8_t failure;    //!< FailureType
+      double time;
+    };
+    static_assert(sizeof(TransitionRecord) == 24, "TransitionRecord size changed");
+
+    //! Variable assignment; followed by valueLength bytes of the
+    //! value in PLEXIL::Value serial format.
+    struct AssignmentRecord
+    {
+      RecordHeader header;
+      uint32_t nameId;    //!< Interned destination name
+      uint32_t valueLength;
+      double time;
+    };
+    static_assert(sizeof(AssignmentRecord) == 24, "AssignmentRecord size changed");
+
+    //! Round a record length up to the record alignment.
+    constexpr size_t paddedLength(size_t len)
+    {
+      return (len + 7) & ~((size_t) 7);
+    }
+
+  } // namespace FlightRecord
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_FLIGHT_RECORD_HH
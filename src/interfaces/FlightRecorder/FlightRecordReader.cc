@@ -0,0 +1,237 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "FlightRecordReader.hh"
+
+#include "Value.hh"
+
+#include <algorithm>
+#include <fstream>
+
+#include <cstring>
+
+namespace PLEXIL
+{
+  namespace FlightRecord
+  {
+
+    bool readSegment(std::string const &path, Segment &seg, std::string &error)
+    {
+      std::ifstream in(path, std::ios::binary);
+      if (!in) {
+        error = "unable to open " + path;
+        return false;
+      }
+      if (!in.read(reinterpret_cast<char *>(&seg.header), sizeof(seg.header))
+          || memcmp(seg.header.magic, MAGIC, sizeof(seg.header.magic))) {
+        error = path + " is not a flight recorder segment";
+        return false;
+      }
+      if (seg.header.byteOrder != BYTE_ORDER_MARK
+          || seg.header.version != VERSION) {
+        error = path + " was recorded on an incompatible host or version";
+        return false;
+      }
+      size_t used = std::min(seg.header.used, seg.header.capacity);
+      if (used < sizeof(seg.header)) {
+        error = path + " has an invalid header";
+        return false;
+      }
+      seg.data.resize(used - sizeof(seg.header));
+      in.read(seg.data.data(), seg.data.size());
+      seg.data.resize(in.gcount());
+      seg.path = path;
+      return true;
+    }
+
+    // Read the 3 byte big-endian size used by strings and arrays.
+    static size_t serialSize24(char const *buf)
+    {
+      return (((size_t) (unsigned char) buf[0]) << 16)
+        | (((size_t) (unsigned char) buf[1]) << 8)
+        | ((size_t) (unsigned char) buf[2]);
+    }
+
+    //
+    // Mirrors the serial formats in ValueType.cc and ArrayImpl.cc.
+    //
+    size_t serialValueLength(char const *buf, size_t avail)
+    {
+      if (!avail)
+        return 0;
+      size_t len = 0;
+      switch ((ValueType) *buf) {
+      case UNKNOWN_TYPE:
+        len = 1;
+        break;
+
+      case BOOLEAN_TYPE:
+      case COMMAND_HANDLE_TYPE:
+        len = 2;
+        break;
+
+      case INTEGER_TYPE:
+        len = 5;
+        break;
+
+      case REAL_TYPE:
+        len = 9;
+        break;
+
+      case STRING_TYPE:
+        if (avail < 4)
+          return 0;
+        len = 4 + serialSize24(buf + 1);
+        break;
+
+      case BOOLEAN_ARRAY_TYPE:
+      case INTEGER_ARRAY_TYPE:
+      case REAL_ARRAY_TYPE:
+      case STRING_ARRAY_TYPE: {
+        if (avail < 4)
+          return 0;
+        size_t const n = serialSize24(buf + 1);
+        size_t const maskBytes = (n + 7) / 8;
+        len = 4 + maskBytes;
+        switch ((ValueType) *buf) {
+        case BOOLEAN_ARRAY_TYPE:
+          len += maskBytes;
+          break;
+
+        case INTEGER_ARRAY_TYPE:
+          len += 4 * n;
+          break;
+
+        case REAL_ARRAY_TYPE:
+          len += 8 * n;
+          break;
+
+        default: // STRING_ARRAY_TYPE
+          for (size_t i = 0; i < n; ++i) {
+            if (len + 3 > avail)
+              return 0;
+            len += 3 + serialSize24(buf + len);
+          }
+          break;
+        }
+        break;
+      }
+
+      default: // not a serializable type
+        return 0;
+      }
+      return len <= avail ? len : 0;
+    }
+
+    static std::string const &nameOf(std::vector<std::string> const &names, uint32_t id)
+    {
+      static std::string const sl_unknown("<unknown>");
+      return id < names.size() ? names[id] : sl_unknown;
+    }
+
+    bool scanSegment(Segment const &seg, RecordVisitor &visitor, std::string &error)
+    {
+      std::vector<std::string> names;
+      char const *const start = seg.data.data();
+      size_t const size = seg.data.size();
+      size_t offset = 0;
+      while (size - offset >= sizeof(RecordHeader)) {
+        char const *ptr = start + offset;
+        RecordHeader hdr;
+        memcpy(&hdr, ptr, sizeof(hdr));
+        bool valid = hdr.length >= sizeof(hdr) && hdr.length <= size - offset;
+        if (valid) {
+          switch (hdr.type) {
+          case NAME_RECORD: {
+            NameRecord rec;
+            valid = hdr.length >= sizeof(rec);
+            if (!valid)
+              break;
+            memcpy(&rec, ptr, sizeof(rec));
+            valid = rec.nameLength <= hdr.length - sizeof(rec);
+            if (!valid)
+              break;
+            if (names.size() <= rec.id)
+              names.resize(rec.id + 1);
+            names[rec.id].assign(ptr + sizeof(rec), rec.nameLength);
+            break;
+          }
+
+          case TRANSITION_RECORD: {
+            TransitionRecord rec;
+            valid = hdr.length >= sizeof(rec);
+            if (!valid)
+              break;
+            memcpy(&rec, ptr, sizeof(rec));
+            visitor.transition(rec, nameOf(names, rec.nodeId));
+            break;
+          }
+
+          case ASSIGNMENT_RECORD: {
+            AssignmentRecord rec;
+            valid = hdr.length >= sizeof(rec);
+            if (!valid)
+              break;
+            memcpy(&rec, ptr, sizeof(rec));
+            valid = rec.valueLength <= hdr.length - sizeof(rec);
+            if (!valid)
+              break;
+            std::string const &name = nameOf(names, rec.nameId);
+            if (!visitor.wantAssignment(rec, name))
+              break;
+            // Value::deserialize() trusts the sizes embedded in the
+            // value, so check them against the record first
+            char const *valuePtr = ptr + sizeof(rec);
+            valid = rec.valueLength
+              && serialValueLength(valuePtr, rec.valueLength) == rec.valueLength;
+            if (!valid)
+              break;
+            Value value;
+            valid = value.deserialize(valuePtr) == valuePtr + rec.valueLength;
+            if (!valid)
+              break;
+            visitor.assignment(rec, name, value);
+            break;
+          }
+
+          default:
+            // Skip unknown record types
+            break;
+          }
+        }
+        if (!valid) {
+          error = seg.path + ": malformed record at offset "
+            + std::to_string(offset + sizeof(seg.header));
+          return false;
+        }
+        offset += hdr.length;
+      }
+      return true;
+    }
+
+  } // namespace FlightRecord
+
+} // namespace PLEXIL
@@ -0,0 +1,100 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_FLIGHT_RECORD_READER_HH
+#define PLEXIL_FLIGHT_RECORD_READER_HH
+
+#include "FlightRecord.hh"
+
+#include <string>
+#include <vector>
+
+namespace PLEXIL
+{
+  // Forward reference
+  class Value;
+
+  namespace FlightRecord
+  {
+    //! One segment file, read into memory.
+    struct Segment
+    {
+      SegmentHeader header;
+      std::vector<char> data; //!< Records following the header
+      std::string path;
+    };
+
+    //! Read a segment file.
+    //! @param path The file name.
+    //! @param seg The segment to fill in.
+    //! @param error Set to a description of the problem on failure.
+    //! @return true if successful, false otherwise.
+    bool readSegment(std::string const &path, Segment &seg, std::string &error);
+
+    //! @class RecordVisitor
+    //! Receives the records decoded by scanSegment().
+    class RecordVisitor
+    {
+    public:
+      virtual ~RecordVisitor() = default;
+
+      virtual void transition(TransitionRecord const &rec,
+                              std::string const &name) = 0;
+
+      //! @return true if the value of this assignment is wanted.
+      //! @note Lets a caller skip decoding values it won't report.
+      virtual bool wantAssignment(AssignmentRecord const & /* rec */,
+                                  std::string const & /* name */)
+      {
+        return true;
+      }
+
+      virtual void assignment(AssignmentRecord const &rec,
+                              std::string const &name,
+                              Value const &value) = 0;
+    };
+
+    //! Decode the records of one segment, passing each to the visitor.
+    //! Every record, and every value, is checked against its stated
+    //! length and the end of the segment before it is decoded.
+    //! @param seg The segment.
+    //! @param visitor The visitor.
+    //! @param error Set to a description of the first malformed record.
+    //! @return true if the segment was well formed, false otherwise.
+    bool scanSegment(Segment const &seg, RecordVisitor &visitor, std::string &error);
+
+    //! Find the length of a value in PLEXIL::Value serial format,
+    //! reading no more than the given number of bytes.
+    //! @param buf Start of the serialized value.
+    //! @param avail Number of bytes available.
+    //! @return The length; 0 if the value is malformed or doesn't fit.
+    size_t serialValueLength(char const *buf, size_t avail);
+
+  } // namespace FlightRecord
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_FLIGHT_RECORD_READER_HH
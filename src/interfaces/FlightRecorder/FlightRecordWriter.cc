@@ -0,0 +1,322 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "FlightRecordWriter.hh"
+#include "FlightRecord.hh"
+
+#include "Debug.hh"
+#include "Error.hh"
+#include "Node.hh"
+#include "StateCache.hh"
+#include "Value.hh"
+
+#include <cerrno>
+#include <cstring> // memcpy(), strerror()
+
+#include <fcntl.h>     // open()
+#include <sys/mman.h>  // mmap(), munmap()
+#include <unistd.h>    // close(), ftruncate(), pread()
+
+namespace PLEXIL
+{
+
+  //! Segment sequence value for a name not yet written to any segment.
+  static constexpr uint64_t NOT_WRITTEN = ~((uint64_t) 0);
+
+  //! Smallest usable segment size.
+  static constexpr size_t MIN_SEGMENT_SIZE = 4096;
+
+  constexpr size_t FlightRecordWriter::MAX_CACHED_NODES;
+
+  FlightRecordWriter::FlightRecordWriter(std::string const &directory,
+                                         std::string const &prefix,
+                                         size_t segmentSize,
+                                         unsigned int segmentCount)
+    : m_nodeCache(),
+      m_planNodes(),
+      m_nameIds(),
+      m_names(),
+      m_nameSequence(),
+      m_directory(directory),
+      m_prefix(prefix),
+      m_sequence(0),
+      m_capacity(segmentSize),
+      m_used(0),
+      m_segment(nullptr),
+      m_fd(-1),
+      m_segmentCount(segmentCount)
+  {
+  }
+
+  FlightRecordWriter::~FlightRecordWriter()
+  {
+    close();
+  }
+
+  bool FlightRecordWriter::open()
+  {
+    if (m_segment)
+      return true;
+    if (m_capacity < MIN_SEGMENT_SIZE) {
+      warn("FlightRecorder: segment size " << m_capacity
+           << " too small, using " << MIN_SEGMENT_SIZE);
+      m_capacity = MIN_SEGMENT_SIZE;
+    }
+    if (!m_segmentCount) {
+      warn("FlightRecorder: segment count must be positive, using 1");
+      m_segmentCount = 1;
+    }
+    m_sequence = nextSequence();
+    return openSegment();
+  }
+
+  void FlightRecordWriter::close()
+  {
+    if (!m_segment)
+      return;
+    debugMsg("FlightRecorder:close",
+             " closing segment " << m_sequence << ", " << m_used << " bytes used");
+    munmap(m_segment, m_capacity);
+    m_segment = nullptr;
+    ::close(m_fd);
+    m_fd = -1;
+  }
+
+  void FlightRecordWriter::recordTransition(Node const *node,
+                                            NodeState oldState,
+                                            NodeState newState,
+                                            double time)
+  {
+    uint32_t id = nodeNameId(node);
+    char *rec = reserve(sizeof(FlightRecord::TransitionRecord), id);
+    if (!rec)
+      return;
+    FlightRecord::TransitionRecord *trec =
+      reinterpret_cast<FlightRecord::TransitionRecord *>(rec);
+    trec->header.length = sizeof(FlightRecord::TransitionRecord);
+    trec->header.type = FlightRecord::TRANSITION_RECORD;
+    trec->header.reserved = 0;
+    trec->nodeId = id;
+    trec->oldState = oldState;
+    trec->newState = newState;
+    trec->outcome = node->getOutcome();
+    trec->failure = node->getFailureType();
+    trec->time = time;
+    commit(sizeof(FlightRecord::TransitionRecord));
+  }
+
+  void FlightRecordWriter::recordAssignment(std::string const &destName,
+                                            Value const &value,
+                                            double time)
+  {
+    uint32_t id = nameId(destName);
+    size_t valueLen = value.serialSize();
+    size_t len =
+      FlightRecord::paddedLength(sizeof(FlightRecord::AssignmentRecord) + valueLen);
+    char *rec = reserve(len, id);
+    if (!rec)
+      return;
+    FlightRecord::AssignmentRecord *arec =
+      reinterpret_cast<FlightRecord::AssignmentRecord *>(rec);
+    if (!value.serialize(rec + sizeof(FlightRecord::AssignmentRecord))) {
+      debugMsg("FlightRecorder:recordAssignment",
+               " unable to serialize value for " << destName);
+      return;
+    }
+    arec->header.length = (uint32_t) len;
+    arec->header.type = FlightRecord::ASSIGNMENT_RECORD;
+    arec->header.reserved = 0;
+    arec->nameId = id;
+    arec->valueLength = (uint32_t) valueLen;
+    arec->time = time;
+    commit(len);
+  }
+
+  void FlightRecordWriter::forgetPlan(Node const *root)
+  {
+    std::unordered_map<Node const *, std::vector<Node const *> >::iterator it =
+      m_planNodes.find(root);
+    if (it == m_planNodes.end())
+      return;
+    for (Node const *node : it->second)
+      m_nodeCache.erase(node);
+    debugMsg("FlightRecorder:forgetPlan",
+             " dropped " << it->second.size() << " cached nodes of "
+             << root->getNodeId());
+    m_planNodes.erase(it);
+  }
+
+  std::string FlightRecordWriter::segmentPath(uint64_t sequence) const
+  {
+    return m_directory + '/' + m_prefix + '-'
+      + std::to_string(sequence % m_segmentCount) + FlightRecord::SEGMENT_SUFFIX;
+  }
+
+  //! Find the sequence number following the newest existing segment.
+  uint64_t FlightRecordWriter::nextSequence() const
+  {
+    uint64_t result = 0;
+    for (unsigned int i = 0; i < m_segmentCount; ++i) {
+      int fd = ::open(segmentPath(i).c_str(), O_RDONLY);
+      if (fd < 0)
+        continue;
+      FlightRecord::SegmentHeader hdr;
+      if (pread(fd, &hdr, sizeof(hdr), 0) == (ssize_t) sizeof(hdr)
+          && !memcmp(hdr.magic, FlightRecord::MAGIC, sizeof(hdr.magic))
+          && hdr.sequence >= result)
+        result = hdr.sequence + 1;
+      ::close(fd);
+    }
+    return result;
+  }
+
+  bool FlightRecordWriter::openSegment()
+  {
+    std::string path = segmentPath(m_sequence);
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+      warn("FlightRecorder: unable to open " << path << ": " << strerror(errno));
+      return false;
+    }
+    if (ftruncate(m_fd, (off_t) m_capacity)) {
+      warn("FlightRecorder: unable to size " << path << ": " << strerror(errno));
+      ::close(m_fd);
+      m_fd = -1;
+      return false;
+    }
+    void *seg = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (seg == MAP_FAILED) {
+      warn("FlightRecorder: unable to map " << path << ": " << strerror(errno));
+      ::close(m_fd);
+      m_fd = -1;
+      return false;
+    }
+    m_segment = static_cast<char *>(seg);
+
+    FlightRecord::SegmentHeader *hdr =
+      reinterpret_cast<FlightRecord::SegmentHeader *>(m_segment);
+    memcpy(hdr->magic, FlightRecord::MAGIC, sizeof(hdr->magic));
+    hdr->version = FlightRecord::VERSION;
+    hdr->byteOrder = FlightRecord::BYTE_ORDER_MARK;
+    hdr->sequence = m_sequence;
+    hdr->capacity = m_capacity;
+    hdr->startTime = StateCache::currentTime();
+    m_used = sizeof(FlightRecord::SegmentHeader);
+    hdr->used = m_used;
+    debugMsg("FlightRecorder:openSegment",
+             " opened " << path << ", sequence " << m_sequence);
+    return true;
+  }
+
+  //! Find or assign the ID for this name.
+  uint32_t FlightRecordWriter::nameId(std::string const &name)
+  {
+    std::unordered_map<std::string, uint32_t>::const_iterator it =
+      m_nameIds.find(name);
+    if (it != m_nameIds.end())
+      return it->second;
+    uint32_t id = (uint32_t) m_names.size();
+    m_nameIds.emplace(name, id);
+    m_names.push_back(name);
+    m_nameSequence.push_back(NOT_WRITTEN);
+    return id;
+  }
+
+  //! Find or assign the ID for this node's name.
+  //! @note Caches by address, but verifies the name in case the
+  //!       address has been reused by another node.
+  uint32_t FlightRecordWriter::nodeNameId(Node const *node)
+  {
+    std::string const &name = node->getNodeId();
+    std::unordered_map<Node const *, uint32_t>::iterator it =
+      m_nodeCache.find(node);
+    if (it != m_nodeCache.end()) {
+      if (m_names[it->second] != name)
+        it->second = nameId(name);
+      return it->second;
+    }
+
+    if (m_nodeCache.size() >= MAX_CACHED_NODES) {
+      debugMsg("FlightRecorder:nodeNameId",
+               " node cache full, clearing " << m_nodeCache.size() << " entries");
+      m_nodeCache.clear();
+      m_planNodes.clear();
+    }
+    uint32_t id = nameId(name);
+    m_nodeCache.emplace(node, id);
+    Node const *root = node;
+    while (root->getParent())
+      root = root->getParent();
+    m_planNodes[root].push_back(node);
+    return id;
+  }
+
+  //! Get a pointer to space for a record of the given length
+  //! referring to the given name, rotating segments if required.
+  //! Writes the name record first if the current segment lacks it.
+  //! @return Pointer to the space; nullptr if the record can't be written.
+  char *FlightRecordWriter::reserve(size_t len, uint32_t nameId)
+  {
+    if (!m_segment)
+      return nullptr;
+    std::string const &name = m_names[nameId];
+    size_t nameLen =
+      FlightRecord::paddedLength(sizeof(FlightRecord::NameRecord) + name.size());
+    if (m_used + nameLen + len > m_capacity) {
+      if (sizeof(FlightRecord::SegmentHeader) + nameLen + len > m_capacity) {
+        debugMsg("FlightRecorder:reserve",
+                 " record of " << len << " bytes too large for segment, discarded");
+        return nullptr;
+      }
+      close();
+      ++m_sequence;
+      if (!openSegment())
+        return nullptr;
+    }
+    if (m_nameSequence[nameId] != m_sequence) {
+      FlightRecord::NameRecord *nrec =
+        reinterpret_cast<FlightRecord::NameRecord *>(m_segment + m_used);
+      nrec->header.length = (uint32_t) nameLen;
+      nrec->header.type = FlightRecord::NAME_RECORD;
+      nrec->header.reserved = 0;
+      nrec->id = nameId;
+      nrec->nameLength = (uint32_t) name.size();
+      memcpy(m_segment + m_used + sizeof(FlightRecord::NameRecord),
+             name.data(), name.size());
+      m_nameSequence[nameId] = m_sequence;
+      commit(nameLen);
+    }
+    return m_segment + m_used;
+  }
+
+  //! Account for a record just written.
+  void FlightRecordWriter::commit(size_t len)
+  {
+    m_used += len;
+    reinterpret_cast<FlightRecord::SegmentHeader *>(m_segment)->used = m_used;
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,124 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_FLIGHT_RECORD_WRITER_HH
+#define PLEXIL_FLIGHT_RECORD_WRITER_HH
+
+#include "NodeConstants.hh"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cstdint>
+
+namespace PLEXIL
+{
+  // Forward references
+  class Node;
+  class Value;
+
+  //! @class FlightRecordWriter
+  //! Appends records to a rotating ring of memory-mapped segment files.
+  //! @see FlightRecord.hh for the format.
+  class FlightRecordWriter final
+  {
+  public:
+
+    //! Upper bound on the number of nodes whose name IDs are cached.
+    //! Reaching it empties the cache, in case some plan's nodes were
+    //! never released by forgetPlan().
+    static constexpr size_t MAX_CACHED_NODES = 65536;
+
+    FlightRecordWriter(std::string const &directory,
+                       std::string const &prefix,
+                       size_t segmentSize,
+                       unsigned int segmentCount);
+
+    ~FlightRecordWriter();
+
+    //! Open the first segment, continuing the sequence of any
+    //! existing recording with the same prefix.
+    //! @return true if successful, false otherwise.
+    bool open();
+
+    //! Unmap and close the current segment.
+    void close();
+
+    void recordTransition(Node const *node,
+                          NodeState oldState,
+                          NodeState newState,
+                          double time);
+
+    void recordAssignment(std::string const &destName,
+                          Value const &value,
+                          double time);
+
+    //! Drop the cached name IDs of every node of the plan with this
+    //! root.  Call when the plan finishes, before its nodes are deleted.
+    void forgetPlan(Node const *root);
+
+    //! @return The number of nodes whose name IDs are cached.
+    size_t cachedNodeCount() const
+    {
+      return m_nodeCache.size();
+    }
+
+  private:
+
+    // Not implemented
+    FlightRecordWriter() = delete;
+    FlightRecordWriter(FlightRecordWriter const &) = delete;
+    FlightRecordWriter(FlightRecordWriter &&) = delete;
+    FlightRecordWriter &operator=(FlightRecordWriter const &) = delete;
+    FlightRecordWriter &operator=(FlightRecordWriter &&) = delete;
+
+    std::string segmentPath(uint64_t sequence) const;
+    uint64_t nextSequence() const;
+    bool openSegment();
+    uint32_t nameId(std::string const &name);
+    uint32_t nodeNameId(Node const *node);
+    char *reserve(size_t len, uint32_t nameId);
+    void commit(size_t len);
+
+    std::unordered_map<Node const *, uint32_t> m_nodeCache;
+    std::unordered_map<Node const *, std::vector<Node const *> > m_planNodes; // cached nodes by root
+    std::unordered_map<std::string, uint32_t> m_nameIds;
+    std::vector<std::string> m_names;
+    std::vector<uint64_t> m_nameSequence; // segment in which name was last written
+    std::string m_directory;
+    std::string m_prefix;
+    uint64_t m_sequence;
+    size_t m_capacity;
+    size_t m_used;
+    char *m_segment;
+    int m_fd;
+    unsigned int m_segmentCount;
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_FLIGHT_RECORD_WRITER_HH
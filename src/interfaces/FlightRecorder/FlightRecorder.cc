@@ -0,0 +1,126 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "FlightRecorder.hh"
+#include "FlightRecordWriter.hh"
+
+#include "plexil-config.h"
+
+#include "ExecListener.hh"
+#include "ExecListenerFactory.hh"
+#include "Node.hh"
+#include "StateCache.hh"
+#include "Value.hh"
+
+#include "pugixml.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PLEXIL
+{
+
+  //! @class FlightRecorder
+  //! An ExecListener which records node transitions and variable
+  //! assignments to a compact binary ring buffer on disk.
+  //! @see flightRecorderQuery for reading the recording.
+  class FlightRecorder final : public ExecListener
+  {
+  public:
+
+    // Configuration XML attributes
+    static constexpr char const *DIRECTORY_ATTR = "Directory";
+    static constexpr char const *PREFIX_ATTR = "Prefix";
+    static constexpr char const *SEGMENT_SIZE_ATTR = "SegmentSize";
+    static constexpr char const *SEGMENT_COUNT_ATTR = "SegmentCount";
+
+    // Defaults
+    static constexpr unsigned int DEFAULT_SEGMENT_SIZE = 16 * 1024 * 1024;
+    static constexpr unsigned int DEFAULT_SEGMENT_COUNT = 8;
+
+    FlightRecorder(pugi::xml_node const xml)
+      : ExecListener(xml),
+        m_writer(new FlightRecordWriter(xml.attribute(DIRECTORY_ATTR).as_string("."),
+                                        xml.attribute(PREFIX_ATTR).as_string("flight"),
+                                        xml.attribute(SEGMENT_SIZE_ATTR).as_uint(DEFAULT_SEGMENT_SIZE),
+                                        xml.attribute(SEGMENT_COUNT_ATTR).as_uint(DEFAULT_SEGMENT_COUNT)))
+    {
+    }
+
+    virtual ~FlightRecorder() = default;
+
+    virtual bool start() override
+    {
+      return m_writer->open();
+    }
+
+    virtual void stop() override
+    {
+      m_writer->close();
+    }
+
+  protected:
+
+    virtual void
+    implementNotifyNodeTransitions(std::vector<NodeTransition> const &transitions) const override
+    {
+      double now = StateCache::currentTime();
+      for (NodeTransition const &trans : transitions) {
+        if (!m_filter || m_filter->reportNodeTransition(trans))
+          m_writer->recordTransition(trans.node, trans.oldState, trans.newState, now);
+        // The plan will be deleted; its node addresses may be reused
+        if (trans.newState == FINISHED_STATE && !trans.node->getParent())
+          m_writer->forgetPlan(trans.node);
+      }
+    }
+
+    virtual void implementNotifyAssignment(Expression const * /* dest */,
+                                           std::string const &destName,
+                                           Value const &value) const override
+    {
+      m_writer->recordAssignment(destName, value, StateCache::currentTime());
+    }
+
+  private:
+
+    // Not implemented
+    FlightRecorder() = delete;
+    FlightRecorder(FlightRecorder const &) = delete;
+    FlightRecorder(FlightRecorder &&) = delete;
+    FlightRecorder &operator=(FlightRecorder const &) = delete;
+    FlightRecorder &operator=(FlightRecorder &&) = delete;
+
+    std::unique_ptr<FlightRecordWriter> m_writer;
+  };
+
+} // namespace PLEXIL
+
+extern "C"
+void initFlightRecorder()
+{
+  REGISTER_EXEC_LISTENER(PLEXIL::FlightRecorder, "FlightRecorder");
+}
@@ -0,0 +1,250 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// flightRecorderQuery - filter and export a FlightRecorder recording
+//
+
+#include "FlightRecordReader.hh"
+
+#include "NodeConstants.hh"
+#include "Value.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <cstdlib>
+
+using namespace PLEXIL;
+
+static char const *usage =
+  "Usage: flightRecorderQuery [options] <segment file> ...\n\
+ Options:\n\
+  -n <name>    Only report transitions of the named node (may be repeated)\n\
+  -v <name>    Only report assignments to the named variable (may be repeated)\n\
+  -s <state>   Only report transitions into the named state (may be repeated)\n\
+  -b <time>    Only report events at or after this time\n\
+  -e <time>    Only report events at or before this time\n\
+  -T           Only report node transitions\n\
+  -A           Only report variable assignments\n\
+  -c           Write comma-separated values instead of text\n\
+  -h           Print this message\n\
+ Node and state filters exclude assignments unless -v is also given;\n\
+ variable filters exclude transitions unless -n or -s is also given.";
+
+struct Query
+{
+  std::set<std::string> nodes;
+  std::set<std::string> variables;
+  std::set<NodeState> states;
+  double begin = -std::numeric_limits<double>::infinity();
+  double end = std::numeric_limits<double>::infinity();
+  bool transitions = true;
+  bool assignments = true;
+  bool csv = false;
+};
+
+static void printTransition(Query const &q,
+                            FlightRecord::TransitionRecord const &rec,
+                            std::string const &name)
+{
+  if (q.csv)
+    std::cout << std::setprecision(17) << rec.time << ",transition,"
+              << name << ','
+              << nodeStateName((NodeState) rec.oldState) << ','
+              << nodeStateName((NodeState) rec.newState) << ','
+              << outcomeName((NodeOutcome) rec.outcome) << ','
+              << failureTypeName((FailureType) rec.failure) << ",\n";
+  else {
+    std::cout << std::fixed << std::setprecision(6) << rec.time << ' '
+              << name << ' '
+              << nodeStateName((NodeState) rec.oldState) << " -> "
+              << nodeStateName((NodeState) rec.newState);
+    if (rec.outcome != NO_OUTCOME)
+      std::cout << ' ' << outcomeName((NodeOutcome) rec.outcome);
+    if (rec.failure != NO_FAILURE)
+      std::cout << ' ' << failureTypeName((FailureType) rec.failure);
+    std::cout << '\n';
+  }
+}
+
+static void printAssignment(Query const &q,
+                            FlightRecord::AssignmentRecord const &rec,
+                            std::string const &name,
+                            Value const &value)
+{
+  if (q.csv) {
+    // Quote the value, doubling any embedded quotes
+    std::string valstr = value.valueToString();
+    std::string quoted;
+    for (char c : valstr) {
+      if (c == '"')
+        quoted.push_back('"');
+      quoted.push_back(c);
+    }
+    std::cout << std::setprecision(17) << rec.time << ",assignment,"
+              << name << ",,,,,\"" << quoted << "\"\n";
+  }
+  else
+    std::cout << std::fixed << std::setprecision(6) << rec.time << ' '
+              << name << " = " << value << '\n';
+}
+
+//! Reports the records matching a query.
+class QueryVisitor final : public FlightRecord::RecordVisitor
+{
+public:
+  QueryVisitor(Query const &q)
+    : m_query(q)
+  {
+  }
+
+  virtual void transition(FlightRecord::TransitionRecord const &rec,
+                          std::string const &name) override
+  {
+    if (!m_query.transitions
+        || rec.time < m_query.begin || rec.time > m_query.end)
+      return;
+    if (!m_query.states.empty() && !m_query.states.count((NodeState) rec.newState))
+      return;
+    if (!m_query.nodes.empty() && !m_query.nodes.count(name))
+      return;
+    printTransition(m_query, rec, name);
+  }
+
+  virtual bool wantAssignment(FlightRecord::AssignmentRecord const &rec,
+                              std::string const &name) override
+  {
+    return m_query.assignments
+      && rec.time >= m_query.begin && rec.time <= m_query.end
+      && (m_query.variables.empty() || m_query.variables.count(name));
+  }
+
+  virtual void assignment(FlightRecord::AssignmentRecord const &rec,
+                          std::string const &name,
+                          Value const &value) override
+  {
+    printAssignment(m_query, rec, name, value);
+  }
+
+private:
+  Query const &m_query;
+};
+
+int main(int argc, char **argv)
+{
+  Query q;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "-h") {
+      std::cout << usage << std::endl;
+      return 0;
+    }
+    else if (arg == "-T") {
+      q.assignments = false;
+    }
+    else if (arg == "-A") {
+      q.transitions = false;
+    }
+    else if (arg == "-c") {
+      q.csv = true;
+    }
+    else if (arg == "-n" || arg == "-v" || arg == "-s" || arg == "-b" || arg == "-e") {
+      if (++i >= argc) {
+        std::cerr << "Error: Missing argument to the " << arg << " option.\n"
+                  << usage << std::endl;
+        return 2;
+      }
+      if (arg == "-n")
+        q.nodes.insert(argv[i]);
+      else if (arg == "-v")
+        q.variables.insert(argv[i]);
+      else if (arg == "-s") {
+        NodeState s = parseNodeState(argv[i]);
+        if (s == NO_NODE_STATE) {
+          std::cerr << "Error: Unknown node state '" << argv[i] << "'." << std::endl;
+          return 2;
+        }
+        q.states.insert(s);
+      }
+      else if (arg == "-b")
+        q.begin = strtod(argv[i], nullptr);
+      else
+        q.end = strtod(argv[i], nullptr);
+    }
+    else if (arg[0] == '-') {
+      std::cerr << "Error: Unknown option '" << arg << "'.\n" << usage << std::endl;
+      return 2;
+    }
+    else
+      files.push_back(arg);
+  }
+
+  // A filter on one kind of event implies the other kind isn't wanted
+  bool const transitionFilter = !q.nodes.empty() || !q.states.empty();
+  bool const assignmentFilter = !q.variables.empty();
+  if (transitionFilter && !assignmentFilter)
+    q.assignments = false;
+  else if (assignmentFilter && !transitionFilter)
+    q.transitions = false;
+
+  if (files.empty()) {
+    std::cerr << usage << std::endl;
+    return 2;
+  }
+
+  std::vector<FlightRecord::Segment> segments(files.size());
+  std::string error;
+  for (size_t i = 0; i < files.size(); ++i)
+    if (!FlightRecord::readSegment(files[i], segments[i], error)) {
+      std::cerr << "Error: " << error << std::endl;
+      return 1;
+    }
+
+  // Report in recording order
+  std::sort(segments.begin(), segments.end(),
+            [](FlightRecord::Segment const &a, FlightRecord::Segment const &b) -> bool
+            { return a.header.sequence < b.header.sequence; });
+
+  if (q.csv)
+    std::cout << "time,event,name,old_state,new_state,outcome,failure,value\n";
+  QueryVisitor visitor(q);
+  int status = 0;
+  for (FlightRecord::Segment const &seg : segments)
+    if (!FlightRecord::scanSegment(seg, visitor, error)) {
+      std::cerr << "Error: " << error << std::endl;
+      status = 1;
+    }
+  std::cout << std::flush;
+  return status;
+}
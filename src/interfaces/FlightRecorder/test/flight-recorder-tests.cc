@@ -0,0 +1,380 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Unit tests for the FlightRecorder segment writer and reader
+//
+
+#include "FlightRecordReader.hh"
+#include "FlightRecordWriter.hh"
+
+#include "ArrayImpl.hh"
+#include "NodeImpl.hh"
+#include "Value.hh"
+
+#include <iostream>
+#include <vector>
+
+#include <cstdio>  // remove()
+#include <cstdlib> // mkdtemp()
+#include <cstring>
+
+#include <unistd.h> // rmdir()
+
+using namespace PLEXIL;
+
+struct Event
+{
+  std::string name;
+  Value value;
+  int oldState;
+  int newState;
+  bool isTransition;
+};
+
+class CollectingVisitor final : public FlightRecord::RecordVisitor
+{
+public:
+  virtual void transition(FlightRecord::TransitionRecord const &rec,
+                          std::string const &name) override
+  {
+    events.push_back({name, Value(), rec.oldState, rec.newState, true});
+  }
+
+  virtual void assignment(FlightRecord::AssignmentRecord const & /* rec */,
+                          std::string const &name,
+                          Value const &value) override
+  {
+    events.push_back({name, value, 0, 0, false});
+  }
+
+  std::vector<Event> events;
+};
+
+static std::string s_dir;
+
+static std::string segmentPath(unsigned int n)
+{
+  return s_dir + "/test-" + std::to_string(n) + FlightRecord::SEGMENT_SUFFIX;
+}
+
+static void removeSegments(unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+    remove(segmentPath(i).c_str());
+}
+
+static bool scan(std::string const &path, CollectingVisitor &visitor)
+{
+  FlightRecord::Segment seg;
+  std::string error;
+  if (!FlightRecord::readSegment(path, seg, error)
+      || !FlightRecord::scanSegment(seg, visitor, error)) {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static bool testRoundTrip()
+{
+  std::cout << "Testing record round trip" << std::endl;
+  NodeImpl root("Root");
+  NodeImpl child("Child", &root);
+  IntegerArray ary(3, 7);
+  ary.setElementUnknown(1);
+  {
+    FlightRecordWriter writer(s_dir, "test", 4096, 2);
+    if (!writer.open()) {
+      std::cerr << "Unable to open segment" << std::endl;
+      return false;
+    }
+    writer.recordTransition(&root, INACTIVE_STATE, WAITING_STATE, 1.0);
+    writer.recordTransition(&child, INACTIVE_STATE, WAITING_STATE, 1.0);
+    writer.recordAssignment("x", Value((Integer) 42), 2.0);
+    writer.recordAssignment("s", Value(std::string("hello")), 2.0);
+    writer.recordAssignment("a", Value(ary), 2.0);
+    writer.recordAssignment("x", Value(), 3.0);
+    writer.recordTransition(&child, WAITING_STATE, EXECUTING_STATE, 4.0);
+  }
+
+  CollectingVisitor visitor;
+  if (!scan(segmentPath(0), visitor))
+    return false;
+  std::vector<Event> const &ev = visitor.events;
+  bool result = ev.size() == 7
+    && ev[0].isTransition && ev[0].name == "Root"
+    && ev[0].oldState == INACTIVE_STATE && ev[0].newState == WAITING_STATE
+    && ev[1].isTransition && ev[1].name == "Child"
+    && !ev[2].isTransition && ev[2].name == "x" && ev[2].value == Value((Integer) 42)
+    && ev[3].name == "s" && ev[3].value == Value(std::string("hello"))
+    && ev[4].name == "a" && ev[4].value == Value(ary)
+    && ev[5].name == "x" && !ev[5].value.isKnown()
+    && ev[6].isTransition && ev[6].name == "Child"
+    && ev[6].newState == EXECUTING_STATE;
+  if (!result)
+    std::cerr << "Decoded records don't match those written" << std::endl;
+  removeSegments(2);
+  return result;
+}
+
+static bool testRotation()
+{
+  std::cout << "Testing segment rotation" << std::endl;
+  NodeImpl root("Rotor");
+  {
+    FlightRecordWriter writer(s_dir, "test", 4096, 3);
+    if (!writer.open()) {
+      std::cerr << "Unable to open segment" << std::endl;
+      return false;
+    }
+    // About 3 segments' worth of records
+    for (int i = 0; i < 400; ++i)
+      writer.recordTransition(&root, WAITING_STATE, EXECUTING_STATE, (double) i);
+  }
+
+  // Every segment decodes on its own, with the node's name
+  bool result = true;
+  size_t total = 0;
+  for (unsigned int i = 0; i < 3; ++i) {
+    CollectingVisitor visitor;
+    if (!scan(segmentPath(i), visitor))
+      return false;
+    for (Event const &e : visitor.events)
+      if (e.name != "Rotor") {
+        std::cerr << "Segment " << i << " lacks a name record" << std::endl;
+        result = false;
+        break;
+      }
+    total += visitor.events.size();
+  }
+  if (total == 0 || total > 400) {
+    std::cerr << "Unexpected record count " << total << std::endl;
+    result = false;
+  }
+  removeSegments(3);
+  return result;
+}
+
+static bool testSerialValueLength()
+{
+  std::cout << "Testing serialValueLength" << std::endl;
+  std::vector<Value> values =
+    {Value(),
+     Value(true),
+     Value((Integer) -5),
+     Value(3.5),
+     Value(std::string("a string")),
+     Value(BooleanArray(11, true)),
+     Value(IntegerArray(9, 2)),
+     Value(RealArray(4, 1.5)),
+     Value(StringArray(5, std::string("elt")))};
+  char buf[256];
+  bool result = true;
+  for (Value const &v : values) {
+    char *end = v.serialize(buf);
+    size_t len = end - buf;
+    if (FlightRecord::serialValueLength(buf, len) != len) {
+      std::cerr << "Wrong length for " << v << std::endl;
+      result = false;
+    }
+    // Any shorter buffer must be rejected
+    for (size_t avail = 0; avail < len; ++avail)
+      if (FlightRecord::serialValueLength(buf, avail)) {
+        std::cerr << "Truncated " << v << " accepted with "
+                  << avail << " bytes" << std::endl;
+        result = false;
+        break;
+      }
+  }
+  buf[0] = (char) 0x7F; // not a value type
+  if (FlightRecord::serialValueLength(buf, sizeof(buf))) {
+    std::cerr << "Invalid type code accepted" << std::endl;
+    result = false;
+  }
+  return result;
+}
+
+// Write one assignment, then apply a corruption to the segment image
+// and check that the scan rejects it.
+static bool checkCorruption(char const *what,
+                            void (*corrupt)(FlightRecord::Segment &seg,
+                                            size_t assignOffset))
+{
+  NodeImpl root("Root");
+  {
+    FlightRecordWriter writer(s_dir, "test", 4096, 1);
+    if (!writer.open()) {
+      std::cerr << "Unable to open segment" << std::endl;
+      return false;
+    }
+    writer.recordAssignment("s", Value(std::string("hello")), 1.0);
+  }
+  FlightRecord::Segment seg;
+  std::string error;
+  if (!FlightRecord::readSegment(segmentPath(0), seg, error)) {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+  removeSegments(1);
+
+  // Assignment follows the name record for "s"
+  FlightRecord::RecordHeader hdr;
+  memcpy(&hdr, seg.data.data(), sizeof(hdr));
+  corrupt(seg, hdr.length);
+
+  CollectingVisitor visitor;
+  if (FlightRecord::scanSegment(seg, visitor, error)) {
+    std::cerr << what << " not detected" << std::endl;
+    return false;
+  }
+  if (!visitor.events.empty()) {
+    std::cerr << what << " reported a record" << std::endl;
+    return false;
+  }
+  std::cout << " " << what << ": " << error << std::endl;
+  return true;
+}
+
+static bool testCorruptRecords()
+{
+  std::cout << "Testing malformed record detection" << std::endl;
+  bool result = true;
+
+  result = checkCorruption("record length past end of segment",
+                           [](FlightRecord::Segment &seg, size_t off)
+                           {
+                             uint32_t len = 1 << 20;
+                             memcpy(seg.data.data() + off, &len, sizeof(len));
+                           })
+    && result;
+
+  result = checkCorruption("record length shorter than record",
+                           [](FlightRecord::Segment &seg, size_t off)
+                           {
+                             uint32_t len = sizeof(FlightRecord::RecordHeader);
+                             memcpy(seg.data.data() + off, &len, sizeof(len));
+                           })
+    && result;
+
+  result = checkCorruption("value length past end of record",
+                           [](FlightRecord::Segment &seg, size_t off)
+                           {
+                             FlightRecord::AssignmentRecord rec;
+                             memcpy(&rec, seg.data.data() + off, sizeof(rec));
+                             rec.valueLength = rec.header.length;
+                             memcpy(seg.data.data() + off, &rec, sizeof(rec));
+                           })
+    && result;
+
+  result = checkCorruption("string length past end of value",
+                           [](FlightRecord::Segment &seg, size_t off)
+                           {
+                             // First byte of the 3 byte string size
+                             seg.data[off + sizeof(FlightRecord::AssignmentRecord) + 1] = 0x7F;
+                           })
+    && result;
+
+  result = checkCorruption("name length past end of record",
+                           [](FlightRecord::Segment &seg, size_t /* off */)
+                           {
+                             FlightRecord::NameRecord rec;
+                             memcpy(&rec, seg.data.data(), sizeof(rec));
+                             rec.nameLength = 0xFFFFFFF0;
+                             memcpy(seg.data.data(), &rec, sizeof(rec));
+                           })
+    && result;
+
+  result = checkCorruption("truncated segment",
+                           [](FlightRecord::Segment &seg, size_t off)
+                           {
+                             seg.data.resize(off + sizeof(FlightRecord::AssignmentRecord) + 2);
+                           })
+    && result;
+
+  return result;
+}
+
+static bool testNodeCacheEviction()
+{
+  std::cout << "Testing node cache eviction" << std::endl;
+  FlightRecordWriter writer(s_dir, "test", 4096, 1);
+  if (!writer.open()) {
+    std::cerr << "Unable to open segment" << std::endl;
+    return false;
+  }
+
+  bool result = true;
+  for (int plan = 0; plan < 3; ++plan) {
+    NodeImpl root("Root");
+    NodeImpl child1("Child1", &root);
+    NodeImpl child2("Child2", &root);
+    writer.recordTransition(&root, INACTIVE_STATE, WAITING_STATE, 0.0);
+    writer.recordTransition(&child1, INACTIVE_STATE, WAITING_STATE, 0.0);
+    writer.recordTransition(&child2, INACTIVE_STATE, WAITING_STATE, 0.0);
+    writer.recordTransition(&child2, WAITING_STATE, EXECUTING_STATE, 0.0);
+    if (writer.cachedNodeCount() != 3) {
+      std::cerr << "Plan " << plan << ": expected 3 cached nodes, found "
+                << writer.cachedNodeCount() << std::endl;
+      result = false;
+    }
+    writer.forgetPlan(&root);
+    if (writer.cachedNodeCount() != 0) {
+      std::cerr << "Plan " << plan << ": " << writer.cachedNodeCount()
+                << " nodes still cached after forgetPlan" << std::endl;
+      result = false;
+    }
+  }
+  writer.close();
+  removeSegments(1);
+  return result;
+}
+
+int main()
+{
+  char dirTemplate[] = "/tmp/flight-recorder-tests-XXXXXX";
+  if (!mkdtemp(dirTemplate)) {
+    std::cerr << "Unable to create temporary directory" << std::endl;
+    return 1;
+  }
+  s_dir = dirTemplate;
+
+  bool result = testRoundTrip();
+  result = testRotation() && result;
+  result = testSerialValueLength() && result;
+  result = testCorruptRecords() && result;
+  result = testNodeCacheEviction() && result;
+
+  rmdir(s_dir.c_str());
+  if (!result) {
+    std::cerr << "Flight recorder tests FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "Flight recorder tests passed" << std::endl;
+  return 0;
+}
+
+// EOF
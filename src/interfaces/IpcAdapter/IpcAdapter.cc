@@ -186,6 +186,10 @@ namespace PLEXIL
       // Parse other configuration parameters
       bool acceptDuplicates = getXml().attribute("AllowDuplicateMessages").as_bool();
       m_messageQueues.setAllowDuplicateMessages(acceptDuplicates);
+      if (!m_messageQueues.configure(getXml())) {
+        warn("IpcAdapter: invalid message queue configuration");
+        return false;
+      }
 
       debugMsg("IpcAdapter:initialize", " succeeded");
       return true;
@@ -204,6 +208,8 @@ namespace PLEXIL
       if (xml) {
         taskName = xml.attribute("TaskName").value();
         serverName = xml.attribute("Server").value();
+        // Same-host peers with this enabled bypass central
+        m_ipcFacade.setSharedMemoryTransport(xml.attribute("SharedMemoryTransport").as_bool());
       }
 
       // Use defaults if necessary
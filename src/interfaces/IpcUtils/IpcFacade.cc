@@ -30,6 +30,7 @@
 #include "CommandHandle.hh"
 #include "Debug.hh"
 #include "Error.hh"
+#include "SharedMemoryTransport.hh"
 
 #include <algorithm>
 #include <fstream>
@@ -44,6 +45,7 @@ namespace PLEXIL
   // forward reference
   static bool definePlexilIPCMessageTypes(std::string uid);
   static void myIpcDispatch(bool *flag_ptr);
+  static void deleteMessages(std::vector<PlexilMsgBase *> &msgs, size_t first);
   static void ipcMessageHandler(MSG_INSTANCE /* rawMsg */,
                                 void * unmarshalledMsg,
                                 void * this_as_void_ptr);
@@ -481,8 +483,16 @@ namespace PLEXIL
     m_listenersMutex(),
     m_nextSerial(1),
     m_isInitialized(false),
+    m_sharedMemory(),
+    m_sharedMemoryThread(),
+    m_dispatchMutex(),
+    m_centralCopies(new CentralCopyFilter()),
+    m_formatters(),
+    m_serverName(),
     m_isStarted(false),
-    m_stopDispatchThread(false)
+    m_stopDispatchThread(false),
+    m_stopSharedMemoryThread(false),
+    m_useSharedMemory(false)
   {
     debugMsg("IpcFacade", " constructor");
   }
@@ -518,6 +528,7 @@ namespace PLEXIL
 
     if (taskName && *taskName && taskName != m_myUID)
       m_myUID = taskName;
+    m_serverName = serverName ? serverName : "";
 
     debugMsg("IpcFacade:initialize",
              " UID " << m_myUID <<  " server name " << serverName);
@@ -558,6 +569,11 @@ namespace PLEXIL
     return result;
   }
 
+  void IpcFacade::setSharedMemoryTransport(bool enable)
+  {
+    m_useSharedMemory = enable;
+  }
+
   /**
    * @brief Initializes and starts the Ipc message handling thread. If Ipc is already
    * started, this method does nothing and returns IPC_OK.
@@ -576,6 +592,28 @@ namespace PLEXIL
                ' ' << m_myUID << " subscribing to messages");
       subscribeToMsgs();
 
+      // Open the same-host transport, if requested and available
+      if (m_useSharedMemory) {
+        m_formatters.resize(PlexilMsgType_limit, nullptr);
+        for (uint16_t t = 0; t < PlexilMsgType_limit; ++t) {
+          char const *format = msgFormatForType((PlexilMsgType) t);
+          if (format)
+            m_formatters[t] = IPC_msgFormatter(format);
+        }
+        m_sharedMemory.reset(new SharedMemoryTransport());
+        if (m_sharedMemory->open(m_serverName, m_myUID)) {
+          debugMsg("IpcFacade:start",
+                   ' ' << m_myUID << " spawning shared memory listener thread");
+          m_stopSharedMemoryThread = false;
+          m_sharedMemoryThread = std::thread([this]() { sharedMemoryDispatch(); });
+        }
+        else {
+          debugMsg("IpcFacade:start",
+                   ' ' << m_myUID << " shared memory transport unavailable, using central only");
+          m_sharedMemory.reset();
+        }
+      }
+
       // Spawn message thread AFTER all subscribes complete
       // Running thread in parallel with subscriptions resulted in deadlocks
       debugMsg("IpcFacade:start", ' ' << m_myUID << " spawning IPC dispatch thread");
@@ -596,11 +634,24 @@ namespace PLEXIL
       return;
     }
 
-    // Cancel IPC dispatch thread first to prevent deadlocks
+    // Cancel dispatch threads first to prevent deadlocks
+    if (m_sharedMemory) {
+      debugMsg("IpcFacade:stop", ' ' << m_myUID << " cancelling shared memory listener thread");
+      m_stopSharedMemoryThread = true;
+      m_sharedMemory->wake();
+      m_sharedMemoryThread.join();
+    }
     debugMsg("IpcFacade:stop", ' ' << m_myUID << " cancelling dispatch thread");
     m_stopDispatchThread = true;
     m_thread.join();
 
+    if (m_sharedMemory) {
+      debugMsg("IpcFacade:stop", ' ' << m_myUID << " closing shared memory transport");
+      m_sharedMemory->close();
+      m_sharedMemory.reset();
+      m_centralCopies->clear();
+    }
+
     debugMsg("IpcFacade:stop", ' ' << m_myUID << " unsubscribing all");
     unsubscribeAllListeners();
 
@@ -718,7 +769,7 @@ namespace PLEXIL
           getSerialNumber(),
           m_myUID.c_str() },
         command.c_str() };
-    return IPC_publishData(STRING_VALUE_MSG, (void *) &packet);
+    return publishSequence(std::vector<PlexilMsgBase *>(1, &packet.header), "", false);
   }
 
   uint32_t IpcFacade::publishCommand(std::string const &command,
@@ -740,12 +791,10 @@ namespace PLEXIL
           m_myUID.c_str() },
         command.c_str() };
 
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &cmdPacket);
-
-    if (result == IPC_OK) {
-      result = sendParameters(argsToDeliver, serial);
-    }
+    std::vector<PlexilMsgBase *> msgs(1, &cmdPacket.header);
+    appendParameters(argsToDeliver, serial, msgs);
+    IPC_RETURN_TYPE result = publishSequence(msgs, dest, false);
+    deleteMessages(msgs, 1);
 
     setError(result);
 
@@ -777,12 +826,10 @@ namespace PLEXIL
           m_myUID.c_str() },
         lookup.c_str() };
 
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &leader);
-
-    if (result == IPC_OK && !argsToDeliver.empty())
-      // Send trailers, if any 
-      result = sendParameters(argsToDeliver, serial);
+    std::vector<PlexilMsgBase *> msgs(1, &leader.header);
+    appendParameters(argsToDeliver, serial, msgs);
+    IPC_RETURN_TYPE result = publishSequence(msgs, dest, false);
+    deleteMessages(msgs, 1);
 
     setError(result);
     return result == IPC_OK ? serial : ERROR_SERIAL;
@@ -801,11 +848,10 @@ namespace PLEXIL
           m_myUID.c_str() },
         request_serial,
         request_uid.c_str() };
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(RETURN_VALUE_MSG, request_uid), (void *) &packet);
-    if (result == IPC_OK) {
-      result = sendParameters(std::vector<Value>(1, arg), serial, request_uid);
-    }
+    std::vector<PlexilMsgBase *> msgs(1, &packet.header);
+    appendParameters(std::vector<Value>(1, arg), serial, msgs);
+    IPC_RETURN_TYPE result = publishSequence(msgs, request_uid, true);
+    deleteMessages(msgs, 1);
     setError(result);
     return result == IPC_OK ? serial : ERROR_SERIAL;
   }
@@ -831,10 +877,10 @@ namespace PLEXIL
           leaderSerial,
           m_myUID.c_str()},
         destName.c_str()};
-    IPC_RETURN_TYPE status = IPC_publishData(STRING_VALUE_MSG, (void *) &tvMsg);
-    if (status == IPC_OK && !values.empty()) {
-      status = sendParameters(values, leaderSerial);
-    }
+    std::vector<PlexilMsgBase *> msgs(1, &tvMsg.header);
+    appendParameters(values, leaderSerial, msgs);
+    IPC_RETURN_TYPE status = publishSequence(msgs, "", false);
+    deleteMessages(msgs, 1);
     setError(status);
     return status == IPC_OK ? leaderSerial : ERROR_SERIAL;
   }
@@ -850,64 +896,22 @@ namespace PLEXIL
         serial,
         m_myUID.c_str()},
        nodeName.c_str()};
-    IPC_RETURN_TYPE status = IPC_publishData(STRING_VALUE_MSG, (void*) &updatePacket);
-    if (status == IPC_OK) {
-      status = sendPairs(update, serial);
-    }
+    std::vector<PlexilMsgBase *> msgs(1, &updatePacket.header);
+    appendPairs(update, serial, msgs);
+    IPC_RETURN_TYPE status = publishSequence(msgs, "", false);
+    deleteMessages(msgs, 1);
     setError(status);
     return status == IPC_OK ? serial : ERROR_SERIAL;
   }
 
-  /**
-   * @brief Helper function for sending a vector of parameters via IPC.
-   * @param args The arguments to convert into messages and send
-   * @param serial The serial to send along with each parameter. This should be the same serial as the header
-   */
-  IPC_RETURN_TYPE IpcFacade::sendParameters(std::vector<Value> const &args, uint32_t serial) {
-    return sendParameters(args, serial, "");
-  }
-
-  /**
-   * @brief Helper function for sending a vector of parameters via IPC to a specific executive.
-   * @param args The arguments to convert into messages and send
-   * @param serial The serial to send along with each parameter. This should be the same serial as the header
-   * @param dest The destination executive name. If dest is an empty string, parameters are broadcast to
-   * all executives
-   */
-  IPC_RETURN_TYPE IpcFacade::sendParameters(std::vector<Value> const &args, uint32_t serial, std::string const &dest) {
-    size_t nParams = args.size();
-    // Construct parameter messages
-    PlexilMsgBase* paramMsgs[nParams];
-    for (size_t i = 0; i < nParams; ++i) {
-      PlexilMsgBase* paramMsg = constructPlexilValueMsg(args[i]);
-      // Fill in common fields
-      paramMsg->count = i;
-      paramMsg->serial = serial;
-      paramMsg->senderUID = m_myUID.c_str();
-      paramMsgs[i] = paramMsg;
-    }
-    
-    // Send the messages
-    IPC_RETURN_TYPE result = IPC_OK;
-    for (size_t i = 0; i < nParams && result == IPC_OK; i++) {
-      char const *msgFormat = msgFormatForType((PlexilMsgType) paramMsgs[i]->msgType);
-      if (dest.empty()) {
-        debugMsg("IpcFacade:sendParameters",
-                 " using format " << msgFormat << " for parameter " << i);
-        result = IPC_publishData(msgFormat, paramMsgs[i]);
-      }
-      else {
-        char const *msgName = formatMsgName(msgFormat, dest);
-        debugMsg("IpcFacade:sendParameters",
-                 " using format " << msgName << " for parameter " << i);
-        result = IPC_publishData(msgName, paramMsgs[i]);
-      }
-    }
-
-    // free the parameter packets
-    for (size_t i = 0; i < nParams; i++) {
-      PlexilMsgBase* m = paramMsgs[i];
-      paramMsgs[i] = nullptr;
+  //! Free parameter or pair messages constructed by IpcFacade.
+  //! @param msgs The message vector.
+  //! @param first Index of the first message to free.
+  static void deleteMessages(std::vector<PlexilMsgBase *> &msgs, size_t first)
+  {
+    for (size_t i = first; i < msgs.size(); i++) {
+      PlexilMsgBase* m = msgs[i];
+      msgs[i] = nullptr;
       switch (m->msgType) {
       case PlexilMsgType_UnknownValue:
         delete (PlexilUnknownValueMsg*) m;
@@ -958,55 +962,271 @@ namespace PLEXIL
         break;
       }
 
+      case PlexilMsgType_PairBoolean:
+        delete reinterpret_cast<BooleanPair*>(m);
+        break;
+
+      case PlexilMsgType_PairInteger:
+        delete reinterpret_cast<IntegerPair*>(m);
+        break;
+
+      case PlexilMsgType_PairReal:
+        delete reinterpret_cast<RealPair*>(m);
+        break;
+
+      case PlexilMsgType_PairString:
+        delete reinterpret_cast<StringPair*>(m);
+        break;
+
       default:
         delete m;
         break;
       }
     }
+    msgs.resize(first);
+  }
 
-    return result;
+  /**
+   * @brief Construct parameter messages for a sequence and append them to the vector.
+   * @param args The arguments to convert into messages
+   * @param serial The serial to send along with each parameter. This should be the same serial as the header
+   * @param msgs The message vector.
+   */
+  void IpcFacade::appendParameters(std::vector<Value> const &args,
+                                   uint32_t serial,
+                                   std::vector<PlexilMsgBase *> &msgs)
+  {
+    size_t nParams = args.size();
+    for (size_t i = 0; i < nParams; ++i) {
+      PlexilMsgBase* paramMsg = constructPlexilValueMsg(args[i]);
+      // Fill in common fields
+      paramMsg->count = i;
+      paramMsg->serial = serial;
+      paramMsg->senderUID = m_myUID.c_str();
+      msgs.push_back(paramMsg);
+    }
   }
 
   /** 
-   * @brief Helper function for sending a vector of pairs via IPC.
-   * @param pairs The pairs to convert into messages and send
+   * @brief Construct pair messages for a sequence and append them to the vector.
+   * @param pairs The pairs to convert into messages
    * @param serial The serial to send along with each parameter.  This should be the same serial s the header.
-   * 
-   * @return The IPC error status.
+   * @param msgs The message vector.
    */
-  IPC_RETURN_TYPE IpcFacade::sendPairs(std::vector<std::pair<std::string, Value> > const& pairs,
-                                       uint32_t serial) {
-    IPC_RETURN_TYPE result = IPC_OK;
-    for(std::vector<std::pair<std::string, Value> >::const_iterator it = pairs.begin();
-        it != pairs.end() && result == IPC_OK; ++it) {
+  void IpcFacade::appendPairs(std::vector<std::pair<std::string, Value> > const& pairs,
+                              uint32_t serial,
+                              std::vector<PlexilMsgBase *> &msgs)
+  {
+    for (std::vector<std::pair<std::string, Value> >::const_iterator it = pairs.begin();
+         it != pairs.end(); ++it) {
       PlexilMsgBase* pairMsg = constructPlexilPairMsg(it->first, it->second);
       pairMsg->count = std::distance(pairs.begin(), it);
       pairMsg->serial = serial;
       pairMsg->senderUID = m_myUID.c_str();
-      std::string msgName =
-        formatMsgName(msgFormatForType((PlexilMsgType) pairMsg->msgType),
-                      "");
-      result = IPC_publishData(msgName.c_str(), pairMsg);
+      msgs.push_back(pairMsg);
+    }
+  }
 
-      switch(pairMsg->msgType) {
-      case PlexilMsgType_PairBoolean:
-        delete reinterpret_cast<BooleanPair*>(pairMsg);
-        break;
-      case PlexilMsgType_PairInteger:
-        delete reinterpret_cast<IntegerPair*>(pairMsg);
+  /**
+   * @brief Publish a complete message sequence, leader first.
+   * @param msgs The messages.
+   * @param dest The destination UID. If dest is an empty string, the sequence is broadcast to
+   * all clients.
+   * @param directTrailers If true, the messages following the leader are also sent to dest
+   * through central; otherwise only the leader is.
+   * @return The IPC error status.
+   */
+  IPC_RETURN_TYPE IpcFacade::publishSequence(std::vector<PlexilMsgBase *> const &msgs,
+                                             std::string const &dest,
+                                             bool directTrailers)
+  {
+    if (m_sharedMemory) {
+      std::vector<char> record;
+      if (!dest.empty()) {
+        // Directed to a same-host peer: bypass central entirely
+        if (dest != m_myUID
+            && m_sharedMemory->isPeer(dest)
+            && encodeSharedMemoryRecord(msgs, false, record)
+            && m_sharedMemory->send(dest, record.data(), record.size())) {
+          debugMsg("IpcFacade:publishSequence",
+                   ' ' << m_myUID << " sent " << msgs.size()
+                   << " messages to " << dest << " via shared memory");
+          return IPC_OK;
+        }
+      }
+      else {
+        // Broadcast: same-host peers receive it here first,
+        // and discard the copy from central when it arrives
+        std::vector<std::string> peers;
+        m_sharedMemory->getPeers(peers);
+        if (!peers.empty() && encodeSharedMemoryRecord(msgs, true, record)) {
+          for (std::string const &peer : peers)
+            m_sharedMemory->send(peer, record.data(), record.size());
+        }
+      }
+    }
+
+    IPC_RETURN_TYPE result = IPC_OK;
+    for (size_t i = 0; i < msgs.size() && result == IPC_OK; ++i) {
+      char const *msgFormat = msgFormatForType((PlexilMsgType) msgs[i]->msgType);
+      if (!msgFormat) {
+        debugMsg("IpcFacade:publishSequence",
+                 " no format for message type " << msgs[i]->msgType);
+        result = IPC_Error;
         break;
-      case PlexilMsgType_PairReal:
-        delete reinterpret_cast<RealPair*>(pairMsg);
+      }
+      // Central routing is unchanged from sendParameters(): the trailers
+      // of directed commands and LookupNow requests are broadcast
+      char const *msgName =
+        (dest.empty() || (i && !directTrailers)) ? msgFormat : formatMsgName(msgFormat, dest);
+      debugMsg("IpcFacade:publishSequence",
+               " using format " << msgName << " for message " << i);
+      result = IPC_publishData(msgName, (void *) msgs[i]);
+    }
+    return result;
+  }
+
+  //
+  // Shared memory record layout: a SharedMemoryRecordHeader, then for
+  // each message of the sequence a SharedMemoryPartHeader followed by
+  // the IPC-marshalled message, padded to a multiple of 8 bytes.
+  //
+
+  struct SharedMemoryRecordHeader
+  {
+    uint32_t flags;
+    uint32_t count;
+  };
+
+  struct SharedMemoryPartHeader
+  {
+    uint16_t msgType;
+    uint16_t reserved;
+    uint32_t length;
+  };
+
+  //! Flag set when the sequence was also published through central.
+  static constexpr uint32_t RECORD_CENTRAL_COPY = 1;
+
+  static inline size_t paddedLength(size_t length)
+  {
+    return (length + 7) & ~((size_t) 7);
+  }
+
+  bool IpcFacade::encodeSharedMemoryRecord(std::vector<PlexilMsgBase *> const &msgs,
+                                           bool centralCopy,
+                                           std::vector<char> &record)
+  {
+    SharedMemoryRecordHeader const header =
+      {centralCopy ? RECORD_CENTRAL_COPY : 0, (uint32_t) msgs.size()};
+    record.resize(sizeof(header));
+    memcpy(record.data(), &header, sizeof(header));
+    for (PlexilMsgBase *msg : msgs) {
+      FORMATTER_PTR formatter =
+        msg->msgType < m_formatters.size() ? m_formatters[msg->msgType] : nullptr;
+      IPC_VARCONTENT_TYPE content;
+      if (!formatter || IPC_marshall(formatter, (void *) msg, &content) != IPC_OK) {
+        debugMsg("IpcFacade:encodeSharedMemoryRecord",
+                 " unable to marshal message type " << msg->msgType);
+        return false;
+      }
+      SharedMemoryPartHeader const part = {msg->msgType, 0, content.length};
+      size_t offset = record.size();
+      record.resize(offset + sizeof(part) + paddedLength(content.length), 0);
+      memcpy(&record[offset], &part, sizeof(part));
+      if (content.content) {
+        memcpy(&record[offset + sizeof(part)], content.content, content.length);
+        IPC_freeByteArray(content.content);
+      }
+    }
+    return true;
+  }
+
+  // Called with m_dispatchMutex held
+  void IpcFacade::handleSharedMemoryRecord(char const *data, size_t size)
+  {
+    SharedMemoryRecordHeader header;
+    if (size < sizeof(header))
+      return;
+    memcpy(&header, data, sizeof(header));
+
+    // Records may come from any process, so check every part's bounds
+    // and type before unmarshalling any of them
+    size_t const maxParts = (size - sizeof(header)) / sizeof(SharedMemoryPartHeader);
+    bool valid = header.count <= maxParts;
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; valid && i < header.count; ++i) {
+      SharedMemoryPartHeader part;
+      if (offset + sizeof(part) > size) {
+        valid = false;
         break;
-      case PlexilMsgType_PairString:
-        delete reinterpret_cast<StringPair*>(pairMsg);
+      }
+      memcpy(&part, data + offset, sizeof(part));
+      offset += sizeof(part);
+      if (part.msgType >= m_formatters.size()
+          || !m_formatters[part.msgType]
+          || part.length > size - offset) {
+        valid = false;
         break;
-      default:
-        delete pairMsg;
+      }
+      offset += paddedLength(part.length);
+    }
+    if (!valid) {
+      debugMsg("IpcFacade:handleSharedMemoryRecord",
+               ' ' << m_myUID << " discarding malformed record");
+      return;
+    }
+
+    std::vector<PlexilMsgBase *> msgs;
+    offset = sizeof(header);
+    for (uint32_t i = 0; i < header.count; ++i) {
+      SharedMemoryPartHeader part;
+      memcpy(&part, data + offset, sizeof(part));
+      offset += sizeof(part);
+      void *msg = nullptr;
+      if (IPC_unmarshall(m_formatters[part.msgType],
+                         (BYTE_ARRAY) const_cast<char *>(data + offset), &msg) != IPC_OK
+          || !msg) {
+        valid = false;
         break;
       }
+      msgs.push_back(reinterpret_cast<PlexilMsgBase *>(msg));
+      offset += paddedLength(part.length);
     }
-    return result;
+
+    if (!valid) {
+      debugMsg("IpcFacade:handleSharedMemoryRecord",
+               ' ' << m_myUID << " discarding record which failed to unmarshal");
+      for (PlexilMsgBase *msg : msgs)
+        IPC_freeData(m_formatters[msg->msgType], (void *) msg);
+      return;
+    }
+    if (msgs.empty())
+      return;
+
+    if (header.flags & RECORD_CENTRAL_COPY) {
+      m_centralCopies->expect(msgs.front()->senderUID, msgs.front()->serial, msgs.size());
+    }
+
+    debugMsg("IpcFacade:handleSharedMemoryRecord",
+             ' ' << m_myUID << " received " << msgs.size() << " messages from "
+             << msgs.front()->senderUID << " via shared memory");
+    for (PlexilMsgBase *msg : msgs)
+      dispatchMessage(msg);
+  }
+
+  //! Shared memory listener thread top level.
+  //! Exits when the stop flag is set.
+  void IpcFacade::sharedMemoryDispatch()
+  {
+    debugMsg("IpcFacade:sharedMemoryDispatch", " started");
+    while (!m_stopSharedMemoryThread) {
+      m_sharedMemory->wait(1000);
+      std::lock_guard<std::mutex> guard(m_dispatchMutex);
+      m_sharedMemory->receive([this](char const *data, size_t size) -> void
+                              { this->handleSharedMemoryRecord(data, size); });
+    }
+    debugMsg("IpcFacade:sharedMemoryDispatch", " terminated");
   }
 
   /**
@@ -1153,6 +1373,33 @@ namespace PLEXIL
 
   // Handle a message received from IPC dispatch thread
   void IpcFacade::handleMessage(PlexilMsgBase *msgData)
+  {
+    if (!m_sharedMemory) {
+      dispatchMessage(msgData);
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(m_dispatchMutex);
+
+    // Senders write to shared memory before publishing through central,
+    // so any copy received that way is already in the inbox
+    m_sharedMemory->receive([this](char const *data, size_t size) -> void
+                            { this->handleSharedMemoryRecord(data, size); });
+
+    if (m_centralCopies->discard(msgData->senderUID, msgData->serial)) {
+      debugMsg("IpcFacade:handleMessage",
+               ' ' << m_myUID << " discarding central copy of message from "
+               << msgData->senderUID << ", serial " << msgData->serial);
+      IPC_freeData(IPC_msgFormatter(msgFormatForType((PlexilMsgType) msgData->msgType)),
+                   (void *) msgData);
+      return;
+    }
+
+    dispatchMessage(msgData);
+  }
+
+  // Route a received message by type
+  void IpcFacade::dispatchMessage(PlexilMsgBase *msgData)
   {
     PlexilMsgType msgType = (PlexilMsgType) msgData->msgType;
     debugMsg("IpcFacade:handleMessage",
@@ -32,9 +32,11 @@
 
 #include "Value.hh"
 
+#include <atomic>
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -42,6 +44,10 @@
 
 namespace PLEXIL {
 
+  // Forward references
+  class CentralCopyFilter;
+  class SharedMemoryTransport;
+
   //! Return type from many of the IpcFacade member functions
   using IpcSerialNumber = uint32_t;
 
@@ -58,6 +64,13 @@ namespace PLEXIL {
 
   /**
    * @brief Manages connection with IPC. This class is not thread-safe.
+   *
+   * When the shared memory transport is enabled, message sequences
+   * addressed to a peer on the same host which also has it enabled
+   * are delivered through that peer's shared memory inbox instead of
+   * central.  Broadcast sequences are still published through central
+   * for the benefit of remote peers, and the copies same-host peers
+   * already received are discarded on arrival.
    */
   //TODO: Integrate all plexil type converting into this class.
   class IpcFacade
@@ -91,6 +104,13 @@ namespace PLEXIL {
     //!       returns IPC_OK.
     IPC_RETURN_TYPE initialize(const char* taskName, const char* serverName);
 
+    //! Enable or disable the same-host shared memory transport.
+    //! @param enable true to enable, false to disable.
+    //! @note Only takes effect if called before start().
+    //! @note Disabled by default.  Falls back silently to central if
+    //!       the transport is unavailable on this platform.
+    void setSharedMemoryTransport(bool enable);
+
     /**
      * @brief Starts the Ipc message handling thread. If not initialized, initialization occurs.
      * If Ipc is already started, this method does nothing and returns IPC_OK.
@@ -202,6 +222,8 @@ namespace PLEXIL {
     //! Receive the message from IPC and handle it as required.
     //! @param msg The message to be handled.
     //! @note Called from dispatch thread.
+    //! @note Discards messages already received through the shared
+    //!       memory transport.
     void handleMessage(PlexilMsgBase *msg);
 
   private:
@@ -216,6 +238,12 @@ namespace PLEXIL {
     // Implementation functions
     //
 
+    //! Route a received message according to its type.
+    //! @param msg The message.
+    //! @note Caller must hold m_dispatchMutex if the shared memory
+    //!       transport is open.
+    void dispatchMessage(PlexilMsgBase *msg);
+
     /**
      * @brief Cache start message of a multi-message sequence
      */
@@ -232,30 +260,55 @@ namespace PLEXIL {
     //! @note Called from dispatch thread.
     void deliverMessages(const std::vector<PlexilMsgBase *> &msgs);
 
-    /**
-     * @brief Helper function for sending a vector of parameters via IPC.
-     * @param args The arguments to convert into messages and send
-     * @param serial The serial to send along with each parameter. This should be the same serial as the header
-     */
-    IPC_RETURN_TYPE sendParameters(std::vector<Value> const &args, IpcSerialNumber serial);
-
-    /**
-     * @brief Helper function for sending a vector of parameters via IPC to a specific executive.
-     * @param args The arguments to convert into messages and send
-     * @param serial The serial to send along with each parameter. This should be the same serial as the header
-     * @param dest The destination executive name
-     */
-    IPC_RETURN_TYPE sendParameters(std::vector<Value> const &args, IpcSerialNumber serial, std::string const &dest);
-
-    /** 
-     * @brief Helper function for sending a vector of pairs via IPC.
-     * @param pairs The pairs to convert into messages and send
-     * @param serial The serial to send along with each parameter.  This should be the same serial s the header.
-     * 
-     * @return The IPC error status.
-     */
-    IPC_RETURN_TYPE sendPairs(std::vector<std::pair<std::string, Value> > const& pairs,
-                              IpcSerialNumber serial);
+    //! Construct parameter messages for a sequence and append them to
+    //! the vector.
+    //! @param args The arguments to convert into messages.
+    //! @param serial The serial of the sequence leader.
+    //! @param msgs The message vector.
+    void appendParameters(std::vector<Value> const &args,
+                          IpcSerialNumber serial,
+                          std::vector<PlexilMsgBase *> &msgs);
+
+    //! Construct pair messages for a sequence and append them to the vector.
+    //! @param pairs The name-value pairs to convert into messages.
+    //! @param serial The serial of the sequence leader.
+    //! @param msgs The message vector.
+    void appendPairs(std::vector<std::pair<std::string, Value> > const &pairs,
+                     IpcSerialNumber serial,
+                     std::vector<PlexilMsgBase *> &msgs);
+
+    //! Publish a complete message sequence, leader first.
+    //! @param msgs The messages.
+    //! @param dest The destination UID; if empty, the sequence is
+    //!             published to all clients.
+    //! @param directTrailers If true, the messages following the leader
+    //!                       are also sent to dest through central;
+    //!                       otherwise they are published to all clients.
+    //! @return The IPC error status.
+    //! @note Uses the shared memory transport for same-host peers
+    //!       when possible, and central otherwise.  A sequence sent
+    //!       through shared memory goes to dest in its entirety.
+    IPC_RETURN_TYPE publishSequence(std::vector<PlexilMsgBase *> const &msgs,
+                                    std::string const &dest,
+                                    bool directTrailers);
+
+    //! Marshal a message sequence into a shared memory record.
+    //! @param msgs The messages.
+    //! @param centralCopy True if the sequence is also published through central.
+    //! @param record Vector to receive the record.
+    //! @return true if successful, false otherwise.
+    bool encodeSharedMemoryRecord(std::vector<PlexilMsgBase *> const &msgs,
+                                  bool centralCopy,
+                                  std::vector<char> &record);
+
+    //! Unmarshal a shared memory record and handle its messages.
+    //! @param data Pointer to the record.
+    //! @param size Length of the record in bytes.
+    //! @note Caller must hold m_dispatchMutex.
+    void handleSharedMemoryRecord(char const *data, size_t size);
+
+    //! Shared memory transport listener thread top level.
+    void sharedMemoryDispatch();
 
     /**
      * @brief Set the error code of the last called IPC method.
@@ -353,7 +406,8 @@ namespace PLEXIL {
     ListenerMap m_registeredListeners;
 
     //* Cache of incomplete received message data
-    //* @note Only accessed from the dispatch thread, therefore no locking required.
+    //* @note Only accessed from the dispatch threads, under m_dispatchMutex
+    //*       when the shared memory transport is open.
     IncompleteMessageMap m_incompletes;
 
     //* @brief Unique ID of this adapter instance
@@ -375,11 +429,37 @@ namespace PLEXIL {
     //* @brief Is the facade initialized?
     bool m_isInitialized;
 
+    //* @brief Same-host transport; null if not in use.
+    std::unique_ptr<SharedMemoryTransport> m_sharedMemory;
+
+    //* @brief The shared memory listener thread
+    std::thread m_sharedMemoryThread;
+
+    //* @brief Serializes message handling between the IPC and shared memory threads.
+    std::mutex m_dispatchMutex;
+
+    //* @brief Central copies yet to arrive of sequences received
+    //         through shared memory.
+    //  @note Guarded by m_dispatchMutex.
+    std::unique_ptr<CentralCopyFilter> m_centralCopies;
+
+    //* @brief Formatters for each message type, for the shared memory transport.
+    std::vector<FORMATTER_PTR> m_formatters;
+
+    //* @brief Name of the central server.
+    std::string m_serverName;
+
     //* @brief Is the facade started?
     bool m_isStarted;
 
     //* @brief True if the dispatch thread should stop.
     bool m_stopDispatchThread;
+
+    //* @brief True if the shared memory listener thread should stop.
+    std::atomic<bool> m_stopSharedMemoryThread;
+
+    //* @brief Should start() open the shared memory transport?
+    bool m_useSharedMemory;
   };
 
   /**
@@ -0,0 +1,859 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "SharedMemoryTransport.hh"
+
+#include "plexil-config.h"
+
+#include "Debug.hh"
+
+#if defined(__linux__) && defined(HAVE_LINUX_FUTEX_H) && defined(HAVE_SYS_MMAN_H)
+#define PLEXIL_HAVE_SHARED_MEMORY_TRANSPORT 1
+#endif
+
+#ifdef PLEXIL_HAVE_SHARED_MEMORY_TRANSPORT
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace PLEXIL
+{
+
+  //
+  // Shared memory layout
+  //
+
+  static constexpr uint32_t SHM_MAGIC = 0x504c5853; // "PLXS"
+  static constexpr uint32_t SHM_VERSION = 1;
+
+  static constexpr size_t UID_SIZE = 128;
+  static constexpr size_t SEGMENT_NAME_SIZE = 64;
+  static constexpr size_t DIRECTORY_SLOTS = 64;
+
+  static constexpr uint64_t RING_CAPACITY = 1 << 20; // must be a power of 2
+  static constexpr size_t MAX_RECORD_SIZE = RING_CAPACITY / 4;
+
+  //! How long a sender waits for space in a full inbox.
+  static constexpr unsigned int SEND_TIMEOUT_MSECS = 500;
+
+  //! One registered participant.
+  struct DirectorySlot
+  {
+    int32_t pid; // 0 if free
+    char uid[UID_SIZE];
+    char inbox[SEGMENT_NAME_SIZE];
+  };
+
+  //! The directory segment, shared by all participants using the same
+  //! central server.
+  struct DirectoryHeader
+  {
+    std::atomic<uint32_t> magic; // set last by the creator
+    uint32_t version;
+    std::atomic<uint32_t> generation; // incremented on every change
+    pthread_mutex_t mutex;            // guards slots
+    DirectorySlot slots[DIRECTORY_SLOTS];
+  };
+
+  //! Header of an inbox segment.  The ring data follows it.
+  struct RingHeader
+  {
+    std::atomic<uint32_t> magic; // set last by the owner
+    uint32_t version;
+    std::atomic<uint32_t> open;  // cleared when the owner closes
+    int32_t pid;                 // owner's process ID
+    uint64_t capacity;
+    pthread_mutex_t mutex;       // serializes senders
+
+    // Written by senders
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<uint32_t> signal; // futex word
+    std::atomic<uint32_t> waiters;
+
+    // Written by the owner
+    alignas(64) std::atomic<uint64_t> head;
+  };
+
+  static constexpr size_t RING_DATA_OFFSET = (sizeof(RingHeader) + 63) & ~((size_t) 63);
+  static constexpr size_t RING_SEGMENT_SIZE = RING_DATA_OFFSET + RING_CAPACITY;
+
+  //! Precedes every record in the ring.
+  struct RecordHeader
+  {
+    uint32_t length; // of the record proper
+    uint32_t kind;
+  };
+
+  static constexpr uint32_t RECORD_DATA = 0;
+  static constexpr uint32_t RECORD_WRAP = 1; // skip to start of ring
+
+  static inline uint64_t recordSpace(size_t length)
+  {
+    return sizeof(RecordHeader) + ((length + 7) & ~((size_t) 7));
+  }
+
+  static inline RingHeader *ringHeader(void *base)
+  {
+    return reinterpret_cast<RingHeader *>(base);
+  }
+
+  static inline char *ringData(void *base)
+  {
+    return reinterpret_cast<char *>(base) + RING_DATA_OFFSET;
+  }
+
+  //
+  // Helpers
+  //
+
+  static void futexWait(std::atomic<uint32_t> *word, uint32_t expected,
+                        unsigned int timeoutMsecs)
+  {
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMsecs / 1000;
+    timeout.tv_nsec = (long) (timeoutMsecs % 1000) * 1000000;
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT,
+            expected, &timeout, nullptr, 0);
+  }
+
+  static void futexWake(std::atomic<uint32_t> *word)
+  {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE,
+            INT_MAX, nullptr, nullptr, 0);
+  }
+
+  static bool initRobustMutex(pthread_mutex_t *mutex)
+  {
+    pthread_mutexattr_t attr;
+    if (pthread_mutexattr_init(&attr))
+      return false;
+    bool result =
+      !pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED)
+      && !pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST)
+      && !pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return result;
+  }
+
+  // A previous holder may have died holding the lock.  The data it
+  // guards is never left inconsistent, so simply recover the lock.
+  static bool lockRobustMutex(pthread_mutex_t *mutex)
+  {
+    int status = pthread_mutex_lock(mutex);
+    if (status == EOWNERDEAD)
+      return !pthread_mutex_consistent(mutex);
+    return !status;
+  }
+
+  static bool processExists(int32_t pid)
+  {
+    return !(kill((pid_t) pid, 0) && errno == ESRCH);
+  }
+
+  // FNV-1a
+  static uint32_t hashName(std::string const &name)
+  {
+    uint32_t result = 2166136261u;
+    for (char c : name) {
+      result ^= (unsigned char) c;
+      result *= 16777619u;
+    }
+    return result;
+  }
+
+  //
+  // Segment mapping
+  //
+
+  struct SharedMemorySegment
+  {
+    SharedMemorySegment(std::string const &nam, void *bas, size_t siz, bool own)
+      : name(nam),
+        base(bas),
+        size(siz),
+        owner(own)
+    {
+    }
+
+    ~SharedMemorySegment()
+    {
+      munmap(base, size);
+      if (owner)
+        shm_unlink(name.c_str());
+    }
+
+    std::string name;
+    void *base;
+    size_t size;
+    bool owner;
+  };
+
+  //! Create a new zero-filled segment.
+  //! @return The mapping, or null if the segment exists or can't be created.
+  static SharedMemorySegment *createSegment(std::string const &name,
+                                                       size_t size,
+                                                       bool owner)
+  {
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+      return nullptr;
+    if (ftruncate(fd, size)) {
+      close(fd);
+      shm_unlink(name.c_str());
+      return nullptr;
+    }
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+      shm_unlink(name.c_str());
+      return nullptr;
+    }
+    return new SharedMemorySegment(name, base, size, owner);
+  }
+
+  //! Map an existing segment of the given size.
+  //! @return The mapping, or null if the segment can't be mapped.
+  static SharedMemorySegment *openSegment(std::string const &name,
+                                                     size_t size)
+  {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+      return nullptr;
+    // The creator may not have sized it yet
+    struct stat st;
+    for (int i = 0; ; ++i) {
+      if (fstat(fd, &st) || i >= 1000) {
+        close(fd);
+        return nullptr;
+      }
+      if ((size_t) st.st_size >= size)
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+      return nullptr;
+    return new SharedMemorySegment(name, base, size, false);
+  }
+
+  //! Wait a bounded time for the segment's creator to finish initializing it.
+  static bool awaitMagic(std::atomic<uint32_t> const &magic)
+  {
+    for (int i = 0; i < 1000; ++i) {
+      if (magic.load(std::memory_order_acquire) == SHM_MAGIC)
+        return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  }
+
+  //! Create or map the directory segment.
+  static SharedMemorySegment *openDirectory(std::string const &name)
+  {
+    // Second attempt is made after discarding a directory whose
+    // creator died before initializing it
+    for (int attempt = 0; attempt < 2; ++attempt) {
+      // The directory persists after its creator exits
+      SharedMemorySegment *result =
+        createSegment(name, sizeof(DirectoryHeader), false);
+      if (result) {
+        DirectoryHeader *dir = reinterpret_cast<DirectoryHeader *>(result->base);
+        dir->version = SHM_VERSION;
+        if (!initRobustMutex(&dir->mutex)) {
+          shm_unlink(name.c_str());
+          delete result;
+          return nullptr;
+        }
+        dir->magic.store(SHM_MAGIC, std::memory_order_release);
+        debugMsg("SharedMemoryTransport:open", " created directory " << name);
+        return result;
+      }
+
+      result = openSegment(name, sizeof(DirectoryHeader));
+      if (!result) {
+        if (errno == ENOENT)
+          continue; // creator gave up; try again
+        return nullptr;
+      }
+      DirectoryHeader *dir = reinterpret_cast<DirectoryHeader *>(result->base);
+      if (awaitMagic(dir->magic)) {
+        if (dir->version == SHM_VERSION)
+          return result;
+        debugMsg("SharedMemoryTransport:open",
+                 " directory " << name << " has incompatible version " << dir->version);
+        delete result;
+        return nullptr;
+      }
+      debugMsg("SharedMemoryTransport:open",
+               " directory " << name << " was never initialized, replacing it");
+      delete result;
+      shm_unlink(name.c_str());
+    }
+    return nullptr;
+  }
+
+  //
+  // SharedMemoryTransport
+  //
+
+  SharedMemoryTransport::SharedMemoryTransport()
+    : m_directory(),
+      m_inbox(),
+      m_peers(),
+      m_peerMutex(),
+      m_uid(),
+      m_peerGeneration(0),
+      m_slot(DIRECTORY_SLOTS)
+  {
+  }
+
+  SharedMemoryTransport::~SharedMemoryTransport()
+  {
+    close();
+  }
+
+  bool SharedMemoryTransport::isSupported()
+  {
+    return true;
+  }
+
+  bool SharedMemoryTransport::isOpen() const
+  {
+    return (bool) m_inbox;
+  }
+
+  bool SharedMemoryTransport::open(std::string const &serverName,
+                                   std::string const &uid)
+  {
+    if (m_inbox)
+      return true;
+    if (uid.empty() || uid.size() >= UID_SIZE) {
+      debugMsg("SharedMemoryTransport:open",
+               " unique ID \"" << uid << "\" is empty or too long");
+      return false;
+    }
+
+    // Segment names are scoped by user and central server
+    static std::atomic<unsigned int> sl_inboxCount(0);
+    uint32_t serverHash = hashName(serverName);
+    char dirName[SEGMENT_NAME_SIZE];
+    snprintf(dirName, SEGMENT_NAME_SIZE, "/plexil-ipc-%u-%08x",
+             (unsigned int) getuid(), serverHash);
+    char inboxName[SEGMENT_NAME_SIZE];
+    snprintf(inboxName, SEGMENT_NAME_SIZE, "/plexil-ipc-%u-%08x-%d-%u",
+             (unsigned int) getuid(), serverHash, (int) getpid(),
+             sl_inboxCount++);
+
+    m_directory.reset(openDirectory(dirName));
+    if (!m_directory) {
+      debugMsg("SharedMemoryTransport:open",
+               " unable to open directory " << dirName);
+      return false;
+    }
+
+    // Construct the inbox
+    m_inbox.reset(createSegment(inboxName, RING_SEGMENT_SIZE, true));
+    if (!m_inbox) {
+      debugMsg("SharedMemoryTransport:open",
+               " unable to create inbox " << inboxName << ", errno = " << errno);
+      m_directory.reset();
+      return false;
+    }
+    RingHeader *ring = ringHeader(m_inbox->base);
+    ring->version = SHM_VERSION;
+    ring->pid = (int32_t) getpid();
+    ring->capacity = RING_CAPACITY;
+    if (!initRobustMutex(&ring->mutex)) {
+      m_inbox.reset();
+      m_directory.reset();
+      return false;
+    }
+    ring->open.store(1, std::memory_order_relaxed);
+    ring->magic.store(SHM_MAGIC, std::memory_order_release);
+
+    // Register it
+    DirectoryHeader *dir = reinterpret_cast<DirectoryHeader *>(m_directory->base);
+    if (!lockRobustMutex(&dir->mutex)) {
+      m_inbox.reset();
+      m_directory.reset();
+      return false;
+    }
+    size_t freeSlot = DIRECTORY_SLOTS;
+    bool duplicate = false;
+    for (size_t i = 0; i < DIRECTORY_SLOTS; ++i) {
+      DirectorySlot &slot = dir->slots[i];
+      if (slot.pid && !processExists(slot.pid)) {
+        // Reclaim slot and inbox of a participant which exited without closing
+        debugMsg("SharedMemoryTransport:open",
+                 " reclaiming slot of defunct participant " << slot.uid);
+        shm_unlink(slot.inbox);
+        memset(&slot, 0, sizeof(DirectorySlot));
+      }
+      if (!slot.pid) {
+        if (freeSlot == DIRECTORY_SLOTS)
+          freeSlot = i;
+      }
+      else if (uid == slot.uid) {
+        duplicate = true;
+      }
+    }
+    if (!duplicate && freeSlot != DIRECTORY_SLOTS) {
+      DirectorySlot &slot = dir->slots[freeSlot];
+      strncpy(slot.uid, uid.c_str(), UID_SIZE - 1);
+      strncpy(slot.inbox, inboxName, SEGMENT_NAME_SIZE - 1);
+      slot.pid = ring->pid;
+      dir->generation.fetch_add(1);
+    }
+    pthread_mutex_unlock(&dir->mutex);
+
+    if (duplicate || freeSlot == DIRECTORY_SLOTS) {
+      debugMsg("SharedMemoryTransport:open",
+               ' ' << uid << (duplicate ? " is already registered" : " directory is full"));
+      m_inbox.reset();
+      m_directory.reset();
+      return false;
+    }
+
+    m_uid = uid;
+    m_slot = freeSlot;
+    m_peerGeneration = 0;
+    debugMsg("SharedMemoryTransport:open",
+             ' ' << uid << " registered inbox " << inboxName);
+    return true;
+  }
+
+  void SharedMemoryTransport::close()
+  {
+    if (!m_inbox)
+      return;
+
+    ringHeader(m_inbox->base)->open.store(0, std::memory_order_release);
+
+    DirectoryHeader *dir = reinterpret_cast<DirectoryHeader *>(m_directory->base);
+    if (lockRobustMutex(&dir->mutex)) {
+      DirectorySlot &slot = dir->slots[m_slot];
+      if (slot.pid == ringHeader(m_inbox->base)->pid && m_uid == slot.uid) {
+        memset(&slot, 0, sizeof(DirectorySlot));
+        dir->generation.fetch_add(1);
+      }
+      pthread_mutex_unlock(&dir->mutex);
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(m_peerMutex);
+      m_peers.clear();
+    }
+    m_inbox.reset();
+    m_directory.reset();
+    m_slot = DIRECTORY_SLOTS;
+    debugMsg("SharedMemoryTransport:close", ' ' << m_uid << " closed");
+  }
+
+  void SharedMemoryTransport::refreshPeers()
+  {
+    DirectoryHeader *dir = reinterpret_cast<DirectoryHeader *>(m_directory->base);
+    uint32_t generation = dir->generation.load();
+    if (generation == m_peerGeneration)
+      return;
+
+    // Copy out the live entries
+    std::vector<DirectorySlot> entries;
+    if (!lockRobustMutex(&dir->mutex))
+      return;
+    generation = dir->generation.load();
+    for (size_t i = 0; i < DIRECTORY_SLOTS; ++i) {
+      if (i != m_slot && dir->slots[i].pid)
+        entries.push_back(dir->slots[i]);
+    }
+    pthread_mutex_unlock(&dir->mutex);
+
+    PeerMap peers;
+    for (DirectorySlot const &entry : entries) {
+      if (!processExists(entry.pid))
+        continue;
+      std::string const uid(entry.uid);
+      PeerMap::iterator it = m_peers.find(uid);
+      if (it != m_peers.end() && it->second->name == entry.inbox) {
+        peers[uid] = std::move(it->second);
+        continue;
+      }
+      SegmentPtr inbox(openSegment(entry.inbox, RING_SEGMENT_SIZE));
+      if (!inbox)
+        continue;
+      RingHeader *ring = ringHeader(inbox->base);
+      if (ring->magic.load(std::memory_order_acquire) != SHM_MAGIC
+          || ring->version != SHM_VERSION
+          || ring->capacity != RING_CAPACITY
+          || ring->pid != entry.pid
+          || !ring->open.load(std::memory_order_acquire))
+        continue;
+      debugMsg("SharedMemoryTransport:refreshPeers",
+               ' ' << m_uid << " found peer " << uid);
+      peers[uid] = std::move(inbox);
+    }
+    m_peers.swap(peers);
+    m_peerGeneration = generation;
+  }
+
+  void SharedMemoryTransport::dropPeer(std::string const &uid,
+                                       SharedMemorySegment const *inbox)
+  {
+    PeerMap::iterator it = m_peers.find(uid);
+    if (it == m_peers.end() || it->second.get() != inbox)
+      return;
+    debugMsg("SharedMemoryTransport:dropPeer", ' ' << m_uid << " dropping peer " << uid);
+    m_peers.erase(it);
+  }
+
+  void SharedMemoryTransport::getPeers(std::vector<std::string> &uids)
+  {
+    uids.clear();
+    if (!m_inbox)
+      return;
+    std::lock_guard<std::mutex> guard(m_peerMutex);
+    refreshPeers();
+    for (PeerMap::value_type const &peer : m_peers)
+      uids.push_back(peer.first);
+  }
+
+  bool SharedMemoryTransport::isPeer(std::string const &uid)
+  {
+    if (!m_inbox)
+      return false;
+    std::lock_guard<std::mutex> guard(m_peerMutex);
+    refreshPeers();
+    return m_peers.find(uid) != m_peers.end();
+  }
+
+  bool SharedMemoryTransport::send(std::string const &uid,
+                                   char const *data,
+                                   size_t size)
+  {
+    if (!m_inbox || size > MAX_RECORD_SIZE)
+      return false;
+
+    // Don't hold the peer table while waiting on the inbox
+    PeerPtr inbox;
+    {
+      std::lock_guard<std::mutex> guard(m_peerMutex);
+      refreshPeers();
+      PeerMap::const_iterator it = m_peers.find(uid);
+      if (it == m_peers.end())
+        return false;
+      inbox = it->second;
+    }
+    void *base = inbox->base;
+    RingHeader *ring = ringHeader(base);
+    uint64_t const capacity = ring->capacity;
+    uint64_t const needed = recordSpace(size);
+
+    std::chrono::steady_clock::time_point const deadline =
+      std::chrono::steady_clock::now()
+      + std::chrono::milliseconds(SEND_TIMEOUT_MSECS);
+    bool usable = lockRobustMutex(&ring->mutex);
+    uint64_t tail, position, contiguous;
+    while (usable) {
+      if (!ring->open.load(std::memory_order_acquire)) {
+        pthread_mutex_unlock(&ring->mutex);
+        usable = false;
+        break;
+      }
+      tail = ring->tail.load(std::memory_order_relaxed);
+      uint64_t head = ring->head.load(std::memory_order_acquire);
+      position = tail & (capacity - 1);
+      contiguous = capacity - position;
+      uint64_t total = needed + (contiguous < needed ? contiguous : 0);
+      if (capacity - (tail - head) >= total)
+        break;
+
+      // Inbox is full
+      pthread_mutex_unlock(&ring->mutex);
+      if (!processExists(ring->pid)) {
+        usable = false;
+        break;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        // Peer is slow, not gone; only this record goes another way
+        debugMsg("SharedMemoryTransport:send",
+                 ' ' << m_uid << " inbox of " << uid << " is full, giving up on record");
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+      usable = lockRobustMutex(&ring->mutex);
+    }
+    if (!usable) {
+      std::lock_guard<std::mutex> guard(m_peerMutex);
+      dropPeer(uid, inbox.get());
+      return false;
+    }
+
+    char *ringBase = ringData(base);
+    if (contiguous < needed) {
+      RecordHeader *wrap = reinterpret_cast<RecordHeader *>(ringBase + position);
+      wrap->length = 0;
+      wrap->kind = RECORD_WRAP;
+      tail += contiguous;
+      position = 0;
+    }
+    RecordHeader *header = reinterpret_cast<RecordHeader *>(ringBase + position);
+    header->length = (uint32_t) size;
+    header->kind = RECORD_DATA;
+    memcpy(header + 1, data, size);
+    ring->tail.store(tail + needed, std::memory_order_release);
+    pthread_mutex_unlock(&ring->mutex);
+
+    ring->signal.fetch_add(1);
+    if (ring->waiters.load())
+      futexWake(&ring->signal);
+    return true;
+  }
+
+  size_t SharedMemoryTransport::receive(RecordHandler const &handler)
+  {
+    if (!m_inbox)
+      return 0;
+    RingHeader *ring = ringHeader(m_inbox->base);
+    char *ringBase = ringData(m_inbox->base);
+    uint64_t const capacity = ring->capacity;
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    size_t result = 0;
+    while (head != ring->tail.load(std::memory_order_acquire)) {
+      uint64_t position = head & (capacity - 1);
+      RecordHeader const *header =
+        reinterpret_cast<RecordHeader const *>(ringBase + position);
+      // Any process may write this ring, so check the header before using it
+      uint32_t const kind = header->kind;
+      uint32_t const length = header->length;
+      if (kind == RECORD_WRAP) {
+        head += capacity - position;
+      }
+      else if (kind == RECORD_DATA
+               && length <= MAX_RECORD_SIZE
+               && recordSpace(length) <= capacity - position) {
+        // Record remains in place until head is advanced
+        handler(reinterpret_cast<char const *>(header + 1), length);
+        head += recordSpace(length);
+        ++result;
+      }
+      else {
+        // Can't find the next record; discard the rest
+        debugMsg("SharedMemoryTransport:receive",
+                 ' ' << m_uid << " discarding inbox after malformed record at "
+                 << position);
+        head = ring->tail.load(std::memory_order_acquire);
+      }
+      ring->head.store(head, std::memory_order_release);
+    }
+    return result;
+  }
+
+  void SharedMemoryTransport::wait(unsigned int timeoutMsecs)
+  {
+    if (!m_inbox) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMsecs));
+      return;
+    }
+    RingHeader *ring = ringHeader(m_inbox->base);
+    ring->waiters.fetch_add(1);
+    uint32_t signal = ring->signal.load();
+    if (ring->tail.load(std::memory_order_acquire)
+        == ring->head.load(std::memory_order_relaxed))
+      futexWait(&ring->signal, signal, timeoutMsecs);
+    ring->waiters.fetch_sub(1);
+  }
+
+  void SharedMemoryTransport::wake()
+  {
+    if (!m_inbox)
+      return;
+    RingHeader *ring = ringHeader(m_inbox->base);
+    ring->signal.fetch_add(1);
+    futexWake(&ring->signal);
+  }
+
+}
+
+#else // !PLEXIL_HAVE_SHARED_MEMORY_TRANSPORT
+
+#include <chrono>
+#include <thread>
+
+namespace PLEXIL
+{
+
+  //
+  // Stub implementation for platforms without futexes
+  //
+
+  struct SharedMemorySegment
+  {
+  };
+
+  SharedMemoryTransport::SharedMemoryTransport()
+    : m_directory(),
+      m_inbox(),
+      m_peers(),
+      m_peerMutex(),
+      m_uid(),
+      m_peerGeneration(0),
+      m_slot(0)
+  {
+  }
+
+  SharedMemoryTransport::~SharedMemoryTransport()
+  {
+  }
+
+  bool SharedMemoryTransport::isSupported()
+  {
+    return false;
+  }
+
+  bool SharedMemoryTransport::isOpen() const
+  {
+    return false;
+  }
+
+  bool SharedMemoryTransport::open(std::string const & /* serverName */,
+                                   std::string const & /* uid */)
+  {
+    debugMsg("SharedMemoryTransport:open", " not supported on this platform");
+    return false;
+  }
+
+  void SharedMemoryTransport::close()
+  {
+  }
+
+  void SharedMemoryTransport::refreshPeers()
+  {
+  }
+
+  void SharedMemoryTransport::dropPeer(std::string const & /* uid */,
+                                       SharedMemorySegment const * /* inbox */)
+  {
+  }
+
+  void SharedMemoryTransport::getPeers(std::vector<std::string> &uids)
+  {
+    uids.clear();
+  }
+
+  bool SharedMemoryTransport::isPeer(std::string const & /* uid */)
+  {
+    return false;
+  }
+
+  bool SharedMemoryTransport::send(std::string const & /* uid */,
+                                   char const * /* data */,
+                                   size_t /* size */)
+  {
+    return false;
+  }
+
+  size_t SharedMemoryTransport::receive(RecordHandler const & /* handler */)
+  {
+    return 0;
+  }
+
+  void SharedMemoryTransport::wait(unsigned int timeoutMsecs)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMsecs));
+  }
+
+  void SharedMemoryTransport::wake()
+  {
+  }
+
+}
+
+#endif // PLEXIL_HAVE_SHARED_MEMORY_TRANSPORT
+
+namespace PLEXIL
+{
+
+  //
+  // CentralCopyFilter
+  //
+
+  CentralCopyFilter::CentralCopyFilter(size_t maxPending)
+    : m_expected(),
+      m_order(),
+      m_maxPending(maxPending)
+  {
+  }
+
+  void CentralCopyFilter::expect(std::string const &senderUID, uint32_t serial, size_t count)
+  {
+    MessageId const id(senderUID, serial);
+    m_expected[id] += count;
+    m_order.push_back(id);
+    if (m_order.size() > m_maxPending) {
+      m_expected.erase(m_order.front());
+      m_order.pop_front();
+    }
+  }
+
+  bool CentralCopyFilter::discard(std::string const &senderUID, uint32_t serial)
+  {
+    std::map<MessageId, size_t>::iterator it =
+      m_expected.find(MessageId(senderUID, serial));
+    if (it == m_expected.end())
+      return false;
+    if (!--it->second)
+      m_expected.erase(it);
+    return true;
+  }
+
+  size_t CentralCopyFilter::pending() const
+  {
+    return m_expected.size();
+  }
+
+  void CentralCopyFilter::clear()
+  {
+    m_expected.clear();
+    m_order.clear();
+  }
+
+}
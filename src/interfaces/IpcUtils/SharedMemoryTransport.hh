@@ -0,0 +1,230 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_SHARED_MEMORY_TRANSPORT_HH
+#define PLEXIL_SHARED_MEMORY_TRANSPORT_HH
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PLEXIL
+{
+  // Forward reference
+  struct SharedMemorySegment;
+
+  //! @class SharedMemoryTransport
+  //! @brief Same-host message transport for IpcFacade.
+  //!
+  //! Each participant owns a shared memory inbox, a ring buffer of
+  //! opaque records, and registers it in a per-user, per-central
+  //! directory segment.  Any number of same-host senders may append
+  //! records to an inbox; only the owner reads it.  A blocked reader is
+  //! woken with a futex in the inbox header.
+  //!
+  //! Participants which are not registered in the directory, or whose
+  //! inboxes are full, are not reachable through this transport; the
+  //! caller is expected to fall back to central in that case.
+  //!
+  //! @note Only implemented on Linux.  Elsewhere open() always fails.
+  class SharedMemoryTransport final
+  {
+  public:
+
+    //! Function called for each record received.
+    using RecordHandler = std::function<void(char const *, size_t)>;
+
+    //! Default constructor.
+    SharedMemoryTransport();
+
+    //! Destructor.
+    ~SharedMemoryTransport();
+
+    //! Is this transport implemented on this platform?
+    static bool isSupported();
+
+    //! Create this participant's inbox and register it in the directory.
+    //! @param serverName The central server name; only peers using
+    //!                   the same name will be found.
+    //! @param uid The unique ID of this participant.
+    //! @return true if successful, false otherwise.
+    bool open(std::string const &serverName, std::string const &uid);
+
+    //! Unregister and destroy this participant's inbox, and release
+    //! all peer inboxes.
+    void close();
+
+    //! Is the transport open?
+    bool isOpen() const;
+
+    //! Get the unique IDs of all other live participants.
+    //! @param uids Vector to receive the IDs.
+    void getPeers(std::vector<std::string> &uids);
+
+    //! Is the named participant reachable through this transport?
+    //! @param uid The unique ID.
+    bool isPeer(std::string const &uid);
+
+    //! Append one record to a peer's inbox.
+    //! @param uid The unique ID of the peer.
+    //! @param data Pointer to the record.
+    //! @param size Length of the record in bytes.
+    //! @return true if the record was delivered to the inbox, false otherwise.
+    //! @note Waits a bounded time for space if the inbox is full.  The
+    //!       peer is kept if the wait times out, so that only this
+    //!       record must be sent by other means.
+    bool send(std::string const &uid, char const *data, size_t size);
+
+    //! Call the handler on every record in this participant's inbox,
+    //! in order, without blocking.
+    //! @param handler The function to call.
+    //! @return The number of records handled.
+    //! @note Only one thread at a time may call this function.
+    size_t receive(RecordHandler const &handler);
+
+    //! Block until the inbox is not empty, wake() is called, or the
+    //! timeout expires.
+    //! @param timeoutMsecs Maximum wait in milliseconds.
+    void wait(unsigned int timeoutMsecs);
+
+    //! Wake any thread blocked in wait().
+    void wake();
+
+  private:
+
+    // Not implemented
+    SharedMemoryTransport(SharedMemoryTransport const &) = delete;
+    SharedMemoryTransport(SharedMemoryTransport &&) = delete;
+    SharedMemoryTransport &operator=(SharedMemoryTransport const &) = delete;
+    SharedMemoryTransport &operator=(SharedMemoryTransport &&) = delete;
+
+    //! Refresh the peer table if the directory has changed.
+    //! @note Caller must hold m_peerMutex.
+    void refreshPeers();
+
+    //! Forget a peer whose inbox is no longer usable.
+    //! @param uid The unique ID of the peer.
+    //! @param inbox The unusable inbox.  The peer is kept if the
+    //!              peer table has since opened another.
+    //! @note Caller must hold m_peerMutex.
+    void dropPeer(std::string const &uid, SharedMemorySegment const *inbox);
+
+    using SegmentPtr = std::unique_ptr<SharedMemorySegment>;
+
+    // Shared so that send() can use an inbox without holding m_peerMutex
+    using PeerPtr = std::shared_ptr<SharedMemorySegment>;
+    using PeerMap = std::map<std::string, PeerPtr>;
+
+    //! The directory segment.
+    SegmentPtr m_directory;
+
+    //! This participant's inbox.
+    SegmentPtr m_inbox;
+
+    //! Inboxes of other participants, keyed by unique ID.
+    PeerMap m_peers;
+
+    //! Guards m_peers and m_peerGeneration.
+    std::mutex m_peerMutex;
+
+    //! This participant's unique ID.
+    std::string m_uid;
+
+    //! Directory generation at the last peer table refresh.
+    uint32_t m_peerGeneration;
+
+    //! Index of this participant's directory slot.
+    size_t m_slot;
+  };
+
+  //! @class CentralCopyFilter
+  //! @brief Recognizes the copies arriving through central of message
+  //!        sequences already received through shared memory.
+  //!
+  //! Broadcasts are sent both ways, so a same-host receiver gets each
+  //! one twice.  The filter counts the central copies still expected of
+  //! each sequence, keyed by sender and serial.  The number of
+  //! sequences remembered is bounded, in case central drops a copy.
+  class CentralCopyFilter final
+  {
+  public:
+
+    //! Constructor.
+    //! @param maxPending Maximum number of sequences to remember.
+    CentralCopyFilter(size_t maxPending = 4096);
+
+    //! Destructor.
+    ~CentralCopyFilter() = default;
+
+    //! Expect central copies of a sequence received through shared memory.
+    //! @param senderUID The unique ID of the sender.
+    //! @param serial The serial number of the sequence leader.
+    //! @param count The number of messages in the sequence.
+    //! @note Forgets the oldest sequence if the bound is exceeded.
+    void expect(std::string const &senderUID, uint32_t serial, size_t count);
+
+    //! Is this message from central a copy of one already received?
+    //! @param senderUID The unique ID of the sender.
+    //! @param serial The serial number of the message.
+    //! @return true if the message should be discarded, false otherwise.
+    bool discard(std::string const &senderUID, uint32_t serial);
+
+    //! Get the number of sequences with copies still expected.
+    size_t pending() const;
+
+    //! Forget all expected copies.
+    void clear();
+
+  private:
+
+    // Not implemented
+    CentralCopyFilter(CentralCopyFilter const &) = delete;
+    CentralCopyFilter(CentralCopyFilter &&) = delete;
+    CentralCopyFilter &operator=(CentralCopyFilter const &) = delete;
+    CentralCopyFilter &operator=(CentralCopyFilter &&) = delete;
+
+    using MessageId = std::pair<std::string, uint32_t>;
+
+    //! Count of copies yet to arrive of each sequence.
+    std::map<MessageId, size_t> m_expected;
+
+    //! Insertion order of m_expected, to bound its size.
+    std::deque<MessageId> m_order;
+
+    //! Maximum number of sequences to remember.
+    size_t const m_maxPending;
+  };
+
+}
+
+#endif // PLEXIL_SHARED_MEMORY_TRANSPORT_HH
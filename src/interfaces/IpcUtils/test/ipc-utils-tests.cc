@@ -0,0 +1,294 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Unit tests for the IpcFacade shared memory transport
+//
+
+#include "SharedMemoryTransport.hh"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h> // getpid()
+
+using namespace PLEXIL;
+
+// Same as the transport's limits
+static constexpr size_t RING_CAPACITY = 1 << 20;
+static constexpr size_t RECORD_SIZE = RING_CAPACITY / 4 - 64;
+
+// All runs share one directory segment; IDs are unique to this process
+static std::string const s_serverName("ipc-utils-tests");
+
+static std::string uid(char const *name)
+{
+  return std::to_string(getpid()) + '-' + name;
+}
+
+//! Fill a record with a pattern identifying it.
+static std::vector<char> makeRecord(size_t size, unsigned int n)
+{
+  std::vector<char> record(size);
+  for (size_t i = 0; i < size; ++i)
+    record[i] = (char) (n + i);
+  return record;
+}
+
+//! Receives every record in the inbox, checking each against its pattern.
+class Checker final
+{
+public:
+  Checker(SharedMemoryTransport &transport)
+    : m_transport(transport),
+      m_next(0),
+      m_valid(true)
+  {
+  }
+
+  size_t receive(size_t size)
+  {
+    return m_transport.receive([this, size](char const *data, size_t len) -> void
+                               {
+                                 if (len != size
+                                     || std::vector<char>(data, data + len) != makeRecord(size, m_next))
+                                   m_valid = false;
+                                 ++m_next;
+                               });
+  }
+
+  unsigned int received() const
+  {
+    return m_next;
+  }
+
+  bool valid() const
+  {
+    return m_valid;
+  }
+
+private:
+  SharedMemoryTransport &m_transport;
+  unsigned int m_next;
+  bool m_valid;
+};
+
+static bool openPair(SharedMemoryTransport &receiver, SharedMemoryTransport &sender)
+{
+  if (!receiver.open(s_serverName, uid("receiver"))
+      || !sender.open(s_serverName, uid("sender"))) {
+    std::cerr << "Unable to open shared memory transport" << std::endl;
+    return false;
+  }
+  if (!sender.isPeer(uid("receiver"))) {
+    std::cerr << "Sender doesn't see receiver" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Records which don't fit before the end of the ring are preceded by
+// a wrap marker, and must arrive intact and in order.
+static bool testWrap()
+{
+  std::cout << "Testing records which wrap around the ring" << std::endl;
+  SharedMemoryTransport receiver, sender;
+  if (!openPair(receiver, sender))
+    return false;
+
+  Checker checker(receiver);
+  unsigned int sent = 0;
+  // Seven records of a quarter ring each: the fifth one wraps
+  for (unsigned int pass = 0; pass < 3; ++pass) {
+    size_t const count = pass ? 2 : 3;
+    for (size_t i = 0; i < count; ++i) {
+      std::vector<char> const record = makeRecord(RECORD_SIZE, sent++);
+      if (!sender.send(uid("receiver"), record.data(), record.size())) {
+        std::cerr << "Send of record " << sent - 1 << " failed" << std::endl;
+        return false;
+      }
+    }
+    // The wrap marker is not counted
+    if (checker.receive(RECORD_SIZE) != count) {
+      std::cerr << "Wrong number of records received on pass " << pass << std::endl;
+      return false;
+    }
+  }
+
+  if (!checker.valid() || checker.received() != sent) {
+    std::cerr << "Records received don't match those sent" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// A send to a full inbox fails after a bounded wait, without holding
+// up other users of the transport, and the sender keeps the peer.
+static bool testFullInbox()
+{
+  std::cout << "Testing send to a full inbox" << std::endl;
+  SharedMemoryTransport receiver, sender;
+  if (!openPair(receiver, sender))
+    return false;
+
+  // Four records of a quarter ring each leave too little space for
+  // a fifth, contiguous or wrapped
+  unsigned int sent = 0;
+  for (; sent < 4; ++sent) {
+    std::vector<char> const record = makeRecord(RECORD_SIZE, sent);
+    if (!sender.send(uid("receiver"), record.data(), record.size())) {
+      std::cerr << "Send of record " << sent << " failed" << std::endl;
+      return false;
+    }
+  }
+
+  std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+  std::vector<char> const overflow = makeRecord(RECORD_SIZE, sent);
+  bool overflowSent = true;
+  std::thread overflowThread([&]() -> void
+                             {
+                               overflowSent =
+                                 sender.send(uid("receiver"), overflow.data(), overflow.size());
+                             });
+
+  // The peer table is usable while the send waits
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::chrono::steady_clock::time_point const queried = std::chrono::steady_clock::now();
+  bool const peerWhileWaiting = sender.isPeer(uid("receiver"));
+  std::chrono::milliseconds const queryTime =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - queried);
+  overflowThread.join();
+
+  if (overflowSent) {
+    std::cerr << "Send to full inbox succeeded" << std::endl;
+    return false;
+  }
+  std::chrono::milliseconds const waited =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+  if (waited.count() < 400) {
+    std::cerr << "Send to full inbox failed after only " << waited.count() << " ms" << std::endl;
+    return false;
+  }
+  if (!peerWhileWaiting || queryTime.count() > 50) {
+    std::cerr << "Peer query blocked for " << queryTime.count()
+              << " ms by a send to a full inbox" << std::endl;
+    return false;
+  }
+  if (!sender.isPeer(uid("receiver"))) {
+    std::cerr << "Sender dropped the full peer" << std::endl;
+    return false;
+  }
+
+  // Nothing sent before the inbox filled was lost
+  Checker checker(receiver);
+  if (checker.receive(RECORD_SIZE) != sent || !checker.valid()) {
+    std::cerr << "Records received don't match those sent" << std::endl;
+    return false;
+  }
+
+  // Once the inbox drains, records go through again
+  std::vector<char> const next = makeRecord(RECORD_SIZE, sent);
+  if (!sender.send(uid("receiver"), next.data(), next.size())) {
+    std::cerr << "Send after the inbox drained failed" << std::endl;
+    return false;
+  }
+  ++sent;
+  if (checker.receive(RECORD_SIZE) != 1 || checker.received() != sent || !checker.valid()) {
+    std::cerr << "Record sent after the inbox drained doesn't match" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static bool testCentralCopies()
+{
+  std::cout << "Testing suppression of central copies" << std::endl;
+  CentralCopyFilter filter(2);
+
+  // Every message of a sequence has the leader's serial
+  filter.expect("a", 1, 3);
+  bool result = filter.discard("a", 1)
+    && filter.discard("a", 1)
+    && filter.discard("a", 1)
+    && !filter.discard("a", 1);
+  if (!result) {
+    std::cerr << "Wrong number of copies discarded" << std::endl;
+    return false;
+  }
+  if (filter.pending()) {
+    std::cerr << "Sequence not forgotten after its last copy" << std::endl;
+    return false;
+  }
+
+  // Keyed by sender and serial
+  filter.expect("a", 2, 1);
+  if (filter.discard("b", 2) || filter.discard("a", 3)
+      || !filter.discard("a", 2)) {
+    std::cerr << "Copy matched the wrong sequence" << std::endl;
+    return false;
+  }
+
+  // The oldest sequence is forgotten when the bound is exceeded
+  filter.expect("a", 4, 1);
+  filter.expect("a", 5, 1);
+  filter.expect("a", 6, 1);
+  if (filter.pending() != 2 || filter.discard("a", 4)
+      || !filter.discard("a", 5) || !filter.discard("a", 6)) {
+    std::cerr << "Bound on pending sequences not respected" << std::endl;
+    return false;
+  }
+
+  filter.expect("a", 7, 1);
+  filter.clear();
+  if (filter.pending() || filter.discard("a", 7)) {
+    std::cerr << "Sequence not forgotten by clear()" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  bool result = testCentralCopies();
+  if (SharedMemoryTransport::isSupported()) {
+    result = testWrap() && result;
+    result = testFullInbox() && result;
+  }
+  else
+    std::cout << "Shared memory transport not supported, skipping ring tests" << std::endl;
+
+  if (!result) {
+    std::cerr << "IpcUtils tests FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "IpcUtils tests passed" << std::endl;
+  return 0;
+}
+
+// EOF
@@ -201,6 +201,10 @@ namespace PLEXIL
       if (m_default_peer.empty()) {
         warn("UdpAdapter: empty default_peer value supplied");
       }
+      if (!m_messageQueues.configure(xml)) {
+        warn("UdpAdapter: invalid message queue configuration");
+        return false;
+      }
       
       // parse the message definitions and register the commands
       if (!parseMessageDefinitions(config)) {
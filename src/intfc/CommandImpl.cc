@@ -239,6 +239,7 @@ namespace PLEXIL
     m_nameExpr = nullptr;
 
     m_argVec.reset();
+    m_variableArgs.clear();
 
     if (m_destIsGarbage)
       delete m_dest;
@@ -324,23 +325,25 @@ namespace PLEXIL
     }
 
     // Check parameters
-    m_commandArgsAreConstant = true;
     size_t nArgs = 0;
+    m_variableArgs.clear();
     if (m_argVec) {
       nArgs = m_argVec->size();
-      // Check parameters 
-      for (size_t i = 0; i < nArgs; ++i) {
-        if (!(*m_argVec)[i]->isConstant()) {
-          m_commandArgsAreConstant = false;
-          break;
-        }
-      }
+      for (size_t i = 0; i < nArgs; ++i)
+        if (!(*m_argVec)[i]->isConstant())
+          m_variableArgs.push_back(i);
     }
+    m_commandArgsAreConstant = m_variableArgs.empty();
+
     // Parameter list length for a command invocation cannot vary at
-    // run time, so set it now
+    // run time, so set it now.  Constant parameters can't vary either,
+    // so fill them in once; fixCommandArgs() only refills the rest.
     m_command.setParameterCount(nArgs);
+    for (size_t i = 0; i < nArgs; ++i)
+      if ((*m_argVec)[i]->isConstant())
+        m_command.setParameter(i, (*m_argVec)[i]->toValue());
     if (m_commandArgsAreConstant)
-      fixCommandArgs();
+      m_commandArgsFixed = true;
 
     // Check resource specs
     m_resourcesAreConstant = true;
@@ -374,14 +377,12 @@ namespace PLEXIL
     }
   }
 
-  // Note that m_command.setParameterCount() was called in
-  // checkConstant() above.
+  // Note that m_command.setParameterCount() was called, and the
+  // constant parameters filled in, by checkConstant() above.
   void CommandImpl::fixCommandArgs()
   {
-    if (m_argVec) {
-      for (size_t i = 0; i < m_argVec->size(); ++i)
-        m_command.setParameter(i, (*m_argVec)[i]->toValue());
-    }
+    for (size_t i : m_variableArgs)
+      m_command.setParameter(i, (*m_argVec)[i]->toValue());
     m_commandArgsFixed = true;
   }
 
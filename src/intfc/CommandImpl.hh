@@ -393,6 +393,10 @@ namespace PLEXIL
     //!        be null.
     std::unique_ptr<ResourceSpecList> m_resourceList;
 
+    //! \brief Indices of the parameter expressions which are not
+    //!        constants.  Only these are reevaluated on activation.
+    std::vector<size_t> m_variableArgs;
+
     //! \brief The current command handle value.  Referenced by m_ack.
     CommandHandleValue m_commandHandle;
 
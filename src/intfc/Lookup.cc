@@ -29,6 +29,7 @@
 #include "CachedValue.hh"
 #include "Debug.hh"
 #include "ExprVec.hh"
+#include "ExpressionProfiler.hh"
 #include "PlanError.hh"
 #include "State.hh"
 #include "StateCacheEntry.hh"
@@ -278,6 +279,7 @@ namespace PLEXIL
 #define DEFINE_LOOKUP_GET_VALUE_METHOD(_rtype_)                 \
     virtual bool getValue(_rtype_ &result) const override       \
     {                                                           \
+      PROFILE_EXPRESSION_EVALUATION(this);                      \
       if (!isActive() || !m_entry || !m_entry->cachedValue())   \
         return false;                                           \
       return m_entry->cachedValue()->getValue(result);          \
@@ -302,6 +304,7 @@ namespace PLEXIL
 #define DEFINE_LOOKUP_GET_VALUE_POINTER_METHOD(_rtype_)                 \
     virtual bool getValuePointer(_rtype_ const *&ptr) const override    \
     {                                                                   \
+      PROFILE_EXPRESSION_EVALUATION(this);                              \
       if (!isActive() || !m_entry || !m_entry->cachedValue())           \
         return false;                                                   \
       return m_entry->cachedValue()->getValuePointer(ptr);              \
@@ -881,6 +884,7 @@ namespace PLEXIL
 #define DEFINE_CHANGE_LOOKUP_GET_VALUE_METHOD(_rtype_)              \
     virtual bool getValue(_rtype_ &result) const override           \
     {                                                               \
+      PROFILE_EXPRESSION_EVALUATION(this);                          \
       if (!this->isActive() || !m_entry || !m_entry->cachedValue()) \
         return false;                                               \
       if (m_cachedValue)                                            \
@@ -565,6 +565,16 @@ namespace PLEXIL
                     );
     }
 
+    //! \brief Release all resource reservations, retaining the
+    //!        resource hierarchy.
+    virtual void reset()
+    {
+      debugMsg("ResourceArbiter:reset",
+               " releasing " << m_cmdResMap.size() << " command reservations");
+      m_allocated.clear();
+      m_cmdResMap.clear();
+    }
+
   private:
 
     //! \brief Evaluates resource requests and determines which
@@ -65,6 +65,10 @@ namespace PLEXIL
     //! \brief Release the resources reserved by the given command, if any.
     //! \param[in] cmd Pointer to the command.
     virtual void releaseResourcesForCommand(CommandImpl *cmd) = 0;
+
+    //! \brief Release all resource reservations, retaining the
+    //!        resource hierarchy.
+    virtual void reset() = 0;
   };
 
   //! \brief Construct a resource arbiter instance.
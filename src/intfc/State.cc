@@ -190,6 +190,12 @@ namespace PLEXIL
     m_parameters[i] = val;
   }
 
+  void State::setParameter(size_t i, Value &&val)
+  {
+    assertTrue_2(i < m_parameters.size(), "State::setParameter: index out of range");
+    m_parameters[i] = std::move(val);
+  }
+
   void State::print(std::ostream &str) const
   {
     str << m_name << '(';
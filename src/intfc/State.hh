@@ -160,6 +160,11 @@ namespace PLEXIL
     //! \param val Const reference to the new Value.
     void setParameter(size_t i, Value const &val);
 
+    //! \brief Set the requested parameter to a new value.
+    //! \param i The index of the parameter to set.
+    //! \param val Rvalue reference to the new Value.
+    void setParameter(size_t i, Value &&val);
+
     //! \brief Print this State to an output stream.
     //! \param s Reference to the stream.
     void print(std::ostream &s) const;
@@ -27,6 +27,7 @@
 #include "StateCache.hh"
 
 #include "CachedValue.hh"
+#include "Debug.hh"
 #include "Dispatcher.hh"
 #include "Error.hh"
 #include "Message.hh"
@@ -85,6 +86,29 @@ namespace PLEXIL
       ++m_cycleCount;
     }
 
+    //! \brief Discard all cached state values and restart the macro
+    //!        step count.
+    virtual void reset()
+    {
+      debugMsg("StateCache:reset", " discarding " << m_map.size() << " entries");
+      EntryMap::iterator iter = m_map.begin();
+      while (iter != m_map.end()) {
+        if (iter->second->hasRegisteredLookups()) {
+          // Can't delete these w/o leaving dangling pointers
+          warn("StateCache::reset: state " << iter->first
+               << " still has active lookups, not deleted");
+          iter->second->setUnknown();
+          ++iter;
+        }
+        else {
+          if (iter->second.get() == m_timeEntry)
+            m_timeEntry = nullptr;
+          iter = m_map.erase(iter);
+        }
+      }
+      m_cycleCount = 1;
+    }
+
     //! \brief Return the StateCacheEntry corresponding to the time state.
     //! \return Pointer to the entry.
     virtual StateCacheEntry *ensureTimeEntry()
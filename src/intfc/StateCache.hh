@@ -74,6 +74,13 @@ namespace PLEXIL
     //! \brief Increment the Exec macro step count.
     virtual void incrementCycleCount() = 0;
 
+    //! \brief Discard all cached state values and restart the macro
+    //!        step count, as if the cache were newly constructed.
+    //! \note Entries which still have registered lookups are retained,
+    //!       but their values are made unknown.
+    //! \note Should only be called when no plans are loaded.
+    virtual void reset() = 0;
+
     //
     // API to ExternalInterface
     //
@@ -761,6 +761,33 @@ static bool testThresholdUpdate()
   return true;
 }
 
+static bool testStateCacheReset()
+{
+  StringConstant test1("test1");
+  ExpressionPtr l1(makeLookup(&test1, false, UNKNOWN_TYPE, nullptr));
+
+  StateCache::instance().incrementCycleCount();
+  l1->activate();
+  assertTrue_1(l1->isKnown());
+
+  State const resetState("resetTest");
+  StateCache::instance().lookupReturn(resetState, Value((Integer) 3));
+  assertTrue_1(StateCache::instance().ensureStateCacheEntry(resetState)->isKnown());
+  assertTrue_1(StateCache::instance().getCycleCount() > 1);
+
+  StateCache::instance().reset();
+  assertTrue_1(StateCache::instance().getCycleCount() == 1);
+
+  // Entry without lookups was discarded
+  assertTrue_1(!StateCache::instance().ensureStateCacheEntry(resetState)->isKnown());
+
+  // Entry with an active lookup was retained, but made unknown
+  assertTrue_1(!l1->isKnown());
+
+  l1->deactivate();
+  return true;
+}
+
 bool lookupsTest()
 {
   TestInterface foo;
@@ -770,6 +797,7 @@ bool lookupsTest()
   runTest(testLookupNow);
   runTest(testLookupOnChange);
   runTest(testThresholdUpdate);
+  runTest(testStateCacheReset);
   g_dispatcher = nullptr;
   return true;
 }
@@ -24,9 +24,14 @@
 * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "ArrayImpl.hh"
 #include "State.hh"
 #include "TestSupport.hh"
 
+#include <chrono>
+#include <iostream>
+#include <vector>
+
 #include <cstring> // memset()
 
 using namespace PLEXIL;
@@ -148,11 +153,66 @@ static bool testParamSerDes()
   return true;
 }
 
+// Round trip of large numeric arrays, with timing
+static bool testBulkArraySerDes()
+{
+  static size_t const N_ELEMENTS = 100000;
+  static size_t const N_ITERATIONS = 20;
+
+  IntegerArray iary(N_ELEMENTS);
+  RealArray rary(N_ELEMENTS);
+  for (size_t i = 0; i < N_ELEMENTS; ++i) {
+    if (i % 97) {
+      iary.setElement(i, (Integer) (i * 7919 - 300000));
+      rary.setElement(i, (Real) i * -0.125);
+    }
+  }
+
+  State s("bulk", 2);
+  s.setParameter(0, Value(iary));
+  s.setParameter(1, Value(rary));
+
+  // Size the buffer once, from the reported size
+  size_t const expected = serialSize(s);
+  assertTrueMsg(expected > N_ELEMENTS * 12,
+                "serialSize returned implausible size " << expected);
+  std::vector<char> buf(expected + 1, (char) 0xFF);
+
+  State sread;
+  double serSecs = 0, desSecs = 0;
+  for (size_t n = 0; n < N_ITERATIONS; ++n) {
+    auto start = std::chrono::steady_clock::now();
+    char *bufptr = serialize(s, buf.data());
+    auto mid = std::chrono::steady_clock::now();
+    assertTrueMsg(bufptr, "serialize returned null");
+    assertTrueMsg(bufptr == buf.data() + expected,
+                  "serialize didn't increment pointer by expected number");
+    assertTrueMsg(0xFF == (unsigned char) buf[expected],
+                  "serialize wrote more than it should have");
+
+    char const *cbufptr = deserialize(sread, buf.data());
+    auto end = std::chrono::steady_clock::now();
+    assertTrueMsg(cbufptr == buf.data() + expected,
+                  "deserialize didn't increment pointer by expected number");
+    assertTrueMsg(sread == s, "deserialize didn't set result equal to source");
+
+    serSecs += std::chrono::duration<double>(mid - start).count();
+    desSecs += std::chrono::duration<double>(end - mid).count();
+  }
+
+  double const mbytes = (double) (expected * N_ITERATIONS) / 1.0e6;
+  std::cout << "  bulk array round trip, " << expected << " bytes x "
+            << N_ITERATIONS << ": serialize " << mbytes / serSecs
+            << " MB/s, deserialize " << mbytes / desSecs << " MB/s"
+            << std::endl;
+  return true;
+}
 
 bool serializeTest()
 {
   runTest(testBasicStateSerDes);
   runTest(testParamSerDes);
+  runTest(testBulkArraySerDes);
   // more to come
   return true;
 }
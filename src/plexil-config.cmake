@@ -113,6 +113,11 @@ CHECK_INCLUDE_FILE(pthread.h HAVE_PTHREAD_H)
 CHECK_INCLUDE_FILE(semaphore.h HAVE_SEMAPHORE_H)
 CHECK_INCLUDE_FILE(unistd.h HAVE_UNISTD_H)
 CHECK_INCLUDE_FILE(sys/time.h HAVE_SYS_TIME_H)
+CHECK_INCLUDE_FILE(sys/wait.h HAVE_SYS_WAIT_H)
+
+# Shared memory and futexes (IpcUtils same-host transport)
+CHECK_INCLUDE_FILE(sys/mman.h HAVE_SYS_MMAN_H)
+CHECK_INCLUDE_FILE(linux/futex.h HAVE_LINUX_FUTEX_H)
 
 # Networking
 CHECK_INCLUDE_FILE(netdb.h HAVE_NETDB_H)
@@ -218,6 +223,7 @@ unset(CMAKE_REQUIRED_LIBRARIES)
 CHECK_FUNCTION_EXISTS(gethostbyname HAVE_GETHOSTBYNAME) # UdpAdapter, IPC
 CHECK_FUNCTION_EXISTS(getpid HAVE_GETPID) # Logging, ExecApplication
 CHECK_FUNCTION_EXISTS(isatty HAVE_ISATTY) # utils/Logging.cc only
+CHECK_FUNCTION_EXISTS(fork HAVE_FORK) # TestExec batch mode
 
 #
 # Libraries
@@ -307,6 +313,12 @@ else()
   unset(HAVE_UDP_ADAPTER CACHE)
 endif()
 
+if(FLIGHT_RECORDER)
+  set(HAVE_FLIGHT_RECORDER ON)
+else()
+  unset(HAVE_FLIGHT_RECORDER CACHE)
+endif()
+
 if(VIEWER_LISTENER)
   set(HAVE_LUV_LISTENER ON)
 else()
@@ -646,6 +646,13 @@
 #else
 #include "primFmttrs.h"
 #endif
+
+#ifdef CENTRAL_USE_EPOLL
+#include <sys/epoll.h>
+
+/* Maximum number of ready descriptors handled per wait */
+#define MAX_EPOLL_EVENTS 64
+#endif
 
 /******************************************************************************
  * Forward Declarations
@@ -917,6 +924,107 @@ void removeConnection(MODULE_PTR module)
 }
 
 
+/******************************************************************************
+ *
+ * FUNCTION: void setSdModule(sd, module)
+ *
+ * DESCRIPTION:
+ * Record the module connected on a socket descriptor, or forget it if
+ * module is NULL.  Incoming messages find their module through this
+ * table rather than by searching the module list.
+ *
+ * INPUTS:
+ * int sd;
+ * MODULE_PTR module;
+ *
+ * OUTPUTS: void
+ *
+ *****************************************************************************/
+
+static void setSdModule(int sd, MODULE_PTR module)
+{
+  int32 i, oldSize, newSize;
+  MODULE_PTR *newTable;
+
+  if (sd < 0)
+    return;
+  oldSize = GET_S_GLOBAL(sdModuleTableSize);
+  if (sd >= oldSize) {
+    if (module == NULL)
+      return;
+    newSize = (oldSize > 0 ? oldSize : 64);
+    while (newSize <= sd)
+      newSize *= 2;
+    newTable = (MODULE_PTR *)x_ipcMalloc((unsigned)newSize * sizeof(MODULE_PTR));
+    for (i=0; i<oldSize; i++)
+      newTable[i] = GET_S_GLOBAL(sdModuleTable)[i];
+    for (; i<newSize; i++)
+      newTable[i] = NULL;
+    if (GET_S_GLOBAL(sdModuleTable))
+      x_ipcFree((char *)GET_S_GLOBAL(sdModuleTable));
+    GET_S_GLOBAL(sdModuleTable) = newTable;
+    GET_S_GLOBAL(sdModuleTableSize) = newSize;
+  }
+  GET_S_GLOBAL(sdModuleTable)[sd] = module;
+}
+
+static MODULE_PTR sdModule(int sd)
+{
+  if (sd < 0 || sd >= GET_S_GLOBAL(sdModuleTableSize))
+    return NULL;
+  return GET_S_GLOBAL(sdModuleTable)[sd];
+}
+
+static BOOLEAN isListenSd(int sd)
+{
+  return (sd >= 0 && sd < FD_SETSIZE &&
+	  FD_ISSET(sd, &GET_C_GLOBAL(x_ipcListenMaskGlobal)));
+}
+
+#ifdef CENTRAL_USE_EPOLL
+/******************************************************************************
+ *
+ * FUNCTION: BOOLEAN watchSd(sd)
+ *           void unwatchSd(sd)
+ *
+ * DESCRIPTION:
+ * Add a socket descriptor to, or remove it from, the set listenLoop
+ * waits on.
+ *
+ * INPUTS:
+ * int sd;
+ *
+ * OUTPUTS: watchSd returns FALSE if the descriptor could not be added.
+ *
+ *****************************************************************************/
+
+static BOOLEAN watchSd(int sd)
+{
+  struct epoll_event event;
+
+  if (GET_S_GLOBAL(epollSd) < 0) {
+    GET_S_GLOBAL(epollSd) = epoll_create1(EPOLL_CLOEXEC);
+    if (GET_S_GLOBAL(epollSd) < 0) {
+      X_IPC_ERROR1("Internal Error: epoll_create1 error %d\n", errno);
+      return FALSE;
+    }
+  }
+  bzero((void *)&event, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = sd;
+  return (epoll_ctl(GET_S_GLOBAL(epollSd), EPOLL_CTL_ADD, sd, &event) == 0);
+}
+
+static void unwatchSd(int sd)
+{
+  struct epoll_event event; /* Ignored, but older kernels require it */
+
+  if (GET_S_GLOBAL(epollSd) >= 0)
+    (void)epoll_ctl(GET_S_GLOBAL(epollSd), EPOLL_CTL_DEL, sd, &event);
+}
+#endif /* CENTRAL_USE_EPOLL */
+
+
 /******************************************************************************
  *
  * FUNCTION: MODULE_PTR addConnection(sd, modData)
@@ -941,8 +1049,15 @@ static MODULE_PTR addConnection(int readSd, int writeSd, MOD_DATA_PTR modData)
   
   module = x_ipcModuleCreate(readSd, writeSd, modData);
   
-  FD_SET(module->readSd, &(GET_C_GLOBAL(x_ipcConnectionListGlobal)));
+  if (module->readSd < FD_SETSIZE)
+    FD_SET(module->readSd, &(GET_C_GLOBAL(x_ipcConnectionListGlobal)));
   x_ipc_listInsertItem((void *)module, GET_M_GLOBAL(moduleList));
+  setSdModule(module->readSd, module);
+#ifdef CENTRAL_USE_EPOLL
+  if (!watchSd(module->readSd)) {
+    X_IPC_ERROR1("Internal Error: cannot watch sd %d\n", module->readSd);
+  }
+#endif
   
   msgInfoMsgSend(module->writeSd);
   
@@ -1019,6 +1134,11 @@ static void serverModListen(int sd)
   
   FD_SET(sd, &(GET_C_GLOBAL(x_ipcConnectionListGlobal)));
   FD_SET(sd, &(GET_C_GLOBAL(x_ipcListenMaskGlobal)));
+#ifdef CENTRAL_USE_EPOLL
+  if (!watchSd(sd)) {
+    X_IPC_ERROR1("Internal Error: cannot watch listening sd %d\n", sd);
+  }
+#endif
   
   /* Need to keep track of the maximum.  */
   GET_C_GLOBAL(maxConnection) =  MAX(GET_C_GLOBAL(maxConnection), sd);
@@ -1818,7 +1938,12 @@ void x_ipcCloseMod(char *name)
   if (module) {
     LOG1("close Module: Closing %s\n", name);
     
-    FD_CLR((unsigned)module->readSd, &(GET_C_GLOBAL(x_ipcConnectionListGlobal)));
+    if (module->readSd < FD_SETSIZE)
+      FD_CLR((unsigned)module->readSd, &(GET_C_GLOBAL(x_ipcConnectionListGlobal)));
+#ifdef CENTRAL_USE_EPOLL
+    unwatchSd(module->readSd);
+#endif
+    setSdModule(module->readSd, NULL);
     SHUTDOWN_SOCKET(module->readSd);
     if (module->readSd != module->writeSd) {
       SHUTDOWN_SOCKET(module->writeSd);
@@ -2822,15 +2947,16 @@ static void stdinHnd(void)
  *
  *****************************************************************************/
 
-static int32 modSdEq(int sd, MODULE_PTR module)
-{
-  return((sd == module->readSd) ||(sd == module->writeSd));
-}
-
 void listenLoop(void)
 {
   int32 stat;
+#ifdef CENTRAL_USE_EPOLL
+  struct epoll_event events[MAX_EPOLL_EVENTS];
+  int listenSds[MAX_EPOLL_EVENTS];
+  int32 i, numListen;
+#else
   fd_set readMask;
+#endif
   
   /******************/
   
@@ -2853,8 +2979,30 @@ void listenLoop(void)
   
   /* x_ipc_dataMsgDisplayStats();*/
   
+#ifdef CENTRAL_USE_EPOLL
+  /* Also listen for commands on standard input, if it can be watched */
+  if (GET_S_GLOBAL(listenToStdin) && !watchSd(fileno(stdin)))
+    GET_S_GLOBAL(listenToStdin) = FALSE;
+#endif
+
   for(;;) {
     
+#ifdef CENTRAL_USE_EPOLL
+    do {
+      stat = epoll_wait(GET_S_GLOBAL(epollSd), events, MAX_EPOLL_EVENTS, -1);
+    } while (stat < 0 && errno == EINTR);
+
+    if (stat < 0) {
+      X_IPC_ERROR1("Internal Error: epoll_wait error in listenLoop %d",errno);
+    }
+
+    for (i=0; i<stat; i++) {
+      if (GET_S_GLOBAL(listenToStdin) && events[i].data.fd == fileno(stdin)) {
+	/* Handle input on stdin */
+	stdinHnd();
+      }
+    }
+#else
     readMask = (GET_C_GLOBAL(x_ipcConnectionListGlobal));
     
     /* Also listen for commands on standard input */
@@ -2890,6 +3038,7 @@ void listenLoop(void)
       /* Handle input on stdin */
       stdinHnd();
     }
+#endif /* CENTRAL_USE_EPOLL */
     
     GET_S_GLOBAL(byteSize) = 0;
     
@@ -2906,32 +3055,46 @@ void listenLoop(void)
     GET_S_GLOBAL(totalMon) = (GET_S_GLOBAL(totalMon) +
 			      (GET_S_GLOBAL(endMon) - GET_S_GLOBAL(startMon)));
     
-    /* Should really use devUtils, but for now, just loop over
-     * the open devices and call the correct routines.
-     * The call to find the member of the modules list with the correct
-     * file id is wasteful.  The modules should be stored in an array rather
-     * than a list.
+    /* Modules are found through the sd table, not the module list. */
+#ifdef CENTRAL_USE_EPOLL
+    /* Accept new connections only after handling this batch's messages,
+     * so a socket closed while handling the batch can't be reused for a
+     * new module while stale events for it remain.  Events for sockets
+     * already closed find no module and are skipped.
      */
+    numListen = 0;
+    for (i=0; i<stat; i++) {
+      int sd = events[i].data.fd;
+      if (GET_S_GLOBAL(listenToStdin) && sd == fileno(stdin)) {
+	continue;
+      } else if (isListenSd(sd)) {
+	listenSds[numListen++] = sd;
+      } else if (sdModule(sd)) {
+	handleDataMsgRecv(sd, sdModule(sd));
+      }
+    }
+    for (i=0; i<numListen; i++) {
+      /*	It is a new connection requrest. */
+      acceptConnection(listenSds[i]);
+    }
+#else
     if (stat > 0)
       {
 	int32 i;
 	int32 maxDevFd = GET_C_GLOBAL(maxConnection);
 	for(i=0; i<=maxDevFd; i++) {
 	  if (i != fileno(stdin) && FD_ISSET(i,&readMask)) {
-	    if (FD_ISSET(i,&GET_C_GLOBAL(x_ipcListenMaskGlobal))) {
+	    if (isListenSd(i)) {
 	      /*	It is a new connection requrest. */
 	      acceptConnection(i);
 	    } else {
 	      /* It is a message to be handled.  */
-	      handleDataMsgRecv(i,
-				(MODULE_PTR)
-				x_ipc_listMemReturnItem((LIST_ITER_FN) modSdEq,
-						  (void *)(long)i,
-						  GET_M_GLOBAL(moduleList)));
+	      handleDataMsgRecv(i, sdModule(i));
 	    }
 	  }
 	}
       }
+#endif /* CENTRAL_USE_EPOLL */
     /*  (void)x_ipc_listIterateFromFirst((LIST_ITER_FN) iterateDataMsgRecv,*/
     /*	      (void *)&readMask, GET_M_GLOBAL(moduleList));*/
     GET_S_GLOBAL(endLoop) = x_ipc_timeInMsecs();
@@ -484,6 +484,11 @@ void globalSInit(void)
   GET_S_GLOBAL(tapsUnderRoot) = FALSE;
 #endif
   GET_S_GLOBAL(directDefault) = FALSE;
+  GET_S_GLOBAL(sdModuleTable) = NULL;
+  GET_S_GLOBAL(sdModuleTableSize) = 0;
+#ifdef CENTRAL_USE_EPOLL
+  GET_S_GLOBAL(epollSd) = -1;
+#endif
   
 #if defined(VXWORKS) || defined(_WINSOCK_) || defined(OS2)
   GET_S_GLOBAL(listenToStdin) = FALSE;
@@ -554,6 +559,11 @@ void globalSFree(void)
     x_ipc_listFree(&(GET_M_GLOBAL(moduleList)));
 
     x_ipc_idTableFree(&GET_S_GLOBAL(dispatchTable)); 
+    if (GET_S_GLOBAL(sdModuleTable)) {
+      x_ipcFree((char *)GET_S_GLOBAL(sdModuleTable));
+      GET_S_GLOBAL(sdModuleTable) = NULL;
+      GET_S_GLOBAL(sdModuleTableSize) = 0;
+    }
 #ifndef NMP_IPC
     freeJustification(&GET_S_GLOBAL(tmsAssumpJustificationGlobal));
     x_ipc_listFreeAllItems((LIST_FREE_FN)x_ipcFree, 
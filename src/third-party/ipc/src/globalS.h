@@ -326,6 +326,12 @@
 #include "globalVar.h"
 #endif /* DOS_FILE_NAMES */
 
+/* On Linux, central waits for input with epoll rather than select,
+   so the cost of each wait does not grow with the number of modules. */
+#if defined(__linux__) && !defined(VXWORKS) && !defined(_WINSOCK_)
+#define CENTRAL_USE_EPOLL
+#endif
+
 /*****************************************/
 
 #if !defined(VXWORKS) && !defined(_WINSOCK_)
@@ -497,6 +503,13 @@ typedef struct _GS {
   BOOLEAN listenToStdin;
   BOOLEAN directDefault;
 
+  /* Connected module for each socket descriptor, indexed by descriptor */
+  MODULE_PTR *sdModuleTable;
+  int32 sdModuleTableSize;
+#ifdef CENTRAL_USE_EPOLL
+  int epollSd;
+#endif
+
 #ifndef NMP_IPC
   TASK_TREE_NODE_PTR taskTreeRootGlobal;
 #endif
@@ -25,6 +25,7 @@
  */
 
 #include "AdapterConfiguration.hh" 
+#include "ConditionProfiler.hh"
 #include "Debug.hh"
 #include "Error.hh"
 #include "ExecApplication.hh"
@@ -54,6 +55,10 @@ int main_internal(int argc, char** argv)
   std::string resourceFile("resource.data");
   std::vector<std::string> libraryNames;
   std::vector<std::string> libraryPath;
+  std::string recordFile;
+  std::string replayFile;
+  std::string snapshotFile;
+  std::string profileFile;
   std::string
       usage(
           "Usage: universalExec -p <plan>\n\
@@ -61,7 +66,11 @@ int main_internal(int argc, char** argv)
                     [-L <library_directory>]*    (default .)\n\
                     [-c <interface_config_file>] (default ./interface-config.xml)\n\
                     [-d <debug_config_file>]     (default ./Debug.cfg)\n\
-                    [+d]                         (disable debug messages)\n");
+                    [+d]                         (disable debug messages)\n\
+                    [-record <journal_file>]     (record Exec input)\n\
+                    [-replay <journal_file>]     (replay recorded Exec input)\n\
+                    [-snapshot <snapshot_file>]  (save Exec state, resume from it if present)\n\
+                    [-profile <report_file>]     (report the most expensive conditions)\n");
 
 #ifdef HAVE_LUV_LISTENER
   std::string luvHost = LUV_DEFAULT_HOSTNAME;
@@ -180,6 +189,38 @@ int main_internal(int argc, char** argv)
       useResourceFile = true;
       resourceFileSupplied = true;
     }
+    else if (strcmp(argv[i], "-record") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      recordFile = argv[i];
+    }
+    else if (strcmp(argv[i], "-replay") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      replayFile = argv[i];
+    }
+    else if (strcmp(argv[i], "-snapshot") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      snapshotFile = argv[i];
+    }
+    else if (strcmp(argv[i], "-profile") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      profileFile = argv[i];
+    }
     else if (strcmp(argv[i], "+r") == 0) {
       if (resourceFileSupplied) {
         warn("Both -r and +r options specified.\n"
@@ -209,6 +250,17 @@ int main_internal(int argc, char** argv)
       return 2;
     }
   }
+  if (!recordFile.empty() && !replayFile.empty()) {
+    warn("Both -record and -replay options specified.\n"
+         << usage);
+    return 2;
+  }
+  if (!snapshotFile.empty() && !replayFile.empty()) {
+    warn("Both -snapshot and -replay options specified.\n"
+         << usage);
+    return 2;
+  }
+
   // basic initialization
 
   if (useDebugConfig) {
@@ -218,8 +270,12 @@ int main_internal(int argc, char** argv)
   }
 
   // get interface configuration file, if provided
+  // Replay requires no interfaces
   pugi::xml_document configDoc;
-  if (!interfaceConfig.empty()) {
+  if (!replayFile.empty()) {
+    configDoc.append_child(PLEXIL::InterfaceSchema::INTERFACES_TAG);
+  }
+  else if (!interfaceConfig.empty()) {
     std::cout << "Reading interface configuration from " << interfaceConfig << std::endl;
 	pugi::xml_parse_result parseResult =
       configDoc.load_file(interfaceConfig.c_str(), PUGI_PARSE_OPTIONS);
@@ -312,6 +368,42 @@ int main_internal(int argc, char** argv)
       return 1;
   }
 
+  if (!replayFile.empty()) {
+    std::cout << "Replaying " << replayFile << std::endl;
+    bool ok = _app->replay(replayFile);
+    _app->stop();
+    std::cout << "Replay " << (ok ? "complete" : "failed") << std::endl;
+    return (ok ? 0 : 1);
+  }
+
+  if (!recordFile.empty()) {
+    std::cout << "Recording to " << recordFile << std::endl;
+    if (!_app->startRecording(recordFile)) {
+      std::cout << "ERROR: unable to record to " << recordFile << std::endl;
+      return 1;
+    }
+  }
+
+  // Resume from the snapshot if one exists
+  bool resumed = false;
+  if (!snapshotFile.empty()) {
+    if (!_app->startSnapshots(snapshotFile)) {
+      std::cout << "ERROR: unable to save snapshots to " << snapshotFile << std::endl;
+      return 1;
+    }
+    if (std::ifstream(snapshotFile).good()) {
+      std::cout << "Restoring from snapshot " << snapshotFile << std::endl;
+      if (!_app->restoreSnapshot(snapshotFile)) {
+        std::cout << "ERROR: unable to restore snapshot " << snapshotFile << std::endl;
+        return 1;
+      }
+      resumed = !_app->exec()->getPlans().empty();
+    }
+  }
+
+  if (!profileFile.empty())
+    ConditionProfiler::enable();
+
   // start the application
   std::cout << "Starting the exec" << std::endl;
   if (!_app->run()) {
@@ -322,11 +414,16 @@ int main_internal(int argc, char** argv)
   // Below this point, must be careful to shut down gracefully
   bool error = false;
 
-  if (planName.empty()) {
+  if (planName.empty() && !resumed) {
     // No plan provided, wait for one to arrive
     // TODO: add SIGINT handler here
     _app->waitForShutdown();
   }
+  else if (resumed) {
+    std::cout << "Resuming plan(s) from snapshot"
+              << (planName.empty() ? "" : ", ") << planName
+              << (planName.empty() ? "" : " not loaded") << std::endl;
+  }
   else {
     // load the given plan
 	pugi::xml_document plan;
@@ -342,6 +439,8 @@ int main_internal(int argc, char** argv)
 	  std::cout << "Unable to load plan '" << planName << "', exiting" << std::endl;
 	  error = true;
 	}
+  }
+  if (!planName.empty() || resumed) {
     if (!error) {
       // Tell the exec to run it
       _app->notifyAndWaitForCompletion();
@@ -353,6 +452,19 @@ int main_internal(int argc, char** argv)
     std::cout << "Plan complete, Exec exited with"
               << (error ? " " : "out ") << "errors" << std::endl;
   }
+
+  // The Exec has stopped, so the profile is safe to read
+  if (!profileFile.empty()) {
+    std::ofstream profile(profileFile);
+    if (profile.good()) {
+      ConditionProfiler::report(profile, 50);
+      std::cout << "Condition profile written to " << profileFile << std::endl;
+    }
+    else {
+      std::cout << "ERROR: unable to write profile to " << profileFile << std::endl;
+      error = true;
+    }
+  }
   return (error ? 1 : 0);
 }
 
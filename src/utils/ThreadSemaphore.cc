@@ -66,6 +66,11 @@ namespace PLEXIL
     return m_impl->post();
   }
 
+  int ThreadSemaphore::tryWait()
+  {
+    return m_impl->tryWait();
+  }
+
 } // namespace PLEXIL
 
 //
@@ -148,6 +153,16 @@ namespace PLEXIL
       else return 0;
     }
 
+    virtual int tryWait()
+    {
+      int status;
+      while (((status = sem_trywait(&m_posix_sem)) == -1) && (errno == EINTR))
+        continue;
+      if (status == -1)
+        return errno;
+      else return 0;
+    }
+
   private:
     sem_t m_posix_sem;
   };
@@ -233,6 +248,16 @@ namespace PLEXIL
       return (int) semaphore_signal(m_mach_sem);
     }
 
+    int tryWait()
+    {
+      mach_timespec_t const zero = {0, 0};
+      kern_return_t status = KERN_SUCCESS;
+      do {
+        status = semaphore_timedwait(m_mach_sem, zero);
+      } while (status == KERN_ABORTED);
+      return status;
+    }
+
   private:
     semaphore_t m_mach_sem;
     task_t m_mach_owning_task;
@@ -60,6 +60,10 @@ namespace PLEXIL
     //! @note Error number is platform dependent.
     int post();
 
+    //! Decrement the semaphore if it has been posted, without blocking.
+    //! @return 0 if the semaphore was decremented, nonzero otherwise.
+    int tryWait();
+
   private:
 
     //! Pointer to the implementation object.
@@ -72,6 +76,7 @@ namespace PLEXIL
   public:
     virtual int wait() = 0;
     virtual int post() = 0;
+    virtual int tryWait() = 0;
     virtual ~ThreadSemaphoreImpl() = default;
   };
 
@@ -34,22 +34,31 @@
 namespace PLEXIL
 {
   Array::Array()
+    : m_known(),
+      m_size(0)
   {
   }
 
   Array::Array(Array const &orig)
-    : m_known(orig.m_known)
+    : m_known(orig.m_known),
+      m_size(orig.m_size)
   {
   }
 
   Array::Array(Array &&orig)
-    : m_known(std::move(orig.m_known))
+    : m_known(std::move(orig.m_known)),
+      m_size(orig.m_size)
   {
+    orig.m_known.clear();
+    orig.m_size = 0;
   }
 
   Array::Array(size_t size, bool known)
-  : m_known(size, known)
+    : m_known(knownWordCount(size), known ? ~((KnownWord) 0) : 0),
+      m_size(size)
   {
+    if (known)
+      clearUnusedKnownBits();
   }
 
   Array::~Array()
@@ -59,49 +68,82 @@ namespace PLEXIL
   Array &Array::operator=(Array const &other)
   {
     m_known = other.m_known;
+    m_size = other.m_size;
     return *this;
   }
 
   Array &Array::operator=(Array &&other)
   {
     m_known = std::move(other.m_known);
+    m_size = other.m_size;
+    other.m_known.clear();
+    other.m_size = 0;
     return *this;
   }
 
   size_t Array::size() const
   {
-    return m_known.size();
+    return m_size;
   }
 
   bool Array::elementKnown(size_t index) const
   {
     checkPlanError(checkIndex(index),
                    "Array::elementKnown: Index exceeds array size");
-    return m_known[index];
+    return knownBit(index);
   }
 
   void Array::resize(size_t size)
   {
-    m_known.resize(size, false);
+    // New words are zero, i.e. unknown; bits past the old size are
+    // already zero, so growing needs no further work
+    m_known.resize(knownWordCount(size), 0);
+    bool shrinking = size < m_size;
+    m_size = size;
+    if (shrinking)
+      clearUnusedKnownBits();
   }
 
   void Array::setElementUnknown(size_t index)
   {
     checkPlanError(checkIndex(index),
                    "Array::setElementUnknown: Index exceeds array size");
-    m_known[index] = false;
+    setKnownBit(index, false);
   }
 
   void Array::reset()
   {
-    std::fill(m_known.begin(), m_known.end(), false);
+    setAllKnown(false);
+  }
+
+  void Array::setAllKnown(bool known)
+  {
+    std::fill(m_known.begin(), m_known.end(), known ? ~((KnownWord) 0) : 0);
+    if (known)
+      clearUnusedKnownBits();
+  }
+
+  void Array::clearUnusedKnownBits()
+  {
+    size_t tail = m_size % 64;
+    if (tail)
+      m_known.back() &= (((KnownWord) 1) << tail) - 1;
+  }
+
+  bool Array::knownMaskEquals(Array const &other) const
+  {
+    // Unused bits are always zero, so whole words can be compared
+    return m_size == other.m_size && m_known == other.m_known;
   }
 
   bool Array::operator==(Array const &other) const
   {
-    return m_known == other.m_known;
+    return knownMaskEquals(other);
   }
 
+  //
+  // The mask scans below reduce whole words without early exit
+  // so that the compiler can vectorize them.
   //
   // TODO:
   // - Define boundary case size == 0 for any/allElementsKnown
@@ -109,18 +151,24 @@ namespace PLEXIL
 
   bool Array::allElementsKnown() const
   {
-    for (size_t i = 0; i < m_known.size(); ++i)
-      if (!m_known[i])
-        return false;
+    size_t const nFull = m_size / 64;
+    KnownWord acc = ~((KnownWord) 0);
+    for (size_t i = 0; i < nFull; ++i)
+      acc &= m_known[i];
+    if (~acc)
+      return false;
+    size_t const tail = m_size % 64;
+    if (tail)
+      return m_known[nFull] == (((KnownWord) 1) << tail) - 1;
     return true;
   }
 
   bool Array::anyElementsKnown() const
   {
-    for (size_t i = 0; i < m_known.size(); ++i)
-      if (m_known[i])
-        return true;
-    return false;
+    KnownWord acc = 0;
+    for (KnownWord w : m_known)
+      acc |= w;
+    return acc != 0;
   }
 
   // Default methods throw PlanError
@@ -31,6 +31,8 @@
 
 #include <vector>
 
+#include <cstdint>
+
 namespace PLEXIL
 {
   // Forward references
@@ -44,6 +46,18 @@ namespace PLEXIL
   {
   public:
 
+    //! \brief Type of one word of the packed known-element mask.
+    //!        Bit (i % 64) of word (i / 64) is set iff element i is known.
+    using KnownWord = std::uint64_t;
+
+    //! \brief Number of mask words required for an array of the given size.
+    //! \param nElements The number of elements.
+    //! \return The number of words.
+    static constexpr size_t knownWordCount(size_t nElements)
+    {
+      return (nElements + 63) / 64;
+    }
+
     //! \brief Default constructor.
     Array();
 
@@ -91,13 +105,19 @@ namespace PLEXIL
     //! \return True if one or more elements are known, false otherwise.
     bool anyElementsKnown() const;
 
-    //! \brief Get the vector of known flags for the elements of this array.
-    //! \return A const reference to the vector.
-    inline std::vector<bool> const &getKnownVector() const
+    //! \brief Get the packed mask of known flags for the elements of this array.
+    //! \return Const pointer to the first of knownWordCount(size()) words.
+    //! \note Bits beyond the end of the array are always zero.
+    inline KnownWord const *getKnownMask() const
     {
-      return m_known;
+      return m_known.data();
     }
 
+    //! \brief Query whether this array and another have the same size
+    //!        and the same elements known.
+    //! \param other Const reference to the other array.
+    //! \return True if the known masks are identical, false otherwise.
+    bool knownMaskEquals(Array const &other) const;
 
     //! \brief Get the valuue type of the elements of the array.
     //! \return The value type.
@@ -206,11 +226,43 @@ namespace PLEXIL
     //! \return True if the index is valid, false if not.
     inline bool checkIndex(size_t index) const
     {
-      return index < m_known.size();
+      return index < m_size;
+    }
+
+    //! \brief Query the known flag of an element.
+    //! \param index The index; must be valid.
+    //! \return True if known, false if not.
+    inline bool knownBit(size_t index) const
+    {
+      return (m_known[index / 64] >> (index % 64)) & 1;
     }
 
-    //! \brief The vector of known flags.
-    std::vector<bool> m_known;
+    //! \brief Set the known flag of an element.
+    //! \param index The index; must be valid.
+    //! \param known The new value of the flag.
+    inline void setKnownBit(size_t index, bool known)
+    {
+      KnownWord const bit = ((KnownWord) 1) << (index % 64);
+      if (known)
+        m_known[index / 64] |= bit;
+      else
+        m_known[index / 64] &= ~bit;
+    }
+
+    //! \brief Set the known flags of all elements.
+    //! \param known The new value of the flags.
+    void setAllKnown(bool known);
+
+    //! \brief The packed known flags.
+    std::vector<KnownWord> m_known;
+
+    //! \brief The number of elements.
+    size_t m_size;
+
+  private:
+
+    //! \brief Zero the mask bits beyond the end of the array.
+    void clearUnusedKnownBits();
   };
 
   //! \ingroup Values
@@ -29,6 +29,7 @@
 #include "PlexilTypeTraits.hh"
 #include "Value.hh"
 
+#include <algorithm> // std::min()
 #include <memory>  // std::move()
 
 #include <cstring> // memcpy()
@@ -36,6 +37,130 @@
 namespace PLEXIL
 {
 
+  //
+  // Bulk kernels over the packed known mask
+  //
+  // Elements are processed in blocks of 64, one mask word at a time.
+  // Blocks with every element known use branch-free loops over the
+  // contiguous contents, which the compiler can vectorize; partially
+  // known blocks test individual mask bits; wholly unknown blocks
+  // are skipped.
+  //
+
+  //! \brief Get a mask word with the low n bits set.
+  //! \param n The number of bits; must be in the range 1 to 64.
+  static inline Array::KnownWord lowBits(size_t n)
+  {
+    return (n >= 64) ? ~((Array::KnownWord) 0) : (((Array::KnownWord) 1) << n) - 1;
+  }
+
+  //! \brief Get the index of the lowest set bit in a mask word.
+  //! \param w The word; must be nonzero.
+  static inline size_t lowestBit(Array::KnownWord w)
+  {
+    size_t result = 0;
+    while (!(w & 0xFF)) {
+      w >>= 8;
+      result += 8;
+    }
+    while (!(w & 1)) {
+      w >>= 1;
+      ++result;
+    }
+    return result;
+  }
+
+  //! \brief Compare the known elements of two arrays with identical known masks.
+  //! \param a Pointer to the first element of one array.
+  //! \param b Pointer to the first element of the other array.
+  //! \param mask Pointer to the shared known mask.
+  //! \param n The number of elements.
+  //! \return True if all known elements are equal, false otherwise.
+  template <typename T>
+  static bool knownElementsEqual(T const *a, T const *b,
+                                 Array::KnownWord const *mask, size_t n)
+  {
+    for (size_t base = 0; base < n; base += 64, ++mask) {
+      Array::KnownWord const bits = *mask;
+      if (!bits)
+        continue;
+      size_t const len = std::min(n - base, (size_t) 64);
+      T const *pa = a + base;
+      T const *pb = b + base;
+      if (bits == lowBits(len)) {
+        bool same = true;
+        for (size_t i = 0; i < len; ++i)
+          same &= (pa[i] == pb[i]);
+        if (!same)
+          return false;
+      }
+      else {
+        for (size_t i = 0; i < len; ++i)
+          if (((bits >> i) & 1) && !(pa[i] == pb[i]))
+            return false;
+      }
+    }
+    return true;
+  }
+
+  template <typename T>
+  static bool knownElementsEqual(std::vector<T> const &a, std::vector<T> const &b,
+                                 Array::KnownWord const *mask, size_t n)
+  {
+    return knownElementsEqual(a.data(), b.data(), mask, n);
+  }
+
+  // std::vector<bool> has no contiguous element storage
+  static bool knownElementsEqual(std::vector<bool> const &a, std::vector<bool> const &b,
+                                 Array::KnownWord const *mask, size_t n)
+  {
+    for (size_t base = 0; base < n; base += 64, ++mask) {
+      Array::KnownWord const bits = *mask;
+      if (!bits)
+        continue;
+      size_t const len = std::min(n - base, (size_t) 64);
+      for (size_t i = 0; i < len; ++i)
+        if (((bits >> i) & 1) && a[base + i] != b[base + i])
+          return false;
+    }
+    return true;
+  }
+
+  //! \brief Lexicographically compare two arrays of the same size.
+  //!        Unknown elements are less than known elements.
+  //! \param a Const reference to the contents of one array.
+  //! \param b Const reference to the contents of the other array.
+  //! \param ma Pointer to the known mask of a.
+  //! \param mb Pointer to the known mask of b.
+  //! \param n The number of elements.
+  //! \return Negative if a < b, positive if a > b, 0 if equal.
+  template <typename V>
+  static int compareKnownElements(V const &a, V const &b,
+                                  Array::KnownWord const *ma,
+                                  Array::KnownWord const *mb,
+                                  size_t n)
+  {
+    for (size_t base = 0; base < n; base += 64, ++ma, ++mb) {
+      Array::KnownWord const both = *ma & *mb;
+      Array::KnownWord const diff = *ma ^ *mb;
+      // Values only matter up to the first difference in knownness
+      size_t const limit = diff ? lowestBit(diff) : std::min(n - base, (size_t) 64);
+      if (both) {
+        for (size_t i = 0; i < limit; ++i) {
+          if ((both >> i) & 1) {
+            if (a[base + i] < b[base + i])
+              return -1;
+            if (b[base + i] < a[base + i])
+              return 1;
+          }
+        }
+      }
+      if (diff)
+        return ((*mb >> limit) & 1) ? -1 : 1;
+    }
+    return 0;
+  }
+
   template <typename T>
   ArrayImpl<T>::ArrayImpl()
     : Array()
@@ -240,14 +365,14 @@ namespace PLEXIL
   template <typename T>
   Value ArrayImpl<T>::getElementValue(size_t index) const
   {
-    if (this->checkIndex(index) && this->m_known[index])
+    if (this->checkIndex(index) && this->knownBit(index))
       return Value(m_contents[index]);
     return Value(); // unknown
   }
 
   Value ArrayImpl<String>::getElementValue(size_t index) const
   {
-    if (this->checkIndex(index) && this->m_known[index])
+    if (this->checkIndex(index) && this->knownBit(index))
       return Value(m_contents[index]);
     return Value(); // unknown
   }
@@ -257,7 +382,7 @@ namespace PLEXIL
   {
     if (!this->checkIndex(index))
       return false;
-    if (!this->m_known[index])
+    if (!this->knownBit(index))
       return false;
     result = m_contents[index];
     return true;
@@ -267,7 +392,7 @@ namespace PLEXIL
   {
     if (!this->checkIndex(index))
       return false;
-    if (!this->m_known[index])
+    if (!this->knownBit(index))
       return false;
     result = m_contents[index];
     return true;
@@ -277,7 +402,7 @@ namespace PLEXIL
   {
     if (!this->checkIndex(index))
       return false;
-    if (!this->m_known[index])
+    if (!this->knownBit(index))
       return false;
     result = &m_contents[index];
     return true;
@@ -307,16 +432,18 @@ namespace PLEXIL
   template <typename T>
   bool ArrayImpl<T>::operator==(ArrayImpl<T> const &other) const
   {
-    if (!(this->getKnownVector() == other.getKnownVector()))
+    if (!this->knownMaskEquals(other))
       return false;
-    return m_contents == other.m_contents;
+    return knownElementsEqual(m_contents, other.m_contents,
+                              this->getKnownMask(), this->size());
   }
 
   bool ArrayImpl<String>::operator==(ArrayImpl<String> const &other) const
   {
-    if (!(this->getKnownVector() == other.getKnownVector()))
+    if (!this->knownMaskEquals(other))
       return false;
-    return m_contents == other.m_contents;
+    return knownElementsEqual(m_contents, other.m_contents,
+                              this->getKnownMask(), this->size());
   }
 
   template <typename T>
@@ -336,7 +463,7 @@ namespace PLEXIL
     if (!this->checkIndex(index))
       return;
     m_contents[index] = newval;
-    this->m_known[index] = true;
+    this->setKnownBit(index, true);
   }
 
   void ArrayImpl<String>::setElement(size_t index, String const &newval)
@@ -344,7 +471,7 @@ namespace PLEXIL
     if (!this->checkIndex(index))
       return;
     m_contents[index] = newval;
-    this->m_known[index] = true;
+    this->setKnownBit(index, true);
   }
 
   template <typename T>
@@ -356,7 +483,7 @@ namespace PLEXIL
     bool known = value.getValue(temp);
     if (known)
       m_contents[index] = temp;
-    this->m_known[index] = known;
+    this->setKnownBit(index, known);
   }
 
   // Slight optimization for String
@@ -368,7 +495,7 @@ namespace PLEXIL
     bool known = value.getValuePointer(temp);
     if (known)
       m_contents[index] = *temp;
-    this->m_known[index] = known;
+    this->setKnownBit(index, known);
   }
 
   template <typename T>
@@ -420,12 +547,12 @@ namespace PLEXIL
   template <typename T>
   bool operator==(ArrayImpl<T> const &arya, ArrayImpl<T> const &aryb)
   {
-    if (!(arya.getKnownVector() == aryb.getKnownVector()))
+    if (!arya.knownMaskEquals(aryb))
       return false;
     std::vector<T> const *avec, *bvec;
     arya.getContentsVector(avec);
     aryb.getContentsVector(bvec);
-    return *avec == *bvec;
+    return knownElementsEqual(*avec, *bvec, arya.getKnownMask(), arya.size());
   }
 
   // Generic
@@ -445,11 +572,9 @@ namespace PLEXIL
   template <typename T>
   bool operator<(ArrayImpl<T> const &arya, ArrayImpl<T> const &aryb)
   {
-    std::vector<bool> const &aKnownVec = arya.getKnownVector();
-    std::vector<bool> const &bKnownVec = aryb.getKnownVector();
     // Shorter is less
-    size_t aSize = aKnownVec.size();
-    size_t bSize = bKnownVec.size();
+    size_t aSize = arya.size();
+    size_t bSize = aryb.size();
     if (aSize < bSize)
       return true;
     if (aSize > bSize)
@@ -459,64 +584,9 @@ namespace PLEXIL
     std::vector<T> const *aVec, *bVec;
     arya.getContentsVector(aVec);
     aryb.getContentsVector(bVec);
-
-    for (size_t i = 0; i < aSize; ++i) {
-      // Unknown is less than known
-      bool aKnown = aKnownVec[i];
-      bool bKnown = bKnownVec[i];
-      if (!aKnown && bKnown)
-        return true; // unknown < known
-      if (aKnown && !bKnown)
-        return false;
-      if (!aKnown)
-        continue; // neither known
-
-      // Compare values
-      if ((*aVec)[i] < (*bVec)[i])
-        return true;
-      if ((*aVec)[i] > (*bVec)[i])
-        return false;
-    }
-    return false; // equal
-  }
-
-  // Specialization for bool
-  template <>
-  bool operator< <Boolean>(ArrayImpl<Boolean> const &arya, ArrayImpl<Boolean> const &aryb)
-  {
-    std::vector<bool> const &aKnownVec = arya.getKnownVector();
-    std::vector<bool> const &bKnownVec = aryb.getKnownVector();
-    // Shorter is less
-    size_t aSize = aKnownVec.size();
-    size_t bSize = bKnownVec.size();
-    if (aSize < bSize)
-      return true;
-    if (aSize > bSize)
-      return false;
-
-    // Same size
-    std::vector<Boolean> const *aVec, *bVec;
-    arya.getContentsVector(aVec);
-    aryb.getContentsVector(bVec);
-
-    for (size_t i = 0; i < aSize; ++i) {
-      // Unknown is less than known
-      bool aKnown = aKnownVec[i];
-      bool bKnown = bKnownVec[i];
-      if (!aKnown && bKnown)
-        return true; // unknown < known
-      if (aKnown && !bKnown)
-        return false;
-      if (!aKnown)
-        continue; // neither known
-
-      // False less than true
-      if (!(*aVec)[i] && (*bVec)[i])
-        return true;
-      if ((*aVec)[i] && !(*bVec)[i])
-        return false;
-    }
-    return false; // equal
+    return compareKnownElements(*aVec, *bVec,
+                                arya.getKnownMask(), aryb.getKnownMask(),
+                                aSize) < 0;
   }
 
   template <typename T>
@@ -712,6 +782,96 @@ namespace PLEXIL
     return 3 + val.size();
   }
 
+  //
+  // Bulk conversion of numeric contents to and from big-endian
+  //
+  // On little-endian hosts, whole blocks are byte-swapped by simple
+  // loops the compiler recognizes and vectorizes; on big-endian hosts
+  // the contents are copied as is.
+  //
+
+  // Internal function
+  static inline bool hostIsBigEndian()
+  {
+    uint32_t const one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return !first;
+  }
+
+  // Internal function
+  static inline uint32_t byteSwap(uint32_t v)
+  {
+    return ((v & 0xFF000000U) >> 24) | ((v & 0x00FF0000U) >> 8)
+      | ((v & 0x0000FF00U) << 8) | ((v & 0x000000FFU) << 24);
+  }
+
+  // Internal function
+  static inline uint64_t byteSwap(uint64_t v)
+  {
+    return (((uint64_t) byteSwap((uint32_t) v)) << 32)
+      | (uint64_t) byteSwap((uint32_t) (v >> 32));
+  }
+
+  // Internal function
+  // U is the unsigned integer type of the same size as T.
+  template <typename T, typename U>
+  static char *serializeBlock(T const *src, size_t n, char *buf)
+  {
+    static_assert(sizeof(T) == sizeof(U), "serializeBlock: size mismatch");
+    if (hostIsBigEndian()) {
+      memcpy(buf, src, n * sizeof(T));
+      return buf + n * sizeof(T);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      U tmp;
+      memcpy(&tmp, src + i, sizeof(U));
+      tmp = byteSwap(tmp);
+      memcpy(buf + i * sizeof(U), &tmp, sizeof(U));
+    }
+    return buf + n * sizeof(T);
+  }
+
+  // Internal function
+  template <typename T, typename U>
+  static char const *deserializeBlock(T *dest, size_t n, char const *buf)
+  {
+    static_assert(sizeof(T) == sizeof(U), "deserializeBlock: size mismatch");
+    if (hostIsBigEndian()) {
+      memcpy(dest, buf, n * sizeof(T));
+      return buf + n * sizeof(T);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      U tmp;
+      memcpy(&tmp, buf + i * sizeof(U), sizeof(U));
+      tmp = byteSwap(tmp);
+      memcpy(dest + i, &tmp, sizeof(U));
+    }
+    return buf + n * sizeof(T);
+  }
+
+  // Internal functions
+  // Same format as n calls to serializeElement()
+  static char *serializeElements(Integer const *src, size_t n, char *buf)
+  {
+    return serializeBlock<Integer, uint32_t>(src, n, buf);
+  }
+
+  static char *serializeElements(Real const *src, size_t n, char *buf)
+  {
+    return serializeBlock<Real, uint64_t>(src, n, buf);
+  }
+
+  static char const *deserializeElements(Integer *dest, size_t n, char const *buf)
+  {
+    return deserializeBlock<Integer, uint32_t>(dest, n, buf);
+  }
+
+  static char const *deserializeElements(Real *dest, size_t n, char const *buf)
+  {
+    return deserializeBlock<Real, uint64_t>(dest, n, buf);
+  }
+
   // Internal function
   // Big-endian by bit, little-endian by byte
   static char *serializeBoolVector(std::vector<bool> const &val, char *buf)
@@ -827,6 +987,41 @@ namespace PLEXIL
     return result;
   }
 
+  // Internal function
+  static inline uint8_t reverseBits(uint8_t b)
+  {
+    b = (uint8_t) (((b & 0xF0) >> 4) | ((b & 0x0F) << 4));
+    b = (uint8_t) (((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+    b = (uint8_t) (((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+    return b;
+  }
+
+  // Internal function
+  // Same format as serializeBoolVector(), but a byte at a time
+  static char *serializeKnownMask(Array::KnownWord const *mask, size_t nbits, char *buf)
+  {
+    size_t const nBytes = bitVectorSize(nbits);
+    for (size_t k = 0; k < nBytes; ++k)
+      *buf++ = (char) reverseBits((uint8_t) (mask[k / 8] >> (8 * (k % 8))));
+    return buf;
+  }
+
+  // Internal function
+  // Presumes mask size has already been set.
+  static char const *deserializeKnownMask(std::vector<Array::KnownWord> &mask,
+                                          size_t nbits,
+                                          char const *buf)
+  {
+    std::fill(mask.begin(), mask.end(), 0);
+    size_t const nBytes = bitVectorSize(nbits);
+    for (size_t k = 0; k < nBytes; ++k)
+      mask[k / 8] |=
+        ((Array::KnownWord) reverseBits((uint8_t) *buf++)) << (8 * (k % 8));
+    if (nbits % 64)
+      mask.back() &= lowBits(nbits % 64);
+    return buf;
+  }
+
   /**
    * @brief Write a binary version of the object to the given buffer.
    * @param o The object.
@@ -850,15 +1045,10 @@ namespace PLEXIL
     *buf++ = (char) (0xFF & siz);
 
     // Write known vector
-    buf = serializeBoolVector(this->m_known, buf);
+    buf = serializeKnownMask(this->getKnownMask(), siz, buf);
 
     // Write array contents
-    for (size_t i = 0; i < siz; ++i) {
-      buf = serializeElement(m_contents[i], buf);
-      if (!buf)
-        return nullptr; // serializeElement failed
-    }
-    return buf;
+    return serializeElements(m_contents.data(), siz, buf);
   }
 
   template <>
@@ -877,7 +1067,7 @@ namespace PLEXIL
     *buf++ = (char) (0xFF & siz);
 
     // Write known vector
-    buf = serializeBoolVector(this->m_known, buf);
+    buf = serializeKnownMask(this->getKnownMask(), siz, buf);
 
     // Write array contents
     buf = serializeBoolVector(m_contents, buf);
@@ -900,7 +1090,7 @@ namespace PLEXIL
     *buf++ = (char) (0xFF & siz);
 
     // Write known vector
-    buf = serializeBoolVector(this->m_known, buf);
+    buf = serializeKnownMask(this->getKnownMask(), siz, buf);
 
     // Write array contents
     for (size_t i = 0; i < siz; ++i) {
@@ -927,17 +1117,14 @@ namespace PLEXIL
       return nullptr; // not an appropriate array
 
     // Get 3 bytes of size
-    size_t siz = (size_t) *buf++; siz = siz << 8;
-    siz += (size_t) *buf++; siz = siz << 8;
-    siz += (size_t) *buf++;
+    size_t siz = ((size_t) (unsigned char) *buf++) << 8;
+    siz = (siz + (size_t) (unsigned char) *buf++) << 8;
+    siz = siz + (size_t) (unsigned char) *buf++;
     
     this->resize(siz);
     
-    buf = deserializeBoolVector(this->m_known, buf);
-    for (size_t i = 0; i < siz; ++i)
-      buf = deserializeElement(m_contents[i], buf);
-
-    return buf;
+    buf = deserializeKnownMask(this->m_known, siz, buf);
+    return deserializeElements(m_contents.data(), siz, buf);
   }
 
   // Special case for Boolean
@@ -948,12 +1135,12 @@ namespace PLEXIL
       return nullptr; // not a Boolean array
 
     // Get 3 bytes of size
-    size_t siz = (size_t) *buf++; siz = siz << 8;
-    siz += (size_t) *buf++; siz = siz << 8;
-    siz += (size_t) *buf++;
+    size_t siz = ((size_t) (unsigned char) *buf++) << 8;
+    siz = (siz + (size_t) (unsigned char) *buf++) << 8;
+    siz = siz + (size_t) (unsigned char) *buf++;
     this->resize(siz);
     
-    buf = deserializeBoolVector(this->m_known, buf);
+    buf = deserializeKnownMask(this->m_known, siz, buf);
     buf = deserializeBoolVector(m_contents, buf);
     
     return buf;
@@ -966,13 +1153,13 @@ namespace PLEXIL
       return nullptr; // not an appropriate array
 
     // Get 3 bytes of size
-    size_t siz = (size_t) *buf++; siz = siz << 8;
-    siz += (size_t) *buf++; siz = siz << 8;
-    siz += (size_t) *buf++;
+    size_t siz = ((size_t) (unsigned char) *buf++) << 8;
+    siz = (siz + (size_t) (unsigned char) *buf++) << 8;
+    siz = siz + (size_t) (unsigned char) *buf++;
     
     this->resize(siz);
     
-    buf = deserializeBoolVector(this->m_known, buf);
+    buf = deserializeKnownMask(this->m_known, siz, buf);
     for (size_t i = 0; i < siz; ++i)
       buf = deserializeElement(m_contents[i], buf);
 
@@ -991,19 +1178,26 @@ namespace PLEXIL
   {
     NUM const dummy = 0;
     size_t siz = this->size();
+    if (siz > 0xFFFFFF)
+      return 0; // too big to serialize
     return 4 + bitVectorSize(siz) + siz * elementSerialSize(dummy);
   }
 
   template <>
   size_t ArrayImpl<Boolean>::serialSize() const
   {
-    return 4 + 2 * bitVectorSize(this->size());
+    size_t siz = this->size();
+    if (siz > 0xFFFFFF)
+      return 0; // too big to serialize
+    return 4 + 2 * bitVectorSize(siz);
   }
 
   // Requires traversing entire array
   size_t ArrayImpl<String>::serialSize() const
   {
     size_t siz = this->size();
+    if (siz > 0xFFFFFF)
+      return 0; // too big to serialize
     size_t result = 4 + bitVectorSize(siz);
     for (size_t i = 0; i < siz; ++i)
       result += 3 + m_contents[i].size();
@@ -1046,8 +1240,7 @@ namespace PLEXIL
   template bool operator!=(ArrayImpl<Real> const &,    ArrayImpl<Real> const &);
   template bool operator!=(ArrayImpl<String> const &,  ArrayImpl<String> const &);
 
-  // Explicitly defined above
-  // template bool operator<(ArrayImpl<Boolean> const &, ArrayImpl<Boolean> const &);
+  template bool operator<(ArrayImpl<Boolean> const &, ArrayImpl<Boolean> const &);
   template bool operator<(ArrayImpl<Integer> const &, ArrayImpl<Integer> const &);
   template bool operator<(ArrayImpl<Real> const &,    ArrayImpl<Real> const &);
   template bool operator<(ArrayImpl<String> const &,  ArrayImpl<String> const &);
@@ -952,6 +952,101 @@ static bool testLessThan()
   return true;
 }
 
+// Arrays spanning several words of the known mask
+static bool testLargeArrays()
+{
+  size_t const n = 150; // two full mask words and a partial one
+
+  {
+    IntegerArray a(n);
+    assertTrue_1(a.size() == n);
+    assertTrue_1(!a.allElementsKnown());
+    assertTrue_1(!a.anyElementsKnown());
+
+    a.setElement(n - 1, (Integer) 7);
+    assertTrue_1(a.anyElementsKnown());
+    assertTrue_1(!a.allElementsKnown());
+    assertTrue_1(a.elementKnown(n - 1));
+    assertTrue_1(!a.elementKnown(n - 2));
+
+    for (size_t i = 0; i < n; ++i)
+      a.setElement(i, (Integer) i);
+    assertTrue_1(a.allElementsKnown());
+
+    IntegerArray b(a);
+    assertTrue_1(a == b);
+
+    // Differ in a fully known block
+    b.setElement(70, (Integer) 0);
+    assertTrue_1(!(a == b));
+    assertTrue_1(b < a);
+    assertTrue_1(!(a < b));
+    b.setElement(70, (Integer) 70);
+    assertTrue_1(a == b);
+
+    // Contents of unknown elements don't affect equality
+    a.setElementUnknown(130);
+    b.setElementUnknown(130);
+    b.setElement(131, (Integer) 0);
+    b.setElementUnknown(131);
+    a.setElementUnknown(131);
+    assertTrue_1(a == b);
+    assertTrue_1(!(a < b));
+    assertTrue_1(!(b < a));
+
+    // Unknown is less than known
+    b.setElement(131, (Integer) -1);
+    assertTrue_1(!(a == b));
+    assertTrue_1(a < b);
+    assertTrue_1(!(b < a));
+
+    // Shrinking clears the mask beyond the new end
+    a.resize(100);
+    assertTrue_1(a.size() == 100);
+    assertTrue_1(a.allElementsKnown());
+    a.resize(n);
+    assertTrue_1(!a.allElementsKnown());
+    assertTrue_1(a.elementKnown(99));
+    assertTrue_1(!a.elementKnown(100));
+
+    a.reset();
+    assertTrue_1(!a.anyElementsKnown());
+  }
+
+  {
+    RealArray a(n, 1.5);
+    assertTrue_1(a.allElementsKnown());
+    RealArray b(n, 1.5);
+    assertTrue_1(a == b);
+    b.setElement(n - 1, 2.5);
+    assertTrue_1(!(a == b));
+    assertTrue_1(a < b);
+  }
+
+  {
+    BooleanArray a(n, false);
+    BooleanArray b(n, false);
+    assertTrue_1(a == b);
+    b.setElement(64, true);
+    assertTrue_1(!(a == b));
+    assertTrue_1(a < b);
+    a.setElementUnknown(64);
+    b.setElementUnknown(64);
+    assertTrue_1(a == b);
+  }
+
+  {
+    StringArray a(n, std::string("foo"));
+    StringArray b(a);
+    assertTrue_1(a == b);
+    b.setElement(63, std::string("bar"));
+    assertTrue_1(!(a == b));
+    assertTrue_1(b < a);
+  }
+
+  return true;
+}
+
 bool arrayTest()
 {
   runTest(testConstructors);
@@ -959,6 +1054,7 @@ bool arrayTest()
   runTest(testSetters);
   runTest(testEquality);
   runTest(testLessThan);
+  runTest(testLargeArrays);
 
   return true;
 }
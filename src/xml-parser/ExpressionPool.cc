@@ -0,0 +1,213 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExpressionPool.hh"
+
+#include "Constant.hh"
+#include "Debug.hh"
+#include "ExpressionConstants.hh"
+#include "Function.hh"
+#include "NodeImpl.hh"
+#include "PlanError.hh"
+
+namespace PLEXIL
+{
+
+  ExpressionPool::ExpressionPool(NodeImpl *owner)
+    : m_owner(owner),
+      m_constants(),
+      m_expressions()
+  {
+  }
+
+  // Only scalar user types are folded and shared as constants.
+  static bool isFoldableType(ValueType type)
+  {
+    switch (type) {
+    case BOOLEAN_TYPE:
+    case INTEGER_TYPE:
+    case REAL_TYPE:
+    case STRING_TYPE:
+      return true;
+
+    default:
+      return false;
+    }
+  }
+
+  // Evaluate an expression whose subexpressions are all constant.
+  // Return false if evaluating it is an error; leave that for the Exec
+  // to report when (and if) the expression is evaluated at run time.
+  // Plan errors are thrown while evaluating, whatever the application's
+  // setting, so that one can't abort the parse.
+  static bool evaluate(Expression *exp, Value &result)
+  {
+    bool const wasThrowing = PlanError::throwEnabled();
+    PlanError::doThrowExceptions();
+    bool ok = true;
+    exp->activate();
+    try {
+      result = exp->toValue();
+    }
+    catch (PlanError const & /* e */) {
+      ok = false;
+    }
+    exp->deactivate();
+    if (!wasThrowing)
+      PlanError::doNotThrowExceptions();
+    condDebugMsg(!ok, "ExpressionPool:evaluate", " not folding " << exp->exprName());
+    return ok;
+  }
+
+  Expression *ExpressionPool::internConstant(Expression *exp, bool &wasCreated)
+  {
+    Value val;
+    if (!isFoldableType(exp->valueType()) || !evaluate(exp, val))
+      return exp;
+
+    Expression *result = internValue(exp->valueType(), val);
+    delete exp;
+    wasCreated = false;
+    return result;
+  }
+
+  Expression *ExpressionPool::fold(Function *fn, bool &wasCreated)
+  {
+    Value val;
+    if (!isFoldableType(fn->valueType()) || !evaluate(fn, val))
+      return fn;
+
+    debugMsg("ExpressionPool:fold", ' ' << *fn << " => " << val);
+    Expression *result = internValue(fn->valueType(), val);
+    delete fn;
+    wasCreated = false;
+    return result;
+  }
+
+  Expression *ExpressionPool::find(void const *kind,
+                                   ValueType type,
+                                   std::vector<Expression *> const &args) const
+  {
+    Key k {kind, type, std::vector<Expression const *>(args.begin(), args.end())};
+    ExpressionMap::const_iterator it = m_expressions.find(k);
+    if (it == m_expressions.end())
+      return nullptr;
+    debugMsg("ExpressionPool:find", " sharing " << *it->second);
+    return it->second;
+  }
+
+  void ExpressionPool::add(void const *kind,
+                           ValueType type,
+                           std::vector<Expression *> const &args,
+                           Expression *exp)
+  {
+    Key k {kind, type, std::vector<Expression const *>(args.begin(), args.end())};
+    m_expressions.emplace(std::move(k), exp);
+    m_owner->addSharedExpression(exp);
+  }
+
+  Expression *ExpressionPool::internValue(ValueType type, Value const &val)
+  {
+    if (type == BOOLEAN_TYPE) {
+      Boolean b;
+      if (!val.getValue(b))
+        return UNKNOWN_BOOLEAN_EXP();
+      return b ? TRUE_EXP() : FALSE_EXP();
+    }
+
+    std::pair<ValueType, Value> key(type, val);
+    ConstantMap::const_iterator it = m_constants.find(key);
+    if (it != m_constants.end())
+      return it->second;
+
+    Expression *result = nullptr;
+    switch (type) {
+    case INTEGER_TYPE: {
+      Integer i;
+      if (val.getValue(i))
+        result = new Constant<Integer>(i);
+      else
+        result = new Constant<Integer>();
+      break;
+    }
+
+    case REAL_TYPE: {
+      Real r;
+      if (val.getValue(r))
+        result = new Constant<Real>(r);
+      else
+        result = new Constant<Real>();
+      break;
+    }
+
+    case STRING_TYPE: {
+      String const *s;
+      if (val.getValuePointer(s))
+        result = new Constant<String>(*s);
+      else
+        result = new Constant<String>();
+      break;
+    }
+
+    default:
+      errorMsg("ExpressionPool::internValue: unexpected value type "
+               << valueTypeName(type));
+    }
+
+    m_constants.emplace(std::move(key), result);
+    m_owner->addSharedExpression(result);
+    return result;
+  }
+
+  bool ExpressionPool::Key::operator==(Key const &other) const
+  {
+    return kind == other.kind
+      && type == other.type
+      && args == other.args;
+  }
+
+  size_t ExpressionPool::KeyHash::operator()(Key const &k) const
+  {
+    std::hash<void const *> hasher;
+    size_t result = hasher(k.kind) ^ (static_cast<size_t>(k.type) << 1);
+    for (Expression const *arg : k.args)
+      result = result * 31 + hasher(arg);
+    return result;
+  }
+
+  static ExpressionPool *s_expressionPool = nullptr;
+
+  void setExpressionPool(ExpressionPool *pool)
+  {
+    s_expressionPool = pool;
+  }
+
+  ExpressionPool *getExpressionPool()
+  {
+    return s_expressionPool;
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,149 @@
+/* Copyright (c) 2006-2022, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_EXPRESSION_POOL_HH
+#define PLEXIL_EXPRESSION_POOL_HH
+
+#include "Value.hh"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace PLEXIL
+{
+  class Expression;
+  class Function;
+  class NodeImpl;
+
+  //! \class ExpressionPool
+  //! \brief Plan optimization pass applied while a plan's expressions
+  //!        are being constructed.
+  //!
+  //! Folds function calls whose arguments are all constant into
+  //! Constants, and hash-conses structurally identical side-effect-free
+  //! expressions, so that e.g. the same comparison of a variable
+  //! appearing in hundreds of nodes is represented, listened to, and
+  //! evaluated once.
+  //!
+  //! Expressions are identified by their operator (or kind) and the
+  //! identities of their subexpressions. Variables are distinct objects
+  //! in each scope, so sharing never crosses a scope boundary.
+  //!
+  //! Lookups are never shared.  A Lookup reads its state when it is
+  //! activated, and an expression already active for one node is not
+  //! activated again for another, so a shared LookupNow would return
+  //! the value read for the first node.  Lookups are owned by the
+  //! expressions containing them, so those aren't shared either.
+  //!
+  //! Shared expressions are owned by the root node of the plan, which
+  //! deletes them after all of its descendants.  Consumers receive them
+  //! with wasCreated == false and must not delete them.
+  class ExpressionPool final
+  {
+  public:
+    //! \brief Constructor.
+    //! \param owner The root node of the plan being parsed.
+    ExpressionPool(NodeImpl *owner);
+
+    ~ExpressionPool() = default;
+
+    //! \brief Replace a freshly constructed constant scalar expression
+    //!        with the shared instance of the same type and value.
+    //! \param exp The expression; deleted if not retained.
+    //! \param wasCreated Set to false if the shared instance is returned.
+    //! \return The shared instance, or exp if it could not be shared.
+    Expression *internConstant(Expression *exp, bool &wasCreated);
+
+    //! \brief Attempt to fold a function whose arguments are all constant.
+    //! \param fn The function; deleted if folded.
+    //! \param wasCreated Set to false if a shared constant is returned.
+    //! \return The shared constant, or fn if it could not be folded.
+    Expression *fold(Function *fn, bool &wasCreated);
+
+    //! \brief Find a shared expression.
+    //! \param kind Identifies the operation, e.g. the Operator instance.
+    //! \param type The result type of the expression.
+    //! \param args The subexpressions, none of them owned by their parent.
+    //! \return The shared expression; null if none.
+    Expression *find(void const *kind,
+                     ValueType type,
+                     std::vector<Expression *> const &args) const;
+
+    //! \brief Add a newly constructed expression to the pool.
+    //! \param kind Identifies the operation, e.g. the Operator instance.
+    //! \param type The result type of the expression.
+    //! \param args The subexpressions, none of them owned by exp.
+    //! \param exp The expression. The pool's owner takes ownership of it.
+    void add(void const *kind,
+             ValueType type,
+             std::vector<Expression *> const &args,
+             Expression *exp);
+
+  private:
+
+    // Not implemented
+    ExpressionPool() = delete;
+    ExpressionPool(ExpressionPool const &) = delete;
+    ExpressionPool(ExpressionPool &&) = delete;
+    ExpressionPool &operator=(ExpressionPool const &) = delete;
+    ExpressionPool &operator=(ExpressionPool &&) = delete;
+
+    Expression *internValue(ValueType type, Value const &val);
+
+    struct Key
+    {
+      void const *kind;
+      ValueType type;
+      std::vector<Expression const *> args;
+
+      bool operator==(Key const &other) const;
+    };
+
+    struct KeyHash
+    {
+      size_t operator()(Key const &k) const;
+    };
+
+    using ConstantMap = std::map<std::pair<ValueType, Value>, Expression *>;
+    using ExpressionMap = std::unordered_map<Key, Expression *, KeyHash>;
+
+    NodeImpl *m_owner;
+    ConstantMap m_constants;
+    ExpressionMap m_expressions;
+  };
+
+  //! \brief Set the pool used by the expression factories.
+  //! \param pool Pointer to the pool; may be null.
+  extern void setExpressionPool(ExpressionPool *pool);
+
+  //! \brief Get the pool used by the expression factories.
+  //! \return Pointer to the pool; null if plan optimization is not active.
+  extern ExpressionPool *getExpressionPool();
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_EXPRESSION_POOL_HH
@@ -28,6 +28,7 @@
 
 #include "createExpression.hh"
 #include "ExpressionFactory.hh"
+#include "ExpressionPool.hh"
 #include "Function.hh"
 #include "Operator.hh"
 #include "parser-utils.hh"
@@ -99,8 +100,8 @@ namespace PLEXIL
       }
       catch (ParserException & /* e */) {
         for (size_t j = 0; j < i; j++)
-          if (argCreated[i])
-            delete args[i];
+          if (argCreated[j])
+            delete args[j];
         throw;
       }
 
@@ -111,12 +112,45 @@ namespace PLEXIL
                                        << m_operation->getName()
                                        << "\n Arg types " << valueTypeName(argTypes[0])
                                        << ", " << valueTypeName(argTypes[1]));
+
+      // While parsing a plan, share an identical expression if one exists.
+      // Only possible if none of the arguments are owned by this expression,
+      // which also excludes any expression containing a Lookup.
+      ExpressionPool *pool = getExpressionPool();
+      bool shareable = pool && n;
+      bool allConstant = n;
+      for (size_t j = 0; j < n; ++j) {
+        if (argCreated[j])
+          shareable = false;
+        if (!args[j]->isConstant())
+          allConstant = false;
+      }
+      if (shareable) {
+        Expression *shared = pool->find(oper, oper->valueType(), args);
+        if (shared) {
+          wasCreated = false;
+          return shared;
+        }
+      }
+
       Function *result = m_operation->constructFunction(oper, n);
 
       for (size_t j = 0 ; j < n; ++j) {
         result->setArgument(j, args[j], argCreated[j]);
       }
       wasCreated = true;
+
+      if (pool) {
+        if (allConstant) {
+          Expression *folded = pool->fold(result, wasCreated);
+          if (!wasCreated)
+            return folded;
+        }
+        if (shareable) {
+          pool->add(oper, oper->valueType(), args, result);
+          wasCreated = false;
+        }
+      }
       return result;
     }
 
@@ -40,6 +40,7 @@
 #include "createExpression.hh"
 #include "Debug.hh"
 #include "Error.hh"
+#include "ExpressionPool.hh"
 #include "Lookup.hh"
 #include "NodeConnector.hh"
 #include "NodeConstantExpressions.hh"
@@ -133,6 +134,9 @@ namespace PLEXIL
                   "createExpression: No factory registered for name \"" << name << "\".");
 
     Expression *retval = entry->factory->allocate(expr, node, wasCreated, returnType);
+    ExpressionPool *pool = getExpressionPool();
+    if (pool && wasCreated && retval->isConstant())
+      retval = pool->internConstant(retval, wasCreated);
     debugMsg("createExpression",
              " Created " << (wasCreated ? "" : "reference to ") << retval->toString());
     return retval;
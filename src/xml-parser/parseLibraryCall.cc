@@ -27,6 +27,7 @@
 #include "createExpression.hh"
 #include "Debug.hh"
 #include "LibraryCallNode.hh"
+#include "NodeVariableMap.hh"
 #include "parseNode.hh"
 #include "parsePlan.hh"
 #include "parser-utils.hh"
@@ -175,6 +176,8 @@ namespace PLEXIL
 
     pushSymbolTable(l->symtab);
     try {
+      // The aliases are the outermost scope of the called node
+      NodeVariableScope aliases(node->getChildVariableMap());
       finalizeNode(node->getChildren().front().get(), calleeXml);
     }
     catch (...) {
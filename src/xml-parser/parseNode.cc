@@ -40,6 +40,7 @@
 #include "ListNode.hh"
 #include "Mutex.hh"
 #include "NodeFactory.hh"
+#include "NodeVariableMap.hh"
 #include "parseAssignment.hh"
 #include "parseLibraryCall.hh"
 #include "parser-utils.hh"
@@ -1274,6 +1275,9 @@ namespace PLEXIL
   void finalizeNode(NodeImpl *node, xml_node const xml)
   {
     debugMsg("finalizeNode", " node " << node->getNodeId());
+    // Names used in this node and its descendants resolve through
+    // the plan's scope table while the node's variables are open
+    NodeVariableScope scope(node->getVariableMap());
     linkAndInitializeInterfaceVars(node, xml);
     constructVariableInitializers(node, xml);
     createConditions(node, xml);
@@ -25,9 +25,11 @@
 */
 
 #include "Debug.hh"
+#include "ExpressionPool.hh"
 #include "NodeImpl.hh"
 #include "parseGlobalDeclarations.hh"
 #include "parseNode.hh"
+#include "parsePlan.hh"
 #include "parser-utils.hh"
 #include "ParserException.hh"
 #include "PlexilSchema.hh"
@@ -134,16 +136,23 @@ namespace PLEXIL
     SymbolTable *symtab = checkPlan(xml);
     NodeImpl *result = nullptr;
     result = constructPlan(xml, symtab, nullptr); // can throw ParserException
+
+    // Fold constants and share common subexpressions while
+    // constructing the plan's expressions
+    ExpressionPool pool(result);
+    setExpressionPool(&pool);
     pushSymbolTable(symtab);
     try {
       finalizeNode(result, xml.child(NODE_TAG));
     }
     catch (...) {
+      setExpressionPool(nullptr);
       popSymbolTable();
       delete symtab;
       throw;
     }
 
+    setExpressionPool(nullptr);
     popSymbolTable();
     delete symtab;
 